@@ -36,4 +36,5 @@ std::string const bench_mpp = "\nBenchmarking mp++.";
 std::string const bench_cpp_int = "\n\nBenchmarking cpp_int.";
 std::string const bench_mpz_int = "\n\nBenchmarking mpz_int.";
 std::string const bench_fmpzxx =  "\n\nBenchmarking fmpzxx.";
+std::string const bench_mpz =     "\n\nBenchmarking mpz_t.";
 } // namespace
@@ -92,6 +92,22 @@ int main()
         s += "['mp++','total'," + std::to_string(st1.elapsed()) + "],";
         std::cout << totalRuntime;
     }
+    {
+        std::cout << "\n\nBenchmarking mp++ (dot).";
+        simple_timer st1;
+        double init_time;
+        auto p = get_init_vectors<integer_t>(init_time);
+        s += "['mp++ (dot)','init'," + std::to_string(init_time) + "],";
+        {
+            simple_timer st2;
+            const auto ret = dot(p.first.begin(), p.first.end(), p.second.begin());
+            std::cout << " / " << ret;
+            s += "['mp++ (dot)','operation'," + std::to_string(st2.elapsed()) + "],";
+            std::cout << operRuntime;
+        }
+        s += "['mp++ (dot)','total'," + std::to_string(st1.elapsed()) + "],";
+        std::cout << totalRuntime;
+    }
     {
         std::cout << "\n\nBenchmarking int64.";
         simple_timer st1;
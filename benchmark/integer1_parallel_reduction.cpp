@@ -0,0 +1,81 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <mp++/mp++.hpp>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "constStrings.hpp"
+#include "simple_timer.hpp"
+
+#include <boost/format.hpp>
+
+using namespace mppp;
+using namespace mppp_bench;
+
+static std::mt19937 rng;
+
+using integer_t = integer<1>;
+static const std::string name = "integer1_parallel_reduction";
+
+constexpr auto size = 30000000ul;
+
+// NOTE: the product of many values is much more expensive
+// than their sum, use a shorter range.
+constexpr auto prod_size = 1000000ul;
+
+int main()
+{
+    // Warm up.
+    for (auto volatile counter = 0ull; counter < 1000000000ull; ++counter) {
+    }
+    // Setup of the python output.
+    std::string s = pyPrefix;
+    std::cout << "\nParallel reductions 1\n----------------------------------" << std::endl;
+    rng.seed(1);
+    std::uniform_int_distribution<int> dist(1, 1000), sign(0, 1);
+    std::vector<integer_t> v1(size), v2(size);
+    std::generate(v1.begin(), v1.end(), [&dist, &sign]() { return integer_t(dist(rng) * (sign(rng) ? 1 : -1)); });
+    std::generate(v2.begin(), v2.end(), [&dist, &sign]() { return integer_t(dist(rng) * (sign(rng) ? 1 : -1)); });
+    const auto max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    for (unsigned nt = 1; nt <= max_threads; nt *= 2u) {
+        parallel::set_n_threads(nt);
+        // NOTE: run once to create the threads of the pool.
+        parallel::sum(v1.begin(), v1.begin() + 1);
+        const std::string lib = "mp++ (" + std::to_string(nt) + (nt == 1u ? " thread)" : " threads)");
+        std::cout << "\n\nBenchmarking " << lib << ".";
+        {
+            simple_timer st;
+            std::cout << "\nSum: " << parallel::sum(v1.begin(), v1.end());
+            s += "['" + lib + "','sum'," + std::to_string(st.elapsed()) + "],";
+            std::cout << operRuntime;
+        }
+        {
+            simple_timer st;
+            std::cout << "\nProduct: " << parallel::product(v1.begin(), v1.begin() + prod_size).nbits() << " bits";
+            s += "['" + lib + "','product'," + std::to_string(st.elapsed()) + "],";
+            std::cout << operRuntime;
+        }
+        {
+            simple_timer st;
+            std::cout << "\nDot: " << parallel::dot(v1.begin(), v1.end(), v2.begin());
+            s += "['" + lib + "','dot'," + std::to_string(st.elapsed()) + "],";
+            std::cout << operRuntime;
+        }
+    }
+    s += boost::str(boost::format(pySuffix) % name);
+    std::ofstream of(name + ".py", std::ios_base::trunc);
+    of << s;
+    of.close();
+    std::cout << "\n\n" << std::flush;
+}
@@ -0,0 +1,80 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <fstream>
+#include <gmp.h>
+#include <iostream>
+#include <mp++/mp++.hpp>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "constStrings.hpp"
+#include "simple_timer.hpp"
+
+#include <boost/format.hpp>
+
+using namespace mppp;
+using namespace mppp_bench;
+
+static std::mt19937 rng;
+
+using integer_t = integer<1>;
+static const std::string name = "integer1_vec_factor";
+
+constexpr auto size = 100000ul;
+
+// Random values of exactly 1 limb.
+template <typename T, typename F>
+static inline std::vector<T> get_init_vector(double &init_time, const F &assign)
+{
+    rng.seed(1);
+    std::uniform_int_distribution<::mp_limb_t> dist(::mp_limb_t(1) << (GMP_NUMB_BITS - 1), GMP_NUMB_MAX);
+    simple_timer st;
+    std::vector<T> v(size);
+    for (auto i = 0ul; i < size; ++i) {
+        assign(v[i], integer_t{dist(rng)});
+    }
+    std::cout << initRuntime;
+    init_time = st.elapsed();
+    return v;
+}
+
+int main()
+{
+    // Warm up.
+    for (auto volatile counter = 0ull; counter < 1000000000ull; ++counter) {
+    }
+    // Setup of the python output.
+    std::string s = pyPrefix;
+    {
+        std::cout << "\nVector factorisation 1\n----------------------------------" << std::endl;
+        std::cout << bench_mpp;
+        simple_timer st1;
+        double init_time;
+        auto v = get_init_vector<integer_t>(init_time, [](integer_t &out, const integer_t &n) { out = n; });
+        s += "['mp++','init'," + std::to_string(init_time) + "],";
+        {
+            simple_timer st2;
+            unsigned long count = 0;
+            for (auto i = 0ul; i < size; ++i) {
+                count += static_cast<unsigned long>(factor(v[i]).size());
+            }
+            std::cout << " / " << count;
+            s += "['mp++','operation'," + std::to_string(st2.elapsed()) + "],";
+            std::cout << operRuntime;
+        }
+        s += "['mp++','total'," + std::to_string(st1.elapsed()) + "],";
+        std::cout << totalRuntime;
+    }
+    s += boost::str(boost::format(pySuffix) % name);
+    std::ofstream of(name + ".py", std::ios_base::trunc);
+    of << s;
+    of.close();
+    std::cout << "\n\n" << std::flush;
+}
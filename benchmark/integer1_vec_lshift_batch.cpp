@@ -0,0 +1,103 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <mp++/mp++.hpp>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "constStrings.hpp"
+#include "simple_timer.hpp"
+
+#include <boost/format.hpp>
+
+using namespace mppp;
+using namespace mppp_bench;
+
+static std::mt19937 rng;
+
+using integer_t = integer<1>;
+static const std::string name = "integer1_vec_lshift_batch";
+
+constexpr auto size = 30000000ul;
+
+// NOTE: all the elements are shifted by the same amount.
+constexpr unsigned shift = 5;
+
+static inline std::vector<integer_t> get_init_vector(double &init_time)
+{
+    rng.seed(45);
+    std::uniform_int_distribution<int> dist(1, 10), sign(0, 1);
+    simple_timer st;
+    std::vector<integer_t> v(size);
+    std::generate(v.begin(), v.end(), [&dist, &sign]() { return integer_t(dist(rng) * (sign(rng) ? 1 : -1)); });
+    std::cout << initRuntime;
+    init_time = st.elapsed();
+    return v;
+}
+
+int main()
+{
+    // Warm up.
+    for (auto volatile counter = 0ull; counter < 1000000000ull; ++counter) {
+    }
+    // Setup of the python output.
+    std::string s = pyPrefix;
+    {
+        std::cout << "\nVector batch left shift signed 1\n----------------------------------" << std::endl;
+        std::cout << bench_mpp;
+        simple_timer st1;
+        double init_time;
+        auto v1 = get_init_vector(init_time);
+        std::vector<integer_t> v2(size);
+        s += "['mp++','init'," + std::to_string(init_time) + "],";
+        {
+            simple_timer st2;
+            for (auto i = 0ul; i < size; ++i) {
+                mul_2exp(v2[i], v1[i], shift);
+            }
+            std::cout << " / " << v2[size - 1u];
+            s += "['mp++','operation'," + std::to_string(st2.elapsed()) + "],";
+            std::cout << operRuntime;
+        }
+        s += "['mp++','total'," + std::to_string(st1.elapsed()) + "],";
+        std::cout << totalRuntime;
+    }
+    {
+        std::cout << "\n\nBenchmarking mp++ (integer_vector).";
+        simple_timer st1;
+        double init_time;
+        integer_vector<1> v1, v2;
+        {
+            const auto v = get_init_vector(init_time);
+            simple_timer st3;
+            for (const auto &n : v) {
+                v1.push_back(n);
+            }
+            init_time += st3.elapsed();
+        }
+        s += "['mp++ (integer_vector)','init'," + std::to_string(init_time) + "],";
+        {
+            simple_timer st2;
+            mul_2exp(v2, v1, shift);
+            std::cout << " / " << v2.get(size - 1u);
+            s += "['mp++ (integer_vector)','operation'," + std::to_string(st2.elapsed()) + "],";
+            std::cout << operRuntime;
+        }
+        s += "['mp++ (integer_vector)','total'," + std::to_string(st1.elapsed()) + "],";
+        std::cout << totalRuntime;
+    }
+    s += boost::str(boost::format(pySuffix) % name);
+    std::ofstream of(name + ".py", std::ios_base::trunc);
+    of << s;
+    of.close();
+    std::cout << "\n\n" << std::flush;
+}
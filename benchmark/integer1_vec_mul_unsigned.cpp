@@ -96,6 +96,33 @@ int main()
         s += "['mp++','total'," + std::to_string(st1.elapsed()) + "],";
         std::cout << totalRuntime;
     }
+    {
+        std::cout << "\n\nBenchmarking mp++ (integer_vector).";
+        simple_timer st1;
+        double init_time;
+        integer_vector<1> v1, v2, v3, v4;
+        {
+            auto p = get_init_vectors<integer_t>(init_time);
+            simple_timer st3;
+            for (auto i = 0ul; i < size; ++i) {
+                v1.push_back(std::get<0>(p)[i]);
+                v2.push_back(std::get<1>(p)[i]);
+                v3.push_back(std::get<2>(p)[i]);
+            }
+            init_time += st3.elapsed();
+        }
+        s += "['mp++ (integer_vector)','init'," + std::to_string(init_time) + "],";
+        {
+            simple_timer st2;
+            mul(v4, v1, v2);
+            add(v4, v3, v4);
+            std::cout << " / " << v4.get(size - 1u);
+            s += "['mp++ (integer_vector)','operation'," + std::to_string(st2.elapsed()) + "],";
+            std::cout << operRuntime;
+        }
+        s += "['mp++ (integer_vector)','total'," + std::to_string(st1.elapsed()) + "],";
+        std::cout << totalRuntime;
+    }
     {
         std::cout << "\n\nBenchmarking uint64.";
         simple_timer st1;
@@ -0,0 +1,144 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <fstream>
+#include <gmp.h>
+#include <iostream>
+#include <mp++/mp++.hpp>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "constStrings.hpp"
+#include "simple_timer.hpp"
+
+#include <boost/format.hpp>
+#if defined(MPPP_BENCHMARK_BOOST)
+#include <boost/multiprecision/cpp_int.hpp>
+#include <boost/multiprecision/miller_rabin.hpp>
+#endif
+
+using namespace mppp;
+using namespace mppp_bench;
+
+#if defined(MPPP_BENCHMARK_BOOST)
+using cpp_int = boost::multiprecision::number<boost::multiprecision::cpp_int_backend<>, boost::multiprecision::et_off>;
+#endif
+
+static std::mt19937 rng;
+
+using integer_t = integer<1>;
+static const std::string name = "integer1_vec_probab_prime_p";
+
+constexpr auto size = 3000000ul;
+
+// Random nonnegative integer with n limbs.
+static integer_t random_limbs(unsigned n)
+{
+    std::uniform_int_distribution<::mp_limb_t> ldist(0, GMP_NUMB_MAX);
+    integer_t retval;
+    for (auto i = 0u; i < n; ++i) {
+        retval <<= GMP_NUMB_BITS;
+        retval += ldist(rng);
+    }
+    return retval;
+}
+
+// Odd candidates of exactly 1 limbs.
+template <typename T, typename F>
+static inline std::vector<T> get_init_vector(double &init_time, const F &assign)
+{
+    rng.seed(1);
+    simple_timer st;
+    std::vector<T> v(size);
+    for (auto i = 0ul; i < size; ++i) {
+        auto n = random_limbs(1);
+        // Set the top and bottom bits.
+        n |= (integer_t{1} << (GMP_NUMB_BITS * 1 - 1)) + 1;
+        assign(v[i], n);
+    }
+    std::cout << initRuntime;
+    init_time = st.elapsed();
+    return v;
+}
+
+int main()
+{
+    // Warm up.
+    for (auto volatile counter = 0ull; counter < 1000000000ull; ++counter) {
+    }
+    // Setup of the python output.
+    std::string s = pyPrefix;
+    {
+        std::cout << "\nVector primality test 1\n----------------------------------" << std::endl;
+        std::cout << bench_mpp;
+        simple_timer st1;
+        double init_time;
+        auto v = get_init_vector<integer_t>(init_time, [](integer_t &out, const integer_t &n) { out = n; });
+        s += "['mp++','init'," + std::to_string(init_time) + "],";
+        {
+            simple_timer st2;
+            unsigned long count = 0;
+            for (auto i = 0ul; i < size; ++i) {
+                count += static_cast<unsigned long>(probab_prime_p(v[i]) != 0);
+            }
+            std::cout << " / " << count;
+            s += "['mp++','operation'," + std::to_string(st2.elapsed()) + "],";
+            std::cout << operRuntime;
+        }
+        s += "['mp++','total'," + std::to_string(st1.elapsed()) + "],";
+        std::cout << totalRuntime;
+    }
+    {
+        std::cout << bench_mpz;
+        simple_timer st1;
+        double init_time;
+        auto v = get_init_vector<detail::mpz_raii>(init_time, [](detail::mpz_raii &out, const integer_t &n) {
+            ::mpz_set(&out.m_mpz, n.get_mpz_view());
+        });
+        s += "['GMP','init'," + std::to_string(init_time) + "],";
+        {
+            simple_timer st2;
+            unsigned long count = 0;
+            for (auto i = 0ul; i < size; ++i) {
+                count += static_cast<unsigned long>(::mpz_probab_prime_p(&v[i].m_mpz, 25) != 0);
+            }
+            std::cout << " / " << count;
+            s += "['GMP','operation'," + std::to_string(st2.elapsed()) + "],";
+            std::cout << operRuntime;
+        }
+        s += "['GMP','total'," + std::to_string(st1.elapsed()) + "],";
+        std::cout << totalRuntime;
+    }
+#if defined(MPPP_BENCHMARK_BOOST)
+    {
+        std::cout << bench_cpp_int;
+        simple_timer st1;
+        double init_time;
+        auto v = get_init_vector<cpp_int>(init_time, [](cpp_int &out, const integer_t &n) { out = cpp_int(n.to_string()); });
+        s += "['Boost (cpp_int)','init'," + std::to_string(init_time) + "],";
+        {
+            simple_timer st2;
+            unsigned long count = 0;
+            for (auto i = 0ul; i < size; ++i) {
+                count += static_cast<unsigned long>(boost::multiprecision::miller_rabin_test(v[i], 25));
+            }
+            std::cout << " / " << count;
+            s += "['Boost (cpp_int)','operation'," + std::to_string(st2.elapsed()) + "],";
+            std::cout << operRuntime;
+        }
+        s += "['Boost (cpp_int)','total'," + std::to_string(st1.elapsed()) + "],";
+        std::cout << totalRuntime;
+    }
+#endif
+    s += boost::str(boost::format(pySuffix) % name);
+    std::ofstream of(name + ".py", std::ios_base::trunc);
+    of << s;
+    of.close();
+    std::cout << "\n\n" << std::flush;
+}
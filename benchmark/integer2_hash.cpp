@@ -0,0 +1,113 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <mp++/mp++.hpp>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <gmp.h>
+
+#include "constStrings.hpp"
+#include "simple_timer.hpp"
+
+#include <boost/format.hpp>
+
+using namespace mppp;
+using namespace mppp_bench;
+
+using integer_t = integer<2>;
+static const std::string name = "integer2_hash";
+
+constexpr auto size = 1000000ul;
+
+static std::mt19937 rng;
+
+// The hash function used by mp++ up to version 0.18, for comparison.
+struct boost_hasher {
+    std::size_t operator()(const integer_t &n) const
+    {
+        const auto v = n.get_mpz_view();
+        const detail::mpz_struct_t *m = v;
+        const auto size = m->_mp_size;
+        const auto asize = static_cast<std::size_t>(size >= 0 ? size : -size);
+        auto retval = static_cast<std::size_t>(size);
+        for (std::size_t i = 0; i < asize; ++i) {
+            retval ^= (m->_mp_d[i] & GMP_NUMB_MASK) + std::size_t(0x9e3779b9ul) + (retval << 6) + (retval >> 2);
+        }
+        return retval;
+    }
+};
+
+// Random values with nlimbs limbs.
+static std::vector<integer_t> get_random_vector(unsigned nlimbs)
+{
+    rng.seed(0);
+    std::vector<integer_t> retval(size / nlimbs);
+    for (auto &n : retval) {
+        for (auto i = 0u; i < nlimbs; ++i) {
+            n <<= GMP_NUMB_BITS;
+            n += rng();
+        }
+    }
+    return retval;
+}
+
+template <typename Hasher>
+static void run(const std::string &lib, std::string &s)
+{
+    const Hasher hasher{};
+    for (auto nlimbs : {1u, 2u, 8u, 64u}) {
+        const auto v = get_random_vector(nlimbs);
+        std::size_t acc = 0;
+        simple_timer st;
+        // Hash each value repeatedly, so that the runtimes
+        // of the different sizes are comparable.
+        for (auto r = 0u; r < nlimbs * 10u; ++r) {
+            for (const auto &n : v) {
+                acc += hasher(n);
+            }
+        }
+        s += "['" + lib + "','" + std::to_string(nlimbs) + " limbs'," + std::to_string(st.elapsed()) + "],";
+        std::cout << "\nHashed " << nlimbs << "-limb values (" << acc % 10u << ")";
+        std::cout << operRuntime;
+    }
+    const auto sv = get_random_vector(2);
+    simple_timer st;
+    std::unordered_set<integer_t, Hasher> set;
+    for (int r = 0; r < 5; ++r) {
+        set.clear();
+        set.insert(sv.begin(), sv.end());
+    }
+    s += "['" + lib + "','set insertion'," + std::to_string(st.elapsed()) + "],";
+    std::cout << "\nInserted 2-limb values into unordered_set";
+    std::cout << operRuntime;
+}
+
+int main()
+{
+    // Warm up.
+    for (auto volatile counter = 0ull; counter < 1000000000ull; ++counter) {
+    }
+    // Setup of the python output.
+    std::string s = pyPrefix;
+    std::cout << "\nInteger hash\n----------------------------------" << std::endl;
+    std::cout << bench_mpp;
+    run<std::hash<integer_t>>("mp++", s);
+    std::cout << "\n\nBenchmarking Boost combiner.";
+    run<boost_hasher>("Boost combiner", s);
+    s += boost::str(boost::format(pySuffix) % name);
+    std::ofstream of(name + ".py", std::ios_base::trunc);
+    of << s;
+    of.close();
+    std::cout << "\n\n" << std::flush;
+}
@@ -0,0 +1,117 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <mp++/mp++.hpp>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gmp.h>
+
+#include "constStrings.hpp"
+#include "simple_timer.hpp"
+
+#include <boost/format.hpp>
+
+using namespace mppp;
+using namespace mppp_bench;
+
+using integer_t = integer<2>;
+static const std::string name = "integer2_string_conversion";
+
+constexpr auto size = 10000000ul;
+
+static std::mt19937 rng;
+
+// Random values with up to 128 bits.
+static std::vector<integer_t> get_init_vector()
+{
+    rng.seed(0);
+    std::uniform_int_distribution<unsigned> bdist(1, 128);
+    std::uniform_int_distribution<int> sdist(0, 1);
+    std::vector<integer_t> retval(size);
+    for (auto &n : retval) {
+        const auto nbits = bdist(rng);
+        const auto lo = (static_cast<unsigned long long>(rng()) << 32) + rng();
+        const auto hi = (static_cast<unsigned long long>(rng()) << 32) + rng();
+        n = (integer_t{hi} << 64) + lo;
+        n >>= 128u - nbits;
+        if (sdist(rng)) {
+            n.neg();
+        }
+    }
+    return retval;
+}
+
+int main()
+{
+    // Warm up.
+    for (auto volatile counter = 0ull; counter < 1000000000ull; ++counter) {
+    }
+    // Setup of the python output.
+    std::string s = pyPrefix;
+    std::cout << "\nInteger string conversion 2\n----------------------------------" << std::endl;
+    const auto v = get_init_vector();
+    std::vector<std::string> strs(size);
+    {
+        std::cout << bench_mpp;
+        simple_timer st1;
+        {
+            simple_timer st2;
+            std::transform(v.begin(), v.end(), strs.begin(), [](const integer_t &n) { return n.to_string(); });
+            s += "['mp++','to_string'," + std::to_string(st2.elapsed()) + "],";
+            std::cout << convRuntime;
+        }
+        std::vector<integer_t> out(size);
+        {
+            simple_timer st2;
+            std::transform(strs.begin(), strs.end(), out.begin(), [](const std::string &str) { return integer_t{str}; });
+            s += "['mp++','from_string'," + std::to_string(st2.elapsed()) + "],";
+            std::cout << convRuntime;
+        }
+        s += "['mp++','total'," + std::to_string(st1.elapsed()) + "],";
+        std::cout << "\n" << (out == v ? "ok" : "mismatch");
+        std::cout << totalRuntime;
+    }
+    {
+        std::cout << bench_mpz;
+        std::vector<detail::mpz_raii> mv(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            ::mpz_set(&mv[i].m_mpz, v[i].get_mpz_view());
+        }
+        simple_timer st1;
+        {
+            simple_timer st2;
+            std::vector<char> buffer(100);
+            for (std::size_t i = 0; i < size; ++i) {
+                strs[i] = ::mpz_get_str(buffer.data(), 10, &mv[i].m_mpz);
+            }
+            s += "['mpz_t','to_string'," + std::to_string(st2.elapsed()) + "],";
+            std::cout << convRuntime;
+        }
+        {
+            simple_timer st2;
+            for (std::size_t i = 0; i < size; ++i) {
+                ::mpz_set_str(&mv[i].m_mpz, strs[i].c_str(), 10);
+            }
+            s += "['mpz_t','from_string'," + std::to_string(st2.elapsed()) + "],";
+            std::cout << convRuntime;
+        }
+        s += "['mpz_t','total'," + std::to_string(st1.elapsed()) + "],";
+        std::cout << totalRuntime;
+    }
+    s += boost::str(boost::format(pySuffix) % name);
+    std::ofstream of(name + ".py", std::ios_base::trunc);
+    of << s;
+    of.close();
+    std::cout << "\n\n" << std::flush;
+}
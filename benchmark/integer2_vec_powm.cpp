@@ -0,0 +1,153 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <algorithm>
+#include <fstream>
+#include <gmp.h>
+#include <iostream>
+#include <mp++/mp++.hpp>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "constStrings.hpp"
+#include "simple_timer.hpp"
+
+#include <boost/format.hpp>
+#if defined(MPPP_BENCHMARK_BOOST)
+#include <boost/multiprecision/cpp_int.hpp>
+#endif
+
+using namespace mppp;
+using namespace mppp_bench;
+
+#if defined(MPPP_BENCHMARK_BOOST)
+using cpp_int = boost::multiprecision::number<boost::multiprecision::cpp_int_backend<>, boost::multiprecision::et_off>;
+#endif
+
+static std::mt19937 rng;
+
+using integer_t = integer<2>;
+static const std::string name = "integer2_vec_powm";
+
+constexpr auto size = 1000000ul;
+
+// Random nonnegative integer with n limbs.
+static integer_t random_limbs(unsigned n)
+{
+    std::uniform_int_distribution<::mp_limb_t> ldist(0, GMP_NUMB_MAX);
+    integer_t retval;
+    for (auto i = 0u; i < n; ++i) {
+        retval <<= GMP_NUMB_BITS;
+        retval += ldist(rng);
+    }
+    return retval;
+}
+
+// Signed bases, 1-limb exponents and odd moduli of exactly 2 limbs.
+template <typename T, typename F>
+static inline std::tuple<std::vector<T>, std::vector<T>, std::vector<T>, std::vector<T>>
+get_init_vectors(double &init_time, const F &assign)
+{
+    rng.seed(1);
+    std::uniform_int_distribution<int> sign(0, 1);
+    simple_timer st;
+    std::vector<T> v1(size), v2(size), v3(size), v4(size);
+    for (auto i = 0ul; i < size; ++i) {
+        auto b = random_limbs(2);
+        if (sign(rng)) {
+            b.neg();
+        }
+        assign(v1[i], b);
+        assign(v2[i], random_limbs(1));
+        auto m = random_limbs(2);
+        // Set the top and bottom bits.
+        m |= (integer_t{1} << (GMP_NUMB_BITS * 2 - 1)) + 1;
+        assign(v3[i], m);
+    }
+    std::cout << initRuntime;
+    init_time = st.elapsed();
+    return std::make_tuple(std::move(v1), std::move(v2), std::move(v3), std::move(v4));
+}
+
+int main()
+{
+    // Warm up.
+    for (auto volatile counter = 0ull; counter < 1000000000ull; ++counter) {
+    }
+    // Setup of the python output.
+    std::string s = pyPrefix;
+    {
+        std::cout << "\nVector modular exponentiation 2\n----------------------------------" << std::endl;
+        std::cout << bench_mpp;
+        simple_timer st1;
+        double init_time;
+        auto p = get_init_vectors<integer_t>(init_time, [](integer_t &out, const integer_t &n) { out = n; });
+        s += "['mp++','init'," + std::to_string(init_time) + "],";
+        {
+            simple_timer st2;
+            for (auto i = 0ul; i < size; ++i) {
+                powm(std::get<3>(p)[i], std::get<0>(p)[i], std::get<1>(p)[i], std::get<2>(p)[i]);
+            }
+            std::cout << " / " << std::get<3>(p)[size - 1u];
+            s += "['mp++','operation'," + std::to_string(st2.elapsed()) + "],";
+            std::cout << operRuntime;
+        }
+        s += "['mp++','total'," + std::to_string(st1.elapsed()) + "],";
+        std::cout << totalRuntime;
+    }
+    {
+        std::cout << bench_mpz;
+        simple_timer st1;
+        double init_time;
+        auto p = get_init_vectors<detail::mpz_raii>(init_time, [](detail::mpz_raii &out, const integer_t &n) {
+            ::mpz_set(&out.m_mpz, n.get_mpz_view());
+        });
+        s += "['GMP','init'," + std::to_string(init_time) + "],";
+        {
+            simple_timer st2;
+            for (auto i = 0ul; i < size; ++i) {
+                ::mpz_powm(&std::get<3>(p)[i].m_mpz, &std::get<0>(p)[i].m_mpz, &std::get<1>(p)[i].m_mpz,
+                           &std::get<2>(p)[i].m_mpz);
+            }
+            std::cout << " / " << integer_t{&std::get<3>(p)[size - 1u].m_mpz};
+            s += "['GMP','operation'," + std::to_string(st2.elapsed()) + "],";
+            std::cout << operRuntime;
+        }
+        s += "['GMP','total'," + std::to_string(st1.elapsed()) + "],";
+        std::cout << totalRuntime;
+    }
+#if defined(MPPP_BENCHMARK_BOOST)
+    {
+        std::cout << bench_cpp_int;
+        simple_timer st1;
+        double init_time;
+        auto p = get_init_vectors<cpp_int>(init_time, [](cpp_int &out, const integer_t &n) { out = cpp_int(n.to_string()); });
+        s += "['Boost (cpp_int)','init'," + std::to_string(init_time) + "],";
+        {
+            simple_timer st2;
+            for (auto i = 0ul; i < size; ++i) {
+                // NOTE: Boost's powm() does not accept negative bases.
+                std::get<3>(p)[i] = boost::multiprecision::powm(abs(std::get<0>(p)[i]), std::get<1>(p)[i],
+                                                                std::get<2>(p)[i]);
+            }
+            std::cout << " / " << std::get<3>(p)[size - 1u];
+            s += "['Boost (cpp_int)','operation'," + std::to_string(st2.elapsed()) + "],";
+            std::cout << operRuntime;
+        }
+        s += "['Boost (cpp_int)','total'," + std::to_string(st1.elapsed()) + "],";
+        std::cout << totalRuntime;
+    }
+#endif
+    s += boost::str(boost::format(pySuffix) % name);
+    std::ofstream of(name + ".py", std::ios_base::trunc);
+    of << s;
+    of.close();
+    std::cout << "\n\n" << std::flush;
+}
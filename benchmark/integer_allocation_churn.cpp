@@ -0,0 +1,118 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mp++/mp++.hpp>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "constStrings.hpp"
+#include "simple_timer.hpp"
+
+#include <boost/format.hpp>
+
+using namespace mppp;
+using namespace mppp_bench;
+
+using integer_t = integer<1>;
+static const std::string name = "integer_allocation_churn";
+
+// Number of rounds per thread, and number of values created in each round.
+constexpr auto nrounds = 200u;
+constexpr auto batch_size = 5000u;
+
+// The batches of values created by a thread are destroyed by another thread.
+struct mailbox {
+    std::mutex m_mutex;
+    std::vector<std::vector<integer_t>> m_batches;
+};
+
+static void churn(unsigned idx, std::vector<std::unique_ptr<mailbox>> &boxes)
+{
+    std::mt19937 rng(idx);
+    std::uniform_int_distribution<unsigned> sdist(64, 64 * 40);
+    auto &out = *boxes[(idx + 1u) % boxes.size()];
+    auto &in = *boxes[idx];
+    for (auto r = 0u; r < nrounds; ++r) {
+        std::vector<integer_t> batch;
+        batch.reserve(batch_size);
+        for (auto i = 0u; i < batch_size; ++i) {
+            // Values of random size, plus some short-lived temporaries.
+            integer_t n{1};
+            n <<= sdist(rng);
+            batch.push_back(n * n + rational<1>{n, 3}.get_den());
+        }
+        {
+            std::lock_guard<std::mutex> lock(out.m_mutex);
+            out.m_batches.push_back(std::move(batch));
+        }
+        std::vector<std::vector<integer_t>> tmp;
+        {
+            std::lock_guard<std::mutex> lock(in.m_mutex);
+            tmp.swap(in.m_batches);
+        }
+    }
+}
+
+static void run(unsigned nt)
+{
+    std::vector<std::unique_ptr<mailbox>> boxes;
+    for (auto i = 0u; i < nt; ++i) {
+        boxes.emplace_back(new mailbox);
+    }
+    std::vector<std::thread> threads;
+    for (auto i = 0u; i < nt; ++i) {
+        threads.emplace_back(churn, i, std::ref(boxes));
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+}
+
+int main()
+{
+    // Warm up.
+    for (auto volatile counter = 0ull; counter < 1000000000ull; ++counter) {
+    }
+    // Setup of the python output.
+    std::string s = pyPrefix;
+    std::cout << "\nAllocation churn\n----------------------------------" << std::endl;
+    // NOTE: disable the integer caches, so that all the
+    // allocations go through the GMP memory functions.
+    integer_cache_config cfg;
+    cfg.max_limbs = 0;
+    set_global_integer_cache_config(cfg);
+    const auto max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    for (auto fast : {false, true}) {
+        if (fast) {
+            install_fast_allocator();
+        }
+        for (unsigned nt = 1; nt <= max_threads; nt *= 2u) {
+            const std::string lib = std::string(fast ? "fast allocator" : "GMP default") + " ("
+                                    + std::to_string(nt) + (nt == 1u ? " thread)" : " threads)");
+            std::cout << "\n\nBenchmarking " << lib << ".";
+            simple_timer st;
+            run(nt);
+            s += "['" + lib + "','churn'," + std::to_string(st.elapsed()) + "],";
+            std::cout << operRuntime;
+        }
+    }
+    s += boost::str(boost::format(pySuffix) % name);
+    std::ofstream of(name + ".py", std::ios_base::trunc);
+    of << s;
+    of.close();
+    std::cout << "\n\n" << std::flush;
+}
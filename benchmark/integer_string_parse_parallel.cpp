@@ -0,0 +1,84 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mp++/mp++.hpp>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "constStrings.hpp"
+#include "simple_timer.hpp"
+
+#include <boost/format.hpp>
+
+using namespace mppp;
+using namespace mppp_bench;
+
+static std::mt19937 rng;
+
+static const std::string name = "integer_string_parse_parallel";
+
+// Number of decimal digits in the input file (100 MB).
+constexpr auto ndigits = 100000000ul;
+
+int main()
+{
+    // Warm up.
+    for (auto volatile counter = 0ull; counter < 1000000000ull; ++counter) {
+    }
+    // Setup of the python output.
+    std::string s = pyPrefix;
+    std::cout << "\nParallel string parsing\n----------------------------------" << std::endl;
+    // Write the digit file.
+    const std::string file_name = name + "_input.txt";
+    {
+        rng.seed(0);
+        std::uniform_int_distribution<int> dist(0, 9);
+        std::string digits(ndigits, '0');
+        std::generate(digits.begin() + 1, digits.end(), [&dist]() { return static_cast<char>('0' + dist(rng)); });
+        digits[0] = '7';
+        std::ofstream of(file_name, std::ios_base::trunc | std::ios_base::binary);
+        of << digits;
+    }
+    const auto max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    for (unsigned nt = 1; nt <= max_threads; nt *= 2u) {
+        parallel::set_n_threads(nt);
+        const std::string lib = "mp++ (" + std::to_string(nt) + (nt == 1u ? " thread)" : " threads)");
+        std::cout << "\n\nBenchmarking " << lib << ".";
+        simple_timer st1;
+        std::string buffer;
+        {
+            simple_timer st2;
+            std::ifstream in(file_name, std::ios_base::binary);
+            buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+            s += "['" + lib + "','read'," + std::to_string(st2.elapsed()) + "],";
+            std::cout << "\nRead runtime: ";
+        }
+        integer<1> n;
+        {
+            simple_timer st2;
+            n = integer<1>{buffer};
+            s += "['" + lib + "','parse'," + std::to_string(st2.elapsed()) + "],";
+            std::cout << "\nParse runtime: ";
+        }
+        s += "['" + lib + "','total'," + std::to_string(st1.elapsed()) + "],";
+        std::cout << "\n" << n.nbits() << " bits";
+        std::cout << totalRuntime;
+    }
+    std::remove(file_name.c_str());
+    s += boost::str(boost::format(pySuffix) % name);
+    std::ofstream of(name + ".py", std::ios_base::trunc);
+    of << s;
+    of.close();
+    std::cout << "\n\n" << std::flush;
+}
@@ -0,0 +1,36 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef MPPP_FAST_ALLOCATOR_HPP
+#define MPPP_FAST_ALLOCATOR_HPP
+
+#include <mp++/config.hpp>
+
+#include <mp++/detail/visibility.hpp>
+
+namespace mppp
+{
+
+// Install mp++'s slab allocator as the GMP memory functions.
+//
+// The allocator serves small requests from per-thread slabs of fixed-size blocks.
+// The blocks freed by a thread other than the owner of the slab are returned via a
+// lock-free queue, and the memory of the slabs which become empty is given back to the
+// operating system. The memory which was allocated before the installation is freed via
+// the memory functions which were in use at the time of the installation.
+//
+// NOTE: like mp_set_memory_functions(), this function must not be called while
+// other threads are using GMP. Calling it more than once has no effect.
+MPPP_DLL_PUBLIC void install_fast_allocator();
+
+// Check if the slab allocator has been installed.
+MPPP_DLL_PUBLIC bool fast_allocator_installed();
+
+} // namespace mppp
+
+#endif
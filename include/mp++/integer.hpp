@@ -16,12 +16,14 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <cinttypes>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <functional>
 #include <initializer_list>
 #include <ios>
@@ -30,6 +32,7 @@
 #include <new>
 #include <stdexcept>
 #include <string>
+#include <system_error>
 #include <tuple>
 #include <type_traits>
 #include <utility>
@@ -39,6 +42,10 @@
 #include <string_view>
 #endif
 
+#if defined(MPPP_HAVE_CHARCONV)
+#include <charconv>
+#endif
+
 #include <mp++/concepts.hpp>
 #include <mp++/detail/fwd_decl.hpp>
 #include <mp++/detail/gmp.hpp>
@@ -63,15 +70,18 @@
 #include <Winnt.h>
 // clang-format on
 
-// We use the BitScanReverse(64) intrinsic in the implementation of limb_msnb(), but
+// We use the BitScanReverse(64) intrinsic in the implementation of limb_msnb(), and
+// the BitScanForward(64) intrinsic in the implementation of limb_ctz(), but
 // only if we are *not* on clang-cl: there, we can use GCC-style intrinsics.
 // https://msdn.microsoft.com/en-us/library/fbxyd7zd.aspx
 #if !defined(__clang__)
 #if _WIN64
 #pragma intrinsic(_BitScanReverse64)
+#pragma intrinsic(_BitScanForward64)
 #else
 #include <intrin.h>
 #pragma intrinsic(_BitScanReverse)
+#pragma intrinsic(_BitScanForward)
 #endif
 #endif
 
@@ -116,24 +126,63 @@ inline std::size_t get_mpz_size(const ::mpz_t n)
 // Structure for caching allocated arrays of limbs.
 // NOTE: needs to be public for testing purposes.
 struct MPPP_DLL_PUBLIC mpz_alloc_cache {
-    // Arrays up to this size will be cached.
+    // Arrays up to this size are cached in size classes
+    // containing arrays of exactly one size.
     static constexpr std::size_t max_size = 10;
-    // Max number of arrays to cache for each size.
-    static constexpr std::size_t max_entries = 100;
-    // The actual cache.
-    std::array<std::array<::mp_limb_t *, max_entries>, max_size> caches;
-    // The number of arrays actually stored in each cache entry.
-    std::array<std::size_t, max_size> sizes;
+    // Larger arrays are cached in power-of-two size classes: the size class
+    // max_size + i contains the arrays whose size is in the [2**k, 2**(k + 1))
+    // range, with k == min_pow2_bits + i. The requests for n limbs are served
+    // from the size class with the smallest k such that n <= 2**k.
+    static constexpr unsigned min_pow2_bits = 4;
+    static constexpr std::size_t n_pow2_classes = 16;
+    static constexpr std::size_t n_classes = max_size + n_pow2_classes;
+    // Max size of the requests which can be served from the cache.
+    static constexpr std::size_t max_cacheable_limbs = std::size_t(1) << (min_pow2_bits + n_pow2_classes - 1u);
+    // Default configuration.
+    static constexpr std::size_t default_max_entries = 100;
+    static constexpr std::size_t default_max_limbs = max_size;
+    // The actual cache. The arrays of each size class are stored
+    // as a singly-linked list, whose links are stored in the first limb
+    // of the arrays. The arrays in the power-of-two size classes
+    // also store their size in the second limb.
+    std::array<::mp_limb_t *, n_classes> caches;
+    // The number of arrays actually stored in each size class.
+    std::array<std::size_t, n_classes> sizes;
+    // Max number of arrays to cache for each size class.
+    std::size_t max_entries;
+    // Max size of the requests served from the cache.
+    std::size_t max_limbs;
+    // Generation of the global configuration the cache was last synchronised
+    // with. The initial value signals that the cache was never synchronised.
+    static constexpr unsigned long unsynced_gen = static_cast<unsigned long>(-1);
+    unsigned long gen;
+    // Flag signalling that the configuration of the cache was
+    // set specifically for this cache, rather than globally.
+    bool local;
+    // Statistics. They are written only by the thread owning the cache,
+    // and they can be read concurrently by the other threads.
+    std::atomic<unsigned long long> hits;
+    std::atomic<unsigned long long> misses;
+    std::atomic<unsigned long long> evictions;
+    std::atomic<unsigned long long> bytes_held;
+    std::atomic<unsigned long long> high_water_mark;
+    // Links in the global list of the synchronised caches.
+    mpz_alloc_cache *prev;
+    mpz_alloc_cache *next;
     // NOTE: use round brackets init for the usual GCC 4.8 workaround.
-    // NOTE: this will zero initialise recursively both members: we will
+    // NOTE: this will zero initialise recursively the first two members: we will
     // have all nullptrs in the caches, and all cache sizes will be zeroes.
-    constexpr mpz_alloc_cache() : caches(), sizes() {}
-    // Clear the cache, deallocating all the data in the arrays.
-    void clear() noexcept;
-    ~mpz_alloc_cache()
+    constexpr mpz_alloc_cache()
+        : caches(), sizes(), max_entries(default_max_entries), max_limbs(default_max_limbs), gen(unsynced_gen),
+          local(false), hits(0), misses(0), evictions(0), bytes_held(0), high_water_mark(0), prev(nullptr),
+          next(nullptr)
     {
-        clear();
     }
+    mpz_alloc_cache(const mpz_alloc_cache &) = delete;
+    mpz_alloc_cache &operator=(const mpz_alloc_cache &) = delete;
+    // Clear the cache, deallocating all the data in the arrays.
+    void clear() noexcept;
+    ~mpz_alloc_cache();
 };
 
 #if defined(_MSC_VER) && defined(__clang__)
@@ -185,6 +234,173 @@ inline std::string mpz_to_str(const mpz_struct_t *mpz, int base = 10)
     return tmp.data();
 }
 
+// Wrapper for mpz_set_str(), which parses very long strings concurrently.
+MPPP_DLL_PUBLIC int mpz_set_str_wrap(mpz_struct_t *, const char *, int);
+
+// Value of the digit c in the given base, following the conventions
+// of mpz_set_str(). Invalid characters return a value of 62.
+inline int char_to_digit(char c, int base)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'A' && c <= 'Z') {
+        return c - 'A' + 10;
+    }
+    if (c >= 'a' && c <= 'z') {
+        // NOTE: lowercase letters represent the same digits
+        // as uppercase letters only up to base 36.
+        return c - 'a' + (base > 36 ? 36 : 10);
+    }
+    return 62;
+}
+
+// Character representing the digit d in the given base, following
+// the conventions of mpz_get_str().
+inline char digit_to_char(unsigned d, int base)
+{
+    if (d < 10u) {
+        return static_cast<char>('0' + d);
+    }
+    if (base <= 36) {
+        return static_cast<char>('a' + (d - 10u));
+    }
+    return d < 36u ? static_cast<char>('A' + (d - 10u)) : static_cast<char>('a' + (d - 36u));
+}
+
+#if defined(MPPP_HAVE_GCC_INT128) && (GMP_NUMB_BITS == 64) && !GMP_NAIL_BITS
+
+// Decimal conversions for values of at most 2 limbs, implemented
+// without GMP via 128-bit integer arithmetic.
+
+// Maximum number of decimal digits of a 2-limb value.
+constexpr std::size_t dec_2limbs_max_digits = 39;
+
+// Table of the decimal representations of the numbers from 0 to 99.
+inline const char *dec_digit_pairs()
+{
+    static const char table[] = "00010203040506070809"
+                                "10111213141516171819"
+                                "20212223242526272829"
+                                "30313233343536373839"
+                                "40414243444546474849"
+                                "50515253545556575859"
+                                "60616263646566676869"
+                                "70717273747576777879"
+                                "80818283848586878889"
+                                "90919293949596979899";
+    return table;
+}
+
+// Write the decimal digits of n into the buffer ending at out, two digits at a time.
+// If Pad is true, exactly 19 digits are written (with leading zeroes).
+// Returns the beginning of the digits.
+template <bool Pad>
+inline char *dec_format_u64(char *out, std::uint64_t n)
+{
+    const auto pairs = dec_digit_pairs();
+    const auto stop = out - 19;
+    while (n >= 100u) {
+        const auto r = static_cast<std::size_t>(n % 100u);
+        n /= 100u;
+        out -= 2;
+        out[0] = pairs[2u * r];
+        out[1] = pairs[2u * r + 1u];
+    }
+    if (n >= 10u) {
+        out -= 2;
+        out[0] = pairs[2u * n];
+        out[1] = pairs[2u * n + 1u];
+    } else {
+        *--out = static_cast<char>('0' + n);
+    }
+    if (Pad) {
+        while (out != stop) {
+            *--out = '0';
+        }
+    }
+    return out;
+}
+
+// Write the decimal digits of the value with limbs ptr[0] and (if asize is 2) ptr[1]
+// into the buffer ending at out. Returns the beginning of the digits.
+inline char *dec_format_2limbs(char *out, const ::mp_limb_t *ptr, std::size_t asize)
+{
+    assert(asize <= 2u);
+    if (asize < 2u) {
+        return dec_format_u64<false>(out, asize == 0u ? 0u : ptr[0]);
+    }
+    // NOTE: split the value in chunks of 19 digits, whose
+    // conversion can be done in 64-bit arithmetic.
+    constexpr std::uint64_t p19 = 10000000000000000000ull;
+    auto v = (static_cast<__uint128_t>(ptr[1]) << 64) + ptr[0];
+    auto q = v / p19;
+    out = dec_format_u64<true>(out, static_cast<std::uint64_t>(v - q * p19));
+    if (q >= p19) {
+        v = q;
+        q = v / p19;
+        out = dec_format_u64<true>(out, static_cast<std::uint64_t>(v - q * p19));
+    }
+    return dec_format_u64<false>(out, static_cast<std::uint64_t>(q));
+}
+
+// Parse the decimal digits in [begin, end) into limbs. Returns false if the range
+// is empty, if it contains characters which are not decimal digits, or if the value
+// does not fit in 2 limbs. Otherwise, returns true and writes the number of limbs
+// of the value into size.
+inline bool dec_parse_2limbs(const char *begin, const char *end, std::array<::mp_limb_t, 2> &limbs,
+                             std::size_t &size)
+{
+    if (begin == end) {
+        return false;
+    }
+    // Skip the leading zeroes.
+    while (end - begin > 1 && *begin == '0') {
+        ++begin;
+    }
+    const auto ndigits = static_cast<std::size_t>(end - begin);
+    if (ndigits > dec_2limbs_max_digits) {
+        return false;
+    }
+    // NOTE: the largest 39-digit value is larger than 2**128 - 1.
+    if (ndigits == dec_2limbs_max_digits
+        && std::char_traits<char>::compare(begin, "340282366920938463463374607431768211455", ndigits) > 0) {
+        return false;
+    }
+    __uint128_t v = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    // Convert 8 digits at a time via SWAR techniques.
+    for (; end - begin >= 8; begin += 8) {
+        std::uint64_t chunk;
+        std::memcpy(&chunk, begin, 8);
+        // Check that all the bytes are in the ['0', '9'] range.
+        if ((chunk & 0xF0F0F0F0F0F0F0F0ull) != 0x3030303030303030ull
+            || ((chunk + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) != 0x3030303030303030ull) {
+            return false;
+        }
+        chunk -= 0x3030303030303030ull;
+        // Combine pairs of adjacent digits, then groups of 4 digits.
+        chunk = chunk * 10u + (chunk >> 8);
+        chunk = ((chunk & 0x000000FF000000FFull) * (100u + (1000000ull << 32))
+                 + ((chunk >> 16) & 0x000000FF000000FFull) * (1u + (10000ull << 32)))
+                >> 32;
+        v = v * 100000000u + chunk;
+    }
+#endif
+    for (; begin != end; ++begin) {
+        if (*begin < '0' || *begin > '9') {
+            return false;
+        }
+        v = v * 10u + static_cast<unsigned>(*begin - '0');
+    }
+    limbs[0] = static_cast<::mp_limb_t>(v);
+    limbs[1] = static_cast<::mp_limb_t>(v >> 64);
+    size = limbs[1] != 0u ? 2u : static_cast<std::size_t>(limbs[0] != 0u);
+    return true;
+}
+
+#endif
+
 // Small wrapper to copy limbs.
 inline void copy_limbs(const ::mp_limb_t *begin, const ::mp_limb_t *end, ::mp_limb_t *out)
 {
@@ -241,6 +457,51 @@ inline unsigned builtin_clz(T n)
     return static_cast<unsigned>(builtin_clz_impl(n));
 }
 
+// Same as above, for the number of trailing zeroes.
+inline int builtin_ctz_impl(unsigned n)
+{
+    return __builtin_ctz(n);
+}
+
+inline int builtin_ctz_impl(unsigned long n)
+{
+    return __builtin_ctzl(n);
+}
+
+inline int builtin_ctz_impl(unsigned long long n)
+{
+    return __builtin_ctzll(n);
+}
+
+template <typename T>
+inline unsigned builtin_ctz(T n)
+{
+    assert(n != 0u);
+    return static_cast<unsigned>(builtin_ctz_impl(n));
+}
+
+// Same as above, for the number of set bits.
+inline int builtin_popcount_impl(unsigned n)
+{
+    return __builtin_popcount(n);
+}
+
+inline int builtin_popcount_impl(unsigned long n)
+{
+    return __builtin_popcountl(n);
+}
+
+inline int builtin_popcount_impl(unsigned long long n)
+{
+    return __builtin_popcountll(n);
+}
+
+template <typename T>
+inline unsigned builtin_popcount(T n)
+{
+    return static_cast<unsigned>(builtin_popcount_impl(n));
+}
+
 #endif
 
 // Determine the size in (numeric) bits of limb l.
@@ -271,6 +532,46 @@ inline unsigned limb_size_nbits(::mp_limb_t l)
 #endif
 }
 
+// Determine the number of trailing zero bits in the nonzero limb l.
+// NOTE: l must not have any nail bit set.
+inline unsigned limb_ctz(::mp_limb_t l)
+{
+    assert((l & GMP_NUMB_MASK) == l);
+    assert(l != 0u);
+#if defined(__clang__) || defined(__GNUC__)
+    return builtin_ctz(l);
+#elif defined(_MSC_VER)
+    unsigned long index;
+#if _WIN64
+    _BitScanForward64
+#else
+    _BitScanForward
+#endif
+        (&index, l);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(::mpn_scan1(&l, 0));
+#endif
+}
+
+// Determine the number of set bits in the limb l.
+// NOTE: l must not have any nail bit set.
+inline unsigned limb_popcount(::mp_limb_t l)
+{
+    assert((l & GMP_NUMB_MASK) == l);
+#if defined(__clang__) || defined(__GNUC__)
+    return builtin_popcount(l);
+#else
+    // NOTE: no portable intrinsic is available, clear
+    // the lowest set bit until l becomes zero.
+    unsigned retval = 0;
+    for (; l != 0u; l &= l - 1u) {
+        ++retval;
+    }
+    return retval;
+#endif
+}
+
 // Machinery for the conversion of a large uint to a limb array.
 
 // Definition of the limb array type.
@@ -697,8 +998,13 @@ union integer_union {
                 "In the constructor of integer from string, a base of " + to_string(base)
                 + " was specified, but the only valid values are 0 and any value in the [2,62] range");
         }
+#if defined(MPPP_HAVE_GCC_INT128) && (GMP_NUMB_BITS == 64) && !GMP_NAIL_BITS
+        if (base == 10 && dispatch_dec_string_ctor(s, s + std::strlen(s))) {
+            return;
+        }
+#endif
         MPPP_MAYBE_TLS mpz_raii mpz;
-        if (mppp_unlikely(::mpz_set_str(&mpz.m_mpz, s, base))) {
+        if (mppp_unlikely(mpz_set_str_wrap(&mpz.m_mpz, s, base))) {
             if (base) {
                 throw std::invalid_argument(std::string("The string '") + s + "' is not a valid integer in base "
                                             + to_string(base));
@@ -709,6 +1015,25 @@ union integer_union {
         }
         dispatch_mpz_ctor(&mpz.m_mpz);
     }
+#if defined(MPPP_HAVE_GCC_INT128) && (GMP_NUMB_BITS == 64) && !GMP_NAIL_BITS
+    // Fast construction from a decimal string representing a value of at most 2 limbs,
+    // without going through GMP. Returns false (without constructing anything)
+    // if the string is not in a form supported by this codepath.
+    bool dispatch_dec_string_ctor(const char *begin, const char *end)
+    {
+        const auto neg_flag = begin != end && *begin == '-';
+        std::array<::mp_limb_t, 2> limbs;
+        std::size_t size;
+        if (!dec_parse_2limbs(begin + neg_flag, end, limbs, size)) {
+            return false;
+        }
+        construct_from_limb_array<false>(limbs.data(), size);
+        if (neg_flag) {
+            neg();
+        }
+        return true;
+    }
+#endif
     // Constructor from C string and base.
     explicit integer_union(const char *s, int base)
     {
@@ -717,6 +1042,11 @@ union integer_union {
     // Constructor from string range and base.
     explicit integer_union(const char *begin, const char *end, int base)
     {
+#if defined(MPPP_HAVE_GCC_INT128) && (GMP_NUMB_BITS == 64) && !GMP_NAIL_BITS
+        if (base == 10 && dispatch_dec_string_ctor(begin, end)) {
+            return;
+        }
+#endif
         // Copy the range into a local buffer.
         MPPP_MAYBE_TLS std::vector<char> buffer;
         buffer.assign(begin, end);
@@ -996,6 +1326,9 @@ namespace detail
 template <std::size_t SSize>
 void nextprime_impl(integer<SSize> &, const integer<SSize> &);
 
+template <std::size_t SSize>
+int probab_prime_p_impl(const integer<SSize> &, int);
+
 }
 
 // NOTE: a few misc future directions:
@@ -1927,6 +2260,19 @@ public:
                                         "2 and 62, but a value of "
                                         + detail::to_string(base) + " was provided instead");
         }
+#if defined(MPPP_HAVE_GCC_INT128) && (GMP_NUMB_BITS == 64) && !GMP_NAIL_BITS
+        if (base == 10 && is_static() && m_int.g_st().abs_size() <= 2) {
+            // Fast path for small values, which does not go through GMP.
+            std::array<char, detail::dec_2limbs_max_digits + 1u> buffer;
+            const auto end = buffer.data() + buffer.size();
+            auto begin = detail::dec_format_2limbs(end, m_int.g_st().m_limbs.data(),
+                                                   static_cast<std::size_t>(m_int.g_st().abs_size()));
+            if (m_int.g_st()._mp_size < 0) {
+                *--begin = '-';
+            }
+            return std::string(begin, end);
+        }
+#endif
         return detail::mpz_to_str(get_mpz_view(), base);
     }
     // NOTE: maybe provide a method to access the lower-level str conversion that writes to
@@ -2355,6 +2701,10 @@ public:
      * It will return \p 2 if \p this is definitely a prime, \p 1 if \p this is probably a prime and \p 0 if \p this
      * is definitely not-prime.
      *
+     * If \p this is stored in static storage and it consists of at most 2 limbs, the primality test
+     * is performed via deterministic Miller-Rabin tests (for values of up to 81 bits, in which case
+     * the result is exact) or via a Baillie-PSW test (for larger values), and \p reps is ignored.
+     *
      * @param reps the number of tests to run.
      *
      * @return an integer indicating if \p this is a prime.
@@ -2363,14 +2713,7 @@ public:
      */
     int probab_prime_p(int reps = 25) const
     {
-        if (mppp_unlikely(reps < 1)) {
-            throw std::invalid_argument("The number of primality tests must be at least 1, but a value of "
-                                        + detail::to_string(reps) + " was provided instead");
-        }
-        if (mppp_unlikely(sgn() < 0)) {
-            throw std::invalid_argument("Cannot run primality tests on the negative number " + to_string());
-        }
-        return ::mpz_probab_prime_p(get_mpz_view(), reps);
+        return detail::probab_prime_p_impl(*this, reps);
     }
     /// Integer square root (in-place version).
     /**
@@ -3255,13 +3598,18 @@ namespace detail
 {
 
 // Metaprogramming for selecting the algorithm for static addition. The selection happens via
-// an std::integral_constant with 3 possible values:
+// an std::integral_constant with 4 possible values:
 // - 0 (default case): use the GMP mpn functions,
 // - 1: selected when there are no nail bits and the static size is 1,
-// - 2: selected when there are no nail bits and the static size is 2.
+// - 2: selected when there are no nail bits and the static size is 2,
+// - 3: selected when there are no nail bits and the static size is 3 or 4.
 template <typename SInt>
 using integer_static_add_algo = std::integral_constant<
-    int, (!GMP_NAIL_BITS && SInt::s_size == 1) ? 1 : ((!GMP_NAIL_BITS && SInt::s_size == 2) ? 2 : 0)>;
+    int, (!GMP_NAIL_BITS && SInt::s_size == 1)
+             ? 1
+             : ((!GMP_NAIL_BITS && SInt::s_size == 2)
+                    ? 2
+                    : ((!GMP_NAIL_BITS && (SInt::s_size == 3 || SInt::s_size == 4)) ? 3 : 0))>;
 
 // General implementation via mpn.
 // Small helper to compute the size after subtraction via mpn. s is a strictly positive size.
@@ -3517,6 +3865,100 @@ inline bool static_add_impl(static_int<SSize> &rop, const static_int<SSize> &op1
     return true;
 }
 
+// Optimization for 3/4-limbs statics with no nails.
+// Small helper to load the limbs of a static into a local buffer, padding with zeroes
+// the limbs above asize.
+// NOTE: we need this because, contrary to the 1/2-limbs case, the static size here is larger
+// than opt_size and thus there's no guarantee that the unused limbs are zero.
+template <std::size_t SSize>
+inline void integer_load_limbs_n(std::array<::mp_limb_t, SSize> &out, const static_int<SSize> &n, mpz_size_t asize)
+{
+    for (std::size_t i = 0; i < SSize; ++i) {
+        out[i] = i < static_cast<std::size_t>(asize) ? n.m_limbs[i] : ::mp_limb_t(0);
+    }
+}
+
+// Compare two zero-padded limb buffers, starting from the top.
+template <std::size_t SSize>
+inline int integer_compare_limbs_n(const std::array<::mp_limb_t, SSize> &a, const std::array<::mp_limb_t, SSize> &b)
+{
+    // NOTE: this requires no nail bits.
+    assert(!GMP_NAIL_BITS);
+    for (std::size_t i = SSize; i > 0u; --i) {
+        if (a[i - 1u] != b[i - 1u]) {
+            return a[i - 1u] > b[i - 1u] ? 1 : -1;
+        }
+    }
+    return 0;
+}
+
+// Carry chain: rop = a + b, returning the carry out of the top limb.
+// NOTE: the loops in these helpers have a compile-time trip count, the compiler
+// fully unrolls them into an add-with-carry (resp. sub-with-borrow) sequence.
+template <std::size_t SSize>
+inline ::mp_limb_t integer_add_limbs_n(std::array<::mp_limb_t, SSize> &rop, const std::array<::mp_limb_t, SSize> &a,
+                                       const std::array<::mp_limb_t, SSize> &b)
+{
+    ::mp_limb_t cy = 0;
+    for (std::size_t i = 0; i < SSize; ++i) {
+        ::mp_limb_t tmp;
+        const ::mp_limb_t cy1 = limb_add_overflow(a[i], b[i], &tmp), cy2 = limb_add_overflow(tmp, cy, &rop[i]);
+        // NOTE: cy1 and cy2 cannot be both 1.
+        cy = cy1 | cy2;
+    }
+    return cy;
+}
+
+// Borrow chain: rop = a - b. Requires a >= b.
+template <std::size_t SSize>
+inline void integer_sub_limbs_n(std::array<::mp_limb_t, SSize> &rop, const std::array<::mp_limb_t, SSize> &a,
+                                const std::array<::mp_limb_t, SSize> &b)
+{
+    ::mp_limb_t br = 0;
+    for (std::size_t i = 0; i < SSize; ++i) {
+        const auto tmp = a[i] - b[i];
+        const auto br1 = static_cast<::mp_limb_t>(a[i] < b[i]), br2 = static_cast<::mp_limb_t>(tmp < br);
+        rop[i] = tmp - br;
+        br = br1 | br2;
+    }
+    // No borrow can come out of the top limb, as a >= b.
+    assert(!br);
+}
+
+template <std::size_t SSize>
+inline bool static_add_impl(static_int<SSize> &rop, const static_int<SSize> &op1, const static_int<SSize> &op2,
+                            mpz_size_t asize1, mpz_size_t asize2, int sign1, int sign2,
+                            const std::integral_constant<int, 3> &)
+{
+    // Load the operands. Everything is computed in local buffers and written out only
+    // at the end: contrary to the mpn implementation, we can detect the overflow
+    // exactly (i.e., after the computation) without destroying overlapping operands.
+    std::array<::mp_limb_t, SSize> a, b, r;
+    integer_load_limbs_n(a, op1, asize1);
+    integer_load_limbs_n(b, op2, asize2);
+    int sign;
+    if (sign1 == sign2) {
+        // NOTE: this handles the case in which the numbers have the same sign, including 0 + 0.
+        if (mppp_unlikely(integer_add_limbs_n(r, a, b))) {
+            return false;
+        }
+        sign = sign1;
+    } else if (integer_compare_limbs_n(a, b) >= 0) {
+        // When the signs differ, we need to implement addition as a subtraction.
+        // op1 is >= op2 in absolute value. The sign of op1 cannot be zero here, unless
+        // both operands are zero.
+        integer_sub_limbs_n(r, a, b);
+        sign = sign1;
+    } else {
+        // op2 is > op1 in absolute value.
+        integer_sub_limbs_n(r, b, a);
+        sign = sign2;
+    }
+    rop._mp_size = sign * integer_sub_compute_size(r.data(), static_cast<mpz_size_t>(SSize));
+    rop.m_limbs = r;
+    return true;
+}
+
 template <bool AddOrSub, std::size_t SSize>
 inline bool static_addsub(static_int<SSize> &rop, const static_int<SSize> &op1, const static_int<SSize> &op2)
 {
@@ -3577,13 +4019,18 @@ namespace detail
 {
 
 // Metaprogramming for selecting the algorithm for static add/sub with a single limb. The selection happens via
-// an std::integral_constant with 3 possible values:
+// an std::integral_constant with 4 possible values:
 // - 0 (default case): use the GMP mpn functions,
 // - 1: selected when there are no nail bits and the static size is 1,
-// - 2: selected when there are no nail bits and the static size is 2.
+// - 2: selected when there are no nail bits and the static size is 2,
+// - 3: selected when there are no nail bits and the static size is 3 or 4.
 template <typename SInt>
 using integer_static_addsub_1_algo = std::integral_constant<
-    int, (!GMP_NAIL_BITS && SInt::s_size == 1) ? 1 : ((!GMP_NAIL_BITS && SInt::s_size == 2) ? 2 : 0)>;
+    int, (!GMP_NAIL_BITS && SInt::s_size == 1)
+             ? 1
+             : ((!GMP_NAIL_BITS && SInt::s_size == 2)
+                    ? 2
+                    : ((!GMP_NAIL_BITS && (SInt::s_size == 3 || SInt::s_size == 4)) ? 3 : 0))>;
 
 // mpn implementation.
 template <bool AddOrSub, std::size_t SSize>
@@ -3734,6 +4181,40 @@ inline bool static_addsub_1_impl(static_int<SSize> &rop, const static_int<SSize>
     return true;
 }
 
+// 3/4-limbs optimisation (no nails).
+template <bool AddOrSub, std::size_t SSize>
+inline bool static_addsub_1_impl(static_int<SSize> &rop, const static_int<SSize> &op1, mpz_size_t asize1, int sign1,
+                                 ::mp_limb_t l2, const std::integral_constant<int, 3> &)
+{
+    // NOTE: re-use the carry/borrow chains of the 3/4-limbs addition, with
+    // the second operand padded with zeroes.
+    std::array<::mp_limb_t, SSize> a, b, r;
+    integer_load_limbs_n(a, op1, asize1);
+    b[0] = l2;
+    std::fill(b.begin() + 1, b.end(), ::mp_limb_t(0));
+    int sign;
+    if ((sign1 >= 0 && AddOrSub) || (sign1 <= 0 && !AddOrSub)) {
+        // op1 non-negative and addition, or op1 non-positive and subtraction. Implement
+        // as a true addition.
+        if (mppp_unlikely(integer_add_limbs_n(r, a, b))) {
+            return false;
+        }
+        sign = AddOrSub ? 1 : -1;
+    } else if (asize1 > 1 || a[0] >= l2) {
+        // op1 negative and addition, or op1 positive and subtraction, and op1 >= op2 in absolute value.
+        // Sign is negative for add, positive for sub.
+        integer_sub_limbs_n(r, a, b);
+        sign = AddOrSub ? -1 : 1;
+    } else {
+        // op2 > op1 in absolute value.
+        integer_sub_limbs_n(r, b, a);
+        sign = AddOrSub ? 1 : -1;
+    }
+    rop._mp_size = sign * integer_sub_compute_size(r.data(), static_cast<mpz_size_t>(SSize));
+    rop.m_limbs = r;
+    return true;
+}
+
 template <bool AddOrSub, std::size_t SSize>
 inline bool static_addsub_1(static_int<SSize> &rop, const static_int<SSize> &op1, ::mp_limb_t op2)
 {
@@ -4021,11 +4502,17 @@ using integer_have_dlimb_mul = std::integral_constant<bool,
 #endif
                                                       >;
 
+// Selection of the algorithm for static multiplication:
+// - 1 and 2 limbs use hand-written dlimb implementations,
+// - 3 and 4 limbs use a schoolbook implementation built on dlimb_mul(),
+// - otherwise we use the mpn functions.
 template <typename SInt>
-using integer_static_mul_algo
-    = std::integral_constant<int, (SInt::s_size == 1 && integer_have_dlimb_mul::value)
-                                      ? 1
-                                      : ((SInt::s_size == 2 && integer_have_dlimb_mul::value) ? 2 : 0)>;
+using integer_static_mul_algo = std::integral_constant<
+    int, (SInt::s_size == 1 && integer_have_dlimb_mul::value)
+             ? 1
+             : ((SInt::s_size == 2 && integer_have_dlimb_mul::value)
+                    ? 2
+                    : (((SInt::s_size == 3 || SInt::s_size == 4) && integer_have_dlimb_mul::value) ? 3 : 0))>;
 
 // mpn implementation.
 // NOTE: this function (and the other overloads) returns 0 in case of success, otherwise it returns a hint
@@ -4118,6 +4605,23 @@ inline ::mp_limb_t dlimb_mul(::mp_limb_t op1, ::mp_limb_t op2, ::mp_limb_t *hi)
     return static_cast<::mp_limb_t>(res);
 }
 
+#else
+
+// Portable implementation via half-limb products.
+// NOTE: this is never used in the arithmetic fast paths (see integer_have_dlimb_mul),
+// it exists so that the code selected via runtime checks on integer_have_dlimb_mul
+// (e.g., the modular arithmetic primitives) compiles on all platforms.
+inline ::mp_limb_t dlimb_mul(::mp_limb_t op1, ::mp_limb_t op2, ::mp_limb_t *hi)
+{
+    constexpr unsigned half = unsigned(nl_digits<::mp_limb_t>()) / 2u;
+    constexpr ::mp_limb_t lmask = (::mp_limb_t(1) << half) - 1u;
+    const ::mp_limb_t a0 = op1 & lmask, a1 = op1 >> half, b0 = op2 & lmask, b1 = op2 >> half;
+    const ::mp_limb_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+    const ::mp_limb_t mid = (p00 >> half) + (p01 & lmask) + (p10 & lmask);
+    *hi = p11 + (p01 >> half) + (p10 >> half) + (mid >> half);
+    return (mid << half) | (p00 & lmask);
+}
+
 #endif
 
 // 1-limb optimization via dlimb.
@@ -4185,6 +4689,72 @@ inline std::size_t static_mul_impl(static_int<SSize> &rop, const static_int<SSiz
     return 4u;
 }
 
+// 3/4-limbs optimization via dlimb.
+// Schoolbook multiplication of two zero-padded limb buffers. The lower SSize limbs of the
+// result are written into rop, the limb at index SSize is returned.
+// NOTE: this requires that the limb sizes of a and b add up to at most SSize + 1. Then all
+// the nonzero partial products a[i] * b[j] have i + j < SSize, and the result fits in SSize + 1
+// limbs. Only these partial products (SSize * (SSize + 1) / 2 of them) are computed,
+// and the loops (which have compile-time trip counts) are fully unrolled by the compiler.
+template <std::size_t SSize>
+inline ::mp_limb_t integer_mul_limbs_n(std::array<::mp_limb_t, SSize> &rop, const std::array<::mp_limb_t, SSize> &a,
+                                       const std::array<::mp_limb_t, SSize> &b)
+{
+    rop.fill(::mp_limb_t(0));
+    ::mp_limb_t top = 0;
+    for (std::size_t i = 0; i < SSize; ++i) {
+        ::mp_limb_t cy = 0;
+        for (std::size_t j = 0; i + j < SSize; ++j) {
+            // NOTE: a[i] * b[j] + rop[i + j] + cy always fits in a double limb,
+            // hence the new carry can never overflow.
+            ::mp_limb_t hi, tmp;
+            const ::mp_limb_t lo = dlimb_mul(a[i], b[j], &hi),
+                              cy1 = limb_add_overflow(lo, rop[i + j], &tmp),
+                              cy2 = limb_add_overflow(tmp, cy, &rop[i + j]);
+            cy = hi + cy1 + cy2;
+        }
+        // NOTE: this cannot overflow either, as the full product fits in SSize + 1 limbs.
+        top += cy;
+    }
+    return top;
+}
+
+template <std::size_t SSize>
+inline std::size_t static_mul_impl(static_int<SSize> &rop, const static_int<SSize> &op1, const static_int<SSize> &op2,
+                                   mpz_size_t asize1, mpz_size_t asize2, int sign1, int sign2,
+                                   const std::integral_constant<int, 3> &)
+{
+    // Handle zeroes.
+    // NOTE: we cannot rely on the limbs of a zero value being zero, as SSize > opt_size.
+    if (mppp_unlikely(!sign1 || !sign2)) {
+        rop._mp_size = 0;
+        return 0u;
+    }
+    // Early overflow detection: the product of an asize1-limb value by an asize2-limb value
+    // has at least asize1 + asize2 - 1 limbs.
+    const auto max_asize = static_cast<std::size_t>(asize1 + asize2);
+    if (mppp_unlikely(max_asize > SSize + 1u)) {
+        return max_asize;
+    }
+    if (asize1 == 1 && asize2 == 1) {
+        // Optimise the common case of 1-limb operands.
+        rop.m_limbs[0] = dlimb_mul(op1.m_limbs[0], op2.m_limbs[0], &rop.m_limbs[1]);
+        rop._mp_size = sign1 * sign2 * static_cast<mpz_size_t>(2 - (rop.m_limbs[1] == 0u));
+        return 0u;
+    }
+    // General case: compute into local buffers (this also takes care of overlapping arguments).
+    std::array<::mp_limb_t, SSize> a, b, res;
+    integer_load_limbs_n(a, op1, asize1);
+    integer_load_limbs_n(b, op2, asize2);
+    if (mppp_unlikely(integer_mul_limbs_n(res, a, b))) {
+        // The result has SSize + 1 limbs.
+        return max_asize;
+    }
+    rop._mp_size = sign1 * sign2 * integer_sub_compute_size(res.data(), static_cast<mpz_size_t>(SSize));
+    rop.m_limbs = res;
+    return 0u;
+}
+
 template <std::size_t SSize>
 inline std::size_t static_mul(static_int<SSize> &rop, const static_int<SSize> &op1, const static_int<SSize> &op2)
 {
@@ -4248,9 +4818,12 @@ namespace detail
 // optimised addmul algos. Otherwise, use the mpn one.
 template <typename SInt>
 using integer_static_addmul_algo = std::integral_constant<
-    int, (integer_static_add_algo<SInt>::value == 2 && integer_static_mul_algo<SInt>::value == 2)
-             ? 2
-             : ((integer_static_add_algo<SInt>::value == 1 && integer_static_mul_algo<SInt>::value == 1) ? 1 : 0)>;
+    int, (integer_static_add_algo<SInt>::value == 3 && integer_static_mul_algo<SInt>::value == 3)
+             ? 3
+             : ((integer_static_add_algo<SInt>::value == 2 && integer_static_mul_algo<SInt>::value == 2)
+                    ? 2
+                    : ((integer_static_add_algo<SInt>::value == 1 && integer_static_mul_algo<SInt>::value == 1) ? 1
+                                                                                                                : 0))>;
 
 // NOTE: same return value as mul: 0 for success, otherwise a hint for the size of the result.
 template <std::size_t SSize>
@@ -4413,6 +4986,51 @@ inline std::size_t static_addmul_impl(static_int<SSize> &rop, const static_int<S
     return 0u;
 }
 
+template <std::size_t SSize>
+inline std::size_t static_addmul_impl(static_int<SSize> &rop, const static_int<SSize> &op1,
+                                      const static_int<SSize> &op2, mpz_size_t asizer, mpz_size_t asize1,
+                                      mpz_size_t asize2, int signr, int sign1, int sign2,
+                                      const std::integral_constant<int, 3> &)
+{
+    if (mppp_unlikely(!asize1 || !asize2)) {
+        // If op1 or op2 are zero, rop will be unchanged.
+        return 0u;
+    }
+    // Early overflow detection for the product (same as in static_mul_impl()).
+    if (mppp_unlikely(static_cast<std::size_t>(asize1 + asize2) > SSize + 1u)) {
+        return SSize * 2u + 1u;
+    }
+    // Handle op1 * op2.
+    std::array<::mp_limb_t, SSize> a, b, prod;
+    integer_load_limbs_n(a, op1, asize1);
+    integer_load_limbs_n(b, op2, asize2);
+    if (mppp_unlikely(integer_mul_limbs_n(prod, a, b))) {
+        return SSize * 2u + 1u;
+    }
+    const int sign_prod = sign1 * sign2;
+    // Proceed to the addition. We re-use a as the buffer for rop.
+    // NOTE: nothing is written into rop until we know the operation succeeded.
+    integer_load_limbs_n(a, rop, asizer);
+    int sign;
+    if (signr == sign_prod) {
+        if (mppp_unlikely(integer_add_limbs_n(b, a, prod))) {
+            return SSize + 1u;
+        }
+        sign = signr;
+    } else if (integer_compare_limbs_n(a, prod) >= 0) {
+        // rop >= prod in absolute value.
+        integer_sub_limbs_n(b, a, prod);
+        sign = signr;
+    } else {
+        // prod > rop in absolute value.
+        integer_sub_limbs_n(b, prod, a);
+        sign = sign_prod;
+    }
+    rop._mp_size = sign * integer_sub_compute_size(b.data(), static_cast<mpz_size_t>(SSize));
+    rop.m_limbs = b;
+    return 0u;
+}
+
 template <bool AddOrSub, std::size_t SSize>
 inline std::size_t static_addsubmul(static_int<SSize> &rop, const static_int<SSize> &op1, const static_int<SSize> &op2)
 {
@@ -4716,10 +5334,12 @@ namespace detail
 // static squaring. We'll be using the
 // double-limb mul primitives if available.
 template <typename SInt>
-using integer_static_sqr_algo
-    = std::integral_constant<int, (SInt::s_size == 1 && integer_have_dlimb_mul::value)
-                                      ? 1
-                                      : ((SInt::s_size == 2 && integer_have_dlimb_mul::value) ? 2 : 0)>;
+using integer_static_sqr_algo = std::integral_constant<
+    int, (SInt::s_size == 1 && integer_have_dlimb_mul::value)
+             ? 1
+             : ((SInt::s_size == 2 && integer_have_dlimb_mul::value)
+                    ? 2
+                    : (((SInt::s_size == 3 || SInt::s_size == 4) && integer_have_dlimb_mul::value) ? 3 : 0))>;
 
 // mpn implementation.
 // NOTE: this function (and the other overloads) returns 0 in case of success, otherwise it returns a hint
@@ -4812,6 +5432,62 @@ inline std::size_t static_sqr_impl(static_int<SSize> &rop, const static_int<SSiz
     return 0;
 }
 
+// 3/4-limbs optimization via dlimb.
+template <std::size_t SSize>
+inline std::size_t static_sqr_impl(static_int<SSize> &rop, const static_int<SSize> &op,
+                                   const std::integral_constant<int, 3> &)
+{
+    const auto asize = static_cast<std::size_t>(std::abs(op._mp_size));
+
+    // Early overflow detection: the square of an asize-limb value has at least
+    // 2 * asize - 1 limbs. For 3 and 4 static limbs, this means that
+    // only operands with asize <= 2 can succeed.
+    static_assert(SSize == 3u || SSize == 4u, "Invalid static size.");
+    if (mppp_unlikely(asize > 2u)) {
+        return asize * 2u;
+    }
+
+    // Handle zero.
+    // NOTE: we cannot rely on the limbs of a zero value being zero, as SSize > opt_size.
+    if (mppp_unlikely(asize == 0u)) {
+        rop._mp_size = 0;
+        return 0u;
+    }
+
+    // Square the (zero-padded) 2-limb value:
+    //
+    // (a1 * B + a0)**2 = a1**2 * B**2 + 2 * a0 * a1 * B + a0**2.
+    const ::mp_limb_t a0 = op.m_limbs[0], a1 = asize == 2u ? op.m_limbs[1] : ::mp_limb_t(0);
+    ::mp_limb_t sq0_hi, cross_hi, sq1_hi;
+    const ::mp_limb_t sq0_lo = dlimb_mul(a0, a0, &sq0_hi), cross_lo = dlimb_mul(a0, a1, &cross_hi),
+                      sq1_lo = dlimb_mul(a1, a1, &sq1_hi);
+    // Double the cross product. This may spill over into a third limb.
+    const ::mp_limb_t d0 = cross_lo << 1, d1 = (cross_hi << 1) | (cross_lo >> (GMP_NUMB_BITS - 1)),
+                      d2 = cross_hi >> (GMP_NUMB_BITS - 1);
+    // Accumulate.
+    std::array<::mp_limb_t, 4> res;
+    ::mp_limb_t tmp;
+    res[0] = sq0_lo;
+    const ::mp_limb_t cy1 = limb_add_overflow(sq0_hi, d0, &res[1]), cy2 = limb_add_overflow(sq1_lo, d1, &tmp),
+                      cy3 = limb_add_overflow(tmp, cy1, &res[2]);
+    // NOTE: this cannot overflow, as the square of a 2-limb value fits in 4 limbs.
+    res[3] = sq1_hi + d2 + cy2 + cy3;
+
+    // Compute the size of the result.
+    const auto res_size = static_cast<std::size_t>(integer_sub_compute_size(res.data(), 4));
+    if (res_size > SSize) {
+        // Not enough space: return asize * 2, which is
+        // what mpz_mul() would like to allocate for the result.
+        return asize * 2u;
+    }
+
+    // Enough space, write out the result.
+    rop._mp_size = static_cast<mpz_size_t>(res_size);
+    copy_limbs_no(res.data(), res.data() + res_size, rop.m_limbs.data());
+
+    return 0u;
+}
+
 template <std::size_t SSize>
 inline std::size_t static_sqr(static_int<SSize> &rop, const static_int<SSize> &op)
 {
@@ -5924,7 +6600,280 @@ inline integer<SSize> &tdiv_q_2exp(integer<SSize> &rop, const integer<SSize> &n,
     return rop;
 }
 
-/** @} */
+namespace detail
+{
+
+// Floor (Ceil == false) or ceiling (Ceil == true) division with remainder, implemented
+// on top of the truncated division. The truncated quotient needs to be adjusted (by -1 in
+// the floor case, by +1 in the ceiling case) if the remainder is nonzero and its sign
+// differs from (floor), or matches (ceiling), the sign of the divisor.
+// NOTE: the adjusted quotient and remainder are never larger in absolute value than the
+// dividend and the divisor respectively, hence the adjustments cannot fail.
+template <bool Ceil, std::size_t SSize>
+inline void static_fcdiv_qr(static_int<SSize> &q, static_int<SSize> &r, const static_int<SSize> &op1,
+                            const static_int<SSize> &op2)
+{
+    // NOTE: the divisor is needed after the truncated division, make
+    // a copy of it if it overlaps with q or r.
+    static_int<SSize> d_copy;
+    const static_int<SSize> *d = &op2;
+    if (&op2 == &q || &op2 == &r) {
+        d_copy = op2;
+        d = &d_copy;
+    }
+    static_tdiv_qr(q, r, op1, op2);
+    if (r._mp_size != 0 && ((integral_sign(r._mp_size) != integral_sign(d->_mp_size)) != Ceil)) {
+        const bool sq = static_addsub_1<Ceil>(q, q, ::mp_limb_t(1)), sr = static_addsub<!Ceil>(r, r, *d);
+        ignore(sq, sr);
+        assert(sq && sr);
+    }
+}
+
+// Non-negative remainder.
+template <std::size_t SSize>
+inline void static_mod(static_int<SSize> &r, const static_int<SSize> &op1, const static_int<SSize> &op2)
+{
+    static_int<SSize> d_copy;
+    const static_int<SSize> *d = &op2;
+    if (&op2 == &r) {
+        d_copy = op2;
+        d = &d_copy;
+    }
+    static_int<SSize> q;
+    static_tdiv_qr(q, r, op1, op2);
+    if (r._mp_size < 0) {
+        // r + abs(d).
+        const bool sr = d->_mp_size > 0 ? static_addsub<true>(r, r, *d) : static_addsub<false>(r, r, *d);
+        ignore(sr);
+        assert(sr);
+    }
+}
+
+// Check if any of the lowest s bits of the static integer n is nonzero.
+template <std::size_t SSize>
+inline bool static_any_low_bits(const static_int<SSize> &n, ::mp_bitcnt_t s)
+{
+    const auto asize = static_cast<std::size_t>(n.abs_size());
+    const auto ls = s / unsigned(GMP_NUMB_BITS), rs = s % unsigned(GMP_NUMB_BITS);
+    const auto nl = ls < asize ? static_cast<std::size_t>(ls) : asize;
+    for (std::size_t i = 0; i < nl; ++i) {
+        if (n.m_limbs[i] & GMP_NUMB_MASK) {
+            return true;
+        }
+    }
+    return nl < asize && rs != 0u && (n.m_limbs[nl] & GMP_NUMB_MASK & ((::mp_limb_t(1) << rs) - 1u)) != 0u;
+}
+
+// Floor (Ceil == false) or ceiling (Ceil == true) division by 2**s.
+template <bool Ceil, std::size_t SSize>
+inline void static_fcdiv_q_2exp(static_int<SSize> &rop, const static_int<SSize> &n, ::mp_bitcnt_t s)
+{
+    // NOTE: the truncated quotient needs to be adjusted only if n is negative (floor)
+    // or positive (ceiling), and some nonzero bits are shifted out.
+    const bool adjust = (Ceil ? n._mp_size > 0 : n._mp_size < 0) && static_any_low_bits(n, s);
+    static_tdiv_q_2exp(rop, n, s);
+    if (adjust) {
+        const bool sr = static_addsub_1<Ceil>(rop, rop, ::mp_limb_t(1));
+        ignore(sr);
+        assert(sr);
+    }
+}
+
+// Implementation of the floor/ceiling division functions.
+template <bool Ceil, std::size_t SSize>
+inline void fcdiv_qr_impl(integer<SSize> &q, integer<SSize> &r, const integer<SSize> &n, const integer<SSize> &d)
+{
+    if (mppp_unlikely(&q == &r)) {
+        throw std::invalid_argument("When performing a division with remainder, the quotient 'q' and the "
+                                    "remainder 'r' must be distinct objects");
+    }
+    if (mppp_unlikely(d.sgn() == 0)) {
+        throw zero_division_error("Integer division by zero");
+    }
+    const bool sq = q.is_static(), sr = r.is_static(), s1 = n.is_static(), s2 = d.is_static();
+    if (mppp_likely(s1 && s2)) {
+        if (!sq) {
+            q.set_zero();
+        }
+        if (!sr) {
+            r.set_zero();
+        }
+        static_fcdiv_qr<Ceil>(q._get_union().g_st(), r._get_union().g_st(), n._get_union().g_st(),
+                              d._get_union().g_st());
+        return;
+    }
+    if (sq) {
+        q._get_union().promote();
+    }
+    if (sr) {
+        r._get_union().promote();
+    }
+    if (Ceil) {
+        ::mpz_cdiv_qr(&q._get_union().g_dy(), &r._get_union().g_dy(), n.get_mpz_view(), d.get_mpz_view());
+    } else {
+        ::mpz_fdiv_qr(&q._get_union().g_dy(), &r._get_union().g_dy(), n.get_mpz_view(), d.get_mpz_view());
+    }
+}
+
+template <bool Ceil, std::size_t SSize>
+inline integer<SSize> &fcdiv_q_impl(integer<SSize> &q, const integer<SSize> &n, const integer<SSize> &d)
+{
+    if (mppp_unlikely(d.sgn() == 0)) {
+        throw zero_division_error("Integer division by zero");
+    }
+    const bool sq = q.is_static(), s1 = n.is_static(), s2 = d.is_static();
+    if (mppp_likely(s1 && s2)) {
+        if (!sq) {
+            q.set_zero();
+        }
+        static_int<SSize> r;
+        static_fcdiv_qr<Ceil>(q._get_union().g_st(), r, n._get_union().g_st(), d._get_union().g_st());
+        return q;
+    }
+    if (sq) {
+        q._get_union().promote();
+    }
+    if (Ceil) {
+        ::mpz_cdiv_q(&q._get_union().g_dy(), n.get_mpz_view(), d.get_mpz_view());
+    } else {
+        ::mpz_fdiv_q(&q._get_union().g_dy(), n.get_mpz_view(), d.get_mpz_view());
+    }
+    return q;
+}
+
+template <bool Ceil, std::size_t SSize>
+inline integer<SSize> &fcdiv_r_impl(integer<SSize> &r, const integer<SSize> &n, const integer<SSize> &d)
+{
+    if (mppp_unlikely(d.sgn() == 0)) {
+        throw zero_division_error("Integer division by zero");
+    }
+    const bool sr = r.is_static(), s1 = n.is_static(), s2 = d.is_static();
+    if (mppp_likely(s1 && s2)) {
+        if (!sr) {
+            r.set_zero();
+        }
+        static_int<SSize> q;
+        static_fcdiv_qr<Ceil>(q, r._get_union().g_st(), n._get_union().g_st(), d._get_union().g_st());
+        return r;
+    }
+    if (sr) {
+        r._get_union().promote();
+    }
+    if (Ceil) {
+        ::mpz_cdiv_r(&r._get_union().g_dy(), n.get_mpz_view(), d.get_mpz_view());
+    } else {
+        ::mpz_fdiv_r(&r._get_union().g_dy(), n.get_mpz_view(), d.get_mpz_view());
+    }
+    return r;
+}
+
+template <bool Ceil, std::size_t SSize>
+inline integer<SSize> &fcdiv_q_2exp_impl(integer<SSize> &rop, const integer<SSize> &n, ::mp_bitcnt_t s)
+{
+    const bool sn = n.is_static(), sr = rop.is_static();
+    if (mppp_likely(sn)) {
+        if (!sr) {
+            rop.set_zero();
+        }
+        static_fcdiv_q_2exp<Ceil>(rop._get_union().g_st(), n._get_union().g_st(), s);
+        return rop;
+    }
+    if (sr) {
+        rop._get_union().promote();
+    }
+    if (Ceil) {
+        ::mpz_cdiv_q_2exp(&rop._get_union().g_dy(), n.get_mpz_view(), s);
+    } else {
+        ::mpz_fdiv_q_2exp(&rop._get_union().g_dy(), n.get_mpz_view(), s);
+    }
+    return rop;
+}
+
+} // namespace detail
+
+#if !defined(MPPP_DOXYGEN_INVOKED)
+
+// Ternary floor division with remainder.
+template <std::size_t SSize>
+inline void fdiv_qr(integer<SSize> &q, integer<SSize> &r, const integer<SSize> &n, const integer<SSize> &d)
+{
+    detail::fcdiv_qr_impl<false>(q, r, n, d);
+}
+
+// Ternary ceiling division with remainder.
+template <std::size_t SSize>
+inline void cdiv_qr(integer<SSize> &q, integer<SSize> &r, const integer<SSize> &n, const integer<SSize> &d)
+{
+    detail::fcdiv_qr_impl<true>(q, r, n, d);
+}
+
+// Ternary floor division without remainder.
+template <std::size_t SSize>
+inline integer<SSize> &fdiv_q(integer<SSize> &q, const integer<SSize> &n, const integer<SSize> &d)
+{
+    return detail::fcdiv_q_impl<false>(q, n, d);
+}
+
+// Ternary ceiling division without remainder.
+template <std::size_t SSize>
+inline integer<SSize> &cdiv_q(integer<SSize> &q, const integer<SSize> &n, const integer<SSize> &d)
+{
+    return detail::fcdiv_q_impl<true>(q, n, d);
+}
+
+// Ternary floor remainder.
+template <std::size_t SSize>
+inline integer<SSize> &fdiv_r(integer<SSize> &r, const integer<SSize> &n, const integer<SSize> &d)
+{
+    return detail::fcdiv_r_impl<false>(r, n, d);
+}
+
+// Ternary ceiling remainder.
+template <std::size_t SSize>
+inline integer<SSize> &cdiv_r(integer<SSize> &r, const integer<SSize> &n, const integer<SSize> &d)
+{
+    return detail::fcdiv_r_impl<true>(r, n, d);
+}
+
+// Ternary non-negative remainder.
+template <std::size_t SSize>
+inline integer<SSize> &mod(integer<SSize> &r, const integer<SSize> &n, const integer<SSize> &d)
+{
+    if (mppp_unlikely(d.sgn() == 0)) {
+        throw zero_division_error("Integer division by zero");
+    }
+    const bool sr = r.is_static(), s1 = n.is_static(), s2 = d.is_static();
+    if (mppp_likely(s1 && s2)) {
+        if (!sr) {
+            r.set_zero();
+        }
+        detail::static_mod(r._get_union().g_st(), n._get_union().g_st(), d._get_union().g_st());
+        return r;
+    }
+    if (sr) {
+        r._get_union().promote();
+    }
+    ::mpz_mod(&r._get_union().g_dy(), n.get_mpz_view(), d.get_mpz_view());
+    return r;
+}
+
+// Ternary floor division by a power of 2.
+template <std::size_t SSize>
+inline integer<SSize> &fdiv_q_2exp(integer<SSize> &rop, const integer<SSize> &n, ::mp_bitcnt_t s)
+{
+    return detail::fcdiv_q_2exp_impl<false>(rop, n, s);
+}
+
+// Ternary ceiling division by a power of 2.
+template <std::size_t SSize>
+inline integer<SSize> &cdiv_q_2exp(integer<SSize> &rop, const integer<SSize> &n, ::mp_bitcnt_t s)
+{
+    return detail::fcdiv_q_2exp_impl<true>(rop, n, s);
+}
+
+#endif
+
+/** @} */
 
 /** @defgroup integer_comparison integer_comparison
  *  @{
@@ -7003,107 +7952,494 @@ inline integer<SSize> &bitwise_xor(integer<SSize> &rop, const integer<SSize> &op
     return rop;
 }
 
-/** @} */
-
-/** @defgroup integer_ntheory integer_ntheory
- *  @{
- */
-
 namespace detail
 {
 
-// mpn/mpz implementation.
+// The value of the limb with index idx in the two's complement representation of
+// the static integer n. low_zero must be true if all the limbs of n below idx are zero.
 template <std::size_t SSize>
-inline void static_gcd_impl(static_int<SSize> &rop, const static_int<SSize> &op1, const static_int<SSize> &op2,
-                            mpz_size_t asize1, mpz_size_t asize2)
+inline ::mp_limb_t static_tc_limb(const static_int<SSize> &n, std::size_t idx, bool low_zero)
 {
-    // NOTE: performance testing indicates that, even if mpz_gcd() does special casing
-    // for zeroes and 1-limb values, it is still worth it to repeat the special casing
-    // here. This is probably because if we manage to actually call mpn_gcd_1() here,
-    // we avoid interacting with dynamically allocated memory below in the thread-local
-    // object. If we ever start using mpn_gcd(), we will probably have to re-do a
-    // performance analysis.
-    //
-    // Handle zeroes.
-    if (!asize1) {
-        // NOTE: we want the result to be positive, and to copy only the set limbs.
-        rop._mp_size = asize2;
-        copy_limbs(op2.m_limbs.data(), op2.m_limbs.data() + asize2, rop.m_limbs.data());
-        return;
+    const auto asize = static_cast<std::size_t>(n.abs_size());
+    if (idx >= asize) {
+        // Beyond the size, the limbs are all zeroes for a nonnegative
+        // value, and all ones for a negative value.
+        return n._mp_size < 0 ? GMP_NUMB_MASK : ::mp_limb_t(0);
     }
-    if (!asize2) {
-        rop._mp_size = asize1;
-        copy_limbs(op1.m_limbs.data(), op1.m_limbs.data() + asize1, rop.m_limbs.data());
-        return;
+    const ::mp_limb_t l = n.m_limbs[idx] & GMP_NUMB_MASK;
+    if (n._mp_size > 0) {
+        return l;
     }
-    // Special casing if an operand has asize 1.
-    if (asize1 == 1) {
-        rop._mp_size = 1;
-        rop.m_limbs[0] = ::mpn_gcd_1(op2.m_limbs.data(), static_cast<::mp_size_t>(asize2), op1.m_limbs[0]);
-        return;
+    // NOTE: the two's complement of -x is ~(x - 1). The subtraction of 1
+    // borrows through the lower limbs only if they are all zero.
+    return (low_zero ? ::mp_limb_t(0) - l : ~l) & GMP_NUMB_MASK;
+}
+
+// Check if all the limbs of the static integer n below idx are zero.
+template <std::size_t SSize>
+inline bool static_low_limbs_zero(const static_int<SSize> &n, std::size_t idx)
+{
+    const auto asize = static_cast<std::size_t>(n.abs_size());
+    const auto nl = idx < asize ? idx : asize;
+    for (std::size_t i = 0; i < nl; ++i) {
+        if (n.m_limbs[i] & GMP_NUMB_MASK) {
+            return false;
+        }
     }
-    if (asize2 == 1) {
-        rop._mp_size = 1;
-        rop.m_limbs[0] = ::mpn_gcd_1(op1.m_limbs.data(), static_cast<::mp_size_t>(asize1), op2.m_limbs[0]);
-        return;
+    return true;
+}
+
+template <std::size_t SSize>
+inline bool static_tstbit(const static_int<SSize> &n, ::mp_bitcnt_t idx)
+{
+    const auto li = idx / unsigned(GMP_NUMB_BITS);
+    if (li >= static_cast<::mp_bitcnt_t>(n.abs_size())) {
+        return n._mp_size < 0;
     }
-    // General case, via mpz.
-    // NOTE: there is an mpn_gcd() function, but it seems difficult to use. Apparently, and contrary to
-    // what stated in the latest documentation, the mpn function requires odd operands and bit size
-    // (not only limb size!) of the second operand not greater than the first. See for instance the old
-    // documentation:
-    // ftp://ftp.gnu.org/old-gnu/Manuals/gmp-3.1.1/html_chapter/gmp_9.html
-    // Indeed, compiling GMP in debug mode and then trying to use the mpn function without respecting the above
-    // results in assertion failures. For now let's keep it like this, the small operand cases are handled above
-    // (partially) via mpn_gcd_1(), and in the future we can also think about binary GCD for 1/2 limbs optimisation.
-    MPPP_MAYBE_TLS mpz_raii tmp;
-    const auto v1 = op1.get_mpz_view();
-    const auto v2 = op2.get_mpz_view();
-    ::mpz_gcd(&tmp.m_mpz, &v1, &v2);
-    // Copy over.
-    rop._mp_size = tmp.m_mpz._mp_size;
-    assert(rop._mp_size > 0);
-    copy_limbs_no(tmp.m_mpz._mp_d, tmp.m_mpz._mp_d + rop._mp_size, rop.m_limbs.data());
+    const auto l = static_tc_limb(n, static_cast<std::size_t>(li),
+                                  n._mp_size < 0 && static_low_limbs_zero(n, static_cast<std::size_t>(li)));
+    return ((l >> (idx % unsigned(GMP_NUMB_BITS))) & 1u) != 0u;
 }
 
-// 1-limb optimization.
-inline void static_gcd_impl(static_int<1> &rop, const static_int<1> &op1, const static_int<1> &op2, mpz_size_t asize1,
-                            mpz_size_t asize2)
+// Scan for the first bit equal to Bit, at or above the position start, in the two's complement
+// representation of the static integer n. If no such bit exists, the maximum value of
+// ::mp_bitcnt_t will be returned, like in GMP.
+template <bool Bit, std::size_t SSize>
+inline ::mp_bitcnt_t static_scan(const static_int<SSize> &n, ::mp_bitcnt_t start)
 {
-    // Handle the special cases first.
-    if (asize1 == 0) {
-        // gcd(0, n) = abs(n). This also covers the convention
-        // that gcd(0, 0) = 0.
-        // NOTE: don't use the copy assignment operator of static_int,
-        // as the size needs to be set to positive.
-        rop._mp_size = asize2;
-        rop.m_limbs = op2.m_limbs;
-        return;
+    const auto asize = static_cast<std::size_t>(n.abs_size());
+    const bool neg = n._mp_size < 0;
+    // The bit value beyond the size.
+    const bool beyond = neg;
+    const auto sli = start / unsigned(GMP_NUMB_BITS);
+    if (sli >= asize) {
+        return beyond == Bit ? start : nl_max<::mp_bitcnt_t>();
     }
-    if (asize2 == 0) {
-        // gcd(n, 0) = abs(n).
-        // NOTE: op1 is not zero, its size can only be 1.
-        rop._mp_size = 1;
-        rop.m_limbs = op1.m_limbs;
-        return;
+    auto li = static_cast<std::size_t>(sli);
+    bool low_zero = neg && static_low_limbs_zero(n, li);
+    for (; li < asize; ++li) {
+        const auto l = static_tc_limb(n, li, low_zero);
+        low_zero = low_zero && (n.m_limbs[li] & GMP_NUMB_MASK) == 0u;
+        auto x = (Bit ? l : ~l) & GMP_NUMB_MASK;
+        if (li == sli) {
+            // Discard the bits below start.
+            x &= ~((::mp_limb_t(1) << (start % unsigned(GMP_NUMB_BITS))) - 1u);
+        }
+        if (x != 0u) {
+            return static_cast<::mp_bitcnt_t>(li) * unsigned(GMP_NUMB_BITS) + limb_ctz(x);
+        }
     }
-    // At this point, asize1 == asize2 == 1, and the result
-    // will also have size 1.
-    rop._mp_size = 1;
-    // Compute the limb value.
-    // NOTE: as an alternative, here we could have a custom binary GCD. See for
-    // instance this implementation by Howard Hinnant using compiler intrinsics:
-    // https://groups.google.com/a/isocpp.org/forum/#!topic/std-proposals/8WB2Z9d7A0w
-    // Testing however shows that mpn_gcd_1() is quite well optimised, so let's
-    // use it and keep in mind the option about the binary GCD for the future.
-    // NOTE: at the commit c146af86e416cf1348d0b3fc454600b47b523f4f we have an implementation
-    // of the binary GCD, just in case.
-    // NOTE: currently, the binary GCD is faster on Zen processors, but I believe
-    // that is because the current GMP version does not have optimised GCD assembly for Zen.
-    // We need to benchmark again when the next GMP version comes out. If the binary GCD
-    // is still faster, we should consider using it instead of mpn_gcd_1(), as even on Intel
-    // processors the binary GCD is only marginally slower than mpn_gcd_1().
-    rop.m_limbs[0] = ::mpn_gcd_1(op1.m_limbs.data(), static_cast<::mp_size_t>(1), op2.m_limbs[0]);
+    return beyond == Bit ? static_cast<::mp_bitcnt_t>(asize) * unsigned(GMP_NUMB_BITS) : nl_max<::mp_bitcnt_t>();
+}
+
+template <std::size_t SSize>
+inline ::mp_bitcnt_t static_popcount(const static_int<SSize> &n)
+{
+    if (n._mp_size < 0) {
+        // Infinite number of ones in the two's complement representation.
+        return nl_max<::mp_bitcnt_t>();
+    }
+    ::mp_bitcnt_t retval = 0;
+    for (std::size_t i = 0; i < static_cast<std::size_t>(n._mp_size); ++i) {
+        retval += limb_popcount(n.m_limbs[i] & GMP_NUMB_MASK);
+    }
+    return retval;
+}
+
+template <std::size_t SSize>
+inline ::mp_bitcnt_t static_hamdist(const static_int<SSize> &op1, const static_int<SSize> &op2)
+{
+    if ((op1._mp_size < 0) != (op2._mp_size < 0)) {
+        // Infinite number of different bits.
+        return nl_max<::mp_bitcnt_t>();
+    }
+    const auto asize1 = static_cast<std::size_t>(op1.abs_size()), asize2 = static_cast<std::size_t>(op2.abs_size());
+    // NOTE: for negative values, the two's complement representations are ~(x - 1) and ~(y - 1),
+    // and their Hamming distance is the Hamming distance of x - 1 and y - 1.
+    std::array<::mp_limb_t, SSize> x, y;
+    copy_limbs_no(op1.m_limbs.data(), op1.m_limbs.data() + asize1, x.data());
+    copy_limbs_no(op2.m_limbs.data(), op2.m_limbs.data() + asize2, y.data());
+    if (op1._mp_size < 0) {
+        ::mpn_sub_1(x.data(), x.data(), static_cast<::mp_size_t>(asize1), 1u);
+        ::mpn_sub_1(y.data(), y.data(), static_cast<::mp_size_t>(asize2), 1u);
+    }
+    ::mp_bitcnt_t retval = 0;
+    const auto max_asize = asize1 > asize2 ? asize1 : asize2;
+    for (std::size_t i = 0; i < max_asize; ++i) {
+        const auto l1 = i < asize1 ? x[i] : ::mp_limb_t(0), l2 = i < asize2 ? y[i] : ::mp_limb_t(0);
+        retval += limb_popcount((l1 ^ l2) & GMP_NUMB_MASK);
+    }
+    return retval;
+}
+
+// Add (Add == true) or subtract (Add == false) 2**idx to/from the absolute value of the static integer n.
+// In case of subtraction, the absolute value of n must be at least 2**idx. Returns false, leaving n
+// unmodified, if the result does not fit in static storage.
+template <bool Add, std::size_t SSize>
+inline bool static_abs_addsub_2exp(static_int<SSize> &n, ::mp_bitcnt_t idx)
+{
+    const int sign = n._mp_size < 0 ? -1 : 1;
+    auto asize = static_cast<std::size_t>(n.abs_size());
+    const auto li = idx / unsigned(GMP_NUMB_BITS);
+    const auto b = ::mp_limb_t(1) << (idx % unsigned(GMP_NUMB_BITS));
+    if (Add) {
+        if (li >= SSize) {
+            return false;
+        }
+        const auto sli = static_cast<std::size_t>(li);
+        if (sli >= asize) {
+            // NOTE: with SSize > opt_size, the limbs above the size are not guaranteed to be zero.
+            std::fill(n.m_limbs.begin() + static_cast<std::ptrdiff_t>(asize),
+                      n.m_limbs.begin() + static_cast<std::ptrdiff_t>(sli), ::mp_limb_t(0));
+            n.m_limbs[sli] = b;
+            n._mp_size = sign * static_cast<mpz_size_t>(sli + 1u);
+            return true;
+        }
+        if (::mpn_add_1(n.m_limbs.data() + sli, n.m_limbs.data() + sli, static_cast<::mp_size_t>(asize - sli), b)) {
+            if (asize == SSize) {
+                // Undo the addition and signal the overflow.
+                ::mpn_sub_1(n.m_limbs.data() + sli, n.m_limbs.data() + sli, static_cast<::mp_size_t>(asize - sli),
+                            b);
+                return false;
+            }
+            n.m_limbs[asize] = 1u;
+            n._mp_size = sign * static_cast<mpz_size_t>(asize + 1u);
+        }
+        return true;
+    }
+    assert(li < asize);
+    const auto sli = static_cast<std::size_t>(li);
+    ::mpn_sub_1(n.m_limbs.data() + sli, n.m_limbs.data() + sli, static_cast<::mp_size_t>(asize - sli), b);
+    while (asize != 0u && (n.m_limbs[asize - 1u] & GMP_NUMB_MASK) == 0u) {
+        --asize;
+    }
+    n._mp_size = sign * static_cast<mpz_size_t>(asize);
+    return true;
+}
+
+// Add (Up == true) or subtract (Up == false) 2**idx to/from the static integer n.
+// Returns false, leaving n unmodified, if the result does not fit in static storage.
+// NOTE: this is used to implement the bit mutation functions, and it requires
+// that bit idx of n is currently 0 (if Up) or 1 (if !Up) in two's complement.
+template <bool Up, std::size_t SSize>
+inline bool static_addsub_2exp(static_int<SSize> &n, ::mp_bitcnt_t idx)
+{
+    if (Up == (n._mp_size >= 0)) {
+        return static_abs_addsub_2exp<true>(n, idx);
+    }
+    return static_abs_addsub_2exp<false>(n, idx);
+}
+
+// Implementation of the bit mutation functions: Op == 0 sets the bit,
+// Op == 1 clears it, Op == 2 complements it.
+template <int Op, std::size_t SSize>
+inline integer<SSize> &bit_mutation_impl(integer<SSize> &n, ::mp_bitcnt_t idx)
+{
+    if (mppp_likely(n.is_static())) {
+        auto &st = n._get_union().g_st();
+        const bool cur = static_tstbit(st, idx);
+        if ((Op == 0 && cur) || (Op == 1 && !cur)) {
+            // Nothing to do.
+            return n;
+        }
+        if (mppp_likely(cur ? static_addsub_2exp<false>(st, idx) : static_addsub_2exp<true>(st, idx))) {
+            return n;
+        }
+        n._get_union().promote();
+    }
+    switch (Op) {
+        case 0:
+            ::mpz_setbit(&n._get_union().g_dy(), idx);
+            break;
+        case 1:
+            ::mpz_clrbit(&n._get_union().g_dy(), idx);
+            break;
+        default:
+            ::mpz_combit(&n._get_union().g_dy(), idx);
+    }
+    return n;
+}
+
+} // namespace detail
+
+#if !defined(MPPP_DOXYGEN_INVOKED)
+
+// Population count.
+template <std::size_t SSize>
+inline ::mp_bitcnt_t popcount(const integer<SSize> &n)
+{
+    if (mppp_likely(n.is_static())) {
+        return detail::static_popcount(n._get_union().g_st());
+    }
+    return ::mpz_popcount(n.get_mpz_view());
+}
+
+// Hamming distance.
+template <std::size_t SSize>
+inline ::mp_bitcnt_t hamdist(const integer<SSize> &op1, const integer<SSize> &op2)
+{
+    if (mppp_likely(op1.is_static() && op2.is_static())) {
+        return detail::static_hamdist(op1._get_union().g_st(), op2._get_union().g_st());
+    }
+    return ::mpz_hamdist(op1.get_mpz_view(), op2.get_mpz_view());
+}
+
+// Scan for the first 0 bit.
+template <std::size_t SSize>
+inline ::mp_bitcnt_t scan0(const integer<SSize> &n, ::mp_bitcnt_t start)
+{
+    if (mppp_likely(n.is_static())) {
+        return detail::static_scan<false>(n._get_union().g_st(), start);
+    }
+    return ::mpz_scan0(n.get_mpz_view(), start);
+}
+
+// Scan for the first 1 bit.
+template <std::size_t SSize>
+inline ::mp_bitcnt_t scan1(const integer<SSize> &n, ::mp_bitcnt_t start)
+{
+    if (mppp_likely(n.is_static())) {
+        return detail::static_scan<true>(n._get_union().g_st(), start);
+    }
+    return ::mpz_scan1(n.get_mpz_view(), start);
+}
+
+// Test bit.
+template <std::size_t SSize>
+inline bool tstbit(const integer<SSize> &n, ::mp_bitcnt_t idx)
+{
+    if (mppp_likely(n.is_static())) {
+        return detail::static_tstbit(n._get_union().g_st(), idx);
+    }
+    return ::mpz_tstbit(n.get_mpz_view(), idx) != 0;
+}
+
+// Set bit.
+template <std::size_t SSize>
+inline integer<SSize> &setbit(integer<SSize> &n, ::mp_bitcnt_t idx)
+{
+    return detail::bit_mutation_impl<0>(n, idx);
+}
+
+// Clear bit.
+template <std::size_t SSize>
+inline integer<SSize> &clrbit(integer<SSize> &n, ::mp_bitcnt_t idx)
+{
+    return detail::bit_mutation_impl<1>(n, idx);
+}
+
+// Complement bit.
+template <std::size_t SSize>
+inline integer<SSize> &combit(integer<SSize> &n, ::mp_bitcnt_t idx)
+{
+    return detail::bit_mutation_impl<2>(n, idx);
+}
+
+#endif
+
+/** @} */
+
+/** @defgroup integer_ntheory integer_ntheory
+ *  @{
+ */
+
+namespace detail
+{
+
+// Binary GCD of the odd 1-limb values u and v.
+// NOTE: this requires no nail bits.
+inline ::mp_limb_t integer_binary_gcd_1(::mp_limb_t u, ::mp_limb_t v)
+{
+    assert((u & 1u) && (v & 1u));
+    while (true) {
+        // NOTE: the loop is written in terms of masks, so that
+        // the compiler can avoid hard-to-predict branches.
+        const ::mp_limb_t d = v - u, m = -static_cast<::mp_limb_t>(v < u);
+        if (d == 0u) {
+            return u;
+        }
+        // NOTE: d and -d have the same number of trailing zeroes.
+        const auto z = limb_ctz(d);
+        // u = min(u, v), v = abs(v - u). The new v is even and nonzero.
+        u ^= (u ^ v) & m;
+        v = ((d ^ m) - m) >> z;
+    }
+}
+
+// Number of trailing zero bits in the nonzero 2-limb value (lo, hi).
+inline unsigned integer_ctz_2(::mp_limb_t lo, ::mp_limb_t hi)
+{
+    return lo != 0u ? limb_ctz(lo) : unsigned(GMP_NUMB_BITS) + limb_ctz(hi);
+}
+
+// Right shift of the 2-limb value (lo, hi) by s bits, with s < 2 * GMP_NUMB_BITS.
+inline void integer_shr_2(::mp_limb_t &lo, ::mp_limb_t &hi, unsigned s)
+{
+    if (s >= unsigned(GMP_NUMB_BITS)) {
+        lo = hi >> (s - unsigned(GMP_NUMB_BITS));
+        hi = 0;
+    } else if (s != 0u) {
+        lo = (lo >> s) | (hi << (unsigned(GMP_NUMB_BITS) - s));
+        hi >>= s;
+    }
+}
+
+// Binary GCD of the nonzero 2-limb values (u0, u1) and (v0, v1).
+// The result is written into (u0, u1).
+// NOTE: this requires no nail bits.
+inline void integer_binary_gcd_2(::mp_limb_t &u0, ::mp_limb_t &u1, ::mp_limb_t v0, ::mp_limb_t v1)
+{
+    constexpr unsigned nbits = unsigned(GMP_NUMB_BITS);
+    // Remove the powers of 2, and remember the common one.
+    const unsigned zu = integer_ctz_2(u0, u1), zv = integer_ctz_2(v0, v1), shift = zu < zv ? zu : zv;
+    integer_shr_2(u0, u1, zu);
+    integer_shr_2(v0, v1, zv);
+    // u and v are now odd. Drop their (implicit) least significant bit, so that
+    // the top bit of u - v is the sign of the difference.
+    integer_shr_2(u0, u1, 1);
+    integer_shr_2(v0, v1, 1);
+    bool equal = false;
+    // Iterate in 2-limb arithmetic as long as one of the operands does not fit in a single limb.
+    while ((u1 | v1 | ((u0 | v0) >> (nbits - 1u))) != 0u) {
+        // t = u - v, and m = -1 if u < v, 0 otherwise.
+        const ::mp_limb_t t0 = u0 - v0, t1 = u1 - v1 - static_cast<::mp_limb_t>(u0 < v0),
+                          m = -(t1 >> (nbits - 1u));
+        if (mppp_unlikely(t0 == 0u && t1 == 0u)) {
+            equal = true;
+            break;
+        }
+        // NOTE: the difference of the actual odd values is 2 * t. Its
+        // trailing zeroes, plus the implicit bit, are removed below.
+        const unsigned c = (t0 != 0u ? limb_ctz(t0) : nbits + limb_ctz(t1)) + 1u;
+        // v = min(u, v) = v + (u - v) if u < v.
+        const ::mp_limb_t a0 = m & t0;
+        v0 += a0;
+        v1 += (m & t1) + static_cast<::mp_limb_t>(v0 < a0);
+        // u = abs(t) >> c.
+        u0 = (t0 ^ m) - m;
+        u1 = (t1 ^ m) + (m & static_cast<::mp_limb_t>(t0 == 0u));
+        integer_shr_2(u0, u1, c);
+    }
+    if (equal) {
+        // Restore the implicit bit.
+        u1 = (u1 << 1) | (u0 >> (nbits - 1u));
+        u0 = (u0 << 1) | 1u;
+    } else {
+        // Finish off in 1-limb arithmetic.
+        u0 = integer_binary_gcd_1((u0 << 1) | 1u, (v0 << 1) | 1u);
+        u1 = 0;
+    }
+    // Restore the common power of 2.
+    if (shift >= nbits) {
+        u1 = u0 << (shift - nbits);
+        u0 = 0;
+    } else if (shift != 0u) {
+        u1 = (u1 << shift) | (u0 >> (nbits - shift));
+        u0 <<= shift;
+    }
+}
+
+// mpn/mpz implementation.
+template <std::size_t SSize>
+inline void static_gcd_impl(static_int<SSize> &rop, const static_int<SSize> &op1, const static_int<SSize> &op2,
+                            mpz_size_t asize1, mpz_size_t asize2)
+{
+    // NOTE: performance testing indicates that, even if mpz_gcd() does special casing
+    // for zeroes and 1-limb values, it is still worth it to repeat the special casing
+    // here. This is probably because if we manage to actually call mpn_gcd_1() here,
+    // we avoid interacting with dynamically allocated memory below in the thread-local
+    // object. If we ever start using mpn_gcd(), we will probably have to re-do a
+    // performance analysis.
+    //
+    // Handle zeroes.
+    if (!asize1) {
+        // NOTE: we want the result to be positive, and to copy only the set limbs.
+        rop._mp_size = asize2;
+        copy_limbs(op2.m_limbs.data(), op2.m_limbs.data() + asize2, rop.m_limbs.data());
+        return;
+    }
+    if (!asize2) {
+        rop._mp_size = asize1;
+        copy_limbs(op1.m_limbs.data(), op1.m_limbs.data() + asize1, rop.m_limbs.data());
+        return;
+    }
+    // Special casing if an operand has asize 1.
+    if (asize1 == 1) {
+        rop._mp_size = 1;
+        rop.m_limbs[0] = ::mpn_gcd_1(op2.m_limbs.data(), static_cast<::mp_size_t>(asize2), op1.m_limbs[0]);
+        return;
+    }
+    if (asize2 == 1) {
+        rop._mp_size = 1;
+        rop.m_limbs[0] = ::mpn_gcd_1(op1.m_limbs.data(), static_cast<::mp_size_t>(asize1), op2.m_limbs[0]);
+        return;
+    }
+    // Two 2-limb operands: binary GCD, which avoids the thread-local mpz below.
+    if (!GMP_NAIL_BITS && asize1 == 2 && asize2 == 2) {
+        ::mp_limb_t g0 = op1.m_limbs[0], g1 = op1.m_limbs[1];
+        integer_binary_gcd_2(g0, g1, op2.m_limbs[0], op2.m_limbs[1]);
+        rop._mp_size = size_from_lohi(g0, g1);
+        rop.m_limbs[0] = g0;
+        rop.m_limbs[1] = g1;
+        return;
+    }
+    // General case, via mpz.
+    // NOTE: there is an mpn_gcd() function, but it seems difficult to use. Apparently, and contrary to
+    // what stated in the latest documentation, the mpn function requires odd operands and bit size
+    // (not only limb size!) of the second operand not greater than the first. See for instance the old
+    // documentation:
+    // ftp://ftp.gnu.org/old-gnu/Manuals/gmp-3.1.1/html_chapter/gmp_9.html
+    // Indeed, compiling GMP in debug mode and then trying to use the mpn function without respecting the above
+    // results in assertion failures. For now let's keep it like this, the small operand cases are handled above
+    // via mpn_gcd_1() and the binary GCD.
+    MPPP_MAYBE_TLS mpz_raii tmp;
+    const auto v1 = op1.get_mpz_view();
+    const auto v2 = op2.get_mpz_view();
+    ::mpz_gcd(&tmp.m_mpz, &v1, &v2);
+    // Copy over.
+    rop._mp_size = tmp.m_mpz._mp_size;
+    assert(rop._mp_size > 0);
+    copy_limbs_no(tmp.m_mpz._mp_d, tmp.m_mpz._mp_d + rop._mp_size, rop.m_limbs.data());
+}
+
+// 1-limb optimization.
+inline void static_gcd_impl(static_int<1> &rop, const static_int<1> &op1, const static_int<1> &op2, mpz_size_t asize1,
+                            mpz_size_t asize2)
+{
+    // Handle the special cases first.
+    if (asize1 == 0) {
+        // gcd(0, n) = abs(n). This also covers the convention
+        // that gcd(0, 0) = 0.
+        // NOTE: don't use the copy assignment operator of static_int,
+        // as the size needs to be set to positive.
+        rop._mp_size = asize2;
+        rop.m_limbs = op2.m_limbs;
+        return;
+    }
+    if (asize2 == 0) {
+        // gcd(n, 0) = abs(n).
+        // NOTE: op1 is not zero, its size can only be 1.
+        rop._mp_size = 1;
+        rop.m_limbs = op1.m_limbs;
+        return;
+    }
+    // At this point, asize1 == asize2 == 1, and the result
+    // will also have size 1.
+    rop._mp_size = 1;
+    // Compute the limb value.
+    // NOTE: as an alternative, here we could have a custom binary GCD. See for
+    // instance this implementation by Howard Hinnant using compiler intrinsics:
+    // https://groups.google.com/a/isocpp.org/forum/#!topic/std-proposals/8WB2Z9d7A0w
+    // Testing however shows that mpn_gcd_1() is quite well optimised, so let's
+    // use it and keep in mind the option about the binary GCD for the future.
+    // NOTE: at the commit c146af86e416cf1348d0b3fc454600b47b523f4f we have an implementation
+    // of the binary GCD, just in case.
+    // NOTE: currently, the binary GCD is faster on Zen processors, but I believe
+    // that is because the current GMP version does not have optimised GCD assembly for Zen.
+    // We need to benchmark again when the next GMP version comes out. If the binary GCD
+    // is still faster, we should consider using it instead of mpn_gcd_1(), as even on Intel
+    // processors the binary GCD is only marginally slower than mpn_gcd_1().
+    rop.m_limbs[0] = ::mpn_gcd_1(op1.m_limbs.data(), static_cast<::mp_size_t>(1), op2.m_limbs[0]);
 }
 
 template <std::size_t SSize>
@@ -7164,47 +8500,382 @@ inline integer<SSize> gcd(const integer<SSize> &op1, const integer<SSize> &op2)
     return retval;
 }
 
-/// Factorial.
-/**
- * This function will set \p rop to the factorial of \p n.
- *
- * @param rop the return value.
- * @param n the argument for the factorial.
- *
- * @return a reference to \p rop.
- *
- * @throws std::invalid_argument if \p n is larger than an implementation-defined limit.
- */
-template <std::size_t SSize>
-inline integer<SSize> &fac_ui(integer<SSize> &rop, unsigned long n)
+namespace detail
 {
-    // NOTE: we put a limit here because the GMP function just crashes and burns
-    // if n is too large, and n does not even need to be that large.
-    constexpr auto max_fac = 1000000ull;
-    if (mppp_unlikely(n > max_fac)) {
-        throw std::invalid_argument(
-            "The value " + detail::to_string(n)
-            + " is too large to be used as input for the factorial function (the maximum allowed value is "
-            + detail::to_string(max_fac) + ")");
+
+// Extended Euclidean algorithm on the 1-limb values r0 and r1, with r1 nonzero. On output, r0
+// will contain gcd(r0, r1), s0 and t0 the absolute values of the cofactors of the original r0 and r1.
+// The signs of the cofactors alternate: the return value is true if the cofactor of r0
+// is nonpositive and the cofactor of r1 nonnegative, false otherwise.
+// NOTE: the cofactors computed by the classical algorithm satisfy abs(s0) <= r1 / (2 * g) and
+// abs(t0) <= r0 / (2 * g), and they coincide with the cofactors computed by mpz_gcdext().
+inline bool integer_gcdext_1(::mp_limb_t &r0, ::mp_limb_t r1, ::mp_limb_t &s0, ::mp_limb_t &t0)
+{
+    assert(r1 != 0u);
+    ::mp_limb_t s1 = 0, t1 = 1;
+    s0 = 1;
+    t0 = 0;
+    bool odd = false;
+    while (r1 != 0u) {
+        // NOTE: testing indicates that special-casing small quotients (which are
+        // the most common) does not pay off here, as the branches are hard to predict.
+        const ::mp_limb_t q = r0 / r1, r2 = r0 - q * r1;
+        // NOTE: the cofactors are bounded by the original operands,
+        // hence these computations cannot overflow.
+        const ::mp_limb_t s2 = s0 + q * s1, t2 = t0 + q * t1;
+        r0 = r1;
+        r1 = r2;
+        s0 = s1;
+        s1 = s2;
+        t0 = t1;
+        t1 = t2;
+        odd = !odd;
+    }
+    return odd;
+}
+
+// Division with remainder of zero-padded 2-limb values.
+inline void integer_gcdext_divrem_2(std::array<::mp_limb_t, 2> &q, std::array<::mp_limb_t, 2> &r,
+                                    const std::array<::mp_limb_t, 2> &n, const std::array<::mp_limb_t, 2> &d)
+{
+#if (defined(MPPP_HAVE_GCC_INT128) && (GMP_NUMB_BITS == 64) && !GMP_NAIL_BITS)                                        \
+    || (GMP_NUMB_BITS == 32 && !GMP_NAIL_BITS)
+    dlimb_tdiv_qr(n[0], n[1], d[0], d[1], &q[0], &q[1], &r[0], &r[1]);
+#else
+    // NOTE: mpn_tdiv_qr() requires the top limb of the divisor to be nonzero.
+    const auto dn = static_cast<::mp_size_t>(d[1] ? 2 : 1);
+    q = std::array<::mp_limb_t, 2>{};
+    r = std::array<::mp_limb_t, 2>{};
+    ::mpn_tdiv_qr(q.data(), r.data(), 0, n.data(), 2, d.data(), dn);
+#endif
+}
+
+// 2-limb counterpart of integer_gcdext_1(). Requires r0 >= r1 > 0.
+// NOTE: this requires no nail bits.
+inline bool integer_gcdext_2(std::array<::mp_limb_t, 2> &r0, std::array<::mp_limb_t, 2> r1,
+                             std::array<::mp_limb_t, 2> &s0, std::array<::mp_limb_t, 2> &t0)
+{
+    assert(integer_compare_limbs_n(r0, r1) >= 0);
+    std::array<::mp_limb_t, 2> s1{}, t1{{1u, 0u}}, q, r2, tmp;
+    s0 = std::array<::mp_limb_t, 2>{{1u, 0u}};
+    t0 = std::array<::mp_limb_t, 2>{};
+    bool odd = false;
+    while (r1[0] != 0u || r1[1] != 0u) {
+        if (r0[1] == 0u) {
+            // Both r0 and r1 fit in a single limb, use the native division.
+            q = std::array<::mp_limb_t, 2>{{r0[0] / r1[0], 0u}};
+            r2 = std::array<::mp_limb_t, 2>{{r0[0] % r1[0], 0u}};
+        } else {
+            // NOTE: the 2-limb division is expensive, try the unitary quotient first.
+            integer_sub_limbs_n(r2, r0, r1);
+            if (integer_compare_limbs_n(r2, r1) < 0) {
+                q = std::array<::mp_limb_t, 2>{{1u, 0u}};
+            } else {
+                integer_gcdext_divrem_2(q, r2, r0, r1);
+            }
+        }
+        // NOTE: the products q * s1 and q * t1 are bounded by the original
+        // operands, hence the truncated 2-limb multiplications are exact.
+        integer_mul_limbs_n(tmp, q, s1);
+        integer_add_limbs_n(tmp, tmp, s0);
+        s0 = s1;
+        s1 = tmp;
+        integer_mul_limbs_n(tmp, q, t1);
+        integer_add_limbs_n(tmp, tmp, t0);
+        t0 = t1;
+        t1 = tmp;
+        r0 = r1;
+        r1 = r2;
+        odd = !odd;
     }
-    // NOTE: let's get through a static temporary and then assign it to the rop,
-    // so that rop will be static/dynamic according to the size of tmp.
-    MPPP_MAYBE_TLS detail::mpz_raii tmp;
-    ::mpz_fac_ui(&tmp.m_mpz, n);
-    return rop = &tmp.m_mpz;
+    return odd;
 }
 
-/// Binomial coefficient (ternary version).
-/**
- * This function will set \p rop to the binomial coefficient of \p n and \p k. Negative values of \p n are
- * supported.
- *
- * @param rop the return value.
- * @param n the top argument.
- * @param k the bottom argument.
- *
- * @return a reference to \p rop.
- */
+// Write the zero-padded 2-limb value x with sign sign into rop.
+template <std::size_t SSize>
+inline void integer_static_set_limbs_2(static_int<SSize> &rop, const std::array<::mp_limb_t, 2> &x, int sign)
+{
+    rop._mp_size = sign * size_from_lohi(x[0], x[1]);
+    rop.m_limbs[0] = x[0];
+    if (SSize > 1u) {
+        rop.m_limbs[1] = x[1];
+        rop.zero_upper_limbs(2);
+    } else {
+        assert(x[1] == 0u);
+    }
+}
+
+// Selection of the algorithm for static extended GCD:
+// - for 1 limb, the extended Euclidean algorithm with native divisions,
+// - if the double-limb multiplication is available, the 2-limb
+//   extended Euclidean algorithm for operands with up to 2 limbs,
+// - otherwise, use the mpz function.
+template <typename SInt>
+using integer_static_gcdext_algo
+    = std::integral_constant<int, SInt::s_size == 1 ? 1 : (integer_have_dlimb_mul::value ? 2 : 0)>;
+
+// Static extended GCD. On output, g will contain the GCD, s and t the absolute values
+// of the cofactors and sign_s and sign_t their signs. The return value is false if the
+// operands are too large for the static implementation.
+// NOTE: the special cases (zero operands) are handled in static_gcdext().
+template <std::size_t SSize>
+inline bool static_gcdext_impl(std::array<::mp_limb_t, 2> &, std::array<::mp_limb_t, 2> &,
+                               std::array<::mp_limb_t, 2> &, int &, int &, const static_int<SSize> &,
+                               const static_int<SSize> &, mpz_size_t, mpz_size_t, const std::integral_constant<int, 0> &)
+{
+    return false;
+}
+
+template <std::size_t SSize>
+inline bool static_gcdext_impl(std::array<::mp_limb_t, 2> &g, std::array<::mp_limb_t, 2> &s,
+                               std::array<::mp_limb_t, 2> &t, int &sign_s, int &sign_t, const static_int<SSize> &a,
+                               const static_int<SSize> &b, mpz_size_t asize1, mpz_size_t asize2,
+                               const std::integral_constant<int, 1> &)
+{
+    if (asize1 > 1 || asize2 > 1) {
+        return false;
+    }
+    g = std::array<::mp_limb_t, 2>{{a.m_limbs[0], 0u}};
+    s[1] = 0u;
+    t[1] = 0u;
+    const bool odd = integer_gcdext_1(g[0], b.m_limbs[0], s[0], t[0]);
+    sign_s = odd ? -1 : 1;
+    sign_t = -sign_s;
+    return true;
+}
+
+template <std::size_t SSize>
+inline bool static_gcdext_impl(std::array<::mp_limb_t, 2> &g, std::array<::mp_limb_t, 2> &s,
+                               std::array<::mp_limb_t, 2> &t, int &sign_s, int &sign_t, const static_int<SSize> &a,
+                               const static_int<SSize> &b, mpz_size_t asize1, mpz_size_t asize2,
+                               const std::integral_constant<int, 2> &)
+{
+    if (asize1 > 2 || asize2 > 2) {
+        return false;
+    }
+    if (asize1 == 1 && asize2 == 1) {
+        return static_gcdext_impl(g, s, t, sign_s, sign_t, a, b, asize1, asize2, std::integral_constant<int, 1>{});
+    }
+    // NOTE: with more than 2 static limbs, the limbs above the
+    // size are not guaranteed to be zero, don't read them.
+    std::array<::mp_limb_t, 2> x{{a.m_limbs[0], asize1 == 2 ? a.m_limbs[1] : ::mp_limb_t(0)}},
+        y{{b.m_limbs[0], asize2 == 2 ? b.m_limbs[1] : ::mp_limb_t(0)}};
+    // The 2-limb core requires the first operand not to be less than the second.
+    const bool swapped = integer_compare_limbs_n(x, y) < 0;
+    if (swapped) {
+        std::swap(x, y);
+    }
+    const bool odd = integer_gcdext_2(x, y, s, t);
+    g = x;
+    sign_s = odd ? -1 : 1;
+    sign_t = -sign_s;
+    if (swapped) {
+        std::swap(s, t);
+        std::swap(sign_s, sign_t);
+    }
+    return true;
+}
+
+// NOTE: these return false if the mpz fallback needs to be used, and
+// they write the output only if they return true.
+template <std::size_t SSize>
+inline bool static_gcdext(static_int<SSize> &g, static_int<SSize> &s, static_int<SSize> &t,
+                          const static_int<SSize> &a, const static_int<SSize> &b)
+{
+    const mpz_size_t asize1 = std::abs(a._mp_size), asize2 = std::abs(b._mp_size);
+    const int sign1 = integral_sign(a._mp_size), sign2 = integral_sign(b._mp_size);
+    // Handle the special cases first, following the conventions of mpz_gcdext():
+    // gcdext(0, b) = (abs(b), 0, sgn(b)), gcdext(a, 0) = (abs(a), sgn(a), 0).
+    if (asize1 == 0 || asize2 == 0) {
+        // NOTE: copy the inputs before writing, as g, s and t may overlap a and b.
+        const auto &nz = asize1 == 0 ? b : a;
+        const int sign_nz = asize1 == 0 ? sign2 : sign1;
+        auto &cof_nz = asize1 == 0 ? t : s;
+        auto &cof_z = asize1 == 0 ? s : t;
+        if (&g != &nz) {
+            g = nz;
+        }
+        g._mp_size = std::abs(g._mp_size);
+        cof_z._mp_size = 0;
+        cof_z.zero_upper_limbs(0);
+        // NOTE: if both operands are zero, sign_nz is zero and
+        // all the outputs are set to zero.
+        cof_nz._mp_size = sign_nz;
+        cof_nz.m_limbs[0] = static_cast<::mp_limb_t>(sign_nz != 0);
+        cof_nz.zero_upper_limbs(1);
+        return true;
+    }
+    std::array<::mp_limb_t, 2> g_, s_, t_;
+    int sign_s, sign_t;
+    if (!static_gcdext_impl(g_, s_, t_, sign_s, sign_t, a, b, asize1, asize2,
+                            integer_static_gcdext_algo<static_int<SSize>>{})) {
+        return false;
+    }
+    integer_static_set_limbs_2(g, g_, 1);
+    integer_static_set_limbs_2(s, s_, sign_s * sign1);
+    integer_static_set_limbs_2(t, t_, sign_t * sign2);
+    return true;
+}
+
+// Static modular inverse. Requires a nonzero mod. The return value is false if the operands are too
+// large for the static implementation, otherwise inv will be set to whether the inverse exists.
+template <std::size_t SSize>
+inline bool static_invert(static_int<SSize> &rop, bool &inv, const static_int<SSize> &op,
+                          const static_int<SSize> &mod)
+{
+    const mpz_size_t asize1 = std::abs(op._mp_size), asize2 = std::abs(mod._mp_size);
+    assert(asize2 != 0);
+    const int sign1 = integral_sign(op._mp_size);
+    if (asize1 == 0) {
+        // The inverse of zero exists only modulo 1, and it is zero.
+        inv = asize2 == 1 && mod.m_limbs[0] == 1u;
+        if (inv) {
+            rop._mp_size = 0;
+            rop.zero_upper_limbs(0);
+        }
+        return true;
+    }
+    std::array<::mp_limb_t, 2> g, s, t;
+    int sign_s, sign_t;
+    if (!static_gcdext_impl(g, s, t, sign_s, sign_t, op, mod, asize1, asize2,
+                            integer_static_gcdext_algo<static_int<SSize>>{})) {
+        return false;
+    }
+    inv = g[0] == 1u && g[1] == 0u;
+    if (!inv) {
+        return true;
+    }
+    // NOTE: the cofactor is less than abs(mod) in absolute value. If it is
+    // negative, bring it into the [0, abs(mod)) range.
+    if (sign_s * sign1 < 0 && (s[0] != 0u || s[1] != 0u)) {
+        const std::array<::mp_limb_t, 2> m{{mod.m_limbs[0], asize2 == 2 ? mod.m_limbs[1] : ::mp_limb_t(0)}};
+        integer_sub_limbs_n(s, m, s);
+    }
+    integer_static_set_limbs_2(rop, s, 1);
+    return true;
+}
+
+} // namespace detail
+
+#if !defined(MPPP_DOXYGEN_INVOKED)
+
+// Extended GCD.
+template <std::size_t SSize>
+inline void gcdext(integer<SSize> &g, integer<SSize> &s, integer<SSize> &t, const integer<SSize> &a,
+                   const integer<SSize> &b)
+{
+    if (mppp_unlikely(&g == &s || &g == &t || &s == &t)) {
+        throw std::invalid_argument("When computing the extended GCD, the return values 'g', 's' and 't' "
+                                    "must be distinct objects");
+    }
+    if (mppp_likely(a.is_static() && b.is_static())) {
+        // NOTE: if g, s or t are dynamic, they cannot overlap with the static operands.
+        if (!g.is_static()) {
+            g.set_zero();
+        }
+        if (!s.is_static()) {
+            s.set_zero();
+        }
+        if (!t.is_static()) {
+            t.set_zero();
+        }
+        if (mppp_likely(detail::static_gcdext(g._get_union().g_st(), s._get_union().g_st(), t._get_union().g_st(),
+                                              a._get_union().g_st(), b._get_union().g_st()))) {
+            return;
+        }
+    }
+    MPPP_MAYBE_TLS detail::mpz_raii g_, s_, t_;
+    ::mpz_gcdext(&g_.m_mpz, &s_.m_mpz, &t_.m_mpz, a.get_mpz_view(), b.get_mpz_view());
+    g = &g_.m_mpz;
+    s = &s_.m_mpz;
+    t = &t_.m_mpz;
+}
+
+// Ternary modular inverse.
+template <std::size_t SSize>
+inline integer<SSize> &invert(integer<SSize> &rop, const integer<SSize> &op, const integer<SSize> &mod)
+{
+    if (mppp_unlikely(mod.sgn() == 0)) {
+        throw zero_division_error("Integer division by zero");
+    }
+    bool inv = false;
+    if (mppp_likely(op.is_static() && mod.is_static())) {
+        // NOTE: compute into a temporary, so that rop is left untouched
+        // if the inverse does not exist.
+        detail::static_int<SSize> tmp;
+        if (mppp_likely(detail::static_invert(tmp, inv, op._get_union().g_st(), mod._get_union().g_st()))) {
+            if (mppp_likely(inv)) {
+                if (!rop.is_static()) {
+                    rop.set_zero();
+                }
+                rop._get_union().g_st() = tmp;
+                return rop;
+            }
+            throw zero_division_error("Cannot compute the inverse of " + op.to_string() + " modulo "
+                                      + mod.to_string());
+        }
+    }
+    MPPP_MAYBE_TLS detail::mpz_raii tmp;
+    if (mppp_unlikely(!::mpz_invert(&tmp.m_mpz, op.get_mpz_view(), mod.get_mpz_view()))) {
+        throw zero_division_error("Cannot compute the inverse of " + op.to_string() + " modulo "
+                                  + mod.to_string());
+    }
+    rop = &tmp.m_mpz;
+    return rop;
+}
+
+// Binary modular inverse.
+template <std::size_t SSize>
+inline integer<SSize> invert(const integer<SSize> &op, const integer<SSize> &mod)
+{
+    integer<SSize> retval;
+    invert(retval, op, mod);
+    return retval;
+}
+
+#endif
+
+/// Factorial.
+/**
+ * This function will set \p rop to the factorial of \p n.
+ *
+ * @param rop the return value.
+ * @param n the argument for the factorial.
+ *
+ * @return a reference to \p rop.
+ *
+ * @throws std::invalid_argument if \p n is larger than an implementation-defined limit.
+ */
+template <std::size_t SSize>
+inline integer<SSize> &fac_ui(integer<SSize> &rop, unsigned long n)
+{
+    // NOTE: we put a limit here because the GMP function just crashes and burns
+    // if n is too large, and n does not even need to be that large.
+    constexpr auto max_fac = 1000000ull;
+    if (mppp_unlikely(n > max_fac)) {
+        throw std::invalid_argument(
+            "The value " + detail::to_string(n)
+            + " is too large to be used as input for the factorial function (the maximum allowed value is "
+            + detail::to_string(max_fac) + ")");
+    }
+    // NOTE: let's get through a static temporary and then assign it to the rop,
+    // so that rop will be static/dynamic according to the size of tmp.
+    MPPP_MAYBE_TLS detail::mpz_raii tmp;
+    ::mpz_fac_ui(&tmp.m_mpz, n);
+    return rop = &tmp.m_mpz;
+}
+
+/// Binomial coefficient (ternary version).
+/**
+ * This function will set \p rop to the binomial coefficient of \p n and \p k. Negative values of \p n are
+ * supported.
+ *
+ * @param rop the return value.
+ * @param n the top argument.
+ * @param k the bottom argument.
+ *
+ * @return a reference to \p rop.
+ */
 template <std::size_t SSize>
 inline integer<SSize> &bin_ui(integer<SSize> &rop, const integer<SSize> &n, unsigned long k)
 {
@@ -7339,18 +9010,6 @@ inline detail::integer_common_t<T, U> binomial(const T &n, const U &k)
     return detail::binomial_impl(n, k);
 }
 
-namespace detail
-{
-
-template <std::size_t SSize>
-inline void nextprime_impl(integer<SSize> &rop, const integer<SSize> &n)
-{
-    MPPP_MAYBE_TLS mpz_raii tmp;
-    ::mpz_nextprime(&tmp.m_mpz, n.get_mpz_view());
-    rop = &tmp.m_mpz;
-}
-} // namespace detail
-
 /// Compute next prime number (binary version).
 /**
  * This function will set \p rop to the first prime number greater than \p n.
@@ -7451,93 +9110,1197 @@ inline bool integer_exp_is_odd(const T &exp)
     return (exp % T(2)) != T(0);
 }
 
-template <std::size_t SSize>
-inline bool integer_exp_is_odd(const integer<SSize> &exp)
+template <std::size_t SSize>
+inline bool integer_exp_is_odd(const integer<SSize> &exp)
+{
+    return exp.odd_p();
+}
+
+// Implementation of pow().
+// integer -- integral overload.
+template <typename T, std::size_t SSize,
+          enable_if_t<disjunction<std::is_same<T, integer<SSize>>, is_integral<T>>::value, int> = 0>
+inline integer<SSize> pow_impl(const integer<SSize> &base, const T &exp)
+{
+    integer<SSize> rop;
+    if (sgn(exp) >= 0) {
+        pow_ui(rop, base, integer_exp_to_ulong(exp));
+    } else if (mppp_unlikely(is_zero(base))) {
+        // 0**-n is a division by zero.
+        throw zero_division_error("Cannot raise zero to the negative power " + detail::to_string(exp));
+    } else if (base.is_one()) {
+        // 1**n == 1.
+        rop = 1;
+    } else if (base.is_negative_one()) {
+        if (integer_exp_is_odd(exp)) {
+            // 1**(-2n-1) == -1.
+            rop = -1;
+        } else {
+            // 1**(-2n) == 1.
+            rop = 1;
+        }
+    } else {
+        // m**-n == 1 / m**n == 0.
+        rop = 0;
+    }
+    return rop;
+}
+
+// C++ integral -- integer overload.
+template <typename T, std::size_t SSize, enable_if_t<is_integral<T>::value, int> = 0>
+inline integer<SSize> pow_impl(const T &base, const integer<SSize> &exp)
+{
+    return pow_impl(integer<SSize>{base}, exp);
+}
+
+// integer -- FP overload.
+template <typename T, std::size_t SSize, enable_if_t<std::is_floating_point<T>::value, int> = 0>
+inline T pow_impl(const integer<SSize> &base, const T &exp)
+{
+    return std::pow(static_cast<T>(base), exp);
+}
+
+// FP -- integer overload.
+template <typename T, std::size_t SSize, enable_if_t<std::is_floating_point<T>::value, int> = 0>
+inline T pow_impl(const T &base, const integer<SSize> &exp)
+{
+    return std::pow(base, static_cast<T>(exp));
+}
+} // namespace detail
+
+/// Generic binary exponentiation for \link mppp::integer integer\endlink.
+/**
+ * \rststar
+ * This function will raise ``base`` to the power ``exp``, and return the result. If one of the arguments
+ * is a floating-point value, then the result will be computed via ``std::pow()`` and it will also be a
+ * floating-point value. Otherwise, the result will be an :cpp:class:`~mppp::integer`.
+ * In case of a negative integral exponent and integral base, the result will be zero unless
+ * the absolute value of ``base`` is 1.
+ * \endrststar
+ *
+ * @param base the base.
+ * @param exp the exponent.
+ *
+ * @return <tt>base**exp</tt>.
+ *
+ * @throws std::overflow_error if \p base and \p exp are integrals and \p exp is non-negative and outside the range
+ * of <tt>unsigned long</tt>.
+ * @throws zero_division_error if \p base and \p exp are integrals and \p base is zero and \p exp is negative.
+ */
+#if defined(MPPP_HAVE_CONCEPTS)
+template <typename T, typename U>
+requires IntegerOpTypes<T, U> inline auto pow(const T &base, const U &exp)
+#else
+template <typename T, typename U>
+inline detail::integer_common_t<T, U> pow(const T &base, const U &exp)
+#endif
+{
+    return detail::pow_impl(base, exp);
+}
+
+namespace detail
+{
+
+// Montgomery arithmetic. The Montgomery representation of x modulo
+// an odd n with N limbs is x * R mod n, with R = 2**(N * GMP_NUMB_BITS).
+// NOTE: all these functions require the double-limb multiplication primitives.
+
+// Compute -n**-1 mod 2**GMP_NUMB_BITS for an odd n.
+inline ::mp_limb_t integer_mont_ninv(::mp_limb_t n)
+{
+    assert(n & 1u);
+    // Newton iteration: n * n == 1 mod 8 for odd n, so we start with 3 correct bits
+    // and the number of correct bits doubles at each step.
+    ::mp_limb_t x = n;
+    for (unsigned nbits = 3; nbits < unsigned(GMP_NUMB_BITS); nbits *= 2u) {
+        x *= 2u - n * x;
+    }
+    assert(x * n == 1u);
+    return ::mp_limb_t(0) - x;
+}
+
+// Compute t + a * b + cy, writing the low limb into rop and returning the high limb.
+// NOTE: the result always fits in a double limb.
+inline ::mp_limb_t integer_limb_muladd(::mp_limb_t *rop, ::mp_limb_t t, ::mp_limb_t a, ::mp_limb_t b, ::mp_limb_t cy)
+{
+    ::mp_limb_t hi, tmp;
+    const ::mp_limb_t lo = dlimb_mul(a, b, &hi), cy1 = limb_add_overflow(lo, t, &tmp),
+                      cy2 = limb_add_overflow(tmp, cy, rop);
+    return hi + cy1 + cy2;
+}
+
+// Montgomery multiplication (CIOS variant): rop = a * b * R**-1 mod n.
+// a and b must be in the [0, n) range, the result will also be in the [0, n) range.
+// Overlap between rop and a/b is allowed.
+template <std::size_t N>
+inline void integer_mont_mul(std::array<::mp_limb_t, N> &rop, const std::array<::mp_limb_t, N> &a,
+                             const std::array<::mp_limb_t, N> &b, const std::array<::mp_limb_t, N> &n,
+                             ::mp_limb_t ninv)
+{
+    // The accumulator, with two extra limbs.
+    std::array<::mp_limb_t, N + 2u> t{};
+    for (std::size_t i = 0; i < N; ++i) {
+        // t += a * b[i].
+        ::mp_limb_t cy = 0;
+        for (std::size_t j = 0; j < N; ++j) {
+            cy = integer_limb_muladd(&t[j], t[j], a[j], b[i], cy);
+        }
+        t[N + 1u] = limb_add_overflow(t[N], cy, &t[N]);
+        // t = (t + m * n) / 2**GMP_NUMB_BITS, where m is chosen
+        // so that the lowest limb of t + m * n is zero.
+        const ::mp_limb_t m = t[0] * ninv;
+        ::mp_limb_t lo;
+        cy = integer_limb_muladd(&lo, t[0], m, n[0], 0);
+        assert(lo == 0u);
+        for (std::size_t j = 1; j < N; ++j) {
+            cy = integer_limb_muladd(&t[j - 1u], t[j], m, n[j], cy);
+        }
+        const auto cy_top = limb_add_overflow(t[N], cy, &t[N - 1u]);
+        t[N] = t[N + 1u] + cy_top;
+    }
+    // Now t is in the [0, 2 * n) range: compute t - n, and select
+    // it without branching if there's no borrow out of the top limb.
+    std::array<::mp_limb_t, N> d;
+    ::mp_limb_t br = 0;
+    for (std::size_t j = 0; j < N; ++j) {
+        const auto tmp = t[j] - n[j];
+        const auto br1 = static_cast<::mp_limb_t>(t[j] < n[j]), br2 = static_cast<::mp_limb_t>(tmp < br);
+        d[j] = tmp - br;
+        br = br1 | br2;
+    }
+    // NOTE: mask is all ones if t < n, zero otherwise.
+    const auto mask = ::mp_limb_t(0) - (br & ~t[N]);
+    for (std::size_t j = 0; j < N; ++j) {
+        rop[j] = (t[j] & mask) | (d[j] & ~mask);
+    }
+}
+
+// Specialisation for 1-limb moduli.
+inline void integer_mont_mul(std::array<::mp_limb_t, 1> &rop, const std::array<::mp_limb_t, 1> &a,
+                             const std::array<::mp_limb_t, 1> &b, const std::array<::mp_limb_t, 1> &n,
+                             ::mp_limb_t ninv)
+{
+    ::mp_limb_t hi, mhi;
+    const auto lo = dlimb_mul(a[0], b[0], &hi);
+    // NOTE: the low limb of lo + m * n is zero by construction,
+    // hence the carry out of the low limb is 1 iff lo is nonzero.
+    dlimb_mul(lo * ninv, n[0], &mhi);
+    // The result is hi + x, with x = mhi + (lo != 0) <= n and hi < n. Compute
+    // it as hi - (n - x), adding back n if that underflows, so that
+    // there's no need to deal with the carry out of hi + x.
+    const auto y = n[0] - mhi - static_cast<::mp_limb_t>(lo != 0u), r = hi - y;
+    rop[0] = hi < y ? r + n[0] : r;
+}
+
+// Read the bit at index idx in the limb array ptr.
+inline ::mp_limb_t integer_limbs_tstbit(const ::mp_limb_t *ptr, std::size_t idx)
+{
+    return (ptr[idx / unsigned(GMP_NUMB_BITS)] >> (idx % unsigned(GMP_NUMB_BITS))) & 1u;
+}
+
+// Left-to-right fixed-window modular exponentiation. acc must be initialised
+// to the base, and exp must be positive. mul(rop, a, b) is the modular multiplication
+// primitive (e.g., the Montgomery multiplication), which must allow overlap
+// between rop and a/b.
+// NOTE: with the small moduli this is used for, the multiplications are cheap enough
+// that the unpredictable branching of a sliding window costs more than the
+// multiplications it saves.
+template <std::size_t N, typename F>
+inline void integer_powm_window(std::array<::mp_limb_t, N> &acc, const ::mp_limb_t *exp, std::size_t exp_asize,
+                                const F &mul)
+{
+    assert(exp_asize > 0u);
+    const auto nbits = (exp_asize - 1u) * unsigned(GMP_NUMB_BITS) + limb_size_nbits(exp[exp_asize - 1u]);
+    // Pick the window size so that the cost of the precomputation
+    // roughly balances the number of saved multiplications. For short
+    // exponents this degenerates to the plain square-and-multiply.
+    const unsigned wsize = nbits <= 8u ? 1u : (nbits <= 64u ? 3u : (nbits <= 256u ? 4u : 5u));
+    // Precompute the powers of the base, up to base**(2**wsize - 1).
+    // NOTE: table[0] is never used.
+    std::array<std::array<::mp_limb_t, N>, 32> table;
+    table[1] = acc;
+    for (std::size_t k = 2; k < (std::size_t(1) << wsize); ++k) {
+        mul(table[k], table[k - 1u], acc);
+    }
+    // Read the window of cnt bits starting from bit index lo.
+    const auto window = [exp](std::size_t lo, unsigned cnt) {
+        std::size_t val = 0;
+        for (auto k = lo + cnt; k > lo; --k) {
+            val = (val << 1) | static_cast<std::size_t>(integer_limbs_tstbit(exp, k - 1u));
+        }
+        return val;
+    };
+    // NOTE: the topmost window is shorter if nbits is not a multiple of wsize.
+    // It always contains the top bit of the exponent, so that acc never
+    // needs to be set to one.
+    const auto top = nbits % wsize == 0u ? wsize : static_cast<unsigned>(nbits % wsize);
+    auto i = nbits - top;
+    acc = table[window(i, top)];
+    while (i > 0u) {
+        i -= wsize;
+        for (unsigned k = 0; k < wsize; ++k) {
+            mul(acc, acc, acc);
+        }
+        const auto val = window(i, wsize);
+        if (val != 0u) {
+            mul(acc, acc, table[val]);
+        }
+    }
+}
+
+// Modular exponentiation via Montgomery arithmetic, for an odd
+// modulus with exactly N limbs and a positive exponent.
+template <std::size_t N, std::size_t SSize>
+inline void static_powm_mont(static_int<SSize> &rop, const static_int<SSize> &base, const static_int<SSize> &exp,
+                             const static_int<SSize> &mod)
+{
+    const auto asizeb = static_cast<std::size_t>(std::abs(base._mp_size)),
+               asizee = static_cast<std::size_t>(exp._mp_size);
+    assert(static_cast<std::size_t>(std::abs(mod._mp_size)) == N);
+    assert(asizee > 0u);
+    if (asizeb == 0u) {
+        // 0**n == 0 for n > 0.
+        rop._mp_size = 0;
+        rop.zero_upper_limbs(0);
+        return;
+    }
+    std::array<::mp_limb_t, N> n;
+    copy_limbs_no(mod.m_limbs.data(), mod.m_limbs.data() + N, n.data());
+    const auto ninv = integer_mont_ninv(n[0]);
+    // Compute the Montgomery representation of abs(base), that is,
+    // abs(base) * R mod n. This also takes care of reducing
+    // base modulo n.
+    std::array<::mp_limb_t, SSize + N> num, q;
+    std::fill(num.begin(), num.begin() + N, ::mp_limb_t(0));
+    copy_limbs_no(base.m_limbs.data(), base.m_limbs.data() + asizeb, num.data() + N);
+    std::array<::mp_limb_t, N> acc;
+    ::mpn_tdiv_qr(q.data(), acc.data(), 0, num.data(), static_cast<::mp_size_t>(asizeb + N), n.data(),
+                  static_cast<::mp_size_t>(N));
+    // Exponentiate.
+    integer_powm_window(acc, exp.m_limbs.data(), asizee,
+                        [&n, ninv](std::array<::mp_limb_t, N> &r, const std::array<::mp_limb_t, N> &a,
+                                   const std::array<::mp_limb_t, N> &b) { integer_mont_mul(r, a, b, n, ninv); });
+    // Convert out of the Montgomery representation.
+    std::array<::mp_limb_t, N> one{};
+    one[0] = 1u;
+    integer_mont_mul(acc, acc, one, n, ninv);
+    auto res_size = integer_sub_compute_size(acc.data(), static_cast<mpz_size_t>(N));
+    if (base._mp_size < 0 && (exp.m_limbs[0] & 1u) && res_size) {
+        // Negative base and odd exponent: the result is n - abs(base)**exp mod n.
+        integer_sub_limbs_n(acc, n, acc);
+        res_size = integer_sub_compute_size(acc.data(), static_cast<mpz_size_t>(N));
+    }
+    // Write out the result.
+    rop._mp_size = res_size;
+    copy_limbs_no(acc.data(), acc.data() + N, rop.m_limbs.data());
+    rop.zero_upper_limbs(N);
+}
+
+// Selection of the algorithm for static modular exponentiation:
+// - if the double-limb multiplication is available, use Montgomery
+//   arithmetic for odd moduli with 1 or 2 limbs,
+// - otherwise, use the mpz function.
+template <typename SInt>
+using integer_static_powm_algo = std::integral_constant<
+    int, integer_have_dlimb_mul::value ? (SInt::s_size == 1 ? 1 : 2) : 0>;
+
+// NOTE: these functions return true if the computation was performed, false
+// if the mpz fallback needs to be used. They require a positive exponent and a nonzero mod.
+template <std::size_t SSize>
+inline bool static_powm(static_int<SSize> &, const static_int<SSize> &, const static_int<SSize> &,
+                        const static_int<SSize> &, const std::integral_constant<int, 0> &)
+{
+    return false;
+}
+
+// 1-limb modulus.
+template <std::size_t SSize>
+inline bool static_powm(static_int<SSize> &rop, const static_int<SSize> &base, const static_int<SSize> &exp,
+                        const static_int<SSize> &mod, const std::integral_constant<int, 1> &)
+{
+    if (mppp_likely(mod.m_limbs[0] & 1u)) {
+        static_powm_mont<1>(rop, base, exp, mod);
+        return true;
+    }
+    return false;
+}
+
+// 1-limb or 2-limb modulus.
+template <std::size_t SSize>
+inline bool static_powm(static_int<SSize> &rop, const static_int<SSize> &base, const static_int<SSize> &exp,
+                        const static_int<SSize> &mod, const std::integral_constant<int, 2> &)
+{
+    if (mppp_unlikely(!(mod.m_limbs[0] & 1u))) {
+        return false;
+    }
+    switch (std::abs(mod._mp_size)) {
+        case 1:
+            static_powm_mont<1>(rop, base, exp, mod);
+            return true;
+        case 2:
+            static_powm_mont<2>(rop, base, exp, mod);
+            return true;
+        default:
+            return false;
+    }
+}
+
+template <std::size_t SSize>
+inline void powm_impl(integer<SSize> &rop, const integer<SSize> &base, const integer<SSize> &exp,
+                      const integer<SSize> &mod)
+{
+    if (mppp_unlikely(mod.sgn() == 0)) {
+        throw zero_division_error("Integer division by zero");
+    }
+    const int exp_sign = exp.sgn();
+    if (mppp_likely(exp_sign > 0 && base.is_static() && mod.is_static() && exp.is_static())) {
+        // NOTE: if rop is dynamic, it cannot overlap with the static operands.
+        if (!rop.is_static()) {
+            rop.set_zero();
+        }
+        if (mppp_likely(static_powm(rop._get_union().g_st(), base._get_union().g_st(), exp._get_union().g_st(),
+                                    mod._get_union().g_st(), integer_static_powm_algo<static_int<SSize>>{}))) {
+            return;
+        }
+    }
+    // NOTE: go through a temporary, and then assign it to rop, so that
+    // rop will be static whenever the result fits in static storage
+    // (which is always the case if mod is static).
+    MPPP_MAYBE_TLS mpz_raii tmp;
+    if (exp_sign < 0) {
+        // NOTE: GMP supports negative exponents if the inverse of base
+        // exists, but it raises a division by zero if it does not. Check
+        // it beforehand and throw a proper exception instead.
+        if (mppp_unlikely(!::mpz_invert(&tmp.m_mpz, base.get_mpz_view(), mod.get_mpz_view()))) {
+            throw zero_division_error("Cannot raise " + base.to_string() + " to the negative power "
+                                      + exp.to_string() + " modulo " + mod.to_string()
+                                      + ": the base is not invertible");
+        }
+        MPPP_MAYBE_TLS mpz_raii nexp;
+        ::mpz_neg(&nexp.m_mpz, exp.get_mpz_view());
+        ::mpz_powm(&tmp.m_mpz, &tmp.m_mpz, &nexp.m_mpz, mod.get_mpz_view());
+    } else {
+        ::mpz_powm(&tmp.m_mpz, base.get_mpz_view(), exp.get_mpz_view(), mod.get_mpz_view());
+    }
+    rop = &tmp.m_mpz;
+}
+
+// Primality testing for values with 1 or 2 limbs, via Miller-Rabin and
+// strong Lucas tests in Montgomery arithmetic.
+// NOTE: all these functions require the double-limb multiplication primitives.
+
+// Modular addition and subtraction: rop = a +- b mod n, with a and b in the [0, n) range.
+// NOTE: these are valid both for the standard and the Montgomery representation.
+template <std::size_t N>
+inline void integer_mod_add(std::array<::mp_limb_t, N> &rop, const std::array<::mp_limb_t, N> &a,
+                            const std::array<::mp_limb_t, N> &b, const std::array<::mp_limb_t, N> &n)
+{
+    // NOTE: compute a - (n - b), so that there's no need to deal
+    // with the carry out of a + b.
+    std::array<::mp_limb_t, N> t;
+    integer_sub_limbs_n(t, n, b);
+    if (integer_compare_limbs_n(a, t) >= 0) {
+        integer_sub_limbs_n(rop, a, t);
+    } else {
+        integer_add_limbs_n(rop, a, b);
+    }
+}
+
+template <std::size_t N>
+inline void integer_mod_sub(std::array<::mp_limb_t, N> &rop, const std::array<::mp_limb_t, N> &a,
+                            const std::array<::mp_limb_t, N> &b, const std::array<::mp_limb_t, N> &n)
+{
+    if (integer_compare_limbs_n(a, b) >= 0) {
+        integer_sub_limbs_n(rop, a, b);
+    } else {
+        std::array<::mp_limb_t, N> t;
+        integer_sub_limbs_n(t, n, b);
+        integer_add_limbs_n(rop, a, t);
+    }
+}
+
+// Modular halving: rop = a / 2 mod n, with a in the [0, n) range and n odd.
+template <std::size_t N>
+inline void integer_mod_half(std::array<::mp_limb_t, N> &rop, const std::array<::mp_limb_t, N> &a,
+                             const std::array<::mp_limb_t, N> &n)
+{
+    // NOTE: if a is odd, a + n is even.
+    std::array<::mp_limb_t, N> t = a;
+    const auto cy = (a[0] & 1u) ? integer_add_limbs_n(t, a, n) : ::mp_limb_t(0);
+    for (std::size_t i = 0; i + 1u < N; ++i) {
+        rop[i] = (t[i] >> 1) | (t[i + 1u] << (unsigned(GMP_NUMB_BITS) - 1u));
+    }
+    rop[N - 1u] = (t[N - 1u] >> 1) | (cy << (unsigned(GMP_NUMB_BITS) - 1u));
+}
+
+// Write the nonzero value x as d * 2**s, with d odd. d is written
+// into x, s is returned.
+template <std::size_t N>
+inline unsigned integer_split_odd(std::array<::mp_limb_t, N> &x)
+{
+    std::size_t i = 0;
+    while (x[i] == 0u) {
+        ++i;
+    }
+    const auto s = limb_ctz(x[i]);
+    for (std::size_t j = 0; j < N; ++j) {
+        const auto lo = j + i < N ? x[j + i] : ::mp_limb_t(0), hi = j + i + 1u < N ? x[j + i + 1u] : ::mp_limb_t(0);
+        x[j] = s != 0u ? (lo >> s) | (hi << (unsigned(GMP_NUMB_BITS) - s)) : lo;
+    }
+    return static_cast<unsigned>(i) * unsigned(GMP_NUMB_BITS) + s;
+}
+
+// Number of nonzero limbs in x.
+template <std::size_t N>
+inline std::size_t integer_limbs_n_size(const std::array<::mp_limb_t, N> &x)
+{
+    auto size = N;
+    while (size != 0u && x[size - 1u] == 0u) {
+        --size;
+    }
+    return size;
+}
+
+// Primality test for the odd value n with exactly N limbs. n must have been
+// checked beforehand for small prime factors via trial division (in particular,
+// n must be greater than 3 and not a multiple of 3). The return value follows
+// the conventions of mpz_probab_prime_p():
+// - if n has at most 64 bits, a Miller-Rabin test with the bases
+//   found by Jim Sinclair gives a definite answer,
+// - if n has at most 81 bits, a Miller-Rabin test with the first 13
+//   primes as bases gives a definite answer (Jiang and Deng, 2014),
+// - otherwise, a Baillie-PSW test (Miller-Rabin with base 2 followed by
+//   a strong Lucas test) is performed. No Baillie-PSW pseudoprime is known,
+//   hence the result is reported as probably prime.
+template <std::size_t N>
+inline int integer_mont_prime_p(const std::array<::mp_limb_t, N> &n)
+{
+    using arr_t = std::array<::mp_limb_t, N>;
+    assert(n[0] & 1u);
+    assert(n[N - 1u] != 0u);
+    const auto ninv = integer_mont_ninv(n[0]);
+    const auto mul = [&n, ninv](arr_t &r, const arr_t &a, const arr_t &b) { integer_mont_mul(r, a, b, n, ninv); };
+    // Compute R**2 mod n, which is used to convert into the Montgomery representation.
+    std::array<::mp_limb_t, 2u * N + 1u> num{};
+    std::array<::mp_limb_t, N + 2u> q;
+    num[2u * N] = 1u;
+    arr_t r2;
+    ::mpn_tdiv_qr(q.data(), r2.data(), 0, num.data(), static_cast<::mp_size_t>(2u * N + 1u), n.data(),
+                  static_cast<::mp_size_t>(N));
+    // Montgomery representation of the small integer value x, with abs(x) < n.
+    const auto to_mont = [&mul, &r2, &n](arr_t &rop, long x) {
+        arr_t tmp{};
+        tmp[0] = static_cast<::mp_limb_t>(x < 0 ? -static_cast<unsigned long>(x) : static_cast<unsigned long>(x));
+        mul(rop, tmp, r2);
+        if (x < 0 && integer_limbs_n_size(rop) != 0u) {
+            integer_sub_limbs_n(rop, n, rop);
+        }
+    };
+    arr_t one, mone, zero{};
+    to_mont(one, 1);
+    integer_sub_limbs_n(mone, n, one);
+    // n - 1 = d * 2**s.
+    arr_t d = n;
+    d[0] ^= 1u;
+    const auto s = integer_split_odd(d);
+    const auto d_size = integer_limbs_n_size(d);
+    // Miller-Rabin test with base b.
+    const auto mr_test = [&](unsigned long b) -> bool {
+        arr_t x{};
+        x[0] = b;
+        if (N == 1u && x[0] >= n[0]) {
+            x[0] %= n[0];
+            if (x[0] == 0u) {
+                // NOTE: bases multiple of n are skipped.
+                return true;
+            }
+        }
+        mul(x, x, r2);
+        integer_powm_window(x, d.data(), d_size, mul);
+        if (x == one || x == mone) {
+            return true;
+        }
+        for (unsigned i = 1; i < s; ++i) {
+            mul(x, x, x);
+            if (x == mone) {
+                return true;
+            }
+            if (x == one) {
+                return false;
+            }
+        }
+        return false;
+    };
+    const auto nbits = (N - 1u) * unsigned(GMP_NUMB_BITS) + limb_size_nbits(n[N - 1u]);
+    if (nbits <= 64u) {
+        for (auto b : {2ul, 325ul, 9375ul, 28178ul, 450775ul, 9780504ul, 1795265022ul}) {
+            if (!mr_test(b)) {
+                return 0;
+            }
+        }
+        return 2;
+    }
+    if (nbits <= 81u) {
+        for (auto b : {2ul, 3ul, 5ul, 7ul, 11ul, 13ul, 17ul, 19ul, 23ul, 29ul, 31ul, 37ul, 41ul}) {
+            if (!mr_test(b)) {
+                return 0;
+            }
+        }
+        return 2;
+    }
+    if (!mr_test(2)) {
+        return 0;
+    }
+    // Strong Lucas test, with the parameters P = 1 and Q = (1 - D) / 4,
+    // where D is the first element of the sequence 5, -7, 9, -11, ...
+    // for which the Jacobi symbol (D/n) is -1 (Selfridge's method A).
+    const mpz_struct_t n_view{static_cast<mpz_alloc_t>(N), static_cast<mpz_size_t>(N),
+                              const_cast<::mp_limb_t *>(n.data())};
+    long D = 5;
+    while (true) {
+        const auto j = ::mpz_si_kronecker(D, &n_view);
+        if (j == -1) {
+            break;
+        }
+        if (j == 0) {
+            // NOTE: abs(D) < n, hence n has a nontrivial factor.
+            return 0;
+        }
+        if (D == 13 && ::mpz_perfect_square_p(&n_view)) {
+            // NOTE: if n is a perfect square, a suitable D does not exist.
+            return 0;
+        }
+        D = D > 0 ? -D - 2 : -D + 2;
+    }
+    // n + 1 = k * 2**t.
+    arr_t k = n, one_p{};
+    one_p[0] = 1u;
+    // NOTE: n + 1 does not overflow, as n is not a multiple of 3
+    // (and thus it is not 2**(N * GMP_NUMB_BITS) - 1).
+    ignore(integer_add_limbs_n(k, n, one_p));
+    const auto t = integer_split_odd(k);
+    const auto k_size = integer_limbs_n_size(k);
+    // Compute U_k, V_k and Q**k in the Montgomery representation,
+    // scanning the bits of k from the top.
+    arr_t Dm, Qm, U = one, V = one, Qk, tmp;
+    to_mont(Dm, D);
+    to_mont(Qm, (1 - D) / 4);
+    Qk = Qm;
+    const auto k_nbits = (k_size - 1u) * unsigned(GMP_NUMB_BITS) + limb_size_nbits(k[k_size - 1u]);
+    for (auto i = k_nbits - 1u; i > 0u; --i) {
+        // U_2k = U_k * V_k, V_2k = V_k**2 - 2 * Q**k.
+        mul(U, U, V);
+        mul(V, V, V);
+        integer_mod_add(tmp, Qk, Qk, n);
+        integer_mod_sub(V, V, tmp, n);
+        mul(Qk, Qk, Qk);
+        if (integer_limbs_tstbit(k.data(), i - 1u)) {
+            // U_(k+1) = (U_k + V_k) / 2, V_(k+1) = (D * U_k + V_k) / 2.
+            mul(tmp, Dm, U);
+            integer_mod_add(U, U, V, n);
+            integer_mod_half(U, U, n);
+            integer_mod_add(V, V, tmp, n);
+            integer_mod_half(V, V, n);
+            mul(Qk, Qk, Qm);
+        }
+    }
+    if (U == zero || V == zero) {
+        return 1;
+    }
+    for (unsigned i = 1; i < t; ++i) {
+        // V_2k = V_k**2 - 2 * Q**k.
+        mul(V, V, V);
+        integer_mod_add(tmp, Qk, Qk, n);
+        integer_mod_sub(V, V, tmp, n);
+        if (V == zero) {
+            return 1;
+        }
+        mul(Qk, Qk, Qk);
+    }
+    return 0;
+}
+
+// Primality test for the nonnegative value n, stored in 2 limbs.
+inline int integer_prime_p_2(const std::array<::mp_limb_t, 2> &n)
+{
+    // Trial division by the small odd primes whose product fits in a limb.
+#if GMP_NUMB_BITS == 64
+    constexpr ::mp_limb_t trial_prod = 16294579238595022365ull;
+    constexpr std::size_t n_trial = 15;
+#else
+    constexpr ::mp_limb_t trial_prod = 111546435ul;
+    constexpr std::size_t n_trial = 8;
+#endif
+    constexpr std::array<unsigned, 15> trial_primes{{3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53}};
+    if (n[1] == 0u) {
+        if (n[0] < 3u) {
+            return n[0] == 2u ? 2 : 0;
+        }
+        if (!(n[0] & 1u)) {
+            return 0;
+        }
+        const auto r = n[0] % trial_prod;
+        for (std::size_t i = 0; i < n_trial; ++i) {
+            if (r % trial_primes[i] == 0u) {
+                return n[0] == trial_primes[i] ? 2 : 0;
+            }
+        }
+        const auto p = ::mp_limb_t(trial_primes[n_trial - 1u] + 2u);
+        if (n[0] < p * p) {
+            return 2;
+        }
+        return integer_mont_prime_p(std::array<::mp_limb_t, 1>{{n[0]}});
+    }
+    if (!(n[0] & 1u)) {
+        return 0;
+    }
+    const auto r = ::mpn_mod_1(n.data(), 2, trial_prod);
+    for (std::size_t i = 0; i < n_trial; ++i) {
+        if (r % trial_primes[i] == 0u) {
+            return 0;
+        }
+    }
+    return integer_mont_prime_p(n);
+}
+
+// Selection of the algorithm for static primality testing and
+// prime searching: if the double-limb multiplication is available,
+// use the Montgomery-based tests for values with 1 or 2 limbs, otherwise
+// use the mpz functions.
+using integer_static_prime_algo = std::integral_constant<int, integer_have_dlimb_mul::value ? 1 : 0>;
+
+// NOTE: these functions return the result of the primality test, or -1 if the
+// mpz fallback needs to be used.
+template <std::size_t SSize>
+inline int static_probab_prime_p(const static_int<SSize> &, const std::integral_constant<int, 0> &)
+{
+    return -1;
+}
+
+template <std::size_t SSize>
+inline int static_probab_prime_p(const static_int<SSize> &n, const std::integral_constant<int, 1> &)
+{
+    assert(n._mp_size >= 0);
+    if (n._mp_size > 2) {
+        return -1;
+    }
+    return integer_prime_p_2(
+        {{n._mp_size > 0 ? n.m_limbs[0] : ::mp_limb_t(0), n._mp_size > 1 ? n.m_limbs[1] : ::mp_limb_t(0)}});
+}
+
+template <std::size_t SSize>
+inline int probab_prime_p_impl(const integer<SSize> &n, int reps)
+{
+    if (mppp_unlikely(reps < 1)) {
+        throw std::invalid_argument("The number of primality tests must be at least 1, but a value of "
+                                    + to_string(reps) + " was provided instead");
+    }
+    if (mppp_unlikely(n.sgn() < 0)) {
+        throw std::invalid_argument("Cannot run primality tests on the negative number " + n.to_string());
+    }
+    if (n.is_static()) {
+        const auto ret = static_probab_prime_p(n._get_union().g_st(), integer_static_prime_algo{});
+        if (ret >= 0) {
+            return ret;
+        }
+    }
+    return ::mpz_probab_prime_p(n.get_mpz_view(), reps);
+}
+
+// NOTE: these functions return true if the computation was performed, false
+// if the mpz fallback needs to be used.
+template <std::size_t SSize>
+inline bool static_nextprime(static_int<SSize> &, const static_int<SSize> &, const std::integral_constant<int, 0> &)
+{
+    return false;
+}
+
+template <std::size_t SSize>
+inline bool static_nextprime(static_int<SSize> &rop, const static_int<SSize> &n,
+                             const std::integral_constant<int, 1> &)
+{
+    if (n._mp_size > 2) {
+        return false;
+    }
+    std::array<::mp_limb_t, 2> c{};
+    if (n._mp_size > 0) {
+        c[0] = n.m_limbs[0];
+        c[1] = n._mp_size > 1 ? n.m_limbs[1] : ::mp_limb_t(0);
+    }
+    if (n._mp_size < 0 || (c[1] == 0u && c[0] < 2u)) {
+        // NOTE: the next prime of any number less than 2 is 2.
+        c = {{2u, 0u}};
+    } else {
+        // Start from the smallest odd number greater than n.
+        const std::array<::mp_limb_t, 2> inc{{(c[0] & 1u) ? ::mp_limb_t(2) : ::mp_limb_t(1), 0u}};
+        const std::array<::mp_limb_t, 2> two{{2u, 0u}};
+        auto cy = integer_add_limbs_n(c, c, inc);
+        while (!cy && !integer_prime_p_2(c)) {
+            cy = integer_add_limbs_n(c, c, two);
+        }
+        if (cy) {
+            // The result does not fit in 2 limbs.
+            return false;
+        }
+    }
+    const auto size = c[1] != 0u ? 2 : 1;
+    if (mppp_unlikely(static_cast<std::size_t>(size) > SSize)) {
+        return false;
+    }
+    rop._mp_size = size;
+    copy_limbs_no(c.data(), c.data() + size, rop.m_limbs.data());
+    rop.zero_upper_limbs(static_cast<std::size_t>(size));
+    return true;
+}
+
+template <std::size_t SSize>
+inline void nextprime_impl(integer<SSize> &rop, const integer<SSize> &n)
+{
+    if (n.is_static()) {
+        // NOTE: if rop is dynamic, it cannot overlap with the static operand.
+        if (!rop.is_static()) {
+            rop.set_zero();
+        }
+        if (static_nextprime(rop._get_union().g_st(), n._get_union().g_st(), integer_static_prime_algo{})) {
+            return;
+        }
+    }
+    MPPP_MAYBE_TLS mpz_raii tmp;
+    ::mpz_nextprime(&tmp.m_mpz, n.get_mpz_view());
+    rop = &tmp.m_mpz;
+}
+
+// Integer factorisation. The values with 1 or 2 limbs are factored via trial division,
+// Pollard-Brent rho in Montgomery arithmetic and SQUFOF, without any dynamic memory allocation.
+// NOTE: the static functions require the double-limb multiplication primitives.
+
+// The odd primes below 2**8, used for trial division.
+constexpr std::array<unsigned char, 53> integer_factor_primes{
+    {3,   5,   7,   11,  13,  17,  19,  23,  29,  31,  37,  41,  43,  47,  53,  59,  61,  67,
+     71,  73,  79,  83,  89,  97,  101, 103, 107, 109, 113, 127, 131, 137, 139, 149, 151, 157,
+     163, 167, 173, 179, 181, 191, 193, 197, 199, 211, 223, 227, 229, 233, 239, 241, 251}};
+
+// rop = gcd(a, n), for the odd value n.
+inline void integer_factor_gcd(std::array<::mp_limb_t, 1> &rop, std::array<::mp_limb_t, 1> a,
+                               const std::array<::mp_limb_t, 1> &n)
+{
+    if (a[0] == 0u) {
+        rop = n;
+        return;
+    }
+    rop[0] = integer_binary_gcd_1(a[0] >> limb_ctz(a[0]), n[0]);
+}
+
+inline void integer_factor_gcd(std::array<::mp_limb_t, 2> &rop, std::array<::mp_limb_t, 2> a,
+                               const std::array<::mp_limb_t, 2> &n)
+{
+    if (a[0] == 0u && a[1] == 0u) {
+        rop = n;
+        return;
+    }
+    integer_binary_gcd_2(a[0], a[1], n[0], n[1]);
+    rop = a;
+}
+
+// Pollard-Brent rho method for the odd composite value n with N limbs. The iteration
+// function is x -> x**2 + c, with x in the Montgomery representation (that is, the squaring
+// is the Montgomery multiplication, which is an equally good pseudorandom map and avoids
+// any conversion). On success, a nontrivial factor of n is written into f and true is returned.
+// False is returned if the cycle closes without revealing a factor, or after (roughly) max_iter
+// iterations.
+template <std::size_t N>
+inline bool integer_rho(std::array<::mp_limb_t, N> &f, const std::array<::mp_limb_t, N> &n, ::mp_limb_t c,
+                        std::uint_least64_t max_iter)
+{
+    using arr_t = std::array<::mp_limb_t, N>;
+    assert(n[0] & 1u);
+    const auto ninv = integer_mont_ninv(n[0]);
+    arr_t c_arr{}, one{};
+    c_arr[0] = c;
+    one[0] = 1u;
+    const auto step = [&n, ninv, &c_arr](arr_t &x) {
+        integer_mont_mul(x, x, x, n, ninv);
+        integer_mod_add(x, x, c_arr, n);
+    };
+    // NOTE: the differences are accumulated into a product, so that
+    // a gcd is computed only every batch iterations.
+    constexpr std::uint_least64_t batch = 128;
+    arr_t x, y{}, ys, q = one, d;
+    y[0] = 2u;
+    std::uint_least64_t iter = 0;
+    for (std::uint_least64_t r = 1; iter < max_iter; r *= 2u) {
+        x = y;
+        for (std::uint_least64_t i = 0; i < r; ++i) {
+            step(y);
+        }
+        for (std::uint_least64_t k = 0; k < r; k += batch) {
+            ys = y;
+            const auto lim = std::min(batch, r - k);
+            for (std::uint_least64_t i = 0; i < lim; ++i) {
+                step(y);
+                integer_mod_sub(d, x, y, n);
+                integer_mont_mul(q, q, d, n, ninv);
+            }
+            integer_factor_gcd(f, q, n);
+            if (f == n) {
+                // The product of the batch is a multiple of n: redo
+                // the batch one step at a time.
+                do {
+                    step(ys);
+                    integer_mod_sub(d, x, ys, n);
+                    integer_factor_gcd(f, d, n);
+                } while (f == one);
+                return f != n;
+            }
+            if (f != one) {
+                return true;
+            }
+        }
+        iter += 2u * r;
+    }
+    return false;
+}
+
+// Integer square root of n < 2**62.
+inline std::uint_least64_t integer_isqrt_u62(std::uint_least64_t n)
+{
+    assert(n < (std::uint_least64_t(1) << 62));
+    // NOTE: the floating-point estimate is off by at most one.
+    auto r = static_cast<std::uint_least64_t>(std::sqrt(static_cast<double>(n)));
+    while (r * r > n) {
+        --r;
+    }
+    while ((r + 1u) * (r + 1u) <= n) {
+        ++r;
+    }
+    return r;
+}
+
+// Shanks' square forms factorisation of the odd composite value n < 2**62, which must
+// not be a perfect square. Returns a nontrivial factor of n, or zero on failure.
+inline std::uint_least64_t integer_squfof(std::uint_least64_t n)
+{
+    assert(n & 1u);
+    assert(n < (std::uint_least64_t(1) << 62));
+    constexpr std::array<unsigned, 16> mults{{1, 3, 5, 7, 11, 15, 21, 33, 35, 55, 77, 105, 165, 231, 385, 1155}};
+    const auto s = integer_isqrt_u62(n);
+    const auto bound = 6u * integer_isqrt_u62(2u * s);
+    for (const auto k : mults) {
+        if (n > ((std::uint_least64_t(1) << 62) - 1u) / k) {
+            break;
+        }
+        const auto D = k * n, P0 = integer_isqrt_u62(D);
+        if (P0 * P0 == D) {
+            // NOTE: no square forms for a square D, try the next multiplier.
+            continue;
+        }
+        // Forward cycle, looking for a square form.
+        auto P = P0, P_prev = P0, Q_prev = std::uint_least64_t(1), Q = D - P0 * P0, r = std::uint_least64_t(0);
+        std::uint_least64_t i = 2;
+        for (; i < bound; ++i) {
+            const auto b = (P0 + P) / Q;
+            P = b * Q - P;
+            const auto q = Q;
+            // NOTE: the difference may wrap around, but the result is correct modulo 2**64.
+            Q = Q_prev + b * (P_prev - P);
+            r = integer_isqrt_u62(Q);
+            if (!(i & 1u) && r * r == Q) {
+                break;
+            }
+            Q_prev = q;
+            P_prev = P;
+        }
+        if (i >= bound) {
+            continue;
+        }
+        // Reverse cycle, looking for a symmetry point.
+        const auto b0 = (P0 - P) / r;
+        P = b0 * r + P;
+        P_prev = P;
+        Q_prev = r;
+        Q = (D - P_prev * P_prev) / Q_prev;
+        i = 0;
+        do {
+            const auto b = (P0 + P) / Q;
+            P_prev = P;
+            P = b * Q - P;
+            const auto q = Q;
+            Q = Q_prev + b * (P_prev - P);
+            Q_prev = q;
+        } while (P != P_prev && ++i < bound);
+        // f = gcd(n, Q_prev).
+        auto f = n, g = Q_prev;
+        while (g != 0u) {
+            const auto t = f % g;
+            f = g;
+            g = t;
+        }
+        if (f != 1u && f != n) {
+            return f;
+        }
+    }
+    return 0;
+}
+
+// Find a nontrivial factor of the odd composite value n, stored in 2 limbs. n
+// must not have prime factors below 2**8.
+inline void integer_factor_split_2(std::array<::mp_limb_t, 2> &f, const std::array<::mp_limb_t, 2> &n)
+{
+    if (n[1] != 0u) {
+        // NOTE: rho fails only if the cycles modulo all the prime factors
+        // of n close at the same time, which is rare: retry with another c.
+        for (::mp_limb_t c = 1;; ++c) {
+            if (integer_rho(f, n, c, std::numeric_limits<std::uint_least64_t>::max())) {
+                return;
+            }
+        }
+    }
+    // NOTE: with 1 limb, rho is expected to succeed within about 2**17 iterations. If
+    // it does not, try with SQUFOF before switching to an unbounded rho.
+    std::array<::mp_limb_t, 1> n1{{n[0]}}, f1;
+    for (::mp_limb_t c = 1;; ++c) {
+        if (integer_rho(f1, n1, c, c <= 2u ? std::uint_least64_t(1) << 20
+                                           : std::numeric_limits<std::uint_least64_t>::max())) {
+            f = {{f1[0], 0u}};
+            return;
+        }
+        if (c == 2u && std::uint_least64_t(n[0]) < (std::uint_least64_t(1) << 62)) {
+            const auto s = integer_isqrt_u62(n[0]);
+            const auto g = s * s == n[0] ? s : integer_squfof(n[0]);
+            if (g != 0u) {
+                f = {{static_cast<::mp_limb_t>(g), 0u}};
+                return;
+            }
+        }
+    }
+}
+
+// Factor the value n > 0, stored in 2 limbs. For each prime factor p with multiplicity e,
+// emit(p, e) is invoked (possibly several times for the same p).
+template <typename F>
+inline void integer_factor_2(std::array<::mp_limb_t, 2> n, const F &emit)
+{
+    using arr_t = std::array<::mp_limb_t, 2>;
+    assert(n[0] != 0u || n[1] != 0u);
+    if (!(n[0] & 1u)) {
+        emit(arr_t{{2u, 0u}}, integer_split_odd(n));
+    }
+    // Trial division.
+    arr_t q;
+    for (const auto p : integer_factor_primes) {
+        if (n[1] == 0u && n[0] < ::mp_limb_t(p) * p) {
+            break;
+        }
+        unsigned long e = 0;
+        if (n[1] == 0u) {
+            for (; n[0] % p == 0u; ++e) {
+                n[0] /= p;
+            }
+        } else {
+            for (; ::mpn_divrem_1(q.data(), 0, n.data(), 2, p) == 0u; ++e) {
+                n = q;
+            }
+        }
+        if (e != 0u) {
+            emit(arr_t{{p, 0u}}, e);
+        }
+    }
+    if (n[1] == 0u && n[0] == 1u) {
+        return;
+    }
+    // The cofactors which still need to be factored. Their prime factors
+    // are all greater than 2**8, which bounds their number.
+    std::array<arr_t, 2u * unsigned(GMP_NUMB_BITS) / 8u> stack;
+    std::size_t size = 1;
+    stack[0] = n;
+    while (size != 0u) {
+        const auto c = stack[--size];
+        if (integer_prime_p_2(c)) {
+            emit(c, 1);
+            continue;
+        }
+        arr_t f{}, r;
+        integer_factor_split_2(f, c);
+        const auto c_size = integer_limbs_n_size(c), f_size = integer_limbs_n_size(f);
+        q = arr_t{};
+        ::mpn_tdiv_qr(q.data(), r.data(), 0, c.data(), static_cast<::mp_size_t>(c_size), f.data(),
+                      static_cast<::mp_size_t>(f_size));
+        assert(size + 2u <= stack.size());
+        stack[size++] = f;
+        stack[size++] = q;
+    }
+}
+
+// Pollard-Brent rho method for the odd composite value n, in mpz arithmetic. A nontrivial
+// factor of n is written into f.
+inline void integer_rho_mpz(mpz_struct_t *f, const mpz_struct_t *n)
+{
+    mpz_raii x, y, ys, q, d;
+    const unsigned long batch = 128;
+    // NOTE: mpz_cmp_ui() is a macro in GMP.
+    const auto f_is_one = [f]() { return f->_mp_size == 1 && f->_mp_d[0] == 1u; };
+    for (unsigned long c = 1;; ++c) {
+        const auto step = [n, c](mpz_struct_t *z) {
+            ::mpz_mul(z, z, z);
+            ::mpz_add_ui(z, z, c);
+            ::mpz_tdiv_r(z, z, n);
+        };
+        ::mpz_set_ui(&y.m_mpz, 2u);
+        ::mpz_set_ui(&q.m_mpz, 1u);
+        ::mpz_set_ui(f, 1u);
+        for (unsigned long r = 1; f_is_one(); r *= 2u) {
+            ::mpz_set(&x.m_mpz, &y.m_mpz);
+            for (unsigned long i = 0; i < r; ++i) {
+                step(&y.m_mpz);
+            }
+            for (unsigned long k = 0; k < r && f_is_one(); k += batch) {
+                ::mpz_set(&ys.m_mpz, &y.m_mpz);
+                const auto lim = std::min(batch, r - k);
+                for (unsigned long i = 0; i < lim; ++i) {
+                    step(&y.m_mpz);
+                    ::mpz_sub(&d.m_mpz, &x.m_mpz, &y.m_mpz);
+                    ::mpz_mul(&q.m_mpz, &q.m_mpz, &d.m_mpz);
+                    ::mpz_tdiv_r(&q.m_mpz, &q.m_mpz, n);
+                }
+                ::mpz_gcd(f, &q.m_mpz, n);
+            }
+        }
+        if (::mpz_cmp(f, n) == 0) {
+            // Redo the last batch one step at a time.
+            do {
+                step(&ys.m_mpz);
+                ::mpz_sub(&d.m_mpz, &x.m_mpz, &ys.m_mpz);
+                ::mpz_gcd(f, &d.m_mpz, n);
+            } while (f_is_one());
+        }
+        if (::mpz_cmp(f, n) != 0) {
+            return;
+        }
+    }
+}
+
+// NOTE: these functions return true if the factorisation of the positive value n
+// was performed, false if the mpz fallback needs to be used.
+template <std::size_t SSize, typename F>
+inline bool static_factor(const static_int<SSize> &, const F &, const std::integral_constant<int, 0> &)
+{
+    return false;
+}
+
+template <std::size_t SSize, typename F>
+inline bool static_factor(const static_int<SSize> &n, const F &emit, const std::integral_constant<int, 1> &)
+{
+    assert(n._mp_size > 0);
+    if (n._mp_size > 2) {
+        return false;
+    }
+    integer_factor_2({{n.m_limbs[0], n._mp_size > 1 ? n.m_limbs[1] : ::mp_limb_t(0)}},
+                     [&emit](const std::array<::mp_limb_t, 2> &p, unsigned long e) {
+                         emit(integer<SSize>{p.data(), integer_limbs_n_size(p)}, e);
+                     });
+    return true;
+}
+
+// Factor the value n > 0 in mpz arithmetic. The cofactors which fit in a static
+// integer are handed over to the static implementation (if available).
+template <std::size_t SSize, typename F>
+inline void integer_factor_mpz(const integer<SSize> &n, const F &emit)
 {
-    return exp.odd_p();
+    // Trial division.
+    MPPP_MAYBE_TLS mpz_raii m;
+    ::mpz_set(&m.m_mpz, n.get_mpz_view());
+    const auto e2 = ::mpz_scan1(&m.m_mpz, 0);
+    if (e2 != 0u) {
+        ::mpz_tdiv_q_2exp(&m.m_mpz, &m.m_mpz, e2);
+        emit(integer<SSize>{2}, static_cast<unsigned long>(e2));
+    }
+    for (const unsigned long p : integer_factor_primes) {
+        unsigned long e = 0;
+        for (; ::mpz_divisible_ui_p(&m.m_mpz, p); ++e) {
+            ::mpz_divexact_ui(&m.m_mpz, &m.m_mpz, p);
+        }
+        if (e != 0u) {
+            emit(integer<SSize>{p}, e);
+        }
+    }
+    // The cofactors which still need to be factored.
+    std::vector<integer<SSize>> stack;
+    stack.emplace_back(&m.m_mpz);
+    while (!stack.empty()) {
+        auto c = std::move(stack.back());
+        stack.pop_back();
+        if (c.is_one()
+            || (c.is_static() && static_factor(c._get_union().g_st(), emit, integer_static_prime_algo{}))) {
+            continue;
+        }
+        if (probab_prime_p_impl(c, 25) != 0) {
+            emit(std::move(c), 1);
+            continue;
+        }
+        MPPP_MAYBE_TLS mpz_raii f;
+        integer_rho_mpz(&f.m_mpz, c.get_mpz_view());
+        stack.emplace_back(&f.m_mpz);
+        stack.push_back(divexact(c, stack.back()));
+    }
 }
 
-// Implementation of pow().
-// integer -- integral overload.
-template <typename T, std::size_t SSize,
-          enable_if_t<disjunction<std::is_same<T, integer<SSize>>, is_integral<T>>::value, int> = 0>
-inline integer<SSize> pow_impl(const integer<SSize> &base, const T &exp)
+template <std::size_t SSize>
+inline std::vector<std::pair<integer<SSize>, unsigned long>> factor_impl(const integer<SSize> &n)
 {
-    integer<SSize> rop;
-    if (sgn(exp) >= 0) {
-        pow_ui(rop, base, integer_exp_to_ulong(exp));
-    } else if (mppp_unlikely(is_zero(base))) {
-        // 0**-n is a division by zero.
-        throw zero_division_error("Cannot raise zero to the negative power " + detail::to_string(exp));
-    } else if (base.is_one()) {
-        // 1**n == 1.
-        rop = 1;
-    } else if (base.is_negative_one()) {
-        if (integer_exp_is_odd(exp)) {
-            // 1**(-2n-1) == -1.
-            rop = -1;
+    if (mppp_unlikely(n.is_zero())) {
+        throw std::domain_error("Cannot factor zero");
+    }
+    using pair_t = std::pair<integer<SSize>, unsigned long>;
+    std::vector<pair_t> retval;
+    const auto emit = [&retval](integer<SSize> &&p, unsigned long e) { retval.emplace_back(std::move(p), e); };
+    const auto m = abs(n);
+    if (!m.is_static() || !static_factor(m._get_union().g_st(), emit, integer_static_prime_algo{})) {
+        integer_factor_mpz(m, emit);
+    }
+    // Sort the prime factors, and merge the duplicates.
+    std::sort(retval.begin(), retval.end(), [](const pair_t &a, const pair_t &b) { return a.first < b.first; });
+    std::size_t j = 0;
+    for (std::size_t i = 1; i < retval.size(); ++i) {
+        if (retval[i].first == retval[j].first) {
+            retval[j].second += retval[i].second;
         } else {
-            // 1**(-2n) == 1.
-            rop = 1;
+            retval[++j] = std::move(retval[i]);
         }
-    } else {
-        // m**-n == 1 / m**n == 0.
-        rop = 0;
     }
-    return rop;
+    retval.resize(retval.empty() ? 0u : j + 1u);
+    return retval;
 }
 
-// C++ integral -- integer overload.
-template <typename T, std::size_t SSize, enable_if_t<is_integral<T>::value, int> = 0>
-inline integer<SSize> pow_impl(const T &base, const integer<SSize> &exp)
+} // namespace detail
+
+#if !defined(MPPP_DOXYGEN_INVOKED)
+
+// Quaternary modular exponentiation.
+template <std::size_t SSize>
+inline integer<SSize> &powm(integer<SSize> &rop, const integer<SSize> &base, const integer<SSize> &exp,
+                            const integer<SSize> &mod)
 {
-    return pow_impl(integer<SSize>{base}, exp);
+    detail::powm_impl(rop, base, exp, mod);
+    return rop;
 }
 
-// integer -- FP overload.
-template <typename T, std::size_t SSize, enable_if_t<std::is_floating_point<T>::value, int> = 0>
-inline T pow_impl(const integer<SSize> &base, const T &exp)
+// Ternary modular exponentiation.
+template <std::size_t SSize>
+inline integer<SSize> powm(const integer<SSize> &base, const integer<SSize> &exp, const integer<SSize> &mod)
 {
-    return std::pow(static_cast<T>(base), exp);
+    integer<SSize> retval;
+    detail::powm_impl(retval, base, exp, mod);
+    return retval;
 }
 
-// FP -- integer overload.
-template <typename T, std::size_t SSize, enable_if_t<std::is_floating_point<T>::value, int> = 0>
-inline T pow_impl(const T &base, const integer<SSize> &exp)
+// Integer factorisation.
+template <std::size_t SSize>
+inline std::vector<std::pair<integer<SSize>, unsigned long>> factor(const integer<SSize> &n)
 {
-    return std::pow(base, static_cast<T>(exp));
+    return detail::factor_impl(n);
 }
-} // namespace detail
 
-/// Generic binary exponentiation for \link mppp::integer integer\endlink.
-/**
- * \rststar
- * This function will raise ``base`` to the power ``exp``, and return the result. If one of the arguments
- * is a floating-point value, then the result will be computed via ``std::pow()`` and it will also be a
- * floating-point value. Otherwise, the result will be an :cpp:class:`~mppp::integer`.
- * In case of a negative integral exponent and integral base, the result will be zero unless
- * the absolute value of ``base`` is 1.
- * \endrststar
- *
- * @param base the base.
- * @param exp the exponent.
- *
- * @return <tt>base**exp</tt>.
- *
- * @throws std::overflow_error if \p base and \p exp are integrals and \p exp is non-negative and outside the range
- * of <tt>unsigned long</tt>.
- * @throws zero_division_error if \p base and \p exp are integrals and \p base is zero and \p exp is negative.
- */
-#if defined(MPPP_HAVE_CONCEPTS)
-template <typename T, typename U>
-requires IntegerOpTypes<T, U> inline auto pow(const T &base, const U &exp)
-#else
-template <typename T, typename U>
-inline detail::integer_common_t<T, U> pow(const T &base, const U &exp)
 #endif
-{
-    return detail::pow_impl(base, exp);
-}
 
 /** @} */
 
@@ -7813,6 +10576,200 @@ inline std::ostream &operator<<(std::ostream &os, const integer<SSize> &n)
     return detail::integer_stream_operator_impl(os, n.get_mpz_view(), n.sgn());
 }
 
+#if defined(MPPP_HAVE_CHARCONV)
+
+using to_chars_result = std::to_chars_result;
+using from_chars_result = std::from_chars_result;
+
+#else
+
+// Result types of to_chars() and from_chars(), mirroring the
+// C++17 std::to_chars_result and std::from_chars_result.
+struct to_chars_result {
+    char *ptr;
+    std::errc ec;
+};
+
+struct from_chars_result {
+    const char *ptr;
+    std::errc ec;
+};
+
+#endif
+
+namespace detail
+{
+
+inline void charconv_check_base(int base)
+{
+    if (mppp_unlikely(base < 2 || base > 62)) {
+        throw std::invalid_argument("Invalid base for string conversion: the base must be between "
+                                    "2 and 62, but a value of "
+                                    + to_string(base) + " was provided instead");
+    }
+}
+
+// Write the representation of the mpz n in the given base into [first, last). Returns the
+// end of the representation, or nullptr if the range is too small.
+MPPP_DLL_PUBLIC char *mpz_to_chars(char *, char *, const mpz_struct_t *, int);
+
+// Implementation of to_chars() for static integers. The digits are generated
+// via mpn_get_str() into a buffer on the stack, so that no memory is allocated.
+template <std::size_t SSize>
+inline char *static_to_chars(char *first, char *last, const static_int<SSize> &n, int base)
+{
+    const auto asize = static_cast<std::size_t>(n.abs_size());
+#if defined(MPPP_HAVE_GCC_INT128) && (GMP_NUMB_BITS == 64) && !GMP_NAIL_BITS
+    if (base == 10 && asize <= 2u) {
+        std::array<char, dec_2limbs_max_digits + 1u> buffer;
+        const auto end = buffer.data() + buffer.size();
+        auto begin = dec_format_2limbs(end, n.m_limbs.data(), asize);
+        if (n._mp_size < 0) {
+            *--begin = '-';
+        }
+        if (last - first < end - begin) {
+            return nullptr;
+        }
+        return std::copy(begin, end, first);
+    }
+#endif
+    // NOTE: mpn_get_str() needs room for the largest value with
+    // asize limbs, plus one extra digit.
+    std::array<unsigned char, SSize * unsigned(GMP_NUMB_BITS) + 1u> digits;
+    std::size_t ndigits;
+    if (asize == 0u) {
+        digits[0] = 0;
+        ndigits = 1;
+    } else {
+        // NOTE: mpn_get_str() clobbers its input.
+        std::array<::mp_limb_t, SSize> limbs;
+        copy_limbs_no(n.m_limbs.data(), n.m_limbs.data() + asize, limbs.data());
+        ndigits = ::mpn_get_str(digits.data(), base, limbs.data(), static_cast<::mp_size_t>(asize));
+    }
+    // Skip the leading zeroes produced by mpn_get_str().
+    std::size_t start = 0;
+    while (start + 1u < ndigits && digits[start] == 0u) {
+        ++start;
+    }
+    const auto neg = n._mp_size < 0;
+    const auto nchars = ndigits - start + static_cast<std::size_t>(neg);
+    if (static_cast<std::size_t>(last - first) < nchars) {
+        return nullptr;
+    }
+    if (neg) {
+        *first++ = '-';
+    }
+    for (auto i = start; i < ndigits; ++i) {
+        *first++ = digit_to_char(digits[i], base);
+    }
+    return first;
+}
+
+// Implementation of from_chars(). The digits in [begin, end) have already been validated.
+template <std::size_t SSize>
+inline void integer_from_chars_impl(integer<SSize> &n, const char *begin, const char *end, int base, bool neg)
+{
+#if defined(MPPP_HAVE_GCC_INT128) && (GMP_NUMB_BITS == 64) && !GMP_NAIL_BITS
+    if (base == 10) {
+        std::array<::mp_limb_t, 2> limbs;
+        std::size_t size;
+        if (dec_parse_2limbs(begin, end, limbs, size)) {
+            n = integer<SSize>{limbs.data(), size};
+            if (neg) {
+                n.neg();
+            }
+            return;
+        }
+    }
+#endif
+    // Skip the leading zeroes.
+    while (begin != end && *begin == '0') {
+        ++begin;
+    }
+    const auto ndigits = static_cast<std::size_t>(end - begin);
+    // Number of bits per digit, rounded up.
+    unsigned dbits = 0;
+    for (auto b = static_cast<unsigned>(base - 1); b != 0u; b >>= 1) {
+        ++dbits;
+    }
+    if (ndigits <= SSize * unsigned(GMP_NUMB_BITS) / dbits) {
+        // The value fits in static storage: parse it via mpn_set_str() using buffers on the stack.
+        std::array<unsigned char, SSize * unsigned(GMP_NUMB_BITS)> digits;
+        for (std::size_t i = 0; i < ndigits; ++i) {
+            digits[i] = static_cast<unsigned char>(char_to_digit(begin[i], base));
+        }
+        // NOTE: mpn_set_str() needs room for the largest value
+        // with ndigits digits, plus one extra limb.
+        std::array<::mp_limb_t, SSize + 1u> limbs;
+        auto size = ndigits == 0u ? std::size_t(0)
+                                  : static_cast<std::size_t>(::mpn_set_str(limbs.data(), digits.data(), ndigits, base));
+        while (size != 0u && limbs[size - 1u] == 0u) {
+            --size;
+        }
+        assert(size <= SSize);
+        n = integer<SSize>{limbs.data(), size};
+        if (neg) {
+            n.neg();
+        }
+    } else {
+        MPPP_MAYBE_TLS std::vector<char> buffer;
+        buffer.assign(begin, end);
+        buffer.emplace_back('\0');
+        MPPP_MAYBE_TLS mpz_raii mpz;
+        const auto ret = mpz_set_str_wrap(&mpz.m_mpz, buffer.data(), base);
+        assert(ret == 0);
+        ignore(ret);
+        if (neg) {
+            ::mpz_neg(&mpz.m_mpz, &mpz.m_mpz);
+        }
+        n = integer<SSize>{&mpz.m_mpz};
+    }
+}
+
+} // namespace detail
+
+// Convert an integer to characters.
+template <std::size_t SSize>
+inline to_chars_result to_chars(char *first, char *last, const integer<SSize> &n, int base = 10)
+{
+    detail::charconv_check_base(base);
+    auto ret = n.is_static() ? detail::static_to_chars(first, last, n._get_union().g_st(), base)
+                             : detail::mpz_to_chars(first, last, &n._get_union().g_dy(), base);
+    if (ret == nullptr) {
+        return to_chars_result{last, std::errc::value_too_large};
+    }
+    return to_chars_result{ret, std::errc{}};
+}
+
+// Parse an integer from characters.
+template <std::size_t SSize>
+inline from_chars_result from_chars(const char *first, const char *last, integer<SSize> &n, int base = 10)
+{
+    detail::charconv_check_base(base);
+    auto p = first;
+    const bool neg = p != last && *p == '-';
+    if (neg) {
+        ++p;
+    }
+    const auto digits_begin = p;
+    while (p != last && detail::char_to_digit(*p, base) < base) {
+        ++p;
+    }
+    if (p == digits_begin) {
+        return from_chars_result{first, std::errc::invalid_argument};
+    }
+    detail::integer_from_chars_impl(n, digits_begin, p, base, neg);
+    return from_chars_result{p, std::errc{}};
+}
+
+// Upper bound for the number of characters written by to_chars().
+template <std::size_t SSize>
+inline std::size_t max_chars(const integer<SSize> &n, int base = 10)
+{
+    detail::charconv_check_base(base);
+    return ::mpz_sizeinbase(n.get_mpz_view(), base) + static_cast<std::size_t>(n.sgn() < 0);
+}
+
 /** @defgroup integer_s11n integer_s11n
  *  @{
  */
@@ -7927,6 +10884,82 @@ inline std::size_t binary_load(integer<SSize> &n, T &&src)
 
 /** @} */
 
+namespace detail
+{
+
+// The constants of the hash function (from wyhash).
+constexpr std::uint64_t hash_p0 = 0xa0761d6478bd642full;
+constexpr std::uint64_t hash_p1 = 0xe7037ed1a0b428dbull;
+constexpr std::uint64_t hash_p2 = 0x8ebc6af09c88c6e3ull;
+constexpr std::uint64_t hash_p3 = 0x589965cc75374cc3ull;
+
+// The mixing primitive of the hash function: the full 128-bit
+// product of a and b, folded to 64 bits via xor.
+// NOTE: the operands are xored into the result (as in the "condom"
+// variant of wyhash), so that a zero operand does not wipe out the other one.
+#if defined(MPPP_HAVE_GCC_INT128)
+
+inline std::uint64_t hash_mix(std::uint64_t a, std::uint64_t b)
+{
+    const auto res = static_cast<__uint128_t>(a) * b;
+    return a ^ b ^ static_cast<std::uint64_t>(res) ^ static_cast<std::uint64_t>(res >> 64);
+}
+
+#elif defined(_MSC_VER) && defined(_WIN64)
+
+inline std::uint64_t hash_mix(std::uint64_t a, std::uint64_t b)
+{
+    std::uint64_t hi;
+    const auto lo = ::UnsignedMultiply128(a, b, &hi);
+    return a ^ b ^ lo ^ hi;
+}
+
+#else
+
+inline std::uint64_t hash_mix(std::uint64_t a, std::uint64_t b)
+{
+    const std::uint64_t a0 = a & 0xffffffffull, a1 = a >> 32, b0 = b & 0xffffffffull, b1 = b >> 32;
+    const std::uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+    const std::uint64_t mid = (p00 >> 32) + (p01 & 0xffffffffull) + (p10 & 0xffffffffull);
+    return a ^ b ^ ((mid << 32) | (p00 & 0xffffffffull)) ^ (p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32));
+}
+
+#endif
+
+// Final step of the hash function: x and y are the last (up to) two limbs, seed is
+// the state accumulated from the preceding limbs and size the signed size of the integer.
+inline std::uint64_t hash_finalise(std::uint64_t x, std::uint64_t y, std::uint64_t seed, mpz_size_t size)
+{
+    return hash_mix(hash_p1 ^ static_cast<std::uint64_t>(size), hash_mix(x ^ hash_p1, y ^ seed));
+}
+
+// Hash of an integer with more than 2 limbs.
+MPPP_DLL_PUBLIC std::uint64_t hash_limbs(const ::mp_limb_t *, std::size_t, mpz_size_t);
+
+// 64-bit hash of an integer. Zero hashes to zero.
+template <std::size_t SSize>
+inline std::uint64_t hash64(const integer<SSize> &n)
+{
+    const mpz_size_t size = n._get_union().m_st._mp_size;
+    const std::size_t asize = size >= 0 ? static_cast<std::size_t>(size) : static_cast<std::size_t>(nint_abs(size));
+    const ::mp_limb_t *ptr
+        = n._get_union().is_static() ? n._get_union().g_st().m_limbs.data() : n._get_union().g_dy()._mp_d;
+    // NOTE: the hash depends only on the signed size and on the
+    // limbs, thus it does not depend on the storage type.
+    switch (asize) {
+        case 0u:
+            return 0;
+        case 1u:
+            return hash_finalise(ptr[0] & GMP_NUMB_MASK, 0, hash_p0, size);
+        case 2u:
+            return hash_finalise(ptr[0] & GMP_NUMB_MASK, ptr[1] & GMP_NUMB_MASK, hash_p0, size);
+        default:
+            return hash_limbs(ptr, asize, size);
+    }
+}
+
+} // namespace detail
+
 /** @defgroup integer_other integer_other
  *  @{
  */
@@ -7935,7 +10968,8 @@ inline std::size_t binary_load(integer<SSize> &n, T &&src)
 /**
  * \rststar
  * This function will return a hash value for ``n``. The hash value depends only on the value of ``n``
- * (and *not* on its storage type).
+ * (and *not* on its storage type). The limbs of ``n`` are mixed a word at a time via
+ * 64-bit multiplications, in the style of `wyhash <https://github.com/wangyi-fudan/wyhash>`__.
  *
  * A :ref:`specialisation <integer_std_specialisations>` of the standard ``std::hash`` functor is also provided, so that
  * it is possible to use :cpp:class:`~mppp::integer` in standard unordered associative containers out of the box.
@@ -7948,20 +10982,7 @@ inline std::size_t binary_load(integer<SSize> &n, T &&src)
 template <std::size_t SSize>
 inline std::size_t hash(const integer<SSize> &n)
 {
-    const detail::mpz_size_t size = n._get_union().m_st._mp_size;
-    const std::size_t asize
-        = size >= 0 ? static_cast<std::size_t>(size) : static_cast<std::size_t>(detail::nint_abs(size));
-    const ::mp_limb_t *ptr
-        = n._get_union().is_static() ? n._get_union().g_st().m_limbs.data() : n._get_union().g_dy()._mp_d;
-    // Init the retval as the signed size.
-    auto retval = static_cast<std::size_t>(size);
-    // Combine the limbs.
-    for (std::size_t i = 0; i < asize; ++i) {
-        // The hash combiner. This is lifted directly from Boost. See also:
-        // http://www.open-std.org/jtc1/sc22/wg21/docs/papers/2014/n3876.pdf
-        retval ^= (ptr[i] & GMP_NUMB_MASK) + std::size_t(0x9e3779b9ul) + (retval << 6) + (retval >> 2);
-    }
-    return retval;
+    return static_cast<std::size_t>(detail::hash64(n));
 }
 
 /// Free the \link mppp::integer integer\endlink caches.
@@ -7980,6 +11001,133 @@ inline std::size_t hash(const integer<SSize> &n)
  */
 MPPP_DLL_PUBLIC void free_integer_caches();
 
+/// Configuration of the \link mppp::integer integer\endlink caches.
+/**
+ * \rststar
+ * The thread-local caches of :cpp:class:`~mppp::integer` store the arrays of limbs
+ * released by dynamic integers, so that they can be reused by subsequent allocations.
+ * Arrays of up to 10 limbs are grouped in size classes of exactly one size. Larger arrays
+ * are grouped in power-of-two size classes, and the allocations of dynamic integers
+ * whose size falls in one of these classes are rounded up to the size of the class.
+ *
+ * The default configuration caches up to 100 arrays of up to 10 limbs per size class.
+ * \endrststar
+ */
+struct integer_cache_config {
+    /// Max number of arrays cached in each size class.
+    std::size_t max_entries = detail::mpz_alloc_cache::default_max_entries;
+    /// Max size (in limbs) of the allocations served from the caches.
+    /**
+     * A value of zero disables the caches. The maximum allowed value is
+     * \f$2^{19}\f$.
+     */
+    std::size_t max_limbs = detail::mpz_alloc_cache::default_max_limbs;
+};
+
+/// Get the configuration of the \link mppp::integer integer\endlink caches for the calling thread.
+/**
+ * @return the configuration of the cache of the calling thread, as set by
+ * mppp::set_integer_cache_config() or mppp::set_global_integer_cache_config().
+ */
+MPPP_DLL_PUBLIC integer_cache_config get_integer_cache_config();
+
+/// Set the configuration of the \link mppp::integer integer\endlink caches for the calling thread.
+/**
+ * \rststar
+ * The configuration set by this function overrides the global configuration set by
+ * :cpp:func:`~mppp::set_global_integer_cache_config()` for the calling thread, until
+ * :cpp:func:`~mppp::reset_integer_cache_config()` is invoked. If the new configuration is
+ * more restrictive than the current one, the arrays in excess are freed.
+ *
+ * On platforms where thread local storage is not supported, this funcion will be a no-op.
+ * \endrststar
+ *
+ * @param cfg the new configuration.
+ *
+ * @throws std::invalid_argument if the \p max_limbs member of \p cfg is larger than \f$2^{19}\f$.
+ */
+MPPP_DLL_PUBLIC void set_integer_cache_config(const integer_cache_config &cfg);
+
+/// Reset the configuration of the \link mppp::integer integer\endlink caches for the calling thread.
+/**
+ * After a call to this function, the cache of the calling thread follows again the global
+ * configuration.
+ */
+MPPP_DLL_PUBLIC void reset_integer_cache_config();
+
+/// Get the global configuration of the \link mppp::integer integer\endlink caches.
+/**
+ * @return the configuration used by the threads which did not set their own configuration
+ * via mppp::set_integer_cache_config().
+ */
+MPPP_DLL_PUBLIC integer_cache_config get_global_integer_cache_config();
+
+/// Set the global configuration of the \link mppp::integer integer\endlink caches.
+/**
+ * \rststar
+ * The new configuration is adopted by the threads which did not set their own configuration
+ * via :cpp:func:`~mppp::set_integer_cache_config()`. Each thread adopts it the next time it
+ * uses its cache.
+ *
+ * It is safe to call this function concurrently from different threads.
+ * \endrststar
+ *
+ * @param cfg the new configuration.
+ *
+ * @throws std::invalid_argument if the \p max_limbs member of \p cfg is larger than \f$2^{19}\f$.
+ */
+MPPP_DLL_PUBLIC void set_global_integer_cache_config(const integer_cache_config &cfg);
+
+/// Statistics about the \link mppp::integer integer\endlink caches.
+/**
+ * \rststar
+ * The statistics are collected only if mp++ was built with the ``MPPP_WITH_CACHE_STATS``
+ * option (which is enabled by default) and on platforms supporting thread local storage.
+ * Otherwise, all the members are zero.
+ * \endrststar
+ */
+struct integer_cache_counters {
+    /// Number of allocations served from the caches.
+    unsigned long long hits = 0;
+    /// Number of allocations which could not be served from the caches.
+    unsigned long long misses = 0;
+    /// Number of arrays of limbs freed by the caches.
+    /**
+     * This includes the arrays which could not be cached, and the arrays
+     * removed from the caches because of a change of configuration
+     * or because of mppp::free_integer_caches().
+     */
+    unsigned long long evictions = 0;
+    /// Number of bytes currently held by the caches.
+    unsigned long long bytes_held = 0;
+    /// Maximum number of bytes held by the caches.
+    /**
+     * In the aggregate statistics returned by mppp::global_integer_cache_stats(),
+     * this is the sum of the high-water marks of the individual threads.
+     */
+    unsigned long long high_water_mark = 0;
+};
+
+/// Get the statistics about the \link mppp::integer integer\endlink cache of the calling thread.
+/**
+ * @return the statistics about the cache of the calling thread.
+ */
+MPPP_DLL_PUBLIC integer_cache_counters integer_cache_stats();
+
+/// Get the aggregate statistics about the \link mppp::integer integer\endlink caches.
+/**
+ * \rststar
+ * The statistics of all the threads which used their cache, including the threads which have
+ * already exited, are added together. The snapshot is not atomic: the statistics of each thread
+ * are read while the thread might be updating them.
+ *
+ * It is safe to call this function concurrently from different threads.
+ * \endrststar
+ *
+ * @return the aggregate statistics about the caches of all the threads.
+ */
+MPPP_DLL_PUBLIC integer_cache_counters global_integer_cache_stats();
+
 /** @} */
 
 /** @defgroup integer_operators integer_operators
@@ -0,0 +1,164 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef MPPP_INTEGER_ACCUMULATOR_HPP
+#define MPPP_INTEGER_ACCUMULATOR_HPP
+
+#include <mp++/config.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+#include <mp++/detail/gmp.hpp>
+#include <mp++/detail/type_traits.hpp>
+#include <mp++/detail/utils.hpp>
+#include <mp++/integer.hpp>
+
+namespace mppp
+{
+
+// Accumulator for sums of products.
+//
+// The products of static operands are added into fixed-size limb buffers, one for the
+// positive and one for the negative products. The carries out of each limb are not
+// propagated when a product is added, they are counted separately and added in bulk
+// only when the counters might overflow or when the result is requested. Products
+// involving dynamic operands are accumulated into a regular integer.
+template <std::size_t SSize>
+class integer_accumulator
+{
+    // NOTE: the product of two static operands has at most 2 * SSize limbs,
+    // the extra limb at the top absorbs the carries.
+    static constexpr std::size_t s_width = 2u * SSize + 1u;
+    using limbs_t = std::array<::mp_limb_t, s_width>;
+
+public:
+    integer_accumulator() = default;
+
+    // Add the product of a and b.
+    void addmul(const integer<SSize> &a, const integer<SSize> &b)
+    {
+        if (mppp_likely(a.is_static() && b.is_static())) {
+            const auto &sa = a._get_union().g_st(), &sb = b._get_union().g_st();
+            if (sa._mp_size == 0 || sb._mp_size == 0) {
+                return;
+            }
+            // NOTE: index 0 for positive products, 1 for negative products.
+            const auto idx = static_cast<std::size_t>((sa._mp_size < 0) != (sb._mp_size < 0));
+            const auto asize = static_cast<std::size_t>(sa._mp_size >= 0 ? sa._mp_size : -sa._mp_size),
+                       bsize = static_cast<std::size_t>(sb._mp_size >= 0 ? sb._mp_size : -sb._mp_size);
+            if (mppp_unlikely(m_count == GMP_NUMB_MAX)) {
+                flush();
+            }
+            ++m_count;
+            if (asize == 1u && bsize == 1u) {
+                ::mp_limb_t hi;
+                const auto lo = detail::dlimb_mul(sa.m_limbs[0], sb.m_limbs[0], &hi);
+                add_limbs(idx, lo, hi);
+            } else {
+                std::array<::mp_limb_t, 2u * SSize> prod;
+                // NOTE: mpn_mul() requires the first operand to be at least as large as the second.
+                if (asize >= bsize) {
+                    ::mpn_mul(prod.data(), sa.m_limbs.data(), static_cast<::mp_size_t>(asize), sb.m_limbs.data(),
+                              static_cast<::mp_size_t>(bsize));
+                } else {
+                    ::mpn_mul(prod.data(), sb.m_limbs.data(), static_cast<::mp_size_t>(bsize), sa.m_limbs.data(),
+                              static_cast<::mp_size_t>(asize));
+                }
+                auto &acc = m_acc[idx];
+                auto &cy = m_cy[idx];
+                for (std::size_t i = 0; i < asize + bsize; ++i) {
+                    acc[i] += prod[i];
+                    cy[i + 1u] += static_cast<::mp_limb_t>(acc[i] < prod[i]);
+                }
+            }
+            return;
+        }
+        mppp::addmul(m_rest, a, b);
+    }
+
+    // Return the accumulated value, and reset the accumulator to zero.
+    integer<SSize> finalize()
+    {
+        flush();
+        integer<SSize> retval{std::move(m_rest)};
+        for (std::size_t idx = 0; idx < 2u; ++idx) {
+            auto size = s_width;
+            while (size != 0u && m_acc[idx][size - 1u] == 0u) {
+                --size;
+            }
+            if (size != 0u) {
+                const integer<SSize> tmp{m_acc[idx].data(), size};
+                if (idx == 0u) {
+                    retval += tmp;
+                } else {
+                    retval -= tmp;
+                }
+            }
+        }
+        m_acc = {};
+        m_count = 0;
+        m_rest.set_zero();
+        return retval;
+    }
+
+private:
+    // Add the double limb (hi, lo) to the buffer at index idx.
+    void add_limbs(std::size_t idx, ::mp_limb_t lo, ::mp_limb_t hi)
+    {
+        auto &acc = m_acc[idx];
+        auto &cy = m_cy[idx];
+        acc[0] += lo;
+        cy[1] += static_cast<::mp_limb_t>(acc[0] < lo);
+        acc[1] += hi;
+        cy[2] += static_cast<::mp_limb_t>(acc[1] < hi);
+    }
+    // Add the pending carries to the buffers.
+    void flush()
+    {
+        for (std::size_t idx = 0; idx < 2u; ++idx) {
+            // NOTE: cy[0] is always zero.
+            const auto c = ::mpn_add_n(m_acc[idx].data() + 1, m_acc[idx].data() + 1, m_cy[idx].data() + 1,
+                                       static_cast<::mp_size_t>(s_width - 1u));
+            detail::ignore(c);
+            assert(c == 0u);
+        }
+        m_cy = {};
+        m_count = 0;
+    }
+
+    std::array<limbs_t, 2> m_acc{};
+    std::array<limbs_t, 2> m_cy{};
+    // Number of products added since the last flush. Each product increases
+    // each carry counter by at most 1.
+    ::mp_limb_t m_count = 0;
+    integer<SSize> m_rest;
+};
+
+// Dot product.
+//
+// Computes the sum of the products of the elements in [first1, last1) with the
+// corresponding elements in the range beginning at first2, via integer_accumulator.
+template <typename It1, typename It2, typename T = typename std::iterator_traits<It1>::value_type,
+          detail::enable_if_t<detail::is_integer<T>::value, int> = 0>
+inline T dot(It1 first1, It1 last1, It2 first2)
+{
+    integer_accumulator<T::ssize> acc;
+    for (; first1 != last1; ++first1, ++first2) {
+        acc.addmul(*first1, *first2);
+    }
+    return acc.finalize();
+}
+
+} // namespace mppp
+
+#endif
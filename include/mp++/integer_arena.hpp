@@ -0,0 +1,87 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef MPPP_INTEGER_ARENA_HPP
+#define MPPP_INTEGER_ARENA_HPP
+
+#include <mp++/config.hpp>
+
+#include <cstddef>
+
+#include <mp++/detail/gmp.hpp>
+#include <mp++/detail/visibility.hpp>
+
+namespace mppp
+{
+
+namespace detail
+{
+
+// Monotonic buffer from which the limbs of the dynamic integers are allocated.
+struct mpz_arena;
+
+// The arenas of a thread.
+struct mpz_arena_thread;
+
+#if defined(MPPP_HAVE_THREAD_LOCAL)
+
+// Get a reference to the pointer to the arenas of the calling
+// thread. The pointer is null if the thread has no arena.
+mpz_arena_thread *&get_thread_local_mpz_arena();
+
+// Init rop with space for at least nlimbs limbs from the active arena of the thread,
+// returning false (without doing anything) if no arena is active.
+bool mpz_arena_init(mpz_arena_thread &, mpz_struct_t &, std::size_t);
+
+// Release the limbs of m if they were allocated from an arena of the thread,
+// returning false (without doing anything) otherwise.
+bool mpz_arena_clear(mpz_arena_thread &, mpz_struct_t &);
+
+// Suspend the active arena of the calling thread, returning it (null if no arena is
+// active). No arena is active until the arena is restored via mpz_arena_resume().
+mpz_arena *mpz_arena_suspend();
+void mpz_arena_resume(mpz_arena *);
+
+#endif
+
+} // namespace detail
+
+// Scoped arena for the dynamic storage of integers.
+//
+// While an arena is alive, the limbs of the integers switching to dynamic storage in the thread which
+// created it are allocated from a monotonic buffer owned by the arena, and they are never individually
+// freed. The memory is returned to the system when the arena is destroyed, unless some integers
+// allocated from it are still alive (in which case it is kept until the last of them is destroyed).
+class MPPP_DLL_PUBLIC integer_arena
+{
+public:
+    // Default size (in bytes) of the first block of memory of the arena.
+    static constexpr std::size_t default_block_size = 65536;
+
+    explicit integer_arena(std::size_t = default_block_size);
+    integer_arena(const integer_arena &) = delete;
+    integer_arena(integer_arena &&) = delete;
+    integer_arena &operator=(const integer_arena &) = delete;
+    integer_arena &operator=(integer_arena &&) = delete;
+    ~integer_arena();
+
+    // Total number of bytes allocated from the arena.
+    std::size_t allocated() const;
+    // Total number of bytes reserved by the arena.
+    std::size_t reserved() const;
+    // Number of arrays of limbs allocated from the arena
+    // which have not been released yet.
+    std::size_t live() const;
+
+private:
+    detail::mpz_arena *m_arena;
+};
+
+} // namespace mppp
+
+#endif
@@ -0,0 +1,376 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef MPPP_INTEGER_VECTOR_HPP
+#define MPPP_INTEGER_VECTOR_HPP
+
+#include <mp++/config.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <mp++/detail/gmp.hpp>
+#include <mp++/detail/utils.hpp>
+#include <mp++/detail/visibility.hpp>
+#include <mp++/integer.hpp>
+
+namespace mppp
+{
+
+namespace detail
+{
+
+// SIMD kernels for 1-limb integer vectors, implemented in integer_vector_simd.cpp.
+//
+// The kernels compute the elements whose operands and result can be represented
+// as signed 64-bit integers, and they append the indices of the other elements
+// (which are left untouched in the output) to the last argument.
+MPPP_DLL_PUBLIC int integer_vector_simd_level();
+
+MPPP_DLL_PUBLIC void integer_vector_set_simd_level(int);
+
+MPPP_DLL_PUBLIC void integer_vector_simd_add(mpz_size_t *, ::mp_limb_t *, const mpz_size_t *, const ::mp_limb_t *,
+                                             const mpz_size_t *, const ::mp_limb_t *, std::size_t,
+                                             std::vector<std::size_t> &);
+
+MPPP_DLL_PUBLIC void integer_vector_simd_sub(mpz_size_t *, ::mp_limb_t *, const mpz_size_t *, const ::mp_limb_t *,
+                                             const mpz_size_t *, const ::mp_limb_t *, std::size_t,
+                                             std::vector<std::size_t> &);
+
+MPPP_DLL_PUBLIC void integer_vector_simd_mul(mpz_size_t *, ::mp_limb_t *, const mpz_size_t *, const ::mp_limb_t *,
+                                             const mpz_size_t *, const ::mp_limb_t *, std::size_t,
+                                             std::vector<std::size_t> &);
+
+MPPP_DLL_PUBLIC void integer_vector_simd_mul_2exp(mpz_size_t *, ::mp_limb_t *, const mpz_size_t *,
+                                                  const ::mp_limb_t *, std::size_t, unsigned,
+                                                  std::vector<std::size_t> &);
+
+MPPP_DLL_PUBLIC void integer_vector_simd_cmp(int *, const mpz_size_t *, const ::mp_limb_t *, const mpz_size_t *,
+                                             const ::mp_limb_t *, std::size_t, std::vector<std::size_t> &);
+
+} // namespace detail
+
+// Vector of integers in structure-of-arrays layout.
+//
+// The signed sizes and the limbs of the elements are stored in two separate
+// contiguous arrays (SSize limbs per element). The elements which do not fit
+// in static storage are stored in a side table, and they are marked via a special
+// size value. The batch kernels run a tight loop on the static elements, and they
+// compute the results involving dynamic operands (or overflowing the static
+// storage) afterwards. For SSize == 1, the static loop of some kernels is
+// vectorised if the CPU supports it.
+template <std::size_t SSize>
+class integer_vector
+{
+    using s_int = detail::static_int<SSize>;
+    // Size value marking the dynamic elements.
+    static constexpr detail::mpz_size_t s_dyn = std::numeric_limits<detail::mpz_size_t>::max();
+
+public:
+    using value_type = integer<SSize>;
+
+    integer_vector() = default;
+    // Constructor from size, the elements are initialised to zero.
+    explicit integer_vector(std::size_t n) : m_sizes(n), m_limbs(n * SSize) {}
+
+    std::size_t size() const
+    {
+        return m_sizes.size();
+    }
+    // Resize, the new elements are initialised to zero.
+    void resize(std::size_t n)
+    {
+        for (std::size_t i = n; i < size(); ++i) {
+            if (m_sizes[i] == s_dyn) {
+                m_dyn.erase(i);
+            }
+        }
+        m_sizes.resize(n);
+        m_limbs.resize(n * SSize);
+    }
+    void push_back(const integer<SSize> &n)
+    {
+        m_sizes.push_back(0);
+        m_limbs.resize(m_limbs.size() + SSize);
+        set(size() - 1u, n);
+    }
+
+    // Element access.
+    integer<SSize> get(std::size_t i) const
+    {
+        assert(i < size());
+        if (mppp_unlikely(m_sizes[i] == s_dyn)) {
+            return m_dyn.find(i)->second;
+        }
+        integer<SSize> retval;
+        load(retval._get_union().g_st(), i);
+        return retval;
+    }
+    void set(std::size_t i, const integer<SSize> &n)
+    {
+        assert(i < size());
+        if (n.is_static()) {
+            store(i, n._get_union().g_st());
+        } else if (n.size() <= SSize) {
+            // NOTE: store the values which fit in static storage as
+            // static elements, regardless of the storage type of n.
+            auto tmp(n);
+            tmp.demote();
+            store(i, tmp._get_union().g_st());
+        } else {
+            m_sizes[i] = s_dyn;
+            m_dyn[i] = n;
+        }
+    }
+    bool is_static(std::size_t i) const
+    {
+        assert(i < size());
+        return m_sizes[i] != s_dyn;
+    }
+    // Number of elements stored in dynamic storage.
+    std::size_t n_dynamic() const
+    {
+        return m_dyn.size();
+    }
+
+    // Batch kernels: rop[i] = a[i] op b[i].
+    friend integer_vector &add(integer_vector &rop, const integer_vector &a, const integer_vector &b)
+    {
+        rop.binary_op(
+            "add", a, b, [](s_int &r, const s_int &x, const s_int &y) { return detail::static_addsub<true>(r, x, y); },
+            [](const integer<SSize> &x, const integer<SSize> &y) { return x + y; }, detail::integer_vector_simd_add);
+        return rop;
+    }
+    friend integer_vector &sub(integer_vector &rop, const integer_vector &a, const integer_vector &b)
+    {
+        rop.binary_op(
+            "sub", a, b, [](s_int &r, const s_int &x, const s_int &y) { return detail::static_addsub<false>(r, x, y); },
+            [](const integer<SSize> &x, const integer<SSize> &y) { return x - y; }, detail::integer_vector_simd_sub);
+        return rop;
+    }
+    friend integer_vector &mul(integer_vector &rop, const integer_vector &a, const integer_vector &b)
+    {
+        rop.binary_op(
+            "mul", a, b, [](s_int &r, const s_int &x, const s_int &y) { return detail::static_mul(r, x, y) == 0u; },
+            [](const integer<SSize> &x, const integer<SSize> &y) { return x * y; }, detail::integer_vector_simd_mul);
+        return rop;
+    }
+    // rop[i] += a[i] * b[i].
+    friend integer_vector &addmul(integer_vector &rop, const integer_vector &a, const integer_vector &b)
+    {
+        check_sizes(rop, a, "addmul");
+        check_sizes(a, b, "addmul");
+        std::vector<std::size_t> fixups;
+        s_int r, x, y;
+        const auto n = a.size();
+        for (std::size_t i = 0; i < n; ++i) {
+            if (mppp_unlikely(rop.m_sizes[i] == s_dyn || a.m_sizes[i] == s_dyn || b.m_sizes[i] == s_dyn)) {
+                fixups.push_back(i);
+                continue;
+            }
+            rop.load(r, i);
+            a.load(x, i);
+            b.load(y, i);
+            if (mppp_likely(detail::static_addsubmul<true>(r, x, y) == 0u)) {
+                rop.store(i, r);
+            } else {
+                fixups.push_back(i);
+            }
+        }
+        for (const auto i : fixups) {
+            auto tmp = rop.get(i);
+            mppp::addmul(tmp, a.get(i), b.get(i));
+            rop.set(i, tmp);
+        }
+        return rop;
+    }
+    // rop[i] = a[i] * 2**s.
+    friend integer_vector &mul_2exp(integer_vector &rop, const integer_vector &a, ::mp_bitcnt_t s)
+    {
+        rop.resize(a.size());
+        std::vector<std::size_t> fixups;
+        const auto s_size = detail::safe_cast<std::size_t>(s);
+        s_int r, x;
+        const auto st_step = [&rop, &a, &fixups, &r, &x, s_size](std::size_t i) {
+            if (mppp_unlikely(a.m_sizes[i] == s_dyn)) {
+                fixups.push_back(i);
+                return;
+            }
+            a.load(x, i);
+            if (mppp_likely(detail::static_mul_2exp(r, x, s_size) == 0u)) {
+                rop.store(i, r);
+            } else {
+                fixups.push_back(i);
+            }
+        };
+        const auto n = a.size();
+        if (use_simd() && s < unsigned(GMP_NUMB_BITS)) {
+            std::vector<std::size_t> pending;
+            detail::integer_vector_simd_mul_2exp(rop.m_sizes.data(), rop.m_limbs.data(), a.m_sizes.data(),
+                                                 a.m_limbs.data(), n, static_cast<unsigned>(s), pending);
+            rop.purge_dyn();
+            for (const auto i : pending) {
+                st_step(i);
+            }
+        } else {
+            for (std::size_t i = 0; i < n; ++i) {
+                st_step(i);
+            }
+        }
+        for (const auto i : fixups) {
+            integer<SSize> tmp;
+            mppp::mul_2exp(tmp, a.get(i), s);
+            rop.set(i, tmp);
+        }
+        return rop;
+    }
+    // out[i] = cmp(a[i], b[i]).
+    friend void cmp(std::vector<int> &out, const integer_vector &a, const integer_vector &b)
+    {
+        check_sizes(a, b, "cmp");
+        const auto n = a.size();
+        out.resize(n);
+        s_int x, y;
+        const auto st_step = [&out, &a, &b, &x, &y](std::size_t i) {
+            if (mppp_unlikely(a.m_sizes[i] == s_dyn || b.m_sizes[i] == s_dyn)) {
+                out[i] = mppp::cmp(a.get(i), b.get(i));
+                return;
+            }
+            a.load(x, i);
+            b.load(y, i);
+            out[i] = detail::static_cmp(x, y);
+        };
+        if (use_simd()) {
+            std::vector<std::size_t> pending;
+            detail::integer_vector_simd_cmp(out.data(), a.m_sizes.data(), a.m_limbs.data(), b.m_sizes.data(),
+                                            b.m_limbs.data(), n, pending);
+            for (const auto i : pending) {
+                st_step(i);
+            }
+        } else {
+            for (std::size_t i = 0; i < n; ++i) {
+                st_step(i);
+            }
+        }
+    }
+
+private:
+    static void check_sizes(const integer_vector &a, const integer_vector &b, const char *op)
+    {
+        if (mppp_unlikely(a.size() != b.size())) {
+            throw std::invalid_argument("Cannot perform the batch operation '" + std::string(op)
+                                        + "' on integer vectors of different sizes (" + detail::to_string(a.size())
+                                        + " and " + detail::to_string(b.size()) + ")");
+        }
+    }
+    // Copy the static element at index i into x.
+    void load(s_int &x, std::size_t i) const
+    {
+        assert(m_sizes[i] != s_dyn);
+        x._mp_size = m_sizes[i];
+        const auto ptr = m_limbs.data() + i * SSize;
+        // NOTE: the unused limbs are always zero in the limbs array, which
+        // is what static_int expects for SSize <= opt_size.
+        detail::copy_limbs_no(ptr, ptr + (SSize <= s_int::opt_size ? SSize : x.abs_size()), x.m_limbs.data());
+    }
+    // Store x as the element at index i.
+    void store(std::size_t i, const s_int &x)
+    {
+        if (mppp_unlikely(m_sizes[i] == s_dyn)) {
+            m_dyn.erase(i);
+        }
+        const auto ptr = m_limbs.data() + i * SSize;
+        if (SSize <= s_int::opt_size) {
+            detail::copy_limbs_no(x.m_limbs.data(), x.m_limbs.data() + SSize, ptr);
+        } else {
+            // NOTE: the unused limbs of x might be uninitialised.
+            const auto asize = static_cast<std::size_t>(x.abs_size());
+            detail::copy_limbs_no(x.m_limbs.data(), x.m_limbs.data() + asize, ptr);
+            std::fill(ptr + asize, ptr + SSize, ::mp_limb_t(0));
+        }
+        m_sizes[i] = x._mp_size;
+    }
+    // Check if the SIMD kernels can be used.
+    static bool use_simd()
+    {
+        return SSize == 1u && detail::integer_vector_simd_level() != 0;
+    }
+    // Remove the side table entries of the dynamic elements
+    // which were overwritten by a SIMD kernel.
+    void purge_dyn()
+    {
+        for (auto it = m_dyn.begin(); it != m_dyn.end();) {
+            if (m_sizes[it->first] != s_dyn) {
+                it = m_dyn.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    template <typename F, typename G, typename H>
+    void binary_op(const char *op, const integer_vector &a, const integer_vector &b, const F &st_op, const G &dyn_op,
+                   const H &simd_op)
+    {
+        check_sizes(a, b, op);
+        resize(a.size());
+        // The indices of the elements which will be computed via integer arithmetic.
+        std::vector<std::size_t> fixups;
+        s_int r, x, y;
+        const auto st_step = [this, &a, &b, &st_op, &fixups, &r, &x, &y](std::size_t i) {
+            if (mppp_unlikely(a.m_sizes[i] == s_dyn || b.m_sizes[i] == s_dyn)) {
+                fixups.push_back(i);
+                return;
+            }
+            a.load(x, i);
+            b.load(y, i);
+            if (mppp_likely(st_op(r, x, y))) {
+                store(i, r);
+            } else {
+                fixups.push_back(i);
+            }
+        };
+        const auto n = a.size();
+        if (use_simd()) {
+            // NOTE: the elements not computed by the SIMD kernel go
+            // through the scalar static implementation first.
+            std::vector<std::size_t> pending;
+            simd_op(m_sizes.data(), m_limbs.data(), a.m_sizes.data(), a.m_limbs.data(), b.m_sizes.data(),
+                    b.m_limbs.data(), n, pending);
+            purge_dyn();
+            for (const auto i : pending) {
+                st_step(i);
+            }
+        } else {
+            for (std::size_t i = 0; i < n; ++i) {
+                st_step(i);
+            }
+        }
+        // NOTE: the elements at the indices in fixups have not been written
+        // to, so this works also if this coincides with a and/or b.
+        for (const auto i : fixups) {
+            set(i, dyn_op(a.get(i), b.get(i)));
+        }
+    }
+
+    std::vector<detail::mpz_size_t> m_sizes;
+    std::vector<::mp_limb_t> m_limbs;
+    std::unordered_map<std::size_t, integer<SSize>> m_dyn;
+};
+
+template <std::size_t SSize>
+constexpr detail::mpz_size_t integer_vector<SSize>::s_dyn;
+
+} // namespace mppp
+
+#endif
@@ -0,0 +1,476 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef MPPP_MOD_CONTEXT_HPP
+#define MPPP_MOD_CONTEXT_HPP
+
+#include <mp++/config.hpp>
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+
+#include <mp++/detail/gmp.hpp>
+#include <mp++/detail/utils.hpp>
+#include <mp++/exceptions.hpp>
+#include <mp++/integer.hpp>
+
+namespace mppp
+{
+
+namespace detail
+{
+
+// Division by invariant integers via precomputed reciprocals, as described in
+// Möller and Granlund, "Improved division by invariant integers" (2011).
+// The divisors must be normalised (i.e., the top bit must be set) and the
+// double-limb multiplication primitives must be available.
+
+// Compute v = floor((B**2 - 1) / d) - B, with B = 2**GMP_NUMB_BITS.
+inline ::mp_limb_t integer_barrett_inv_1(::mp_limb_t d)
+{
+    assert(d >> (GMP_NUMB_BITS - 1));
+    // NOTE: B**2 - 1 - B * d = (B - 1 - d) * B + (B - 1).
+    const std::array<::mp_limb_t, 2> num{{GMP_NUMB_MAX, GMP_NUMB_MAX - d}};
+    std::array<::mp_limb_t, 2> q;
+    ::mp_limb_t r;
+    ::mpn_tdiv_qr(q.data(), &r, 0, num.data(), 2, &d, 1);
+    assert(q[1] == 0u);
+    return q[0];
+}
+
+// Compute v = floor((B**3 - 1) / (d1, d0)) - B.
+inline ::mp_limb_t integer_barrett_inv_2(::mp_limb_t d1, ::mp_limb_t d0)
+{
+    assert(d1 >> (GMP_NUMB_BITS - 1));
+    // NOTE: B**3 - 1 - B * (d1, d0) = (B - 1 - d1, B - 1 - d0, B - 1).
+    const std::array<::mp_limb_t, 3> num{{GMP_NUMB_MAX, GMP_NUMB_MAX - d0, GMP_NUMB_MAX - d1}};
+    const std::array<::mp_limb_t, 2> d{{d0, d1}};
+    std::array<::mp_limb_t, 2> q, r;
+    ::mpn_tdiv_qr(q.data(), r.data(), 0, num.data(), 3, d.data(), 2);
+    assert(q[1] == 0u);
+    return q[0];
+}
+
+// Remainder of (u1, u0) divided by d, with v = integer_barrett_inv_1(d). Requires u1 < d.
+inline ::mp_limb_t integer_barrett_rem_2by1(::mp_limb_t u1, ::mp_limb_t u0, ::mp_limb_t d, ::mp_limb_t v)
+{
+    assert(u1 < d);
+    ::mp_limb_t q1, q0 = dlimb_mul(v, u1, &q1);
+    // (q1, q0) += (u1 + 1, u0).
+    q1 += u1 + 1u + limb_add_overflow(q0, u0, &q0);
+    auto r = u0 - q1 * d;
+    // NOTE: this condition is unpredictable, use a mask rather than a branch.
+    r += (::mp_limb_t(0) - static_cast<::mp_limb_t>(r > q0)) & d;
+    if (mppp_unlikely(r >= d)) {
+        r -= d;
+    }
+    return r;
+}
+
+// Remainder of (u2, u1, u0) divided by (d1, d0), with v = integer_barrett_inv_2(d1, d0).
+// Requires (u2, u1) < (d1, d0).
+inline void integer_barrett_rem_3by2(std::array<::mp_limb_t, 2> &r, ::mp_limb_t u2, ::mp_limb_t u1, ::mp_limb_t u0,
+                                     ::mp_limb_t d1, ::mp_limb_t d0, ::mp_limb_t v)
+{
+    assert(u2 < d1 || (u2 == d1 && u1 < d0));
+    ::mp_limb_t q1, q0 = dlimb_mul(v, u2, &q1);
+    // (q1, q0) += (u2, u1).
+    q1 += u2 + limb_add_overflow(q0, u1, &q0);
+    // (r1, r0) = (u1 - q1 * d1, u0) - (d1, d0) - q1 * d0, modulo B**2.
+    auto r1 = u1 - q1 * d1, r0 = u0 - d0;
+    r1 -= d1 + static_cast<::mp_limb_t>(u0 < d0);
+    ::mp_limb_t t1;
+    const auto t0 = dlimb_mul(d0, q1, &t1);
+    r1 -= t1 + static_cast<::mp_limb_t>(r0 < t0);
+    r0 -= t0;
+    // Adjust the remainder.
+    const auto mask = ::mp_limb_t(0) - static_cast<::mp_limb_t>(r1 >= q0);
+    r1 += (mask & d1) + limb_add_overflow(r0, mask & d0, &r0);
+    if (mppp_unlikely(r1 > d1 || (r1 == d1 && r0 >= d0))) {
+        r1 -= d1 + static_cast<::mp_limb_t>(r0 < d0);
+        r0 -= d0;
+    }
+    r[0] = r0;
+    r[1] = r1;
+}
+
+// Limb idx of u * 2**s, where u has n limbs. idx must be in the [0, n] range.
+inline ::mp_limb_t integer_barrett_shl_limb(const ::mp_limb_t *u, std::size_t n, unsigned s, std::size_t idx)
+{
+    assert(idx <= n);
+    const ::mp_limb_t lo = (s && idx) ? u[idx - 1u] >> (unsigned(GMP_NUMB_BITS) - s) : 0u;
+    return idx < n ? (u[idx] << s) | lo : lo;
+}
+
+// Remainder of the n-limb number u divided by d * 2**-s. d must be the normalised divisor
+// and v its reciprocal.
+// NOTE: the remainder of u divided by d * 2**-s is the remainder of u * 2**s divided by d,
+// shifted right by s bits. The limbs of u * 2**s are computed on the fly.
+inline ::mp_limb_t integer_barrett_mod_1(const ::mp_limb_t *u, std::size_t n, ::mp_limb_t d, unsigned s,
+                                         ::mp_limb_t v)
+{
+    // NOTE: the top limb of u * 2**s is always less than d.
+    auto r = integer_barrett_shl_limb(u, n, s, n);
+    for (auto i = n; i > 0u; --i) {
+        r = integer_barrett_rem_2by1(r, integer_barrett_shl_limb(u, n, s, i - 1u), d, v);
+    }
+    return r >> s;
+}
+
+// Shift the 2-limb value r right by s bits.
+inline void integer_barrett_shr_2(std::array<::mp_limb_t, 2> &r, unsigned s)
+{
+    if (s) {
+        r[0] = (r[0] >> s) | (r[1] << (unsigned(GMP_NUMB_BITS) - s));
+        r[1] >>= s;
+    }
+}
+
+// Same as above, with a 2-limb divisor. n must be nonzero.
+inline void integer_barrett_mod_2(std::array<::mp_limb_t, 2> &r, const ::mp_limb_t *u, std::size_t n,
+                                  const std::array<::mp_limb_t, 2> &d, unsigned s, ::mp_limb_t v)
+{
+    assert(n > 0u);
+    // NOTE: the top limb of u * 2**s is less than d[1], hence the top
+    // two limbs of u * 2**s are less than d.
+    r[1] = integer_barrett_shl_limb(u, n, s, n);
+    r[0] = integer_barrett_shl_limb(u, n, s, n - 1u);
+    for (auto i = n - 1u; i > 0u; --i) {
+        integer_barrett_rem_3by2(r, r[1], r[0], integer_barrett_shl_limb(u, n, s, i - 1u), d[1], d[0], v);
+    }
+    integer_barrett_shr_2(r, s);
+}
+
+} // namespace detail
+
+// Modular arithmetic context.
+//
+// This class precomputes, for a fixed modulus, the data needed to perform
+// modular reductions without divisions: a reciprocal for the division by invariant
+// integers and, for odd moduli, the Montgomery constants. The precomputed
+// data is used whenever the modulus has at most 2 limbs and fits in static storage;
+// otherwise, the computations are forwarded to GMP.
+template <std::size_t SSize>
+class mod_context
+{
+    template <std::size_t N>
+    using limbs_t = std::array<::mp_limb_t, N>;
+
+public:
+    explicit mod_context(const integer<SSize> &mod) : m_mod(abs(mod))
+    {
+        if (mppp_unlikely(m_mod.is_zero())) {
+            throw zero_division_error("Cannot create a modular context with a zero modulus");
+        }
+        if (!detail::integer_have_dlimb_mul::value || m_mod.size() > 2u || m_mod.size() > SSize) {
+            // The modulus is too large, or the double-limb primitives are
+            // not available: everything will go through GMP.
+            return;
+        }
+        // NOTE: the modulus fits in static storage, make sure it is stored there.
+        m_mod.demote();
+        m_nlimbs = static_cast<unsigned>(m_mod.size());
+        const auto ptr = m_mod._get_union().g_st().m_limbs.data();
+        detail::copy_limbs_no(ptr, ptr + m_nlimbs, m_n.data());
+        // Normalise the modulus and compute the reciprocal.
+        m_shift = static_cast<unsigned>(detail::builtin_clz(m_n[m_nlimbs - 1u]));
+        m_dn[0] = m_n[0] << m_shift;
+        if (m_nlimbs == 1u) {
+            m_binv = detail::integer_barrett_inv_1(m_dn[0]);
+        } else {
+            m_dn[1] = m_shift ? (m_n[1] << m_shift) | (m_n[0] >> (unsigned(GMP_NUMB_BITS) - m_shift)) : m_n[1];
+            m_binv = detail::integer_barrett_inv_2(m_dn[1], m_dn[0]);
+        }
+        if (m_n[0] & 1u) {
+            // Odd modulus: compute the Montgomery constant and R**2 mod n.
+            m_ninv = detail::integer_mont_ninv(m_n[0]);
+            limbs_t<5> r2{};
+            r2[m_nlimbs * 2u] = 1u;
+            if (m_nlimbs == 1u) {
+                limbs_t<1> tmp;
+                reduce_limbs(tmp, r2.data(), 3);
+                m_r2[0] = tmp[0];
+            } else {
+                reduce_limbs(m_r2, r2.data(), 5);
+            }
+        }
+    }
+
+    // Getter for the modulus (always positive).
+    const integer<SSize> &get_mod() const
+    {
+        return m_mod;
+    }
+
+    // Modular reduction.
+    integer<SSize> &reduce(integer<SSize> &rop, const integer<SSize> &n) const
+    {
+        if (mppp_likely(m_nlimbs == 1u)) {
+            reduce_impl<1>(rop, n);
+        } else if (m_nlimbs == 2u) {
+            reduce_impl<2>(rop, n);
+        } else {
+            MPPP_MAYBE_TLS detail::mpz_raii tmp;
+            ::mpz_mod(&tmp.m_mpz, n.get_mpz_view(), m_mod.get_mpz_view());
+            rop = &tmp.m_mpz;
+        }
+        return rop;
+    }
+    integer<SSize> reduce(const integer<SSize> &n) const
+    {
+        integer<SSize> retval;
+        reduce(retval, n);
+        return retval;
+    }
+
+    // Modular multiplication.
+    integer<SSize> &mulm(integer<SSize> &rop, const integer<SSize> &a, const integer<SSize> &b) const
+    {
+        if (mppp_likely(m_nlimbs == 1u)) {
+            mulm_impl<1>(rop, a, b);
+        } else if (m_nlimbs == 2u) {
+            mulm_impl<2>(rop, a, b);
+        } else {
+            MPPP_MAYBE_TLS detail::mpz_raii tmp;
+            ::mpz_mul(&tmp.m_mpz, a.get_mpz_view(), b.get_mpz_view());
+            ::mpz_mod(&tmp.m_mpz, &tmp.m_mpz, m_mod.get_mpz_view());
+            rop = &tmp.m_mpz;
+        }
+        return rop;
+    }
+    integer<SSize> mulm(const integer<SSize> &a, const integer<SSize> &b) const
+    {
+        integer<SSize> retval;
+        mulm(retval, a, b);
+        return retval;
+    }
+
+    // Modular squaring.
+    integer<SSize> &sqrm(integer<SSize> &rop, const integer<SSize> &n) const
+    {
+        if (mppp_likely(m_nlimbs == 1u)) {
+            sqrm_impl<1>(rop, n);
+        } else if (m_nlimbs == 2u) {
+            sqrm_impl<2>(rop, n);
+        } else {
+            MPPP_MAYBE_TLS detail::mpz_raii tmp;
+            ::mpz_mul(&tmp.m_mpz, n.get_mpz_view(), n.get_mpz_view());
+            ::mpz_mod(&tmp.m_mpz, &tmp.m_mpz, m_mod.get_mpz_view());
+            rop = &tmp.m_mpz;
+        }
+        return rop;
+    }
+    integer<SSize> sqrm(const integer<SSize> &n) const
+    {
+        integer<SSize> retval;
+        sqrm(retval, n);
+        return retval;
+    }
+
+    // Modular exponentiation.
+    integer<SSize> &powm(integer<SSize> &rop, const integer<SSize> &base, const integer<SSize> &exp) const
+    {
+        const auto exp_sign = exp.sgn();
+        // NOTE: negative exponents require a modular inversion, let the general-purpose
+        // function deal with them. For even 2-limb moduli, the exponentiation via the
+        // reciprocal is slower than GMP's algorithm, and we use the general-purpose
+        // function as well.
+        if (mppp_unlikely(!m_nlimbs || exp_sign < 0 || (m_nlimbs == 2u && !(m_n[0] & 1u)))) {
+            return mppp::powm(rop, base, exp, m_mod);
+        }
+        if (mppp_unlikely(exp_sign == 0)) {
+            // NOTE: m_mod is positive, this is consistent with mppp::powm().
+            rop = m_mod.is_one() ? 0 : 1;
+            return rop;
+        }
+        if (m_nlimbs == 1u) {
+            powm_impl<1>(rop, base, exp);
+        } else {
+            powm_impl<2>(rop, base, exp);
+        }
+        return rop;
+    }
+    integer<SSize> powm(const integer<SSize> &base, const integer<SSize> &exp) const
+    {
+        integer<SSize> retval;
+        powm(retval, base, exp);
+        return retval;
+    }
+
+private:
+    // Pointer to the limbs of n, regardless of the storage type.
+    static const ::mp_limb_t *limbs_ptr(const integer<SSize> &n)
+    {
+        return n.is_static() ? n._get_union().g_st().m_limbs.data() : n._get_union().g_dy()._mp_d;
+    }
+    // The first N limbs of a.
+    template <std::size_t N>
+    static limbs_t<N> head(const limbs_t<2> &a)
+    {
+        limbs_t<N> retval;
+        detail::copy_limbs_no(a.data(), a.data() + N, retval.data());
+        return retval;
+    }
+    // Reduce the n-limb number u modulo m_mod, writing the result into r.
+    void reduce_limbs(limbs_t<1> &r, const ::mp_limb_t *u, std::size_t n) const
+    {
+        r[0] = detail::integer_barrett_mod_1(u, n, m_dn[0], m_shift, m_binv);
+    }
+    void reduce_limbs(limbs_t<2> &r, const ::mp_limb_t *u, std::size_t n) const
+    {
+        detail::integer_barrett_mod_2(r, u, n, m_dn, m_shift, m_binv);
+    }
+    // Reduce abs(n) modulo m_mod, writing the result into r.
+    template <std::size_t N>
+    void reduce_integer(limbs_t<N> &r, const integer<SSize> &n) const
+    {
+        const auto asize = n.size();
+        const auto ptr = limbs_ptr(n);
+        // Fast paths: abs(n) is already less than m_mod.
+        if (asize < N) {
+            r = limbs_t<N>{};
+            if (asize) {
+                r[0] = ptr[0];
+            }
+            return;
+        }
+        if (asize == N) {
+            detail::copy_limbs_no(ptr, ptr + N, r.data());
+            if (detail::integer_compare_limbs_n(r, head<N>(m_n)) < 0) {
+                return;
+            }
+        }
+        reduce_limbs(r, ptr, asize);
+    }
+    // Modular multiplication of the reduced values a and b.
+    // NOTE: overlap between rop and a/b is allowed.
+    void mulm_limbs(limbs_t<1> &rop, const limbs_t<1> &a, const limbs_t<1> &b) const
+    {
+        ::mp_limb_t hi;
+        const auto lo = detail::dlimb_mul(a[0], b[0], &hi);
+        // NOTE: a * b < m_mod**2, hence the product shifted left by m_shift bits
+        // still fits in 2 limbs, and its top limb is less than m_dn[0].
+        const auto s = m_shift;
+        const auto u1 = s ? (hi << s) | (lo >> (unsigned(GMP_NUMB_BITS) - s)) : hi;
+        rop[0] = detail::integer_barrett_rem_2by1(u1, lo << s, m_dn[0], m_binv) >> s;
+    }
+    void mulm_limbs(limbs_t<2> &rop, const limbs_t<2> &a, const limbs_t<2> &b) const
+    {
+        // Compute the 4-limb product.
+        limbs_t<4> p;
+        auto cy = detail::integer_limb_muladd(&p[0], 0, a[0], b[0], 0);
+        p[2] = detail::integer_limb_muladd(&p[1], 0, a[1], b[0], cy);
+        cy = detail::integer_limb_muladd(&p[1], p[1], a[0], b[1], 0);
+        p[3] = detail::integer_limb_muladd(&p[2], p[2], a[1], b[1], cy);
+        // NOTE: as above, the product shifted left by m_shift bits still fits
+        // in 4 limbs, and its top 2 limbs are less than m_dn. Thus, we can
+        // skip the first step of integer_barrett_mod_2().
+        const auto s = m_shift;
+        limbs_t<2> r{{detail::integer_barrett_shl_limb(p.data(), 4, s, 2),
+                      detail::integer_barrett_shl_limb(p.data(), 4, s, 3)}};
+        detail::integer_barrett_rem_3by2(r, r[1], r[0], detail::integer_barrett_shl_limb(p.data(), 4, s, 1), m_dn[1],
+                                         m_dn[0], m_binv);
+        detail::integer_barrett_rem_3by2(r, r[1], r[0], detail::integer_barrett_shl_limb(p.data(), 4, s, 0), m_dn[1],
+                                         m_dn[0], m_binv);
+        detail::integer_barrett_shr_2(r, s);
+        rop = r;
+    }
+    // Write the reduced value r into rop, negating it modulo m_mod if neg is true.
+    template <std::size_t N>
+    void write_result(integer<SSize> &rop, limbs_t<N> r, bool neg) const
+    {
+        auto size = detail::integer_sub_compute_size(r.data(), static_cast<detail::mpz_size_t>(N));
+        if (neg && size) {
+            detail::integer_sub_limbs_n(r, head<N>(m_n), r);
+            size = detail::integer_sub_compute_size(r.data(), static_cast<detail::mpz_size_t>(N));
+        }
+        if (!rop.is_static()) {
+            rop.set_zero();
+        }
+        auto &st = rop._get_union().g_st();
+        st._mp_size = size;
+        // NOTE: the modulus fits in static storage, hence N <= SSize. The min()
+        // here is needed only to avoid out-of-bounds accesses in the (never executed)
+        // N == 2 code path for SSize == 1.
+        constexpr auto nl = N < SSize ? N : SSize;
+        detail::copy_limbs_no(r.data(), r.data() + nl, st.m_limbs.data());
+        st.zero_upper_limbs(nl);
+    }
+    template <std::size_t N>
+    void reduce_impl(integer<SSize> &rop, const integer<SSize> &n) const
+    {
+        limbs_t<N> r;
+        reduce_integer(r, n);
+        write_result(rop, r, n.sgn() < 0);
+    }
+    template <std::size_t N>
+    void mulm_impl(integer<SSize> &rop, const integer<SSize> &a, const integer<SSize> &b) const
+    {
+        limbs_t<N> ra, rb;
+        reduce_integer(ra, a);
+        reduce_integer(rb, b);
+        mulm_limbs(ra, ra, rb);
+        write_result(rop, ra, (a.sgn() < 0) != (b.sgn() < 0));
+    }
+    template <std::size_t N>
+    void sqrm_impl(integer<SSize> &rop, const integer<SSize> &n) const
+    {
+        limbs_t<N> r;
+        reduce_integer(r, n);
+        mulm_limbs(r, r, r);
+        write_result(rop, r, false);
+    }
+    template <std::size_t N>
+    void powm_impl(integer<SSize> &rop, const integer<SSize> &base, const integer<SSize> &exp) const
+    {
+        limbs_t<N> acc;
+        reduce_integer(acc, base);
+        const auto exp_ptr = limbs_ptr(exp);
+        if (acc != limbs_t<N>{}) {
+            if (m_n[0] & 1u) {
+                // Odd modulus: go through the Montgomery representation.
+                const auto n = head<N>(m_n);
+                const auto ninv = m_ninv;
+                const auto mul = [&n, ninv](limbs_t<N> &r, const limbs_t<N> &x, const limbs_t<N> &y) {
+                    detail::integer_mont_mul(r, x, y, n, ninv);
+                };
+                limbs_t<N> one{};
+                one[0] = 1u;
+                mul(acc, acc, head<N>(m_r2));
+                detail::integer_powm_window(acc, exp_ptr, exp.size(), mul);
+                mul(acc, acc, one);
+            } else {
+                const auto mul = [this](limbs_t<N> &r, const limbs_t<N> &x, const limbs_t<N> &y) {
+                    this->mulm_limbs(r, x, y);
+                };
+                detail::integer_powm_window(acc, exp_ptr, exp.size(), mul);
+            }
+        }
+        write_result(rop, acc, base.sgn() < 0 && (exp_ptr[0] & 1u));
+    }
+
+    // The (absolute value of the) modulus.
+    integer<SSize> m_mod;
+    // The number of limbs of the modulus if the precomputed
+    // data is available, zero otherwise.
+    unsigned m_nlimbs = 0;
+    // The limbs of the modulus, the normalised modulus,
+    // the normalisation shift and the reciprocal.
+    limbs_t<2> m_n{}, m_dn{};
+    unsigned m_shift = 0;
+    ::mp_limb_t m_binv = 0;
+    // Montgomery data (odd moduli only): -m_mod**-1 mod 2**GMP_NUMB_BITS
+    // and R**2 mod m_mod.
+    ::mp_limb_t m_ninv = 0;
+    limbs_t<2> m_r2{};
+};
+
+} // namespace mppp
+
+#endif
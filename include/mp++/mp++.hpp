@@ -11,7 +11,14 @@
 
 #include <mp++/config.hpp>
 #include <mp++/exceptions.hpp>
+#include <mp++/fast_allocator.hpp>
 #include <mp++/integer.hpp>
+#include <mp++/integer_accumulator.hpp>
+#include <mp++/integer_arena.hpp>
+#include <mp++/integer_vector.hpp>
+#include <mp++/mod_context.hpp>
+#include <mp++/parallel.hpp>
+#include <mp++/prime_sieve.hpp>
 #include <mp++/rational.hpp>
 #include <mp++/type_name.hpp>
 
@@ -0,0 +1,176 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef MPPP_PARALLEL_HPP
+#define MPPP_PARALLEL_HPP
+
+#include <mp++/config.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <mp++/detail/type_traits.hpp>
+#include <mp++/detail/visibility.hpp>
+#include <mp++/integer.hpp>
+#include <mp++/integer_accumulator.hpp>
+
+namespace mppp
+{
+
+namespace detail
+{
+
+// Run f(0), ..., f(n - 1) on the global thread pool, and wait for their completion.
+// The first exception thrown by the tasks (if any) is re-thrown.
+MPPP_DLL_PUBLIC void parallel_run(std::size_t, const std::function<void(std::size_t)> &);
+
+// Minimum number of elements per task in the parallel algorithms.
+constexpr std::size_t parallel_min_grain = 1024;
+
+// Random-access iterator over integers.
+template <typename It>
+using is_integer_ra_iterator = conjunction<
+    std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<It>::iterator_category>,
+    is_integer<typename std::iterator_traits<It>::value_type>>;
+
+template <typename It>
+using parallel_value_t = typename std::iterator_traits<It>::value_type;
+
+// Split the [0, n) range into chunks, and run f(begin, end) on each chunk via the thread
+// pool. The return value is the vector of the results of the invocations of f.
+template <typename T, typename F>
+inline std::vector<T> parallel_chunks(std::size_t n, unsigned nthreads, const F &f)
+{
+    // NOTE: use a few chunks per thread, so that the threads
+    // which finish early can steal work from the others.
+    const auto nchunks = std::max(std::size_t(1), std::min(std::size_t(nthreads) * 4u, n / parallel_min_grain));
+    std::vector<T> retval(nchunks);
+    if (nchunks == 1u) {
+        retval[0] = f(std::size_t(0), n);
+    } else {
+        parallel_run(nchunks, [&retval, &f, n, nchunks](std::size_t i) {
+            const auto q = n / nchunks, r = n % nchunks;
+            retval[i] = f(q * i + std::min(i, r), q * (i + 1u) + std::min(i + 1u, r));
+        });
+    }
+    return retval;
+}
+
+// Balanced product of the values in the [first, last) range.
+template <typename It>
+inline parallel_value_t<It> parallel_product_tree(It first, It last)
+{
+    assert(first != last);
+    const auto n = last - first;
+    if (n == 1) {
+        return *first;
+    }
+    if (n == 2) {
+        return *first * *(first + 1);
+    }
+    const auto mid = first + n / 2;
+    return parallel_product_tree(first, mid) * parallel_product_tree(mid, last);
+}
+
+} // namespace detail
+
+namespace parallel
+{
+
+// Number of threads used by the parallel algorithms (including the calling thread).
+MPPP_DLL_PUBLIC unsigned get_n_threads();
+// Set the number of threads used by the parallel algorithms. Zero means
+// the number of hardware threads, which is also the default value.
+// NOTE: the threads of the pool are created lazily, and they are kept alive
+// across invocations of the algorithms.
+MPPP_DLL_PUBLIC void set_n_threads(unsigned);
+
+// Sum of the values in the [first, last) range.
+template <typename It, detail::enable_if_t<detail::is_integer_ra_iterator<It>::value, int> = 0>
+inline detail::parallel_value_t<It> sum(It first, It last)
+{
+    using T = detail::parallel_value_t<It>;
+    auto partials = detail::parallel_chunks<T>(
+        static_cast<std::size_t>(last - first), get_n_threads(), [first](std::size_t begin, std::size_t end) {
+            T retval;
+            const auto e = first + static_cast<std::ptrdiff_t>(end);
+            for (auto it = first + static_cast<std::ptrdiff_t>(begin); it != e; ++it) {
+                retval += *it;
+            }
+            return retval;
+        });
+    for (std::size_t i = 1; i < partials.size(); ++i) {
+        partials[0] += partials[i];
+    }
+    return std::move(partials[0]);
+}
+
+// Product of the values in the [first, last) range.
+//
+// The product is computed via a balanced product tree, so that the multiplications
+// between large operands happen at the top levels of the tree, where they are
+// performed concurrently as much as possible.
+template <typename It, detail::enable_if_t<detail::is_integer_ra_iterator<It>::value, int> = 0>
+inline detail::parallel_value_t<It> product(It first, It last)
+{
+    using T = detail::parallel_value_t<It>;
+    if (first == last) {
+        return T{1};
+    }
+    auto partials = detail::parallel_chunks<T>(
+        static_cast<std::size_t>(last - first), get_n_threads(), [first](std::size_t begin, std::size_t end) {
+            return detail::parallel_product_tree(first + static_cast<std::ptrdiff_t>(begin),
+                                                 first + static_cast<std::ptrdiff_t>(end));
+        });
+    // Combine the partial products pairwise, one level of the tree at a time.
+    while (partials.size() > 1u) {
+        const auto npairs = partials.size() / 2u;
+        detail::parallel_run(npairs, [&partials](std::size_t i) { partials[2u * i] *= partials[2u * i + 1u]; });
+        for (std::size_t i = 2; i < partials.size(); i += 2u) {
+            partials[i / 2u] = std::move(partials[i]);
+        }
+        partials.resize(partials.size() - npairs);
+    }
+    return std::move(partials[0]);
+}
+
+// Dot product.
+//
+// Computes the sum of the products of the values in the [first1, last1) range
+// with the corresponding values in the range beginning at first2.
+template <typename It1, typename It2,
+          detail::enable_if_t<
+              detail::conjunction<detail::is_integer_ra_iterator<It1>, detail::is_integer_ra_iterator<It2>,
+                                  std::is_same<detail::parallel_value_t<It1>, detail::parallel_value_t<It2>>>::value,
+              int> = 0>
+inline detail::parallel_value_t<It1> dot(It1 first1, It1 last1, It2 first2)
+{
+    using T = detail::parallel_value_t<It1>;
+    auto partials = detail::parallel_chunks<T>(static_cast<std::size_t>(last1 - first1), get_n_threads(),
+                                               [first1, first2](std::size_t begin, std::size_t end) {
+                                                   const auto b = static_cast<std::ptrdiff_t>(begin),
+                                                              e = static_cast<std::ptrdiff_t>(end);
+                                                   return mppp::dot(first1 + b, first1 + e, first2 + b);
+                                               });
+    for (std::size_t i = 1; i < partials.size(); ++i) {
+        partials[0] += partials[i];
+    }
+    return std::move(partials[0]);
+}
+
+} // namespace parallel
+
+} // namespace mppp
+
+#endif
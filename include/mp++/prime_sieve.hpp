@@ -0,0 +1,228 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef MPPP_PRIME_SIEVE_HPP
+#define MPPP_PRIME_SIEVE_HPP
+
+#include <mp++/config.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include <mp++/detail/visibility.hpp>
+#include <mp++/integer.hpp>
+
+namespace mppp
+{
+
+namespace detail
+{
+
+// Values up to (but excluding) this limit can be sieved. Above it, the base
+// primes and the per-block bookkeeping of the sieve become too large,
+// and primes are enumerated via nextprime() instead.
+constexpr std::uint64_t prime_sieve_limit = std::uint64_t(1) << 48;
+
+MPPP_DLL_PUBLIC std::uint64_t prime_sieve_isqrt(std::uint64_t);
+
+MPPP_DLL_PUBLIC std::vector<std::uint32_t> prime_sieve_base(std::uint64_t);
+
+MPPP_DLL_PUBLIC void prime_sieve_segment(const std::vector<std::uint32_t> &, std::uint64_t, std::uint64_t,
+                                         std::vector<std::uint64_t> &);
+
+MPPP_DLL_PUBLIC void prime_sieve(std::uint64_t, std::uint64_t, std::vector<std::uint64_t> &, unsigned);
+
+// Determine the portion of the [lo, hi) range which will be sieved. The return
+// value is the end of the sieved portion (which begins at lo), and it is equal to lo if
+// no sieving takes place.
+// NOTE: the cost of the sieve includes a part proportional to sqrt(hi), which
+// dominates when the range is short. In such case, calling nextprime()
+// repeatedly is faster.
+template <std::size_t SSize>
+inline std::uint64_t prime_sieve_end(const integer<SSize> &lo, const integer<SSize> &hi)
+{
+    assert(lo.sgn() >= 0);
+    if (lo >= prime_sieve_limit) {
+        return 0;
+    }
+    const auto l = static_cast<std::uint64_t>(lo);
+    const auto h = hi < prime_sieve_limit ? static_cast<std::uint64_t>(hi) : prime_sieve_limit;
+    return (h > l && (h - l) * 16u >= prime_sieve_isqrt(h)) ? h : l;
+}
+
+} // namespace detail
+
+// Enumerate the primes in a range.
+//
+// out will be cleared and then filled with the primes p such that lo <= p < hi, in
+// ascending order. Values below detail::prime_sieve_limit are enumerated via a segmented
+// sieve of Eratosthenes (if the range is long enough to amortise the cost of the sieve),
+// using up to nthreads threads (zero means the number of hardware threads). The remaining
+// values are enumerated via nextprime().
+template <std::size_t SSize>
+inline void primes_in(const integer<SSize> &lo, const integer<SSize> &hi, std::vector<integer<SSize>> &out,
+                      unsigned nthreads = 1)
+{
+    out.clear();
+    // NOTE: the smallest prime is 2.
+    integer<SSize> cur{lo.sgn() < 0 ? integer<SSize>{} : lo};
+    if (hi <= cur) {
+        return;
+    }
+    const auto s_end = detail::prime_sieve_end(cur, hi);
+    if (cur < s_end) {
+        std::vector<std::uint64_t> tmp;
+        detail::prime_sieve(static_cast<std::uint64_t>(cur), s_end, tmp, nthreads);
+        out.reserve(tmp.size());
+        for (auto p : tmp) {
+            out.emplace_back(p);
+        }
+        cur = s_end;
+    }
+    // Enumerate the rest of the range via nextprime().
+    --cur;
+    for (cur.nextprime(); cur < hi; cur.nextprime()) {
+        out.push_back(cur);
+    }
+}
+
+// Range of prime numbers.
+//
+// This class represents the primes p such that lo <= p < hi, which are
+// generated lazily while iterating via a single-pass input iterator. The algorithms
+// are the same as in primes_in(), with the sieve proceeding one segment at a time.
+template <std::size_t SSize>
+class prime_range
+{
+public:
+    class iterator
+    {
+        friend class prime_range;
+        explicit iterator(prime_range *r) : m_range(r) {}
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = integer<SSize>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const integer<SSize> *;
+        using reference = const integer<SSize> &;
+
+        iterator() = default;
+        reference operator*() const
+        {
+            assert(m_range != nullptr);
+            return m_range->m_cur;
+        }
+        pointer operator->() const
+        {
+            return &**this;
+        }
+        iterator &operator++()
+        {
+            assert(m_range != nullptr);
+            if (!m_range->advance()) {
+                m_range = nullptr;
+            }
+            return *this;
+        }
+        void operator++(int)
+        {
+            ++*this;
+        }
+        friend bool operator==(const iterator &a, const iterator &b)
+        {
+            return a.m_range == b.m_range;
+        }
+        friend bool operator!=(const iterator &a, const iterator &b)
+        {
+            return !(a == b);
+        }
+
+    private:
+        prime_range *m_range = nullptr;
+    };
+
+    prime_range(const integer<SSize> &lo, const integer<SSize> &hi)
+        : m_cur(lo.sgn() < 0 ? integer<SSize>{} : lo), m_hi(hi)
+    {
+        if (m_hi <= m_cur) {
+            m_done = true;
+            return;
+        }
+        m_seg_lo = static_cast<std::uint64_t>(
+            m_cur < detail::prime_sieve_limit ? m_cur : integer<SSize>{detail::prime_sieve_limit});
+        m_seg_end = detail::prime_sieve_end(m_cur, m_hi);
+        if (m_seg_lo < m_seg_end) {
+            m_base = detail::prime_sieve_base(m_seg_end);
+            // NOTE: sieve in segments which are large enough to amortise
+            // the setup cost of each call to the segment sieve.
+            m_seg_size = std::max(std::uint64_t(1) << 21, 2u * detail::prime_sieve_isqrt(m_seg_end));
+        }
+        --m_cur;
+        m_done = !advance();
+    }
+    // NOTE: the iterators refer to this object.
+    prime_range(const prime_range &) = delete;
+    prime_range(prime_range &&) = delete;
+    prime_range &operator=(const prime_range &) = delete;
+    prime_range &operator=(prime_range &&) = delete;
+
+    iterator begin()
+    {
+        return iterator{m_done ? nullptr : this};
+    }
+    iterator end()
+    {
+        return iterator{};
+    }
+
+private:
+    // Move to the next prime, returning false if there are no more primes in the range.
+    bool advance()
+    {
+        while (m_idx == m_buffer.size() && m_seg_lo < m_seg_end) {
+            // Sieve the next segment.
+            const auto seg_hi = std::min(m_seg_end, m_seg_lo + m_seg_size);
+            m_buffer.clear();
+            m_idx = 0;
+            detail::prime_sieve_segment(m_base, m_seg_lo, seg_hi, m_buffer);
+            m_seg_lo = seg_hi;
+        }
+        if (m_idx < m_buffer.size()) {
+            m_cur = m_buffer[m_idx++];
+            return true;
+        }
+        // The sieved portion of the range (if any) has been exhausted,
+        // continue via nextprime() from its end.
+        if (m_cur < m_seg_end) {
+            m_cur = m_seg_end;
+            --m_cur;
+        }
+        m_cur.nextprime();
+        return m_cur < m_hi;
+    }
+
+    integer<SSize> m_cur;
+    integer<SSize> m_hi;
+    bool m_done = false;
+    // Sieve state: the segment [m_seg_lo, m_seg_end) remains to be sieved.
+    std::uint64_t m_seg_lo = 0;
+    std::uint64_t m_seg_end = 0;
+    std::uint64_t m_seg_size = 0;
+    std::vector<std::uint32_t> m_base;
+    std::vector<std::uint64_t> m_buffer;
+    std::size_t m_idx = 0;
+};
+
+} // namespace mppp
+
+#endif
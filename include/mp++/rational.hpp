@@ -2975,10 +2975,10 @@ inline rational<SSize> &canonicalise(rational<SSize> &rop)
 template <std::size_t SSize>
 inline std::size_t hash(const rational<SSize> &q)
 {
-    // NOTE: just return the sum of the hashes. We are already doing
-    // some hashing in the integers, hopefully this is enough to obtain
-    // decent hashing on the rational as well.
-    return hash(q.get_num()) + hash(q.get_den());
+    // NOTE: mix the 64-bit hashes of numerator and denominator, so that
+    // (unlike, e.g., with a sum) swapping them changes the hash value.
+    return static_cast<std::size_t>(
+        detail::hash_mix(detail::hash64(q.get_num()) ^ detail::hash_p2, detail::hash64(q.get_den()) ^ detail::hash_p3));
 }
 
 /** @} */
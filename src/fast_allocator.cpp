@@ -0,0 +1,608 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+#if defined(_WIN32)
+
+#include <malloc.h>
+
+#else
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#endif
+
+#include <mp++/config.hpp>
+#include <mp++/detail/gmp.hpp>
+#include <mp++/detail/utils.hpp>
+#include <mp++/fast_allocator.hpp>
+
+namespace mppp
+{
+
+namespace detail
+{
+
+namespace
+{
+
+// The memory of the allocator is organised in spans, which are regions of memory
+// aligned to their size. The requests up to fast_alloc_max_small bytes are rounded up
+// to one of the size classes, and they are served from spans, each subdivided
+// in blocks of the same size class. The span is located by masking the address
+// of a block, and its header is stored at the beginning of the span.
+// NOTE: the larger requests are passed on to the memory functions which were in use
+// when the allocator was installed. The system allocator handles them just as well,
+// and it can grow them in place.
+constexpr unsigned fast_alloc_span_bits = 18;
+constexpr std::size_t fast_alloc_span_size = std::size_t(1) << fast_alloc_span_bits;
+constexpr std::size_t fast_alloc_header_size = 256;
+constexpr std::size_t fast_alloc_max_small = 8192;
+// The size classes are the multiples of 16 bytes up to 128 bytes, and then
+// 4 classes in each interval between consecutive powers of 2.
+constexpr std::size_t fast_alloc_n_classes = 32;
+// Number of empty spans kept by each thread for reuse. The additional empty
+// spans are trimmed (that is, their memory is returned to the operating system)
+// and moved to a global pool.
+constexpr std::size_t fast_alloc_max_empty = 2;
+
+struct fast_alloc_heap;
+
+struct fast_alloc_span {
+    // NOTE: these members can be accessed by any thread.
+    // The heap owning the span (null for empty spans).
+    std::atomic<fast_alloc_heap *> owner;
+    // The blocks freed by threads other than the owner, linked via their first bytes.
+    std::atomic<void *> remote;
+    // Whether the owner has stopped allocating from the span because it was full.
+    // The first thread freeing a block after the span has been flagged as full
+    // hands it back to the owner via the reclaimed stack of the owner.
+    std::atomic<bool> full;
+    fast_alloc_span *reclaim_next;
+    // NOTE: the following members are accessed only by the owner.
+    void *free_list;
+    char *bump;
+    char *end;
+    // Number of allocated blocks, including the ones in the remote list.
+    std::size_t used;
+    std::size_t block_size;
+    unsigned cls;
+    // Whether the span is in the list of its size class in the owner.
+    bool listed;
+    fast_alloc_span *prev;
+    fast_alloc_span *next;
+};
+
+static_assert(sizeof(fast_alloc_span) <= fast_alloc_header_size, "Invalid span header size.");
+
+// The allocator state of a thread.
+// NOTE: the heaps are never destroyed. When a thread exits,
+// its heap is handed over to the next thread needing one.
+struct fast_alloc_heap {
+    // For each size class, the list of spans with free blocks. The first
+    // span of each list is the one the blocks are allocated from.
+    std::array<fast_alloc_span *, fast_alloc_n_classes> lists{};
+    // The empty spans kept for reuse.
+    fast_alloc_span *empty = nullptr;
+    std::size_t n_empty = 0;
+    // Spans handed back by other threads.
+    std::atomic<fast_alloc_span *> reclaimed{nullptr};
+    fast_alloc_heap *pool_next = nullptr;
+};
+
+// Tables of the size classes, filled in when the allocator is installed.
+std::array<unsigned char, fast_alloc_max_small / 16u> fast_alloc_class_table;
+std::array<std::size_t, fast_alloc_n_classes> fast_alloc_class_sizes;
+
+void fast_alloc_init_tables()
+{
+    std::size_t cls = 0;
+    for (std::size_t size = 16; size <= 128u; size += 16u) {
+        fast_alloc_class_sizes[cls++] = size;
+    }
+    for (std::size_t p = 128; p < fast_alloc_max_small; p *= 2u) {
+        for (std::size_t j = 1; j <= 4u; ++j) {
+            fast_alloc_class_sizes[cls++] = p + j * (p / 4u);
+        }
+    }
+    assert(cls == fast_alloc_n_classes);
+    cls = 0;
+    for (std::size_t i = 0; i < fast_alloc_class_table.size(); ++i) {
+        while (fast_alloc_class_sizes[cls] < (i + 1u) * 16u) {
+            ++cls;
+        }
+        fast_alloc_class_table[i] = static_cast<unsigned char>(cls);
+    }
+}
+
+// Map of the spans of the allocator. For each region of the address space
+// of the size of a span, it records whether the region begins with a span.
+// This allows to tell apart the blocks of the allocator from the memory
+// allocated by other means.
+enum : unsigned char { fast_alloc_region_none, fast_alloc_region_small };
+
+constexpr unsigned fast_alloc_addr_bits = 48;
+constexpr unsigned fast_alloc_leaf_bits = 16;
+constexpr unsigned fast_alloc_top_bits = fast_alloc_addr_bits - fast_alloc_span_bits - fast_alloc_leaf_bits;
+
+struct fast_alloc_leaf {
+    std::array<std::atomic<unsigned char>, std::size_t(1) << fast_alloc_leaf_bits> kinds;
+};
+
+std::atomic<fast_alloc_leaf *> fast_alloc_pagemap[std::size_t(1) << fast_alloc_top_bits];
+
+unsigned char fast_alloc_region_kind(const void *ptr)
+{
+    const auto addr = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(ptr));
+    if (mppp_unlikely((addr >> fast_alloc_addr_bits) != 0u)) {
+        return fast_alloc_region_none;
+    }
+    const auto region = addr >> fast_alloc_span_bits;
+    const auto leaf = fast_alloc_pagemap[region >> fast_alloc_leaf_bits].load(std::memory_order_acquire);
+    if (!leaf) {
+        return fast_alloc_region_none;
+    }
+    // NOTE: the region of a block was recorded before the block was handed out,
+    // and the block was passed to the current thread via some synchronisation.
+    return leaf->kinds[region & ((std::uint64_t(1) << fast_alloc_leaf_bits) - 1u)].load(std::memory_order_relaxed);
+}
+
+// Record the kind of the region beginning at span. Returns false
+// if the region is outside the range covered by the map.
+bool fast_alloc_set_region_kind(const void *span, unsigned char kind)
+{
+    const auto addr = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(span));
+    if ((addr >> fast_alloc_addr_bits) != 0u) {
+        // LCOV_EXCL_START
+        return false;
+        // LCOV_EXCL_STOP
+    }
+    const auto region = addr >> fast_alloc_span_bits;
+    auto &top = fast_alloc_pagemap[region >> fast_alloc_leaf_bits];
+    auto leaf = top.load(std::memory_order_acquire);
+    if (!leaf) {
+        // NOTE: the leaves are never freed.
+        auto new_leaf = new fast_alloc_leaf;
+        for (auto &k : new_leaf->kinds) {
+            k.store(fast_alloc_region_none, std::memory_order_relaxed);
+        }
+        if (top.compare_exchange_strong(leaf, new_leaf, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            leaf = new_leaf;
+        } else {
+            delete new_leaf;
+        }
+    }
+    leaf->kinds[region & ((std::uint64_t(1) << fast_alloc_leaf_bits) - 1u)].store(kind, std::memory_order_relaxed);
+    return true;
+}
+
+fast_alloc_span *fast_alloc_span_of(const void *ptr)
+{
+    return reinterpret_cast<fast_alloc_span *>(reinterpret_cast<std::uintptr_t>(ptr)
+                                               & ~static_cast<std::uintptr_t>(fast_alloc_span_size - 1u));
+}
+
+// Allocation of the memory of the spans, aligned to the size of a span.
+// NOTE: the spans are never freed, their memory is trimmed instead.
+void *fast_alloc_aligned_alloc(std::size_t size)
+{
+#if defined(_WIN32)
+    return ::_aligned_malloc(size, fast_alloc_span_size);
+#else
+    void *retval;
+    return ::posix_memalign(&retval, fast_alloc_span_size, size) ? nullptr : retval;
+#endif
+}
+
+// Return the memory of an empty span to the operating system.
+void fast_alloc_trim(fast_alloc_span *s)
+{
+#if defined(_WIN32)
+    ignore(s);
+#else
+    static const auto page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    // NOTE: keep the page containing the header.
+    const auto begin = (fast_alloc_header_size + page_size - 1u) / page_size * page_size;
+    if (begin < fast_alloc_span_size) {
+        // NOTE: the span will be reinitialised before being used again, so
+        // the contents of its blocks can be discarded.
+        ::madvise(reinterpret_cast<char *>(s) + begin, fast_alloc_span_size - begin, MADV_DONTNEED);
+    }
+#endif
+}
+
+// The memory functions which were in use when the allocator was installed.
+void *(*fast_alloc_prev_alloc)(std::size_t) = nullptr;
+void *(*fast_alloc_prev_realloc)(void *, std::size_t, std::size_t) = nullptr;
+void (*fast_alloc_prev_free)(void *, std::size_t) = nullptr;
+
+std::mutex fast_alloc_mutex;
+std::atomic<bool> fast_alloc_installed{false};
+// Global pools of empty (trimmed) spans and of the heaps of the exited threads.
+// Both are protected by fast_alloc_mutex.
+fast_alloc_span *fast_alloc_span_pool = nullptr;
+fast_alloc_heap *fast_alloc_heap_pool = nullptr;
+
+// Management of the lists of the size classes.
+void fast_alloc_list_push_front(fast_alloc_heap &h, fast_alloc_span *s)
+{
+    auto &head = h.lists[s->cls];
+    s->prev = nullptr;
+    s->next = head;
+    if (head) {
+        head->prev = s;
+    }
+    head = s;
+    s->listed = true;
+}
+
+void fast_alloc_list_remove(fast_alloc_heap &h, fast_alloc_span *s)
+{
+    assert(s->listed);
+    if (s->prev) {
+        s->prev->next = s->next;
+    } else {
+        h.lists[s->cls] = s->next;
+    }
+    if (s->next) {
+        s->next->prev = s->prev;
+    }
+    s->listed = false;
+}
+
+// Move the blocks in the remote list of the span s to its free list.
+void fast_alloc_collect(fast_alloc_span *s)
+{
+    auto ptr = s->remote.exchange(nullptr, std::memory_order_acquire);
+    while (ptr) {
+        void *next;
+        std::memcpy(&next, ptr, sizeof(void *));
+        std::memcpy(ptr, &s->free_list, sizeof(void *));
+        s->free_list = ptr;
+        assert(s->used > 0u);
+        --s->used;
+        ptr = next;
+    }
+}
+
+// Move the spans handed back by other threads to the lists of the heap h.
+void fast_alloc_drain_reclaimed(fast_alloc_heap &h)
+{
+    auto s = h.reclaimed.exchange(nullptr, std::memory_order_acquire);
+    while (s) {
+        const auto next = s->reclaim_next;
+        // NOTE: a span may have changed owner after being handed back, if it
+        // became empty in the meantime.
+        if (s->owner.load(std::memory_order_relaxed) == &h && !s->listed) {
+            fast_alloc_list_push_front(h, s);
+        }
+        s = next;
+    }
+}
+
+// Give an empty span to the global pool.
+void fast_alloc_pool_span(fast_alloc_span *s)
+{
+    fast_alloc_trim(s);
+    std::lock_guard<std::mutex> lock(fast_alloc_mutex);
+    s->next = fast_alloc_span_pool;
+    fast_alloc_span_pool = s;
+}
+
+// Release the empty span s of the heap h.
+void fast_alloc_release_span(fast_alloc_heap &h, fast_alloc_span *s)
+{
+    assert(s->used == 0u && !s->listed);
+    assert(s->remote.load(std::memory_order_relaxed) == nullptr);
+    s->owner.store(nullptr, std::memory_order_relaxed);
+    if (h.n_empty < fast_alloc_max_empty) {
+        s->next = h.empty;
+        h.empty = s;
+        ++h.n_empty;
+    } else {
+        fast_alloc_pool_span(s);
+    }
+}
+
+// Get a new span for the size class cls of the heap h.
+fast_alloc_span *fast_alloc_new_span(fast_alloc_heap &h, unsigned cls)
+{
+    fast_alloc_span *s = h.empty;
+    if (s) {
+        h.empty = s->next;
+        --h.n_empty;
+    } else {
+        {
+            std::lock_guard<std::mutex> lock(fast_alloc_mutex);
+            s = fast_alloc_span_pool;
+            if (s) {
+                fast_alloc_span_pool = s->next;
+            }
+        }
+        if (!s) {
+            s = static_cast<fast_alloc_span *>(fast_alloc_aligned_alloc(fast_alloc_span_size));
+            // LCOV_EXCL_START
+            if (mppp_unlikely(!s)) {
+                std::abort();
+            }
+            if (mppp_unlikely(!fast_alloc_set_region_kind(s, fast_alloc_region_small))) {
+                std::abort();
+            }
+            // LCOV_EXCL_STOP
+            // NOTE: construct the atomic members.
+            new (&s->owner) std::atomic<fast_alloc_heap *>(nullptr);
+            new (&s->remote) std::atomic<void *>(nullptr);
+            new (&s->full) std::atomic<bool>(false);
+        }
+    }
+    const auto bs = fast_alloc_class_sizes[cls];
+    s->owner.store(&h, std::memory_order_relaxed);
+    s->full.store(false, std::memory_order_relaxed);
+    s->reclaim_next = nullptr;
+    s->free_list = nullptr;
+    s->bump = reinterpret_cast<char *>(s) + fast_alloc_header_size;
+    s->end = s->bump + (fast_alloc_span_size - fast_alloc_header_size) / bs * bs;
+    s->used = 0;
+    s->block_size = bs;
+    s->cls = cls;
+    s->listed = false;
+    return s;
+}
+
+// Allocate a block from the span s, returning null if the span is full.
+inline void *fast_alloc_from_span(fast_alloc_span *s)
+{
+    void *retval = s->free_list;
+    if (retval) {
+        std::memcpy(&s->free_list, retval, sizeof(void *));
+    } else if (s->bump != s->end) {
+        retval = s->bump;
+        s->bump += s->block_size;
+    } else {
+        return nullptr;
+    }
+    ++s->used;
+    return retval;
+}
+
+void *fast_alloc_small_slow(fast_alloc_heap &h, unsigned cls)
+{
+    fast_alloc_drain_reclaimed(h);
+    auto s = h.lists[cls];
+    while (s) {
+        fast_alloc_collect(s);
+        const auto next = s->next;
+        if (s->free_list || s->bump != s->end) {
+            // Allocate from this span from now on.
+            if (s != h.lists[cls]) {
+                fast_alloc_list_remove(h, s);
+                fast_alloc_list_push_front(h, s);
+            }
+            return fast_alloc_from_span(s);
+        }
+        // The span is full: drop it from the list, and flag it so that
+        // the first thread freeing one of its blocks hands it back.
+        fast_alloc_list_remove(h, s);
+        s->full.store(true);
+        if (s->remote.load() != nullptr && s->full.exchange(false)) {
+            // Some blocks were freed in the meantime.
+            fast_alloc_list_push_front(h, s);
+            continue;
+        }
+        s = next;
+    }
+    s = fast_alloc_new_span(h, cls);
+    fast_alloc_list_push_front(h, s);
+    return fast_alloc_from_span(s);
+}
+
+// Return the memory of the heap h to the global pool, keeping only the spans with live blocks.
+void fast_alloc_trim_heap(fast_alloc_heap &h)
+{
+    fast_alloc_drain_reclaimed(h);
+    for (auto &head : h.lists) {
+        for (auto s = head; s;) {
+            const auto next = s->next;
+            fast_alloc_collect(s);
+            if (s->used == 0u) {
+                fast_alloc_list_remove(h, s);
+                s->owner.store(nullptr, std::memory_order_relaxed);
+                fast_alloc_pool_span(s);
+            }
+            s = next;
+        }
+    }
+    while (h.empty) {
+        const auto s = h.empty;
+        h.empty = s->next;
+        fast_alloc_pool_span(s);
+    }
+    h.n_empty = 0;
+}
+
+#if defined(MPPP_HAVE_THREAD_LOCAL)
+
+// The heap of the thread.
+// NOTE: the pointer is trivially destructible, so that it can be
+// used safely during the destruction of the other thread-local objects.
+thread_local fast_alloc_heap *fast_alloc_tls_heap = nullptr;
+// Whether the heap of the thread has already been given back.
+thread_local bool fast_alloc_tls_done = false;
+
+// Give back the heap of the thread on thread exit.
+struct fast_alloc_heap_guard {
+    ~fast_alloc_heap_guard()
+    {
+        const auto h = fast_alloc_tls_heap;
+        fast_alloc_tls_heap = nullptr;
+        fast_alloc_tls_done = true;
+        if (h) {
+            fast_alloc_trim_heap(*h);
+            std::lock_guard<std::mutex> lock(fast_alloc_mutex);
+            h->pool_next = fast_alloc_heap_pool;
+            fast_alloc_heap_pool = h;
+        }
+    }
+};
+
+fast_alloc_heap *fast_alloc_get_heap()
+{
+    if (mppp_likely(fast_alloc_tls_heap != nullptr)) {
+        return fast_alloc_tls_heap;
+    }
+    if (fast_alloc_tls_done) {
+        // The thread is exiting.
+        return nullptr;
+    }
+    thread_local fast_alloc_heap_guard guard;
+    ignore(guard);
+    fast_alloc_heap *h;
+    {
+        std::lock_guard<std::mutex> lock(fast_alloc_mutex);
+        h = fast_alloc_heap_pool;
+        if (h) {
+            fast_alloc_heap_pool = h->pool_next;
+        }
+    }
+    if (!h) {
+        h = new fast_alloc_heap;
+    }
+    fast_alloc_tls_heap = h;
+    return h;
+}
+
+#else
+
+fast_alloc_heap *fast_alloc_get_heap()
+{
+    return nullptr;
+}
+
+#endif
+
+// Free a block of the small span s.
+void fast_alloc_free_small(fast_alloc_span *s, void *ptr)
+{
+#if defined(MPPP_HAVE_THREAD_LOCAL)
+    const auto h = fast_alloc_tls_heap;
+#else
+    const fast_alloc_heap *h = nullptr;
+#endif
+    const auto owner = s->owner.load(std::memory_order_relaxed);
+    if (mppp_likely(owner == h && h != nullptr)) {
+        std::memcpy(ptr, &s->free_list, sizeof(void *));
+        s->free_list = ptr;
+        --s->used;
+        if (!s->listed) {
+            // The span was flagged as full, put it back in
+            // its list unless another thread is handing it back.
+            if (s->full.exchange(false)) {
+                fast_alloc_list_push_front(*owner, s);
+            }
+        } else if (s->used == 0u && s != owner->lists[s->cls]) {
+            fast_alloc_list_remove(*owner, s);
+            fast_alloc_release_span(*owner, s);
+        }
+        return;
+    }
+    // Remote free.
+    auto head = s->remote.load(std::memory_order_relaxed);
+    do {
+        std::memcpy(ptr, &head, sizeof(void *));
+    } while (!s->remote.compare_exchange_weak(head, ptr));
+    if (s->full.load() && s->full.exchange(false)) {
+        // NOTE: the span may have changed owner after the block was pushed to the
+        // remote list, but not after it has been flagged as full by the new owner.
+        auto &rec = s->owner.load(std::memory_order_relaxed)->reclaimed;
+        auto rhead = rec.load(std::memory_order_relaxed);
+        do {
+            s->reclaim_next = rhead;
+        } while (!rec.compare_exchange_weak(rhead, s, std::memory_order_release, std::memory_order_relaxed));
+    }
+}
+
+// The memory functions of the allocator.
+void *fast_alloc_alloc(std::size_t size)
+{
+    if (size <= fast_alloc_max_small) {
+        const auto h = fast_alloc_get_heap();
+        if (mppp_likely(h != nullptr)) {
+            const unsigned cls = fast_alloc_class_table[size ? (size - 1u) >> 4 : 0u];
+            const auto s = h->lists[cls];
+            void *retval;
+            if (mppp_likely(s != nullptr) && (retval = fast_alloc_from_span(s)) != nullptr) {
+                return retval;
+            }
+            return fast_alloc_small_slow(*h, cls);
+        }
+    }
+    return fast_alloc_prev_alloc(size);
+}
+
+void fast_alloc_free(void *ptr, std::size_t size)
+{
+    if (mppp_likely(fast_alloc_region_kind(ptr) == fast_alloc_region_small)) {
+        fast_alloc_free_small(fast_alloc_span_of(ptr), ptr);
+    } else {
+        // NOTE: the memory was not allocated from a span.
+        fast_alloc_prev_free(ptr, size);
+    }
+}
+
+void *fast_alloc_realloc(void *ptr, std::size_t old_size, std::size_t new_size)
+{
+    if (fast_alloc_region_kind(ptr) != fast_alloc_region_small) {
+        return fast_alloc_prev_realloc(ptr, old_size, new_size);
+    }
+    const auto s = fast_alloc_span_of(ptr);
+    // NOTE: the size of the block is known, do not rely on old_size.
+    const auto cur_size = s->block_size;
+    if (new_size <= cur_size && new_size > cur_size / 2u) {
+        return ptr;
+    }
+    const auto retval = fast_alloc_alloc(new_size);
+    std::memcpy(retval, ptr, std::min(cur_size, new_size));
+    fast_alloc_free_small(s, ptr);
+    return retval;
+}
+
+} // namespace
+
+} // namespace detail
+
+void install_fast_allocator()
+{
+#if defined(MPPP_HAVE_THREAD_LOCAL)
+    std::lock_guard<std::mutex> lock(detail::fast_alloc_mutex);
+    if (!detail::fast_alloc_installed.load(std::memory_order_relaxed)) {
+        detail::fast_alloc_init_tables();
+        ::mp_get_memory_functions(&detail::fast_alloc_prev_alloc, &detail::fast_alloc_prev_realloc,
+                                  &detail::fast_alloc_prev_free);
+        ::mp_set_memory_functions(detail::fast_alloc_alloc, detail::fast_alloc_realloc, detail::fast_alloc_free);
+        detail::fast_alloc_installed.store(true, std::memory_order_relaxed);
+    }
+#endif
+}
+
+bool fast_allocator_installed()
+{
+    return detail::fast_alloc_installed.load(std::memory_order_relaxed);
+}
+
+} // namespace mppp
@@ -6,15 +6,23 @@
 // Public License v. 2.0. If a copy of the MPL was not distributed
 // with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
+#include <cctype>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <ios>
 #include <iostream>
 #include <locale>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <string>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -24,6 +32,8 @@
 #include <mp++/detail/type_traits.hpp>
 #include <mp++/detail/utils.hpp>
 #include <mp++/integer.hpp>
+#include <mp++/integer_arena.hpp>
+#include <mp++/parallel.hpp>
 
 namespace mppp
 {
@@ -85,25 +95,196 @@ static_assert(disjunction<std::is_same<::mp_limb_t, unsigned long>, std::is_same
                           std::is_same<::mp_limb_t, unsigned>>::value,
               "Invalid type for mp_limb_t.");
 
-} // namespace
+static_assert(sizeof(::mp_limb_t *) <= sizeof(::mp_limb_t),
+              "The cached arrays of limbs must be able to store a pointer in their first limb.");
 
-void mpz_alloc_cache::clear() noexcept
+// Increase by n a statistics counter of a cache.
+// NOTE: the counters are written only by the thread owning the cache,
+// thus there is no need for an atomic read-modify-write operation.
+void mpz_alloc_cache_stat_add(std::atomic<unsigned long long> &c, unsigned long long n)
 {
-#if !defined(NDEBUG)
-    std::cout << "Cleaning up the mpz alloc cache." << std::endl;
+#if defined(MPPP_WITH_CACHE_STATS)
+    c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+#else
+    ignore(c, n);
+#endif
+}
+
+// Size class in which the arrays with ualloc limbs are stored,
+// or mpz_alloc_cache::n_classes if they cannot be cached.
+std::size_t mpz_alloc_cache_store_class(std::size_t ualloc)
+{
+    assert(ualloc != 0u);
+    if (ualloc <= mpz_alloc_cache::max_size) {
+        return ualloc - 1u;
+    }
+    unsigned k = 0;
+    while ((ualloc >> k) > 1u) {
+        ++k;
+    }
+    if (k < mpz_alloc_cache::min_pow2_bits || k - mpz_alloc_cache::min_pow2_bits >= mpz_alloc_cache::n_pow2_classes) {
+        return mpz_alloc_cache::n_classes;
+    }
+    return mpz_alloc_cache::max_size + (k - mpz_alloc_cache::min_pow2_bits);
+}
+
+// Size class from which the requests for nlimbs limbs are served.
+// nlimbs must not be larger than mpz_alloc_cache::max_cacheable_limbs.
+std::size_t mpz_alloc_cache_request_class(std::size_t nlimbs)
+{
+    assert(nlimbs != 0u && nlimbs <= mpz_alloc_cache::max_cacheable_limbs);
+    if (nlimbs <= mpz_alloc_cache::max_size) {
+        return nlimbs - 1u;
+    }
+    unsigned k = mpz_alloc_cache::min_pow2_bits;
+    while ((std::size_t(1) << k) < nlimbs) {
+        ++k;
+    }
+    return mpz_alloc_cache::max_size + (k - mpz_alloc_cache::min_pow2_bits);
+}
+
+// Size of the smallest request served from the size class idx.
+std::size_t mpz_alloc_cache_class_min_request(std::size_t idx)
+{
+    if (idx < mpz_alloc_cache::max_size) {
+        return idx + 1u;
+    }
+    const auto k = static_cast<unsigned>(idx - mpz_alloc_cache::max_size) + mpz_alloc_cache::min_pow2_bits;
+    return std::max((std::size_t(1) << (k - 1u)) + 1u, mpz_alloc_cache::max_size + 1u);
+}
+
+// Read the link stored in the cached array ptr.
+::mp_limb_t *mpz_alloc_link(const ::mp_limb_t *ptr)
+{
+    ::mp_limb_t *retval;
+    std::memcpy(&retval, static_cast<const void *>(ptr), sizeof(::mp_limb_t *));
+    return retval;
+}
+
+// Store the link next in the cached array ptr.
+void mpz_alloc_set_link(::mp_limb_t *ptr, ::mp_limb_t *next)
+{
+    std::memcpy(static_cast<void *>(ptr), &next, sizeof(::mp_limb_t *));
+}
+
+// Number of limbs of the cached array ptr in the size class idx.
+std::size_t mpz_alloc_array_size(std::size_t idx, const ::mp_limb_t *ptr)
+{
+    return idx < mpz_alloc_cache::max_size ? idx + 1u : static_cast<std::size_t>(ptr[1]);
+}
+
+// Push the array ptr with ualloc limbs into the size class idx.
+void mpz_alloc_cache_push(mpz_alloc_cache &mpzc, std::size_t idx, ::mp_limb_t *ptr, std::size_t ualloc)
+{
+    mpz_alloc_set_link(ptr, mpzc.caches[idx]);
+    if (idx >= mpz_alloc_cache::max_size) {
+        ptr[1] = static_cast<::mp_limb_t>(ualloc);
+    }
+    mpzc.caches[idx] = ptr;
+    ++mpzc.sizes[idx];
+#if defined(MPPP_WITH_CACHE_STATS)
+    const auto bytes = mpzc.bytes_held.load(std::memory_order_relaxed) + ualloc * sizeof(::mp_limb_t);
+    mpzc.bytes_held.store(bytes, std::memory_order_relaxed);
+    if (bytes > mpzc.high_water_mark.load(std::memory_order_relaxed)) {
+        mpzc.high_water_mark.store(bytes, std::memory_order_relaxed);
+    }
+#endif
+}
+
+// Pop an array from the size class idx, which must not be empty.
+// The number of limbs of the array is written into ualloc.
+::mp_limb_t *mpz_alloc_cache_pop(mpz_alloc_cache &mpzc, std::size_t idx, std::size_t &ualloc)
+{
+    assert(mpzc.sizes[idx] != 0u);
+    const auto ptr = mpzc.caches[idx];
+    ualloc = mpz_alloc_array_size(idx, ptr);
+    mpzc.caches[idx] = mpz_alloc_link(ptr);
+    --mpzc.sizes[idx];
+#if defined(MPPP_WITH_CACHE_STATS)
+    mpzc.bytes_held.store(mpzc.bytes_held.load(std::memory_order_relaxed) - ualloc * sizeof(::mp_limb_t),
+                          std::memory_order_relaxed);
 #endif
+    return ptr;
+}
+
+// Free the arrays in the cache until each size class
+// contains at most the number of arrays allowed by the configuration.
+void mpz_alloc_cache_trim(mpz_alloc_cache &mpzc, bool clear_all)
+{
     // Get the GMP free() function.
     void (*ffp)(void *, std::size_t) = nullptr;
     ::mp_get_memory_functions(nullptr, nullptr, &ffp);
     assert(ffp != nullptr);
-    for (std::size_t i = 0; i < max_size; ++i) {
-        // Free all the limbs arrays allocated for this size.
-        for (std::size_t j = 0; j < sizes[i]; ++j) {
-            ffp(static_cast<void *>(caches[i][j]), i + 1u);
+    for (std::size_t i = 0; i < mpz_alloc_cache::n_classes; ++i) {
+        const auto max_entries
+            = (clear_all || mpz_alloc_cache_class_min_request(i) > mpzc.max_limbs) ? std::size_t(0) : mpzc.max_entries;
+        while (mpzc.sizes[i] > max_entries) {
+            std::size_t ualloc;
+            const auto ptr = mpz_alloc_cache_pop(mpzc, i, ualloc);
+            ffp(static_cast<void *>(ptr), ualloc * sizeof(::mp_limb_t));
+            mpz_alloc_cache_stat_add(mpzc.evictions, 1);
+        }
+    }
+}
+
+// The global configuration of the caches and its generation, which is
+// increased each time the configuration changes.
+std::mutex mpz_alloc_cache_mutex;
+integer_cache_config mpz_alloc_cache_global_config;
+std::atomic<unsigned long> mpz_alloc_cache_gen(0);
+// The list of the synchronised caches, and the statistics
+// of the caches which have been destroyed.
+mpz_alloc_cache *mpz_alloc_cache_list = nullptr;
+integer_cache_counters mpz_alloc_cache_retired;
+
+// NOTE: the objects above are protected by mpz_alloc_cache_mutex
+// (apart from mpz_alloc_cache_gen, which is also read without locking).
+
+// Add the statistics of the cache mpzc to out.
+void mpz_alloc_cache_add_stats(integer_cache_counters &out, const mpz_alloc_cache &mpzc)
+{
+    out.hits += mpzc.hits.load(std::memory_order_relaxed);
+    out.misses += mpzc.misses.load(std::memory_order_relaxed);
+    out.evictions += mpzc.evictions.load(std::memory_order_relaxed);
+    out.bytes_held += mpzc.bytes_held.load(std::memory_order_relaxed);
+    out.high_water_mark += mpzc.high_water_mark.load(std::memory_order_relaxed);
+}
+
+void integer_cache_config_check(const integer_cache_config &cfg)
+{
+    if (mppp_unlikely(cfg.max_limbs > mpz_alloc_cache::max_cacheable_limbs)) {
+        throw std::invalid_argument("Invalid integer cache configuration: the maximum number of limbs ("
+                                    + to_string(cfg.max_limbs) + ") is larger than the maximum supported value ("
+                                    + to_string(std::size_t(mpz_alloc_cache::max_cacheable_limbs)) + ")");
+    }
+}
+
+} // namespace
+
+void mpz_alloc_cache::clear() noexcept
+{
+#if !defined(NDEBUG)
+    std::cout << "Cleaning up the mpz alloc cache." << std::endl;
+#endif
+    mpz_alloc_cache_trim(*this, true);
+}
+
+mpz_alloc_cache::~mpz_alloc_cache()
+{
+    clear();
+    if (gen != unsynced_gen) {
+        // Remove the cache from the list of the synchronised
+        // caches, preserving its statistics.
+        std::lock_guard<std::mutex> lock(mpz_alloc_cache_mutex);
+        mpz_alloc_cache_add_stats(mpz_alloc_cache_retired, *this);
+        if (prev) {
+            prev->next = next;
+        } else {
+            mpz_alloc_cache_list = next;
+        }
+        if (next) {
+            next->prev = prev;
         }
-        // Reset the number of limbs array present in this
-        // cache entry.
-        sizes[i] = 0u;
     }
 }
 
@@ -147,26 +328,191 @@ namespace
 // https://en.cppreference.com/w/cpp/language/constant_initialization
 thread_local mpz_alloc_cache mpz_alloc_cache_inst;
 
-// Implementation of the init of an mpz from cache.
-bool mpz_init_from_cache_impl(mpz_struct_t &rop, std::size_t nlimbs)
+// Set the configuration of the cache mpzc, freeing the arrays in excess.
+void mpz_alloc_cache_set_config(mpz_alloc_cache &mpzc, const integer_cache_config &cfg)
+{
+    mpzc.max_entries = cfg.max_entries;
+    mpzc.max_limbs = cfg.max_limbs;
+    mpz_alloc_cache_trim(mpzc, false);
+}
+
+// Synchronise the cache mpzc with the global state: add it to the list
+// of the synchronised caches on first use, and adopt the global
+// configuration unless the cache has its own configuration.
+void mpz_alloc_cache_sync(mpz_alloc_cache &mpzc)
+{
+    std::lock_guard<std::mutex> lock(mpz_alloc_cache_mutex);
+    if (mpzc.gen == mpz_alloc_cache::unsynced_gen) {
+        mpzc.next = mpz_alloc_cache_list;
+        if (mpz_alloc_cache_list) {
+            mpz_alloc_cache_list->prev = &mpzc;
+        }
+        mpz_alloc_cache_list = &mpzc;
+    }
+    if (!mpzc.local) {
+        mpz_alloc_cache_set_config(mpzc, mpz_alloc_cache_global_config);
+    }
+    mpzc.gen = mpz_alloc_cache_gen.load(std::memory_order_relaxed);
+}
+
+// Get the thread local allocation cache, after having
+// synchronised it with the global state if needed.
+mpz_alloc_cache &get_mpz_alloc_cache()
 {
     auto &mpzc = mpz_alloc_cache_inst;
-    if (nlimbs && nlimbs <= mpzc.max_size && mpzc.sizes[nlimbs - 1u]) {
-        // LCOV_EXCL_START
-        if (mppp_unlikely(nlimbs > make_unsigned(nl_max<mpz_alloc_t>()))) {
-            std::abort();
+    if (mppp_unlikely(mpzc.gen != mpz_alloc_cache_gen.load(std::memory_order_relaxed))) {
+        mpz_alloc_cache_sync(mpzc);
+    }
+    return mpzc;
+}
+
+// Global depot of arrays of limbs, used to move arrays between the caches of
+// different threads. This is useful when the integers created by a thread are
+// destroyed by another thread: the cache of the latter moves the arrays it
+// cannot store to the depot, from which the caches of the other threads
+// replenish themselves when they are empty.
+//
+// Each size class of the depot is a lock-free stack of arrays, linked
+// in the same way as in the thread-local caches. The arrays are moved in
+// batches: a batch is pushed onto a stack via compare-and-swap, and the
+// stacks are emptied all at once via an exchange. Because no thread ever
+// reads the link of the top of a stack, the ABA problem cannot arise.
+struct mpz_alloc_depot {
+    // Max number of arrays in each size class.
+    static constexpr std::size_t max_entries = 1024;
+    struct size_class {
+        std::atomic<::mp_limb_t *> head{nullptr};
+        // NOTE: this is an estimate of the number of arrays in the stack,
+        // as it is updated separately from the stack itself.
+        std::atomic<std::size_t> size{0};
+    };
+    std::array<size_class, mpz_alloc_cache::n_classes> classes;
+    // Free all the arrays in the depot.
+    void clear() noexcept
+    {
+        void (*ffp)(void *, std::size_t) = nullptr;
+        ::mp_get_memory_functions(nullptr, nullptr, &ffp);
+        assert(ffp != nullptr);
+        for (std::size_t i = 0; i < mpz_alloc_cache::n_classes; ++i) {
+            auto ptr = classes[i].head.exchange(nullptr, std::memory_order_acquire);
+            std::size_t n = 0;
+            for (; ptr; ++n) {
+                const auto next = mpz_alloc_link(ptr);
+                ffp(static_cast<void *>(ptr), mpz_alloc_array_size(i, ptr) * sizeof(::mp_limb_t));
+                ptr = next;
+            }
+            classes[i].size.fetch_sub(n, std::memory_order_relaxed);
         }
-        // LCOV_EXCL_STOP
-        const auto idx = nlimbs - 1u;
-        rop._mp_alloc = static_cast<mpz_alloc_t>(nlimbs);
+    }
+    ~mpz_alloc_depot()
+    {
+        clear();
+    }
+};
+
+// NOTE: the depot has a constexpr constructor, thus it is
+// initialised before any dynamic initialisation.
+mpz_alloc_depot mpz_alloc_depot_inst;
+
+// Push the chain of arrays [first, last] onto the stack of a size class of the depot.
+void mpz_alloc_depot_push(mpz_alloc_depot::size_class &dc, ::mp_limb_t *first, ::mp_limb_t *last)
+{
+    auto head = dc.head.load(std::memory_order_relaxed);
+    do {
+        mpz_alloc_set_link(last, head);
+    } while (!dc.head.compare_exchange_weak(head, first, std::memory_order_release, std::memory_order_relaxed));
+}
+
+// Move the array ptr with ualloc limbs, together with half of the arrays
+// in the size class idx of the cache mpzc, to the depot. Returns false
+// (without doing anything) if the depot is full.
+bool mpz_alloc_depot_spill(mpz_alloc_cache &mpzc, std::size_t idx, ::mp_limb_t *ptr, std::size_t ualloc)
+{
+    auto &dc = mpz_alloc_depot_inst.classes[idx];
+    const auto n = mpzc.sizes[idx] / 2u + 1u;
+    if (dc.size.load(std::memory_order_relaxed) + n > mpz_alloc_depot::max_entries) {
+        return false;
+    }
+    if (idx >= mpz_alloc_cache::max_size) {
+        ptr[1] = static_cast<::mp_limb_t>(ualloc);
+    }
+    // Build the batch.
+    auto last = ptr;
+    for (std::size_t i = 1; i < n; ++i) {
+        std::size_t tmp;
+        const auto next = mpz_alloc_cache_pop(mpzc, idx, tmp);
+        mpz_alloc_set_link(last, next);
+        last = next;
+    }
+    dc.size.fetch_add(n, std::memory_order_relaxed);
+    mpz_alloc_depot_push(dc, ptr, last);
+    return true;
+}
+
+// Move arrays from the size class idx of the depot to the same size
+// class of the cache mpzc, which must be empty. Returns false if
+// no array was moved.
+bool mpz_alloc_depot_refill(mpz_alloc_cache &mpzc, std::size_t idx)
+{
+    assert(mpzc.sizes[idx] == 0u);
+    auto &dc = mpz_alloc_depot_inst.classes[idx];
+    // NOTE: check first if the stack is empty, so that the
+    // common case does not need a read-modify-write operation.
+    if (!mpzc.max_entries || !dc.head.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    auto ptr = dc.head.exchange(nullptr, std::memory_order_acquire);
+    std::size_t n = 0;
+    for (; ptr && n < mpzc.max_entries; ++n) {
+        const auto next = mpz_alloc_link(ptr);
+        mpz_alloc_cache_push(mpzc, idx, ptr, mpz_alloc_array_size(idx, ptr));
+        ptr = next;
+    }
+    dc.size.fetch_sub(n, std::memory_order_relaxed);
+    if (ptr) {
+        // Give back the arrays which do not fit in the cache.
+        auto last = ptr;
+        while (const auto next = mpz_alloc_link(last)) {
+            last = next;
+        }
+        mpz_alloc_depot_push(dc, ptr, last);
+    }
+    return n != 0u;
+}
+
+// Implementation of the init of an mpz from cache. If the cache cannot serve
+// the request, nlimbs is set to the number of limbs that must be allocated.
+bool mpz_init_from_cache_impl(mpz_struct_t &rop, std::size_t &nlimbs)
+{
+    auto &mpzc = get_mpz_alloc_cache();
+    if (!nlimbs || nlimbs > mpzc.max_limbs) {
+        mpz_alloc_cache_stat_add(mpzc.misses, 1);
+        return false;
+    }
+    const auto idx = mpz_alloc_cache_request_class(nlimbs);
+    if (mpzc.sizes[idx] || mpz_alloc_depot_refill(mpzc, idx)) {
+        std::size_t ualloc;
+        rop._mp_d = mpz_alloc_cache_pop(mpzc, idx, ualloc);
+        assert(ualloc >= nlimbs);
+        rop._mp_alloc = static_cast<mpz_alloc_t>(ualloc);
         rop._mp_size = 0;
-        rop._mp_d = mpzc.caches[idx][mpzc.sizes[idx] - 1u];
-        --mpzc.sizes[idx];
+        mpz_alloc_cache_stat_add(mpzc.hits, 1);
         return true;
     }
+    mpz_alloc_cache_stat_add(mpzc.misses, 1);
+    if (idx >= mpz_alloc_cache::max_size) {
+        // Allocate an array as large as the size class, so that
+        // it can serve all the requests of this size class when recycled.
+        nlimbs = std::size_t(1) << (idx - mpz_alloc_cache::max_size + mpz_alloc_cache::min_pow2_bits);
+    }
     return false;
 }
 
+// The arenas of the thread.
+// NOTE: the pointer is constant-initialised, and it is kept in this
+// file so that checking it in the init and clear functions is cheap.
+thread_local mpz_arena_thread *mpz_arena_tls = nullptr;
+
 } // namespace
 
 mpz_alloc_cache &get_thread_local_mpz_cache()
@@ -174,11 +520,19 @@ mpz_alloc_cache &get_thread_local_mpz_cache()
     return mpz_alloc_cache_inst;
 }
 
+mpz_arena_thread *&get_thread_local_mpz_arena()
+{
+    return mpz_arena_tls;
+}
+
 #endif
 
 void mpz_init_nlimbs(mpz_struct_t &rop, std::size_t nlimbs)
 {
 #if defined(MPPP_HAVE_THREAD_LOCAL)
+    if (mppp_unlikely(mpz_arena_tls != nullptr) && mpz_arena_init(*mpz_arena_tls, rop, nlimbs)) {
+        return;
+    }
     if (!mpz_init_from_cache_impl(rop, nlimbs)) {
 #endif
         // LCOV_EXCL_START
@@ -208,7 +562,14 @@ void mpz_init_nbits(mpz_struct_t &rop, ::mp_bitcnt_t nbits, std::size_t nlimbs)
     // Check nlimbs.
     assert(nlimbs == nbits_to_nlimbs(nbits));
 #if defined(MPPP_HAVE_THREAD_LOCAL)
+    if (mppp_unlikely(mpz_arena_tls != nullptr) && mpz_arena_init(*mpz_arena_tls, rop, nlimbs)) {
+        return;
+    }
     if (!mpz_init_from_cache_impl(rop, nlimbs)) {
+        if (nlimbs > nbits_to_nlimbs(nbits)) {
+            // The allocation was rounded up to the size of a size class.
+            nbits = static_cast<::mp_bitcnt_t>(nlimbs * unsigned(GMP_NUMB_BITS));
+        }
 #endif
         ignore(nlimbs);
         // NOTE: nbits == 0 is allowed.
@@ -221,41 +582,354 @@ void mpz_init_nbits(mpz_struct_t &rop, ::mp_bitcnt_t nbits, std::size_t nlimbs)
 void mpz_clear_wrap(mpz_struct_t &m)
 {
 #if defined(MPPP_HAVE_THREAD_LOCAL)
-    auto &mpzc = mpz_alloc_cache_inst;
+    // NOTE: the arrays allocated from an arena must
+    // not end up in the allocation cache.
+    if (mppp_unlikely(mpz_arena_tls != nullptr) && mpz_arena_clear(*mpz_arena_tls, m)) {
+        return;
+    }
+    auto &mpzc = get_mpz_alloc_cache();
     const auto ualloc = make_unsigned(m._mp_alloc);
-    if (ualloc && ualloc <= mpzc.max_size && mpzc.sizes[ualloc - 1u] < mpzc.max_entries) {
-        const auto idx = ualloc - 1u;
-        mpzc.caches[idx][mpzc.sizes[idx]] = m._mp_d;
-        ++mpzc.sizes[idx];
-    } else {
+    if (ualloc) {
+        const auto idx = mpz_alloc_cache_store_class(ualloc);
+        if (idx < mpz_alloc_cache::n_classes && mpz_alloc_cache_class_min_request(idx) <= mpzc.max_limbs) {
+            if (mpzc.sizes[idx] < mpzc.max_entries) {
+                mpz_alloc_cache_push(mpzc, idx, m._mp_d, ualloc);
+                return;
+            }
+            // The size class is full, try to move some arrays to the depot.
+            if (mpzc.max_entries && mpz_alloc_depot_spill(mpzc, idx, m._mp_d, ualloc)) {
+                return;
+            }
+        }
+        mpz_alloc_cache_stat_add(mpzc.evictions, 1);
+    }
 #endif
-        ::mpz_clear(&m);
+    ::mpz_clear(&m);
+}
+
+namespace
+{
+
+// Number of limbs above which the conversion to string
+// uses the divide-and-conquer algorithm.
+constexpr std::size_t mpz_to_str_dc_threshold = 1500;
+
+// Number of limbs above which the parts of a number
+// are converted to string concurrently.
+constexpr std::size_t mpz_to_str_par_threshold = 20000;
+
+// Table of powers of the base for the divide-and-conquer conversion
+// to string: m_powers[i] == m_base**(m_leaf * 2**i).
+struct mpz_to_str_powtab {
+    int m_base = 0;
+    // Number of digits of the leaves of the recursion.
+    std::size_t m_leaf = 0;
+    std::vector<std::unique_ptr<mpz_raii>> m_powers;
+};
+
 #if defined(MPPP_HAVE_THREAD_LOCAL)
-    }
+
+// NOTE: the table is kept across conversions, so that
+// the powers are not recomputed when converting numbers
+// of similar size in the same base.
+thread_local mpz_to_str_powtab mpz_to_str_powtab_inst;
+
 #endif
+
+// Make sure tab contains at least n powers of base.
+void mpz_to_str_powtab_ensure(mpz_to_str_powtab &tab, int base, std::size_t n)
+{
+    if (tab.m_base != base) {
+        tab.m_base = base;
+        // NOTE: the leaves are numbers of about half the threshold size.
+        tab.m_leaf = static_cast<std::size_t>(static_cast<double>(mpz_to_str_dc_threshold / 2u * GMP_NUMB_BITS)
+                                              * std::log(2.) / std::log(static_cast<double>(base)));
+        tab.m_powers.clear();
+    }
+    while (tab.m_powers.size() < n) {
+        std::unique_ptr<mpz_raii> p(new mpz_raii);
+        if (tab.m_powers.empty()) {
+            ::mpz_ui_pow_ui(&p->m_mpz, static_cast<unsigned long>(base), static_cast<unsigned long>(tab.m_leaf));
+        } else {
+            const auto &prev = tab.m_powers.back()->m_mpz;
+            ::mpz_mul(&p->m_mpz, &prev, &prev);
+        }
+        tab.m_powers.push_back(std::move(p));
+    }
 }
 
-void mpz_to_str(std::vector<char> &out, const mpz_struct_t *mpz, int base)
+// Write into out the representation of the nonnegative value x, which must be less than
+// tab.m_powers[level], as a string of exactly tab.m_leaf * 2**level digits (with leading zeroes).
+// NOTE: the output is not null-terminated.
+void mpz_to_str_dc_padded(char *out, const mpz_struct_t *x, const mpz_to_str_powtab &tab, std::size_t level)
 {
-    assert(base >= 2 && base <= 62);
-    const auto size_base = ::mpz_sizeinbase(mpz, base);
+    assert(x->_mp_size >= 0);
+    const auto ndigits = tab.m_leaf << level;
+    if (x->_mp_size == 0) {
+        std::fill(out, out + ndigits, '0');
+        return;
+    }
+    if (level == 0u) {
+        // Convert via GMP, and pad with zeroes.
+        std::vector<char> tmp(::mpz_sizeinbase(x, tab.m_base) + 2u);
+        ::mpz_get_str(tmp.data(), tab.m_base, x);
+        const auto len = std::strlen(tmp.data());
+        assert(len <= ndigits);
+        std::fill(out, out + (ndigits - len), '0');
+        std::copy(tmp.data(), tmp.data() + len, out + (ndigits - len));
+        return;
+    }
+    // Split x into high and low halves of tab.m_leaf * 2**(level - 1) digits each.
+    mpz_raii q, r;
+    ::mpz_tdiv_qr(&q.m_mpz, &r.m_mpz, x, &tab.m_powers[level - 1u]->m_mpz);
+    const auto half = ndigits / 2u;
+    if (get_mpz_size(x) >= mpz_to_str_par_threshold) {
+        parallel_run(2, [out, half, &q, &r, &tab, level](std::size_t i) {
+            mpz_to_str_dc_padded(out + half * i, i == 0u ? &q.m_mpz : &r.m_mpz, tab, level - 1u);
+        });
+    } else {
+        mpz_to_str_dc_padded(out, &q.m_mpz, tab, level - 1u);
+        mpz_to_str_dc_padded(out + half, &r.m_mpz, tab, level - 1u);
+    }
+}
+
+// Divide-and-conquer conversion to string of the nonnegative value x. The null-terminated
+// representation is written into out starting from offset.
+void mpz_to_str_dc(std::vector<char> &out, std::size_t offset, const mpz_struct_t *x, int base)
+{
+    assert(x->_mp_size > 0);
+#if defined(MPPP_HAVE_THREAD_LOCAL)
+    auto &tab = mpz_to_str_powtab_inst;
+#else
+    mpz_to_str_powtab tab;
+#endif
+    // Determine the number of powers needed, so that the largest one
+    // is roughly the square root of x.
+    mpz_to_str_powtab_ensure(tab, base, 0);
+    const auto size_base = ::mpz_sizeinbase(x, base);
+    std::size_t nlevels = 0;
+    while ((tab.m_leaf << nlevels) < size_base) {
+        ++nlevels;
+    }
+    mpz_to_str_powtab_ensure(tab, base, nlevels);
+    // Divide x repeatedly by decreasing powers of the base. The remainders are
+    // the lower digits of x, in groups of known size. The final quotient is
+    // the leading part of x, which is then less than the first power.
+    std::vector<std::pair<std::unique_ptr<mpz_raii>, std::size_t>> rems;
+    mpz_raii cur, q;
+    ::mpz_set(&cur.m_mpz, x);
+    for (auto level = nlevels; level != 0u; --level) {
+        const auto &p = tab.m_powers[level - 1u]->m_mpz;
+        if (::mpz_cmp(&cur.m_mpz, &p) >= 0) {
+            std::unique_ptr<mpz_raii> r(new mpz_raii);
+            ::mpz_tdiv_qr(&q.m_mpz, &r->m_mpz, &cur.m_mpz, &p);
+            ::mpz_swap(&cur.m_mpz, &q.m_mpz);
+            rems.emplace_back(std::move(r), level - 1u);
+        }
+    }
+    // Convert the leading part. Now we know the total number of digits,
+    // and we can write the leading part directly into out.
+    const auto lead_max = ::mpz_sizeinbase(&cur.m_mpz, base);
+    std::size_t total = lead_max;
+    for (const auto &r : rems) {
+        total += tab.m_leaf << r.second;
+    }
     // LCOV_EXCL_START
-    if (mppp_unlikely(size_base > nl_max<std::size_t>() - 2u)) {
+    if (mppp_unlikely(total > nl_max<std::size_t>() - offset - 2u)) {
         throw std::overflow_error("Too many digits in the conversion of mpz_t to string");
     }
     // LCOV_EXCL_STOP
-    // Total max size is the size in base plus an optional sign and the null terminator.
-    const auto total_size = size_base + 2u;
-    // NOTE: possible improvement: use a null allocator to avoid initing the chars each time
-    // we resize up.
-    // Overflow check.
+    out.resize(offset + total + 2u);
+    ::mpz_get_str(out.data() + offset, base, &cur.m_mpz);
+    auto pos = offset + std::strlen(out.data() + offset);
+    // Compute the offsets of the remainders (from the last
+    // remainder, which contains the highest digits).
+    std::vector<std::size_t> offsets(rems.size());
+    for (auto i = rems.size(); i != 0u; --i) {
+        offsets[i - 1u] = pos;
+        pos += tab.m_leaf << rems[i - 1u].second;
+    }
+    const auto conv = [&out, &rems, &offsets, &tab](std::size_t i) {
+        mpz_to_str_dc_padded(out.data() + offsets[i], &rems[i].first->m_mpz, tab, rems[i].second);
+    };
+    if (get_mpz_size(x) >= mpz_to_str_par_threshold) {
+        parallel_run(rems.size(), conv);
+    } else {
+        for (std::size_t i = 0; i < rems.size(); ++i) {
+            conv(i);
+        }
+    }
+    out[pos] = '\0';
+}
+
+// Write into out, starting from offset, the null-terminated representation
+// of the absolute value of mpz in the given base. out will be resized as needed,
+// and it might end up being larger than the representation.
+void mpz_to_str_abs(std::vector<char> &out, std::size_t offset, const mpz_struct_t *mpz, int base)
+{
+    // NOTE: shallow copy of mpz, with the sign flipped if needed.
+    auto abs_view = *mpz;
+    abs_view._mp_size = abs_view._mp_size < 0 ? -abs_view._mp_size : abs_view._mp_size;
+    if (get_mpz_size(mpz) >= mpz_to_str_dc_threshold) {
+        mpz_to_str_dc(out, offset, &abs_view, base);
+        return;
+    }
+#if defined(MPPP_HAVE_GCC_INT128) && (GMP_NUMB_BITS == 64) && !GMP_NAIL_BITS
+    if (base == 10 && get_mpz_size(mpz) <= 2u) {
+        std::array<char, dec_2limbs_max_digits> buffer;
+        const auto end = buffer.data() + buffer.size();
+        const auto begin = dec_format_2limbs(end, abs_view._mp_d, get_mpz_size(mpz));
+        const auto ndigits = static_cast<std::size_t>(end - begin);
+        out.resize(std::max(out.size(), offset + ndigits + 1u));
+        std::copy(begin, end, out.data() + offset);
+        out[offset + ndigits] = '\0';
+        return;
+    }
+#endif
+    const auto size_base = ::mpz_sizeinbase(&abs_view, base);
     // LCOV_EXCL_START
-    if (mppp_unlikely(total_size > nl_max<std::vector<char>::size_type>())) {
+    if (mppp_unlikely(size_base > nl_max<std::size_t>() - offset - 1u)) {
         throw std::overflow_error("Too many digits in the conversion of mpz_t to string");
     }
     // LCOV_EXCL_STOP
-    out.resize(static_cast<std::vector<char>::size_type>(total_size));
-    ::mpz_get_str(out.data(), base, mpz);
+    // NOTE: possible improvement: use a null allocator to avoid initing the chars each time
+    // we resize up.
+    out.resize(offset + size_base + 1u);
+    ::mpz_get_str(out.data() + offset, base, &abs_view);
+}
+
+} // namespace
+
+void mpz_to_str(std::vector<char> &out, const mpz_struct_t *mpz, int base)
+{
+    assert(base >= 2 && base <= 62);
+    if (mpz->_mp_size < 0) {
+        // NOTE: write the sign first, so that the digits
+        // can be written directly after it.
+        out.resize(std::max(out.size(), std::vector<char>::size_type(1)));
+        out[0] = '-';
+        mpz_to_str_abs(out, 1, mpz, base);
+    } else {
+        mpz_to_str_abs(out, 0, mpz, base);
+    }
+}
+
+namespace
+{
+
+// Number of characters above which mpz_set_str_wrap()
+// parses strings concurrently.
+constexpr std::size_t mpz_set_str_par_threshold = 100000;
+
+// Minimum number of digits per chunk in the concurrent parsing.
+constexpr std::size_t mpz_set_str_min_chunk = 20000;
+
+// Concurrent parsing of the digits in the nonempty [begin, end) range. The digits
+// are split into chunks, which are converted concurrently and then combined pairwise
+// via a tree of multiplications by powers of the base. Returns false if the
+// range contains characters which are not digits in the given base.
+bool mpz_set_str_par(mpz_struct_t *rop, const char *begin, const char *end, int base, unsigned nthreads)
+{
+    assert(begin != end);
+    const auto ndigits = static_cast<std::size_t>(end - begin);
+    const auto chunk = std::max(mpz_set_str_min_chunk, ndigits / (std::size_t(nthreads) * 4u) + 1u);
+    const auto nchunks = (ndigits - 1u) / chunk + 1u;
+    // NOTE: parts[0] contains the least significant digits.
+    std::vector<mpz_raii> parts(nchunks);
+    std::atomic<bool> valid(true);
+    parallel_run(nchunks, [begin, end, base, chunk, nchunks, &parts, &valid](std::size_t i) {
+        const auto c_end = end - i * chunk, c_begin = (i + 1u == nchunks) ? begin : c_end - chunk;
+        if (!std::all_of(c_begin, c_end, [base](char c) { return char_to_digit(c, base) < base; })) {
+            valid.store(false);
+            return;
+        }
+        std::vector<char> tmp(c_begin, c_end);
+        tmp.push_back('\0');
+        const auto ret = ::mpz_set_str(&parts[i].m_mpz, tmp.data(), base);
+        assert(ret == 0);
+        ignore(ret);
+    });
+    if (!valid.load()) {
+        return false;
+    }
+    // Combine the chunks. At each step, power contains base**(chunk * 2**k), where k is
+    // the step index, and the next power is computed concurrently with the combinations.
+    mpz_raii power, next_power;
+    ::mpz_ui_pow_ui(&power.m_mpz, static_cast<unsigned long>(base), static_cast<unsigned long>(chunk));
+    for (auto n = nchunks; n > 1u; n = (n + 1u) / 2u) {
+        const auto npairs = n / 2u;
+        const bool last = npairs + n % 2u == 1u;
+        parallel_run(npairs + (last ? 0u : 1u), [npairs, &parts, &power, &next_power](std::size_t i) {
+            if (i == npairs) {
+                ::mpz_mul(&next_power.m_mpz, &power.m_mpz, &power.m_mpz);
+            } else {
+                ::mpz_addmul(&parts[2u * i].m_mpz, &parts[2u * i + 1u].m_mpz, &power.m_mpz);
+            }
+        });
+        // Move the results to the beginning of parts.
+        for (std::size_t i = 1; i < npairs; ++i) {
+            ::mpz_swap(&parts[i].m_mpz, &parts[2u * i].m_mpz);
+        }
+        if (n % 2u) {
+            ::mpz_swap(&parts[npairs].m_mpz, &parts[n - 1u].m_mpz);
+        }
+        ::mpz_swap(&power.m_mpz, &next_power.m_mpz);
+    }
+    ::mpz_swap(rop, &parts[0].m_mpz);
+    return true;
+}
+
+} // namespace
+
+int mpz_set_str_wrap(mpz_struct_t *rop, const char *s, int base)
+{
+    const auto len = std::strlen(s);
+    if (len < mpz_set_str_par_threshold) {
+        return ::mpz_set_str(rop, s, base);
+    }
+    const auto nthreads = parallel::get_n_threads();
+    if (nthreads == 1u) {
+        return ::mpz_set_str(rop, s, base);
+    }
+    // Skip the leading whitespace and the sign.
+    auto begin = s;
+    const auto end = s + len;
+    while (begin != end && std::isspace(static_cast<unsigned char>(*begin))) {
+        ++begin;
+    }
+    const bool neg = begin != end && *begin == '-';
+    if (neg) {
+        ++begin;
+    }
+    auto actual_base = base;
+    if (base == 0) {
+        // NOTE: with automatic base detection, only strings without
+        // base prefix (i.e., decimal strings) are parsed concurrently.
+        if (begin == end || *begin == '0') {
+            return ::mpz_set_str(rop, s, base);
+        }
+        actual_base = 10;
+    }
+    // NOTE: in case of failure (which could also be due to whitespace within
+    // the digits, which is accepted by GMP), let mpz_set_str() handle the string.
+    if (begin == end || !mpz_set_str_par(rop, begin, end, actual_base, nthreads)) {
+        return ::mpz_set_str(rop, s, base);
+    }
+    if (neg) {
+        ::mpz_neg(rop, rop);
+    }
+    return 0;
+}
+
+char *mpz_to_chars(char *first, char *last, const mpz_struct_t *mpz, int base)
+{
+    MPPP_MAYBE_TLS std::vector<char> tmp;
+    mpz_to_str(tmp, mpz, base);
+    const auto size = std::strlen(tmp.data());
+    if (static_cast<std::size_t>(last - first) < size) {
+        return nullptr;
+    }
+    return std::copy(tmp.data(), tmp.data() + size, first);
 }
 
 std::ostream &integer_stream_operator_impl(std::ostream &os, const mpz_struct_t *n, int n_sgn)
@@ -281,103 +955,74 @@ std::ostream &integer_stream_operator_impl(std::ostream &os, const mpz_struct_t
     // Uppercase?
     const bool uppercase = (flags & std::ios_base::uppercase) != 0;
 
-    // Write out to a temporary vector in the required base. This will produce
-    // a representation in the required base, with no base prefix and no
-    // extra '+' for nonnegative integers.
-    MPPP_MAYBE_TLS std::vector<char> tmp;
-    mpz_to_str(tmp, n, base);
-    // NOTE: tmp contains the terminator, and it might be
-    // larger than needed. Make sure to shrink it so that
-    // the last element is the terminator.
-    tmp.resize(static_cast<decltype(tmp.size())>(std::strlen(tmp.data())) + 1u);
-
+    // Determine the characters preceding the digits:
+    // - the sign, if the number is negative or if a '+' was requested,
+    // - the base prefix ('0' for octal, '0x'/'0X' for hex), if requested.
+    const bool with_plus = (flags & std::ios_base::showpos) != 0;
+    std::array<char, 3> prefix_buffer;
+    std::size_t prefix_size = 0;
     if (n_sgn == -1) {
-        // Negative number.
-        if (with_base_prefix) {
-            // If we need the base prefix, we will have to add the base after the minus sign.
-            assert(tmp[0] == '-');
-            if (base == 16) {
-                constexpr std::array<char, 2> hex_prefix = {{'0', 'x'}};
-                tmp.insert(tmp.begin() + 1, hex_prefix.begin(), hex_prefix.end());
-            } else {
-                tmp.insert(tmp.begin() + 1, '0');
-            }
+        prefix_buffer[prefix_size++] = '-';
+    } else if (with_plus) {
+        prefix_buffer[prefix_size++] = '+';
+    }
+    if (with_base_prefix) {
+        prefix_buffer[prefix_size++] = '0';
+        if (base == 16) {
+            prefix_buffer[prefix_size++] = 'x';
         }
-    } else {
-        // Nonnegative number. We will be prepending up to 3 characters to the number
-        // representation:
-        // - 1 or 2 for the base prefix ('0' for octal, '0x'/'0X' for hex),
-        // - the '+' sign, if requested.
-        const bool with_plus = (flags & std::ios_base::showpos) != 0;
-        std::array<char, 3> prep_buffer;
-        const auto prep_n = [&prep_buffer, with_plus, with_base_prefix, base]() -> std::size_t {
-            std::size_t ret = 0;
-            if (with_plus) {
-                prep_buffer[ret++] = '+';
-            }
-            if (with_base_prefix) {
-                prep_buffer[ret++] = '0';
-                if (base == 16) {
-                    prep_buffer[ret++] = 'x';
-                }
-            }
-            return ret;
-        }();
-        // Prepend the additional characters.
-        tmp.insert(tmp.begin(), prep_buffer.data(), prep_buffer.data() + prep_n);
     }
 
-    // Apply a final toupper() transformation in base 16, if needed,
-    // but do it before doing the filling in order to avoid
-    // uppercasing the fill character.
+    // Write out to a temporary vector the digits of the absolute value in the
+    // required base, leaving room at the beginning for the prefix.
+    MPPP_MAYBE_TLS std::vector<char> tmp;
+    mpz_to_str_abs(tmp, prefix_size, n, base);
+    std::copy(prefix_buffer.data(), prefix_buffer.data() + prefix_size, tmp.data());
+
+    // Compute the total size of the number
+    // representation (i.e., without fill characters).
+    const auto final_size = prefix_size + std::strlen(tmp.data() + prefix_size);
+
+    // Apply a final toupper() transformation in base 16, if needed.
     if (base == 16 && uppercase) {
         const auto &cloc = std::locale::classic();
-        for (decltype(tmp.size()) i = 0; i < tmp.size() - 1u; ++i) {
+        for (std::size_t i = 0; i < final_size; ++i) {
             if (std::isalpha(tmp[i], cloc)) {
                 tmp[i] = std::toupper(tmp[i], cloc);
             }
         }
     }
 
-    // Compute the total size of the number
-    // representation (i.e., without fill characters).
-    // NOTE: -1 because of the terminator.
-    assert(!tmp.empty());
-    const auto final_size = tmp.size() - 1u;
-
     // We are going to do the filling
     // only if the stream width is larger
     // than the total size of the number.
     if (width >= 0 && make_unsigned(width) > final_size) {
         // Compute how much fill we need.
-        const auto fill_size = safe_cast<decltype(tmp.size())>(make_unsigned(width) - final_size);
+        const auto fill_size = make_unsigned(width) - final_size;
         // Get the fill character.
         const auto fill_char = os.fill();
-        switch (fill) {
-            case 1:
-                // Left fill: fill characters at the end.
-                tmp.insert(tmp.end() - 1, fill_size, fill_char);
-                break;
-            case 2:
-                // Right fill: fill characters at the beginning.
-                tmp.insert(tmp.begin(), fill_size, fill_char);
-                break;
-            case 3: {
-                // Internal fill: the fill characters are always after the sign (if present)
-                // and the base prefix (if present).
-                auto delta = static_cast<int>(tmp[0] == '+' || tmp[0] == '-');
-                if (with_base_prefix) {
-                    delta += 1 + static_cast<int>(base == 16);
-                }
-                tmp.insert(tmp.begin() + delta, fill_size, fill_char);
-                break;
+        // NOTE: the fill characters are written directly into
+        // the stream, before, after or within the number representation.
+        const auto write_fill = [&os, fill_size, fill_char]() {
+            std::array<char, 64> fill_buffer;
+            fill_buffer.fill(fill_char);
+            for (auto left = fill_size; left != 0u;) {
+                const auto n_write = std::min(left, static_cast<decltype(left)>(fill_buffer.size()));
+                os.write(fill_buffer.data(), static_cast<std::streamsize>(n_write));
+                left -= n_write;
             }
-        }
+        };
+        // NOTE: in case of internal fill, the fill characters are always after
+        // the sign (if present) and the base prefix (if present).
+        const auto split = fill == 1 ? final_size : (fill == 2 ? std::size_t(0) : prefix_size);
+        os.write(tmp.data(), safe_cast<std::streamsize>(split));
+        write_fill();
+        os.write(tmp.data() + split, safe_cast<std::streamsize>(final_size - split));
+    } else {
+        // Write out the unformatted data.
+        os.write(tmp.data(), safe_cast<std::streamsize>(final_size));
     }
 
-    // Write out the unformatted data.
-    os.write(tmp.data(), safe_cast<std::streamsize>(tmp.size() - 1u));
-
     // Reset the stream width to zero, like the operator<<() does for builtin types.
     // https://en.cppreference.com/w/cpp/io/manip/setw
     // Do it here so we ensure we don't alter the state of the stream until the very end.
@@ -386,13 +1031,106 @@ std::ostream &integer_stream_operator_impl(std::ostream &os, const mpz_struct_t
     return os;
 }
 
+std::uint64_t hash_limbs(const ::mp_limb_t *ptr, std::size_t asize, mpz_size_t size)
+{
+    assert(asize > 2u);
+
+    std::uint64_t seed = hash_p0;
+    std::size_t i = 0;
+    if (asize > 6u) {
+        // Three independent lanes of two limbs each, so that
+        // the multiplications can proceed in parallel.
+        auto seed1 = seed, seed2 = seed;
+        for (; asize - i > 6u; i += 6u) {
+            seed = hash_mix((ptr[i] & GMP_NUMB_MASK) ^ hash_p1, (ptr[i + 1u] & GMP_NUMB_MASK) ^ seed);
+            seed1 = hash_mix((ptr[i + 2u] & GMP_NUMB_MASK) ^ hash_p2, (ptr[i + 3u] & GMP_NUMB_MASK) ^ seed1);
+            seed2 = hash_mix((ptr[i + 4u] & GMP_NUMB_MASK) ^ hash_p3, (ptr[i + 5u] & GMP_NUMB_MASK) ^ seed2);
+        }
+        seed ^= seed1 ^ seed2;
+    }
+    for (; asize - i > 2u; i += 2u) {
+        seed = hash_mix((ptr[i] & GMP_NUMB_MASK) ^ hash_p1, (ptr[i + 1u] & GMP_NUMB_MASK) ^ seed);
+    }
+    // The last one or two limbs.
+    return hash_finalise(ptr[i] & GMP_NUMB_MASK, asize - i == 2u ? (ptr[i + 1u] & GMP_NUMB_MASK) : 0u, seed,
+                         size);
+}
+
 } // namespace detail
 
 void free_integer_caches()
 {
 #if defined(MPPP_HAVE_THREAD_LOCAL)
     detail::mpz_alloc_cache_inst.clear();
+    detail::mpz_alloc_depot_inst.clear();
+    detail::mpz_to_str_powtab_inst.m_base = 0;
+    detail::mpz_to_str_powtab_inst.m_powers.clear();
 #endif
 }
 
+integer_cache_config get_integer_cache_config()
+{
+#if defined(MPPP_HAVE_THREAD_LOCAL)
+    const auto &mpzc = detail::get_mpz_alloc_cache();
+    integer_cache_config retval;
+    retval.max_entries = mpzc.max_entries;
+    retval.max_limbs = mpzc.max_limbs;
+    return retval;
+#else
+    return get_global_integer_cache_config();
+#endif
+}
+
+void set_integer_cache_config(const integer_cache_config &cfg)
+{
+    detail::integer_cache_config_check(cfg);
+#if defined(MPPP_HAVE_THREAD_LOCAL)
+    auto &mpzc = detail::get_mpz_alloc_cache();
+    detail::mpz_alloc_cache_set_config(mpzc, cfg);
+    mpzc.local = true;
+#endif
+}
+
+void reset_integer_cache_config()
+{
+#if defined(MPPP_HAVE_THREAD_LOCAL)
+    auto &mpzc = detail::mpz_alloc_cache_inst;
+    mpzc.local = false;
+    detail::mpz_alloc_cache_sync(mpzc);
+#endif
+}
+
+integer_cache_config get_global_integer_cache_config()
+{
+    std::lock_guard<std::mutex> lock(detail::mpz_alloc_cache_mutex);
+    return detail::mpz_alloc_cache_global_config;
+}
+
+void set_global_integer_cache_config(const integer_cache_config &cfg)
+{
+    detail::integer_cache_config_check(cfg);
+    std::lock_guard<std::mutex> lock(detail::mpz_alloc_cache_mutex);
+    detail::mpz_alloc_cache_global_config = cfg;
+    detail::mpz_alloc_cache_gen.fetch_add(1u, std::memory_order_relaxed);
+}
+
+integer_cache_counters integer_cache_stats()
+{
+    integer_cache_counters retval;
+#if defined(MPPP_HAVE_THREAD_LOCAL)
+    detail::mpz_alloc_cache_add_stats(retval, detail::mpz_alloc_cache_inst);
+#endif
+    return retval;
+}
+
+integer_cache_counters global_integer_cache_stats()
+{
+    std::lock_guard<std::mutex> lock(detail::mpz_alloc_cache_mutex);
+    auto retval = detail::mpz_alloc_cache_retired;
+    for (auto mpzc = detail::mpz_alloc_cache_list; mpzc; mpzc = mpzc->next) {
+        detail::mpz_alloc_cache_add_stats(retval, *mpzc);
+    }
+    return retval;
+}
+
 } // namespace mppp
@@ -0,0 +1,342 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include <mp++/config.hpp>
+#include <mp++/detail/gmp.hpp>
+#include <mp++/detail/utils.hpp>
+#include <mp++/integer_arena.hpp>
+
+namespace mppp
+{
+
+namespace detail
+{
+
+struct mpz_arena {
+    // A block of memory. The storage of the block follows the header.
+    struct block {
+        block *prev;
+        std::size_t size;
+    };
+    // Offset of the storage of a block, so that the storage is suitably aligned.
+    static constexpr std::size_t header_size
+        = (sizeof(block) + alignof(std::max_align_t) - 1u) / alignof(std::max_align_t) * alignof(std::max_align_t);
+    // The size of the blocks doubles at each new block, up to this limit.
+    static constexpr std::size_t max_block_size = std::size_t(1) << 24;
+
+    explicit mpz_arena(std::size_t block_size) : next_block_size(block_size) {}
+    mpz_arena(const mpz_arena &) = delete;
+    mpz_arena &operator=(const mpz_arena &) = delete;
+    ~mpz_arena()
+    {
+        while (blocks) {
+            const auto prev = blocks->prev;
+            std::free(static_cast<void *>(blocks));
+            blocks = prev;
+        }
+    }
+
+    static char *storage(block *b)
+    {
+        return reinterpret_cast<char *>(b) + header_size;
+    }
+    // Check if ptr points to the storage of one of the blocks.
+    bool owns(const void *ptr) const
+    {
+        const auto p = static_cast<const char *>(ptr);
+        for (auto b = blocks; b; b = b->prev) {
+            const auto s = storage(b);
+            if (!std::less<const char *>{}(p, s) && std::less<const char *>{}(p, s + b->size)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    // Allocate nbytes bytes (a multiple of the size of a limb).
+    void *allocate(std::size_t nbytes)
+    {
+        assert(nbytes % sizeof(::mp_limb_t) == 0u);
+        if (static_cast<std::size_t>(end - cur) < nbytes) {
+            const auto size = std::max(next_block_size, nbytes);
+            // LCOV_EXCL_START
+            if (mppp_unlikely(size > nl_max<std::size_t>() - header_size)) {
+                std::abort();
+            }
+            // NOTE: here we are doing what GMP does in case of memory allocation errors.
+            auto b = static_cast<block *>(std::malloc(header_size + size));
+            if (mppp_unlikely(!b)) {
+                std::abort();
+            }
+            // LCOV_EXCL_STOP
+            b->prev = blocks;
+            b->size = size;
+            blocks = b;
+            cur = storage(b);
+            end = cur + size;
+            reserved += size;
+            if (next_block_size < max_block_size) {
+                next_block_size = std::min(next_block_size * 2u, max_block_size);
+            }
+        }
+        const auto retval = static_cast<void *>(cur);
+        cur += nbytes;
+        allocated += nbytes;
+        ++live;
+        return retval;
+    }
+
+    // The blocks, most recent first.
+    block *blocks = nullptr;
+    // The free portion of the most recent block.
+    char *cur = nullptr;
+    char *end = nullptr;
+    std::size_t next_block_size;
+    std::size_t allocated = 0;
+    std::size_t reserved = 0;
+    // Number of arrays allocated from the arena which have not been released yet.
+    std::size_t live = 0;
+    // The arena which was active when this arena was created.
+    mpz_arena *prev_active = nullptr;
+    // The next arena in the list of the arenas of the thread.
+    mpz_arena *next = nullptr;
+    // An arena is orphaned when its scope ends while some
+    // of its arrays are still alive.
+    bool orphan = false;
+};
+
+constexpr std::size_t mpz_arena::header_size;
+constexpr std::size_t mpz_arena::max_block_size;
+
+// The arenas of a thread: the active arenas form a stack whose top is the
+// arena in use, the orphaned arenas are kept until their arrays are released.
+struct mpz_arena_thread {
+    mpz_arena *active = nullptr;
+    // All the arenas of the thread, most recent first.
+    mpz_arena *arenas = nullptr;
+};
+
+#if defined(MPPP_HAVE_THREAD_LOCAL)
+
+namespace
+{
+
+// Find the arena of the thread t from which ptr was allocated.
+mpz_arena *mpz_arena_find(const mpz_arena_thread &t, const void *ptr)
+{
+    for (auto a = t.arenas; a; a = a->next) {
+        if (a->owns(ptr)) {
+            return a;
+        }
+    }
+    return nullptr;
+}
+
+// Remove the arena a from the arenas of the calling thread and destroy it.
+// The state of the thread is destroyed as well when it has no arenas left.
+void mpz_arena_destroy(mpz_arena *a)
+{
+    auto &t = get_thread_local_mpz_arena();
+    assert(t != nullptr);
+    auto pa = &t->arenas;
+    while (*pa != a) {
+        assert(*pa != nullptr);
+        pa = &(*pa)->next;
+    }
+    *pa = a->next;
+    delete a;
+    if (!t->arenas) {
+        assert(t->active == nullptr);
+        delete t;
+        t = nullptr;
+    }
+}
+
+// Release an array allocated from the arena a. The memory of an orphaned
+// arena is freed when its last array is released.
+// NOTE: this may destroy the state of the thread.
+void mpz_arena_release(mpz_arena &a)
+{
+    assert(a.live > 0u);
+    if (--a.live == 0u && a.orphan) {
+        mpz_arena_destroy(&a);
+    }
+}
+
+// The memory functions which were in use when the arena hooks were installed.
+std::mutex mpz_arena_hooks_mutex;
+bool mpz_arena_hooks_installed = false;
+void *(*mpz_arena_next_alloc)(std::size_t) = nullptr;
+void *(*mpz_arena_next_realloc)(void *, std::size_t, std::size_t) = nullptr;
+void (*mpz_arena_next_free)(void *, std::size_t) = nullptr;
+
+// GMP reallocation function: the arrays allocated from an arena are moved
+// to the active arena (if any) or to the heap.
+void *mpz_arena_realloc_hook(void *ptr, std::size_t old_size, std::size_t new_size)
+{
+    const auto t = get_thread_local_mpz_arena();
+    mpz_arena *a;
+    if (mppp_likely(t == nullptr) || (a = mpz_arena_find(*t, ptr)) == nullptr) {
+        return mpz_arena_next_realloc(ptr, old_size, new_size);
+    }
+    // NOTE: GMP allocates arrays of limbs, whose sizes are multiples of the size of a limb.
+    assert(old_size % sizeof(::mp_limb_t) == 0u && new_size % sizeof(::mp_limb_t) == 0u);
+    const auto act = t->active;
+    if (act == a && static_cast<char *>(ptr) + old_size == act->cur && new_size >= old_size
+        && static_cast<std::size_t>(act->end - act->cur) >= new_size - old_size) {
+        // The array is the last one allocated from the active arena, grow it in place.
+        act->cur += new_size - old_size;
+        act->allocated += new_size - old_size;
+        return ptr;
+    }
+    const auto retval = act ? act->allocate(new_size) : mpz_arena_next_alloc(new_size);
+    std::memcpy(retval, ptr, std::min(old_size, new_size));
+    mpz_arena_release(*a);
+    return retval;
+}
+
+// GMP deallocation function: the arrays allocated from an arena are just released.
+void mpz_arena_free_hook(void *ptr, std::size_t size)
+{
+    const auto t = get_thread_local_mpz_arena();
+    mpz_arena *a;
+    if (mppp_likely(t == nullptr) || (a = mpz_arena_find(*t, ptr)) == nullptr) {
+        mpz_arena_next_free(ptr, size);
+    } else {
+        mpz_arena_release(*a);
+    }
+}
+
+// Install the arena hooks as GMP memory functions, on top of the current ones.
+void mpz_arena_install_hooks()
+{
+    std::lock_guard<std::mutex> lock(mpz_arena_hooks_mutex);
+    if (!mpz_arena_hooks_installed) {
+        ::mp_get_memory_functions(&mpz_arena_next_alloc, &mpz_arena_next_realloc, &mpz_arena_next_free);
+        ::mp_set_memory_functions(mpz_arena_next_alloc, mpz_arena_realloc_hook, mpz_arena_free_hook);
+        mpz_arena_hooks_installed = true;
+    }
+}
+
+} // namespace
+
+bool mpz_arena_init(mpz_arena_thread &t, mpz_struct_t &rop, std::size_t nlimbs)
+{
+    if (!t.active) {
+        return false;
+    }
+    // NOTE: like mpz_init2(), allocate at least one limb.
+    nlimbs = std::max(nlimbs, std::size_t(1));
+    // LCOV_EXCL_START
+    if (mppp_unlikely(nlimbs > make_unsigned(nl_max<mpz_alloc_t>()))) {
+        std::abort();
+    }
+    // LCOV_EXCL_STOP
+    rop._mp_d = static_cast<::mp_limb_t *>(t.active->allocate(nlimbs * sizeof(::mp_limb_t)));
+    rop._mp_alloc = static_cast<mpz_alloc_t>(nlimbs);
+    rop._mp_size = 0;
+    return true;
+}
+
+bool mpz_arena_clear(mpz_arena_thread &t, mpz_struct_t &m)
+{
+    const auto a = mpz_arena_find(t, m._mp_d);
+    if (a) {
+        mpz_arena_release(*a);
+        return true;
+    }
+    return false;
+}
+
+mpz_arena *mpz_arena_suspend()
+{
+    const auto t = get_thread_local_mpz_arena();
+    if (!t) {
+        return nullptr;
+    }
+    const auto retval = t->active;
+    t->active = nullptr;
+    return retval;
+}
+
+void mpz_arena_resume(mpz_arena *a)
+{
+    if (a) {
+        // NOTE: the suspended arena is still in the list of the arenas
+        // of the thread, so the state of the thread cannot have been destroyed.
+        const auto t = get_thread_local_mpz_arena();
+        assert(t != nullptr && t->active == nullptr);
+        t->active = a;
+    }
+}
+
+#endif
+
+} // namespace detail
+
+constexpr std::size_t integer_arena::default_block_size;
+
+integer_arena::integer_arena(std::size_t block_size) : m_arena(nullptr)
+{
+#if defined(MPPP_HAVE_THREAD_LOCAL)
+    detail::mpz_arena_install_hooks();
+    std::unique_ptr<detail::mpz_arena> a(new detail::mpz_arena(std::max(block_size, sizeof(::mp_limb_t))));
+    auto &t = detail::get_thread_local_mpz_arena();
+    if (!t) {
+        t = new detail::mpz_arena_thread;
+    }
+    a->prev_active = t->active;
+    a->next = t->arenas;
+    t->active = t->arenas = m_arena = a.release();
+#else
+    detail::ignore(block_size);
+#endif
+}
+
+integer_arena::~integer_arena()
+{
+#if defined(MPPP_HAVE_THREAD_LOCAL)
+    auto t = detail::get_thread_local_mpz_arena();
+    // NOTE: the arenas must be destroyed by the thread which
+    // created them, in reverse order of creation.
+    assert(t != nullptr && t->active == m_arena);
+    t->active = m_arena->prev_active;
+    if (m_arena->live) {
+        // Some integers allocated from the arena are still alive: keep
+        // the memory of the arena until they are destroyed.
+        m_arena->orphan = true;
+    } else {
+        detail::mpz_arena_destroy(m_arena);
+    }
+#endif
+}
+
+std::size_t integer_arena::allocated() const
+{
+    return m_arena ? m_arena->allocated : 0u;
+}
+
+std::size_t integer_arena::reserved() const
+{
+    return m_arena ? m_arena->reserved : 0u;
+}
+
+std::size_t integer_arena::live() const
+{
+    return m_arena ? m_arena->live : 0u;
+}
+
+} // namespace mppp
@@ -0,0 +1,446 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include <mp++/detail/gmp.hpp>
+#include <mp++/detail/utils.hpp>
+#include <mp++/integer_vector.hpp>
+
+// NOTE: the SIMD kernels are compiled via function-level target attributes,
+// so that the rest of the library does not require the corresponding
+// instruction sets. The kernels are selected at runtime.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && GMP_NUMB_BITS == 64 && !GMP_NAIL_BITS
+
+#define MPPP_INTEGER_VECTOR_SIMD
+
+#include <immintrin.h>
+
+#endif
+
+namespace mppp
+{
+
+namespace detail
+{
+
+namespace
+{
+
+// The kernels operate on the elements of 1-limb integer vectors. The elements
+// whose values have magnitude less than 2**63 are handled as signed 64-bit
+// integers in the SIMD registers (with some further restrictions in the
+// multiplication and shift kernels). If the result of a lane does not fit either,
+// or if the lane contains a dynamic element, the index of the lane is added
+// to the fixups list, and the corresponding element in the output is not written.
+
+// Append the indices in the [i, n) range to fixups.
+inline void simd_push_tail(std::vector<std::size_t> &fixups, std::size_t i, std::size_t n)
+{
+    for (; i < n; ++i) {
+        fixups.push_back(i);
+    }
+}
+
+#if defined(MPPP_INTEGER_VECTOR_SIMD)
+
+// NOTE: the kernels load the sizes as 32-bit integers.
+static_assert(sizeof(mpz_size_t) == 4u, "Invalid size type.");
+
+// Append the indices of the set bits in mask to fixups.
+inline void simd_push_fixups(std::vector<std::size_t> &fixups, std::size_t i, unsigned mask)
+{
+    for (; mask != 0u; mask &= mask - 1u) {
+        fixups.push_back(i + static_cast<std::size_t>(__builtin_ctz(mask)));
+    }
+}
+
+// AVX2 kernels (4 lanes).
+
+// Load 4 elements, returning their values and setting bad to all ones in the
+// lanes whose sizes are not in the [-1, 1] range (i.e., dynamic elements) or
+// whose limbs have the top bit set.
+__attribute__((target("avx2"))) inline __m256i avx2_load(const mpz_size_t *s, const ::mp_limb_t *l, __m256i &bad)
+{
+    const __m256i zero = _mm256_setzero_si256(), one = _mm256_set1_epi64x(1), mone = _mm256_set1_epi64x(-1);
+    const __m256i size
+        = _mm256_cvtepi32_epi64(_mm_loadu_si128(static_cast<const __m128i *>(static_cast<const void *>(s))));
+    const __m256i limb = _mm256_loadu_si256(static_cast<const __m256i *>(static_cast<const void *>(l)));
+    bad = _mm256_or_si256(bad, _mm256_or_si256(_mm256_cmpgt_epi64(size, one), _mm256_cmpgt_epi64(mone, size)));
+    bad = _mm256_or_si256(bad, _mm256_cmpgt_epi64(zero, limb));
+    // NOTE: the negation is (limb ^ mask) - mask, with mask all ones for negative sizes.
+    const __m256i neg = _mm256_cmpgt_epi64(zero, size);
+    return _mm256_sub_epi64(_mm256_xor_si256(limb, neg), neg);
+}
+
+// Store the (64-bit) sizes and the limbs of 4 elements, in the lanes which are not bad.
+__attribute__((target("avx2"))) inline void avx2_store_raw(mpz_size_t *s, ::mp_limb_t *l, __m256i size, __m256i limb,
+                                                           __m256i bad)
+{
+    const __m256i good = _mm256_xor_si256(bad, _mm256_set1_epi64x(-1));
+    // NOTE: narrow the sizes and the mask to 32 bits.
+    const __m256i perm = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+    _mm_maskstore_epi32(s, _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(good, perm)),
+                        _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(size, perm)));
+    _mm256_maskstore_epi64(reinterpret_cast<long long *>(l), good, limb);
+}
+
+// Store 4 elements from their values, in the lanes which are not bad.
+__attribute__((target("avx2"))) inline void avx2_store(mpz_size_t *s, ::mp_limb_t *l, __m256i value, __m256i bad)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i neg = _mm256_cmpgt_epi64(zero, value), pos = _mm256_cmpgt_epi64(value, zero);
+    // NOTE: the magnitude of -2**63 is computed correctly as an unsigned value.
+    avx2_store_raw(s, l, _mm256_sub_epi64(neg, pos), _mm256_sub_epi64(_mm256_xor_si256(value, neg), neg), bad);
+}
+
+__attribute__((target("avx2"))) inline unsigned avx2_mask(__m256i bad)
+{
+    return static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(bad)));
+}
+
+template <bool Sub>
+__attribute__((target("avx2"))) void avx2_addsub(mpz_size_t *rs, ::mp_limb_t *rl, const mpz_size_t *as,
+                                                 const ::mp_limb_t *al, const mpz_size_t *bs, const ::mp_limb_t *bl,
+                                                 std::size_t n, std::vector<std::size_t> &fixups)
+{
+    std::size_t i = 0;
+    for (; i + 4u <= n; i += 4u) {
+        __m256i bad = _mm256_setzero_si256();
+        const __m256i a = avx2_load(as + i, al + i, bad), b = avx2_load(bs + i, bl + i, bad);
+        const __m256i r = Sub ? _mm256_sub_epi64(a, b) : _mm256_add_epi64(a, b);
+        // Signed overflow detection.
+        const __m256i ovf = Sub ? _mm256_and_si256(_mm256_xor_si256(a, b), _mm256_xor_si256(a, r))
+                                : _mm256_andnot_si256(_mm256_xor_si256(a, b), _mm256_xor_si256(a, r));
+        bad = _mm256_or_si256(bad, _mm256_cmpgt_epi64(_mm256_setzero_si256(), ovf));
+        avx2_store(rs + i, rl + i, r, bad);
+        simd_push_fixups(fixups, i, avx2_mask(bad));
+    }
+    simd_push_tail(fixups, i, n);
+}
+
+__attribute__((target("avx2"))) void avx2_mul(mpz_size_t *rs, ::mp_limb_t *rl, const mpz_size_t *as,
+                                              const ::mp_limb_t *al, const mpz_size_t *bs, const ::mp_limb_t *bl,
+                                              std::size_t n, std::vector<std::size_t> &fixups)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; i + 4u <= n; i += 4u) {
+        __m256i bad = zero;
+        const __m256i a = avx2_load(as + i, al + i, bad), b = avx2_load(bs + i, bl + i, bad);
+        // NOTE: the operands must have magnitude less than 2**32, so that the
+        // product of the magnitudes can be computed via a 32x32->64 multiplication.
+        const __m256i na = _mm256_cmpgt_epi64(zero, a), nb = _mm256_cmpgt_epi64(zero, b);
+        const __m256i ma = _mm256_sub_epi64(_mm256_xor_si256(a, na), na),
+                      mb = _mm256_sub_epi64(_mm256_xor_si256(b, nb), nb);
+        bad = _mm256_or_si256(bad, _mm256_xor_si256(_mm256_cmpeq_epi64(_mm256_srli_epi64(_mm256_or_si256(ma, mb), 32),
+                                                                       zero),
+                                                    _mm256_set1_epi64x(-1)));
+        // NOTE: the product of the magnitudes is the limb of the result, its size
+        // is zero if the product is zero, otherwise -1 or 1 depending on the signs.
+        const __m256i p = _mm256_mul_epu32(ma, mb);
+        const __m256i size = _mm256_andnot_si256(_mm256_cmpeq_epi64(p, zero),
+                                                 _mm256_or_si256(_mm256_xor_si256(na, nb), _mm256_set1_epi64x(1)));
+        avx2_store_raw(rs + i, rl + i, size, p, bad);
+        simd_push_fixups(fixups, i, avx2_mask(bad));
+    }
+    simd_push_tail(fixups, i, n);
+}
+
+__attribute__((target("avx2"))) void avx2_mul_2exp(mpz_size_t *rs, ::mp_limb_t *rl, const mpz_size_t *as,
+                                                   const ::mp_limb_t *al, std::size_t n, unsigned s,
+                                                   std::vector<std::size_t> &fixups)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m128i sh = _mm_cvtsi32_si128(static_cast<int>(s)), rsh = _mm_cvtsi32_si128(static_cast<int>(64u - s));
+    std::size_t i = 0;
+    for (; i + 4u <= n; i += 4u) {
+        __m256i bad = zero;
+        // NOTE: here we only need to check the sizes, the limbs are shifted
+        // as unsigned values.
+        const __m256i size = _mm256_cvtepi32_epi64(
+            _mm_loadu_si128(static_cast<const __m128i *>(static_cast<const void *>(as + i))));
+        const __m256i limb = _mm256_loadu_si256(static_cast<const __m256i *>(static_cast<const void *>(al + i)));
+        bad = _mm256_or_si256(_mm256_cmpgt_epi64(size, _mm256_set1_epi64x(1)),
+                              _mm256_cmpgt_epi64(_mm256_set1_epi64x(-1), size));
+        // The bits shifted out of the limb must be zero.
+        // NOTE: shifts by 64 bits produce zero.
+        bad = _mm256_or_si256(bad, _mm256_xor_si256(_mm256_cmpeq_epi64(_mm256_srl_epi64(limb, rsh), zero),
+                                                    _mm256_set1_epi64x(-1)));
+        avx2_store_raw(rs + i, rl + i, size, _mm256_sll_epi64(limb, sh), bad);
+        simd_push_fixups(fixups, i, avx2_mask(bad));
+    }
+    simd_push_tail(fixups, i, n);
+}
+
+__attribute__((target("avx2"))) void avx2_cmp(int *out, const mpz_size_t *as, const ::mp_limb_t *al,
+                                              const mpz_size_t *bs, const ::mp_limb_t *bl, std::size_t n,
+                                              std::vector<std::size_t> &fixups)
+{
+    std::size_t i = 0;
+    for (; i + 4u <= n; i += 4u) {
+        __m256i bad = _mm256_setzero_si256();
+        const __m256i a = avx2_load(as + i, al + i, bad), b = avx2_load(bs + i, bl + i, bad);
+        const __m256i r = _mm256_sub_epi64(_mm256_cmpgt_epi64(b, a), _mm256_cmpgt_epi64(a, b));
+        const __m256i good = _mm256_xor_si256(bad, _mm256_set1_epi64x(-1));
+        const __m256i perm = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+        _mm_maskstore_epi32(out + i, _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(good, perm)),
+                            _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(r, perm)));
+        simd_push_fixups(fixups, i, avx2_mask(bad));
+    }
+    simd_push_tail(fixups, i, n);
+}
+
+// AVX-512 kernels (8 lanes).
+
+// NOTE: some versions of GCC emit spurious warnings about the
+// undefined vectors used in the implementation of the AVX-512 intrinsics.
+#if !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+
+__attribute__((target("avx512f"))) inline __m512i avx512_load(const mpz_size_t *s, const ::mp_limb_t *l,
+                                                              __mmask8 &bad)
+{
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i size
+        = _mm512_cvtepi32_epi64(_mm256_loadu_si256(static_cast<const __m256i *>(static_cast<const void *>(s))));
+    const __m512i limb = _mm512_loadu_si512(l);
+    bad = static_cast<__mmask8>(bad | _mm512_cmpgt_epi64_mask(size, _mm512_set1_epi64(1))
+                                | _mm512_cmplt_epi64_mask(size, _mm512_set1_epi64(-1))
+                                | _mm512_cmplt_epi64_mask(limb, zero));
+    return _mm512_mask_sub_epi64(limb, _mm512_cmplt_epi64_mask(size, zero), zero, limb);
+}
+
+__attribute__((target("avx512f"))) inline void avx512_store(mpz_size_t *s, ::mp_limb_t *l, __m512i value,
+                                                            __mmask8 bad)
+{
+    const __m512i zero = _mm512_setzero_si512();
+    const __mmask8 good = static_cast<__mmask8>(~bad);
+    const __m512i size = _mm512_sub_epi64(_mm512_maskz_set1_epi64(_mm512_cmpgt_epi64_mask(value, zero), 1),
+                                          _mm512_maskz_set1_epi64(_mm512_cmplt_epi64_mask(value, zero), 1));
+    _mm512_mask_cvtepi64_storeu_epi32(s, good, size);
+    _mm512_mask_storeu_epi64(l, good, _mm512_abs_epi64(value));
+}
+
+template <bool Sub>
+__attribute__((target("avx512f"))) void avx512_addsub(mpz_size_t *rs, ::mp_limb_t *rl, const mpz_size_t *as,
+                                                      const ::mp_limb_t *al, const mpz_size_t *bs,
+                                                      const ::mp_limb_t *bl, std::size_t n,
+                                                      std::vector<std::size_t> &fixups)
+{
+    const __m512i zero = _mm512_setzero_si512();
+    std::size_t i = 0;
+    for (; i + 8u <= n; i += 8u) {
+        __mmask8 bad = 0;
+        const __m512i a = avx512_load(as + i, al + i, bad), b = avx512_load(bs + i, bl + i, bad);
+        const __m512i r = Sub ? _mm512_sub_epi64(a, b) : _mm512_add_epi64(a, b);
+        const __m512i ovf = Sub ? _mm512_and_si512(_mm512_xor_si512(a, b), _mm512_xor_si512(a, r))
+                                : _mm512_andnot_si512(_mm512_xor_si512(a, b), _mm512_xor_si512(a, r));
+        bad = static_cast<__mmask8>(bad | _mm512_cmplt_epi64_mask(ovf, zero));
+        avx512_store(rs + i, rl + i, r, bad);
+        simd_push_fixups(fixups, i, bad);
+    }
+    simd_push_tail(fixups, i, n);
+}
+
+__attribute__((target("avx512f"))) void avx512_mul(mpz_size_t *rs, ::mp_limb_t *rl, const mpz_size_t *as,
+                                                   const ::mp_limb_t *al, const mpz_size_t *bs, const ::mp_limb_t *bl,
+                                                   std::size_t n, std::vector<std::size_t> &fixups)
+{
+    const __m512i zero = _mm512_setzero_si512();
+    std::size_t i = 0;
+    for (; i + 8u <= n; i += 8u) {
+        __mmask8 bad = 0;
+        const __m512i a = avx512_load(as + i, al + i, bad), b = avx512_load(bs + i, bl + i, bad);
+        const __m512i ma = _mm512_abs_epi64(a), mb = _mm512_abs_epi64(b);
+        bad = static_cast<__mmask8>(
+            bad | _mm512_cmpneq_epi64_mask(_mm512_srli_epi64(_mm512_or_si512(ma, mb), 32), zero));
+        const __m512i p = _mm512_mul_epu32(ma, mb);
+        // NOTE: the sign of a nonzero product is the sign of a ^ b.
+        const __m512i size
+            = _mm512_maskz_mov_epi64(_mm512_test_epi64_mask(p, p),
+                                     _mm512_mask_blend_epi64(_mm512_cmplt_epi64_mask(_mm512_xor_si512(a, b), zero),
+                                                             _mm512_set1_epi64(1), _mm512_set1_epi64(-1)));
+        const auto good = static_cast<__mmask8>(~bad);
+        _mm512_mask_cvtepi64_storeu_epi32(rs + i, good, size);
+        _mm512_mask_storeu_epi64(rl + i, good, p);
+        simd_push_fixups(fixups, i, bad);
+    }
+    simd_push_tail(fixups, i, n);
+}
+
+__attribute__((target("avx512f"))) void avx512_mul_2exp(mpz_size_t *rs, ::mp_limb_t *rl, const mpz_size_t *as,
+                                                        const ::mp_limb_t *al, std::size_t n, unsigned s,
+                                                        std::vector<std::size_t> &fixups)
+{
+    const __m512i zero = _mm512_setzero_si512();
+    const __m128i sh = _mm_cvtsi32_si128(static_cast<int>(s)), rsh = _mm_cvtsi32_si128(static_cast<int>(64u - s));
+    std::size_t i = 0;
+    for (; i + 8u <= n; i += 8u) {
+        const __m512i size = _mm512_cvtepi32_epi64(
+            _mm256_loadu_si256(static_cast<const __m256i *>(static_cast<const void *>(as + i))));
+        const __m512i limb = _mm512_loadu_si512(al + i);
+        const auto bad = static_cast<__mmask8>(_mm512_cmpgt_epi64_mask(size, _mm512_set1_epi64(1))
+                                               | _mm512_cmplt_epi64_mask(size, _mm512_set1_epi64(-1))
+                                               | _mm512_cmpneq_epi64_mask(_mm512_srl_epi64(limb, rsh), zero));
+        const auto good = static_cast<__mmask8>(~bad);
+        _mm512_mask_cvtepi64_storeu_epi32(rs + i, good, size);
+        _mm512_mask_storeu_epi64(rl + i, good, _mm512_sll_epi64(limb, sh));
+        simd_push_fixups(fixups, i, bad);
+    }
+    simd_push_tail(fixups, i, n);
+}
+
+__attribute__((target("avx512f"))) void avx512_cmp(int *out, const mpz_size_t *as, const ::mp_limb_t *al,
+                                                   const mpz_size_t *bs, const ::mp_limb_t *bl, std::size_t n,
+                                                   std::vector<std::size_t> &fixups)
+{
+    std::size_t i = 0;
+    for (; i + 8u <= n; i += 8u) {
+        __mmask8 bad = 0;
+        const __m512i a = avx512_load(as + i, al + i, bad), b = avx512_load(bs + i, bl + i, bad);
+        const __m512i r = _mm512_sub_epi64(_mm512_maskz_set1_epi64(_mm512_cmpgt_epi64_mask(a, b), 1),
+                                           _mm512_maskz_set1_epi64(_mm512_cmplt_epi64_mask(a, b), 1));
+        _mm512_mask_cvtepi64_storeu_epi32(out + i, static_cast<__mmask8>(~bad), r);
+        simd_push_fixups(fixups, i, bad);
+    }
+    simd_push_tail(fixups, i, n);
+}
+
+#if !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif
+
+// Detect the best available SIMD level.
+int integer_vector_simd_detect()
+{
+#if defined(MPPP_INTEGER_VECTOR_SIMD)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return 2;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return 1;
+    }
+#endif
+    return 0;
+}
+
+std::atomic<int> &integer_vector_simd_level_ref()
+{
+    static std::atomic<int> level(integer_vector_simd_detect());
+    return level;
+}
+
+} // namespace
+
+int integer_vector_simd_level()
+{
+    return integer_vector_simd_level_ref().load(std::memory_order_relaxed);
+}
+
+void integer_vector_set_simd_level(int level)
+{
+    const auto max_level = integer_vector_simd_detect();
+    integer_vector_simd_level_ref().store(level < 0 ? 0 : (level > max_level ? max_level : level),
+                                          std::memory_order_relaxed);
+}
+
+void integer_vector_simd_add(mpz_size_t *rs, ::mp_limb_t *rl, const mpz_size_t *as, const ::mp_limb_t *al,
+                             const mpz_size_t *bs, const ::mp_limb_t *bl, std::size_t n,
+                             std::vector<std::size_t> &fixups)
+{
+    switch (integer_vector_simd_level()) {
+#if defined(MPPP_INTEGER_VECTOR_SIMD)
+        case 2:
+            return avx512_addsub<false>(rs, rl, as, al, bs, bl, n, fixups);
+        case 1:
+            return avx2_addsub<false>(rs, rl, as, al, bs, bl, n, fixups);
+#endif
+        default:
+            ignore(rs, rl, as, al, bs, bl);
+            simd_push_tail(fixups, 0, n);
+    }
+}
+
+void integer_vector_simd_sub(mpz_size_t *rs, ::mp_limb_t *rl, const mpz_size_t *as, const ::mp_limb_t *al,
+                             const mpz_size_t *bs, const ::mp_limb_t *bl, std::size_t n,
+                             std::vector<std::size_t> &fixups)
+{
+    switch (integer_vector_simd_level()) {
+#if defined(MPPP_INTEGER_VECTOR_SIMD)
+        case 2:
+            return avx512_addsub<true>(rs, rl, as, al, bs, bl, n, fixups);
+        case 1:
+            return avx2_addsub<true>(rs, rl, as, al, bs, bl, n, fixups);
+#endif
+        default:
+            ignore(rs, rl, as, al, bs, bl);
+            simd_push_tail(fixups, 0, n);
+    }
+}
+
+void integer_vector_simd_mul(mpz_size_t *rs, ::mp_limb_t *rl, const mpz_size_t *as, const ::mp_limb_t *al,
+                             const mpz_size_t *bs, const ::mp_limb_t *bl, std::size_t n,
+                             std::vector<std::size_t> &fixups)
+{
+    switch (integer_vector_simd_level()) {
+#if defined(MPPP_INTEGER_VECTOR_SIMD)
+        case 2:
+            return avx512_mul(rs, rl, as, al, bs, bl, n, fixups);
+        case 1:
+            return avx2_mul(rs, rl, as, al, bs, bl, n, fixups);
+#endif
+        default:
+            ignore(rs, rl, as, al, bs, bl);
+            simd_push_tail(fixups, 0, n);
+    }
+}
+
+void integer_vector_simd_mul_2exp(mpz_size_t *rs, ::mp_limb_t *rl, const mpz_size_t *as, const ::mp_limb_t *al,
+                                  std::size_t n, unsigned s, std::vector<std::size_t> &fixups)
+{
+    switch (s < 64u ? integer_vector_simd_level() : 0) {
+#if defined(MPPP_INTEGER_VECTOR_SIMD)
+        case 2:
+            return avx512_mul_2exp(rs, rl, as, al, n, s, fixups);
+        case 1:
+            return avx2_mul_2exp(rs, rl, as, al, n, s, fixups);
+#endif
+        default:
+            ignore(rs, rl, as, al, s);
+            simd_push_tail(fixups, 0, n);
+    }
+}
+
+void integer_vector_simd_cmp(int *out, const mpz_size_t *as, const ::mp_limb_t *al, const mpz_size_t *bs,
+                             const ::mp_limb_t *bl, std::size_t n, std::vector<std::size_t> &fixups)
+{
+    switch (integer_vector_simd_level()) {
+#if defined(MPPP_INTEGER_VECTOR_SIMD)
+        case 2:
+            return avx512_cmp(out, as, al, bs, bl, n, fixups);
+        case 1:
+            return avx2_cmp(out, as, al, bs, bl, n, fixups);
+#endif
+        default:
+            ignore(out, as, al, bs, bl);
+            simd_push_tail(fixups, 0, n);
+    }
+}
+
+} // namespace detail
+
+} // namespace mppp
@@ -0,0 +1,275 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <mp++/config.hpp>
+#include <mp++/integer_arena.hpp>
+#include <mp++/parallel.hpp>
+
+namespace mppp
+{
+
+namespace detail
+{
+
+namespace
+{
+
+// A group of tasks submitted by a single call to thread_pool::run().
+struct task_group {
+    explicit task_group(const std::function<void(std::size_t)> &f, std::size_t n) : m_f(f), m_remaining(n) {}
+
+    const std::function<void(std::size_t)> &m_f;
+    // NOTE: m_remaining is modified only while holding m_mutex, but it
+    // is also read without locking by the thread waiting for the group.
+    std::atomic<std::size_t> m_remaining;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::exception_ptr m_error;
+};
+
+struct task {
+    task_group *m_group;
+    std::size_t m_idx;
+};
+
+// Work-stealing thread pool.
+//
+// Each worker thread has its own task queue. A worker takes tasks from the back
+// of its own queue and, when that is empty, steals from the front of the other
+// queues. The thread submitting a group of tasks distributes them among the queues
+// and participates in their execution until the whole group has been completed, so
+// that nested submissions from within a task cannot deadlock.
+class thread_pool
+{
+public:
+    explicit thread_pool(unsigned n) : m_queues(n)
+    {
+        for (auto &q : m_queues) {
+            q.reset(new queue);
+        }
+        m_threads.reserve(n);
+        try {
+            for (unsigned i = 0; i < n; ++i) {
+                m_threads.emplace_back([this, i]() { worker(i); });
+            }
+        } catch (...) {
+            stop();
+            throw;
+        }
+    }
+    thread_pool(const thread_pool &) = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+    ~thread_pool()
+    {
+        stop();
+    }
+
+    // Run f(0), ..., f(n - 1) and wait for their completion.
+    void run(std::size_t n, const std::function<void(std::size_t)> &f)
+    {
+        task_group group(f, n);
+        if (m_queues.empty()) {
+            for (std::size_t i = 0; i < n; ++i) {
+                execute(task{&group, i});
+            }
+        } else {
+            for (std::size_t i = 0; i < n; ++i) {
+                auto &q = *m_queues[i % m_queues.size()];
+                std::lock_guard<std::mutex> lock(q.m_mutex);
+                q.m_tasks.push_back(task{&group, i});
+            }
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_queued += n;
+            }
+            m_cv.notify_all();
+            // Help with the execution of the tasks.
+            task t;
+            while (group.m_remaining.load() != 0u && try_steal(0, t)) {
+                execute(t);
+            }
+        }
+        {
+            std::unique_lock<std::mutex> lock(group.m_mutex);
+            group.m_cv.wait(lock, [&group]() { return group.m_remaining.load() == 0u; });
+        }
+        if (group.m_error) {
+            std::rethrow_exception(group.m_error);
+        }
+    }
+
+private:
+    struct queue {
+        std::mutex m_mutex;
+        std::deque<task> m_tasks;
+    };
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        for (auto &t : m_threads) {
+            t.join();
+        }
+    }
+    bool try_pop(std::size_t idx, task &t)
+    {
+        auto &q = *m_queues[idx];
+        std::lock_guard<std::mutex> lock(q.m_mutex);
+        if (q.m_tasks.empty()) {
+            return false;
+        }
+        t = q.m_tasks.back();
+        q.m_tasks.pop_back();
+        --m_queued;
+        return true;
+    }
+    // Steal a task from the front of the queues, starting from the queue at index start.
+    bool try_steal(std::size_t start, task &t)
+    {
+        for (std::size_t i = 0; i < m_queues.size(); ++i) {
+            auto &q = *m_queues[(start + i) % m_queues.size()];
+            std::lock_guard<std::mutex> lock(q.m_mutex);
+            if (!q.m_tasks.empty()) {
+                t = q.m_tasks.front();
+                q.m_tasks.pop_front();
+                --m_queued;
+                return true;
+            }
+        }
+        return false;
+    }
+    static void execute(const task &t)
+    {
+        auto &group = *t.m_group;
+#if defined(MPPP_HAVE_THREAD_LOCAL)
+        // NOTE: the integers produced by a task may be modified or destroyed by
+        // other threads, thus they must not be allocated from the arena of the
+        // thread executing it (which is active if the thread is the submitting one).
+        const auto arena = mpz_arena_suspend();
+#endif
+        std::exception_ptr error;
+        try {
+            group.m_f(t.m_idx);
+        } catch (...) {
+            error = std::current_exception();
+        }
+#if defined(MPPP_HAVE_THREAD_LOCAL)
+        mpz_arena_resume(arena);
+#endif
+        // NOTE: the group cannot be destroyed before the mutex is released,
+        // because the submitting thread waits on it.
+        std::lock_guard<std::mutex> lock(group.m_mutex);
+        if (error && !group.m_error) {
+            group.m_error = error;
+        }
+        if (--group.m_remaining == 0u) {
+            group.m_cv.notify_all();
+        }
+    }
+    void worker(std::size_t idx)
+    {
+        while (true) {
+            task t;
+            if (try_pop(idx, t) || try_steal(idx + 1u, t)) {
+                execute(t);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this]() { return m_stop || m_queued.load() != 0u; });
+            if (m_stop && m_queued.load() == 0u) {
+                return;
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<queue>> m_queues;
+    std::vector<std::thread> m_threads;
+    // Number of tasks in the queues. It is increased while holding m_mutex,
+    // so that the workers waiting on m_cv do not miss any wakeup.
+    std::atomic<std::size_t> m_queued{0};
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stop = false;
+};
+
+unsigned parallel_default_n_threads()
+{
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+// The global pool, together with the mutex protecting it. The pool is created
+// lazily, and the calling thread is counted in the number of threads.
+std::mutex parallel_pool_mutex;
+std::shared_ptr<thread_pool> parallel_pool;
+unsigned parallel_n_threads = 0;
+
+std::shared_ptr<thread_pool> parallel_get_pool()
+{
+    std::lock_guard<std::mutex> lock(parallel_pool_mutex);
+    if (!parallel_pool) {
+        if (parallel_n_threads == 0u) {
+            parallel_n_threads = parallel_default_n_threads();
+        }
+        parallel_pool = std::make_shared<thread_pool>(parallel_n_threads - 1u);
+    }
+    return parallel_pool;
+}
+
+} // namespace
+
+void parallel_run(std::size_t n, const std::function<void(std::size_t)> &f)
+{
+    // NOTE: the pool is kept alive by the shared pointer even
+    // if it is replaced by set_n_threads() in the meantime.
+    parallel_get_pool()->run(n, f);
+}
+
+} // namespace detail
+
+namespace parallel
+{
+
+unsigned get_n_threads()
+{
+    std::lock_guard<std::mutex> lock(detail::parallel_pool_mutex);
+    return detail::parallel_n_threads == 0u ? detail::parallel_default_n_threads() : detail::parallel_n_threads;
+}
+
+void set_n_threads(unsigned n)
+{
+    std::shared_ptr<detail::thread_pool> old;
+    {
+        std::lock_guard<std::mutex> lock(detail::parallel_pool_mutex);
+        detail::parallel_n_threads = n == 0u ? detail::parallel_default_n_threads() : n;
+        old = std::move(detail::parallel_pool);
+    }
+    // NOTE: the old pool (if any) is destroyed here, outside the critical section,
+    // unless some other thread is still using it.
+}
+
+} // namespace parallel
+
+} // namespace mppp
@@ -0,0 +1,207 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <thread>
+#include <vector>
+
+#include <mp++/prime_sieve.hpp>
+
+namespace mppp
+{
+
+namespace detail
+{
+
+namespace
+{
+
+// Number of odd values sieved at once. The sieving flags (one byte per odd value)
+// are sized to fit in a typical L2 cache.
+constexpr std::size_t prime_sieve_block = 1ul << 17;
+
+// Minimum number of values per chunk in the multithreaded sieve.
+constexpr std::uint64_t prime_sieve_min_chunk = 1ull << 21;
+
+} // namespace
+
+// Integer square root.
+std::uint64_t prime_sieve_isqrt(std::uint64_t n)
+{
+    // NOTE: n is at most prime_sieve_limit, so the floating-point
+    // result is off by at most one.
+    assert(n <= prime_sieve_limit);
+    auto r = static_cast<std::uint64_t>(std::sqrt(static_cast<double>(n)));
+    while (r * r > n) {
+        --r;
+    }
+    while ((r + 1u) * (r + 1u) <= n) {
+        ++r;
+    }
+    return r;
+}
+
+// Odd primes p such that p * p < hi, in ascending order.
+std::vector<std::uint32_t> prime_sieve_base(std::uint64_t hi)
+{
+    assert(hi <= prime_sieve_limit);
+    std::vector<std::uint32_t> retval;
+    const auto r = hi != 0u ? prime_sieve_isqrt(hi - 1u) : std::uint64_t(0);
+    if (r < 3u) {
+        return retval;
+    }
+    // Plain sieve of Eratosthenes on the odd values up to r. The value
+    // at index i is 2 * i + 1.
+    const auto size = static_cast<std::size_t>(r / 2u + 1u);
+    std::vector<unsigned char> composite(size);
+    for (std::size_t i = 1; i < size; ++i) {
+        if (!composite[i]) {
+            const auto p = 2u * i + 1u;
+            retval.push_back(static_cast<std::uint32_t>(p));
+            for (auto j = p * p / 2u; j < size; j += p) {
+                composite[j] = 1;
+            }
+        }
+    }
+    return retval;
+}
+
+// Append the primes in the [lo, hi) range to out, using the base primes
+// computed by prime_sieve_base() for an upper limit of at least hi.
+void prime_sieve_segment(const std::vector<std::uint32_t> &base, std::uint64_t lo, std::uint64_t hi,
+                         std::vector<std::uint64_t> &out)
+{
+    assert(hi <= prime_sieve_limit);
+    if (lo <= 2u && hi > 2u) {
+        out.push_back(2u);
+    }
+    // The first odd value greater than or equal to max(lo, 3).
+    const auto start = std::max(lo, std::uint64_t(3)) | 1u;
+    if (start >= hi) {
+        return;
+    }
+    // For each base prime p, the index of the next odd multiple of p to be
+    // crossed out, relative to the beginning of the current block. Sieving starts
+    // from p * p, as the smaller multiples are crossed out by smaller primes.
+    // NOTE: computing the offsets once (rather than once per block) avoids
+    // a division per base prime per block.
+    std::vector<std::uint64_t> offsets(base.size());
+    for (std::size_t k = 0; k < base.size(); ++k) {
+        const std::uint64_t p = base[k], pp = p * p;
+        std::uint64_t m;
+        if (pp >= start) {
+            m = pp;
+        } else {
+            m = start + (p - start % p) % p;
+            if (!(m & 1u)) {
+                m += p;
+            }
+        }
+        offsets[k] = (m - start) / 2u;
+    }
+    std::vector<unsigned char> flags(prime_sieve_block);
+    for (auto b = start; b < hi;) {
+        // Number of odd values in the current block.
+        const auto n = static_cast<std::size_t>(std::min(std::uint64_t(prime_sieve_block), (hi - b + 1u) / 2u));
+        std::fill(flags.begin(), flags.begin() + static_cast<std::ptrdiff_t>(n), static_cast<unsigned char>(0));
+        for (std::size_t k = 0; k < base.size(); ++k) {
+            const std::uint64_t p = base[k];
+            auto i = offsets[k];
+            for (; i < n; i += p) {
+                flags[static_cast<std::size_t>(i)] = 1;
+            }
+            offsets[k] = i - n;
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            if (!flags[i]) {
+                out.push_back(b + 2u * i);
+            }
+        }
+        b += 2u * n;
+    }
+}
+
+// Append the primes in the [lo, hi) range to out, using up to nthreads threads.
+void prime_sieve(std::uint64_t lo, std::uint64_t hi, std::vector<std::uint64_t> &out, unsigned nthreads)
+{
+    assert(hi <= prime_sieve_limit);
+    if (lo >= hi) {
+        return;
+    }
+    const auto base = prime_sieve_base(hi);
+    if (nthreads == 0u) {
+        nthreads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    // NOTE: split the range in a few chunks per thread, so that
+    // the load is balanced even if the threads run at different speeds.
+    const auto chunk
+        = std::max(prime_sieve_min_chunk, (hi - lo) / (std::uint64_t(nthreads) * 4u) + 1u) & ~std::uint64_t(1);
+    const auto nchunks = static_cast<std::size_t>((hi - lo - 1u) / chunk + 1u);
+    if (nthreads == 1u || nchunks == 1u) {
+        prime_sieve_segment(base, lo, hi, out);
+        return;
+    }
+    nthreads = static_cast<unsigned>(std::min(std::size_t(nthreads), nchunks));
+    std::vector<std::vector<std::uint64_t>> results(nchunks);
+    std::vector<std::exception_ptr> errors(nthreads);
+    std::atomic<std::size_t> next_chunk(0);
+    const auto worker = [&](unsigned idx) {
+        try {
+            for (auto i = next_chunk++; i < nchunks; i = next_chunk++) {
+                const auto c_lo = lo + i * chunk, c_hi = std::min(hi, c_lo + chunk);
+                prime_sieve_segment(base, c_lo, c_hi, results[i]);
+            }
+        } catch (...) {
+            errors[idx] = std::current_exception();
+        }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(nthreads - 1u);
+    try {
+        for (unsigned i = 1; i < nthreads; ++i) {
+            threads.emplace_back(worker, i);
+        }
+    } catch (...) {
+        // NOTE: if a thread cannot be started, the threads already running
+        // reference the locals of this frame: stop them from picking up
+        // new chunks and wait for them before propagating the error.
+        next_chunk = nchunks;
+        for (auto &t : threads) {
+            t.join();
+        }
+        throw;
+    }
+    // NOTE: the calling thread participates in the computation.
+    worker(0);
+    for (auto &t : threads) {
+        t.join();
+    }
+    for (const auto &e : errors) {
+        if (e) {
+            std::rethrow_exception(e);
+        }
+    }
+    std::size_t total = 0;
+    for (const auto &r : results) {
+        total += r.size();
+    }
+    out.reserve(out.size() + total);
+    for (const auto &r : results) {
+        out.insert(out.end(), r.begin(), r.end());
+    }
+}
+
+} // namespace detail
+
+} // namespace mppp
@@ -0,0 +1,206 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <mp++/config.hpp>
+#include <mp++/fast_allocator.hpp>
+#include <mp++/integer.hpp>
+#include <mp++/integer_arena.hpp>
+#include <mp++/rational.hpp>
+
+#if defined(MPPP_WITH_MPFR)
+#include <mp++/real.hpp>
+#endif
+
+#include "catch.hpp"
+#include "test_utils.hpp"
+
+static int ntries = 1000;
+
+using namespace mppp;
+using namespace mppp_test;
+
+using int_t = integer<1>;
+using rat_t = rational<1>;
+
+// NOTE: the installation of the allocator affects the whole process,
+// thus all the checks are in a single test case.
+TEST_CASE("fast allocator")
+{
+    // Bypass the integer caches, so that all the
+    // allocations go through the GMP memory functions.
+    const auto orig_cfg = get_global_integer_cache_config();
+    integer_cache_config cfg;
+    cfg.max_limbs = 0;
+    set_global_integer_cache_config(cfg);
+
+    // Objects allocated before the installation of the allocator.
+    const auto big = pow(int_t{3}, 5000u);
+    auto pre = big + 1;
+    auto pre_rat = rat_t{big, big + 2};
+    detail::mpz_raii pre_mpz;
+    ::mpz_set(&pre_mpz.m_mpz, big.get_mpz_view());
+
+    REQUIRE(!fast_allocator_installed());
+    install_fast_allocator();
+#if defined(MPPP_HAVE_THREAD_LOCAL)
+    REQUIRE(fast_allocator_installed());
+#endif
+    // Installing again has no effect.
+    install_fast_allocator();
+
+    // The memory allocated before the installation can be reallocated and freed.
+    pre <<= 100000;
+    REQUIRE(pre == (big + 1) << 100000);
+    pre = int_t{};
+    pre_rat += 1;
+    REQUIRE(pre_rat == rat_t{2 * big + 2, big + 2});
+    ::mpz_mul_2exp(&pre_mpz.m_mpz, &pre_mpz.m_mpz, 100000);
+    REQUIRE(int_t{&pre_mpz.m_mpz} == big << 100000);
+
+    // Random arithmetic with sizes spanning all the size classes and the larger requests.
+    std::mt19937 rng;
+    detail::mpz_raii tmp, tmp2, res;
+    for (unsigned x = 1; x < 2000u; x = x * 3u / 2u + 1u) {
+        for (int i = 0; i < ntries / 10; ++i) {
+            random_integer(tmp, x, rng);
+            random_integer(tmp2, x, rng);
+            int_t a{&tmp.m_mpz}, b{&tmp2.m_mpz};
+            ::mpz_mul(&res.m_mpz, &tmp.m_mpz, &tmp2.m_mpz);
+            ::mpz_add(&res.m_mpz, &res.m_mpz, &tmp.m_mpz);
+            auto r = a * b + a;
+            REQUIRE(r == int_t{&res.m_mpz});
+            r <<= 1000;
+            r >>= 1000;
+            REQUIRE(r == int_t{&res.m_mpz});
+            REQUIRE(r.to_string() == detail::mpz_to_str(&res.m_mpz));
+        }
+    }
+
+    // Values growing past the largest size class and shrinking back.
+    {
+        int_t g{1};
+        for (int i = 0; i < 100; ++i) {
+            g <<= 1000;
+            g += 1;
+        }
+        REQUIRE(g.nbits() == 100001u);
+        g >>= 99000;
+        ::mpz_realloc2(g.get_mpz_t(), 1100);
+        REQUIRE(g.nbits() == 1001u);
+        g = g * g + g;
+        REQUIRE((g >> 2000) == 1);
+    }
+
+    // Rationals.
+    rat_t q{0};
+    for (int i = 1; i < 200; ++i) {
+        q += rat_t{1, i};
+    }
+    REQUIRE(q - rat_t{1, 199} + rat_t{1, 199} == q);
+
+#if defined(MPPP_WITH_MPFR)
+    // Reals.
+    real rv{1, 1000};
+    for (int i = 0; i < 100; ++i) {
+        rv = sqrt(rv + 1);
+    }
+    REQUIRE(rv > 1);
+#endif
+
+    // The integers created by a thread and destroyed by another one.
+    {
+        std::mutex m;
+        std::vector<std::vector<int_t>> queue;
+        std::atomic<bool> flag{true};
+        std::atomic<int> producers{4};
+        auto producer = [&](unsigned n) {
+            std::mt19937 prng;
+            prng.seed(n);
+            detail::mpz_raii ptmp;
+            for (int r = 0; r < 20; ++r) {
+                std::vector<int_t> v;
+                for (int i = 0; i < ntries; ++i) {
+                    random_integer(ptmp, n + 2u, prng);
+                    v.emplace_back(&ptmp.m_mpz);
+                    if (v.back() != int_t{&ptmp.m_mpz}) {
+                        flag.store(false);
+                    }
+                }
+                std::lock_guard<std::mutex> lock(m);
+                queue.push_back(std::move(v));
+            }
+            --producers;
+        };
+        auto consumer = [&]() {
+            while (true) {
+                std::vector<int_t> v;
+                {
+                    std::lock_guard<std::mutex> lock(m);
+                    if (queue.empty()) {
+                        if (producers.load() == 0) {
+                            return;
+                        }
+                    } else {
+                        v = std::move(queue.back());
+                        queue.pop_back();
+                    }
+                }
+                for (auto &n : v) {
+                    // Reallocate and destroy.
+                    n <<= 2000;
+                }
+            }
+        };
+        std::vector<std::thread> threads;
+        for (unsigned i = 0; i < 4u; ++i) {
+            threads.emplace_back(producer, i);
+            threads.emplace_back(consumer);
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+        REQUIRE(flag.load());
+    }
+
+    // Short-lived threads, reusing the heaps of the exited threads.
+    for (int r = 0; r < 10; ++r) {
+        int_t out;
+        std::thread t([&out, &big]() {
+            std::vector<int_t> v;
+            for (int i = 0; i < ntries; ++i) {
+                v.push_back(big + i);
+            }
+            // Return an integer allocated by the exiting thread.
+            out = v.back();
+        });
+        t.join();
+        REQUIRE(out == big + (ntries - 1));
+    }
+
+    // Composition with the arenas.
+    {
+        integer_arena ar;
+        auto a = big + 1;
+        a <<= 10000;
+        REQUIRE(a == (big + 1) << 10000);
+        pre = a;
+    }
+    REQUIRE(pre == (big + 1) << 10000);
+    pre *= 2;
+    REQUIRE(pre == (big + 1) << 10001);
+
+    set_global_integer_cache_config(orig_cfg);
+}
@@ -0,0 +1,112 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <cstddef>
+#include <list>
+#include <random>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include <gmp.h>
+
+#include <mp++/integer.hpp>
+#include <mp++/integer_accumulator.hpp>
+
+#include "catch.hpp"
+#include "test_utils.hpp"
+
+static int ntries = 1000;
+
+using namespace mppp;
+using namespace mppp_test;
+
+using sizes = std::tuple<std::integral_constant<std::size_t, 1>, std::integral_constant<std::size_t, 2>,
+                         std::integral_constant<std::size_t, 3>, std::integral_constant<std::size_t, 6>,
+                         std::integral_constant<std::size_t, 10>>;
+
+static std::mt19937 rng;
+
+struct accumulator_tester {
+    template <typename S>
+    inline void operator()(const S &) const
+    {
+        using integer = integer<S::value>;
+        // Empty accumulator.
+        integer_accumulator<S::value> acc;
+        REQUIRE(acc.finalize() == 0);
+        acc.addmul(integer{}, integer{42});
+        acc.addmul(integer{-42}, integer{});
+        REQUIRE(acc.finalize() == 0);
+        // Simple values, and cancellation.
+        acc.addmul(integer{3}, integer{4});
+        acc.addmul(integer{-5}, integer{2});
+        REQUIRE(acc.finalize() == 2);
+        acc.addmul(integer{3}, integer{4});
+        acc.addmul(integer{-3}, integer{4});
+        REQUIRE(acc.finalize() == 0);
+        acc.addmul(integer{-3}, integer{4});
+        acc.addmul(integer{-3}, integer{-2});
+        REQUIRE(acc.finalize() == -6);
+        // Carry propagation across limbs.
+        const integer lmax{GMP_NUMB_MAX};
+        integer cmp;
+        for (int i = 0; i < 100; ++i) {
+            acc.addmul(lmax, lmax);
+            addmul(cmp, lmax, lmax);
+        }
+        REQUIRE(acc.finalize() == cmp);
+        // Random testing against addmul(), with operands of different sizes
+        // and storage types.
+        detail::mpz_raii tmp;
+        std::uniform_int_distribution<int> sdist(0, 1);
+        std::uniform_int_distribution<unsigned> ldist(0, S::value + 1u);
+        for (int i = 0; i < ntries / 10; ++i) {
+            cmp.set_zero();
+            for (int j = 0; j < 20; ++j) {
+                random_integer(tmp, ldist(rng), rng);
+                integer a{&tmp.m_mpz};
+                random_integer(tmp, ldist(rng), rng);
+                integer b{&tmp.m_mpz};
+                if (sdist(rng)) {
+                    a.neg();
+                }
+                if (sdist(rng)) {
+                    b.neg();
+                }
+                if (a.is_static() && sdist(rng) && sdist(rng)) {
+                    a.promote();
+                }
+                acc.addmul(a, b);
+                addmul(cmp, a, b);
+            }
+            REQUIRE(acc.finalize() == cmp);
+        }
+        // The dot product.
+        std::vector<integer> v1, v2;
+        REQUIRE(dot(v1.begin(), v1.end(), v2.begin()) == 0);
+        cmp.set_zero();
+        for (int i = 0; i < ntries; ++i) {
+            random_integer(tmp, 1, rng);
+            v1.emplace_back(&tmp.m_mpz);
+            random_integer(tmp, 1, rng);
+            v2.emplace_back(&tmp.m_mpz);
+            if (sdist(rng)) {
+                v1.back().neg();
+            }
+            addmul(cmp, v1.back(), v2.back());
+        }
+        REQUIRE(dot(v1.begin(), v1.end(), v2.begin()) == cmp);
+        REQUIRE(dot(v1.cbegin(), v1.cend(), std::list<integer>(v2.begin(), v2.end()).begin()) == cmp);
+    }
+};
+
+TEST_CASE("integer_accumulator")
+{
+    tuple_for_each(sizes{}, accumulator_tester{});
+}
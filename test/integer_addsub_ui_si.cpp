@@ -26,8 +26,8 @@ using namespace mppp;
 using namespace mppp_test;
 
 using sizes = std::tuple<std::integral_constant<std::size_t, 1>, std::integral_constant<std::size_t, 2>,
-                         std::integral_constant<std::size_t, 3>, std::integral_constant<std::size_t, 6>,
-                         std::integral_constant<std::size_t, 10>>;
+                         std::integral_constant<std::size_t, 3>, std::integral_constant<std::size_t, 4>,
+                         std::integral_constant<std::size_t, 6>, std::integral_constant<std::size_t, 10>>;
 
 using uint_types = std::tuple<unsigned char, unsigned short, unsigned, unsigned long, unsigned long long
 #if defined(MPPP_HAVE_GCC_INT128)
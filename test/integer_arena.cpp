@@ -0,0 +1,232 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <atomic>
+#include <cstddef>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <mp++/config.hpp>
+#include <mp++/integer.hpp>
+#include <mp++/integer_arena.hpp>
+#include <mp++/parallel.hpp>
+#include <mp++/rational.hpp>
+
+#include "catch.hpp"
+#include "test_utils.hpp"
+
+static int ntries = 1000;
+
+using namespace mppp;
+using namespace mppp_test;
+
+using int_t = integer<1>;
+
+TEST_CASE("arena basic")
+{
+    std::mt19937 rng;
+    detail::mpz_raii tmp, tmp2;
+    {
+        integer_arena ar;
+        REQUIRE(ar.allocated() == 0u);
+        REQUIRE(ar.reserved() == 0u);
+        REQUIRE(ar.live() == 0u);
+        std::vector<int_t> v;
+        for (int i = 0; i < ntries; ++i) {
+            random_integer(tmp, 3, rng);
+            v.emplace_back(&tmp.m_mpz);
+            REQUIRE(v.back().is_dynamic());
+            REQUIRE(v.back() == int_t{&tmp.m_mpz});
+        }
+#if defined(MPPP_HAVE_THREAD_LOCAL)
+        REQUIRE(ar.live() == v.size());
+        REQUIRE(ar.allocated() >= v.size() * 3u * sizeof(::mp_limb_t));
+        REQUIRE(ar.reserved() >= ar.allocated());
+#endif
+        // Arithmetic on the integers allocated from the arena.
+        for (std::size_t i = 1; i < v.size(); ++i) {
+            ::mpz_mul(&tmp.m_mpz, v[i - 1u].get_mpz_view(), v[i].get_mpz_view());
+            ::mpz_add(&tmp.m_mpz, &tmp.m_mpz, v[i].get_mpz_view());
+            auto r = v[i - 1u] * v[i] + v[i];
+            REQUIRE(r == int_t{&tmp.m_mpz});
+            v[i - 1u] = std::move(r);
+        }
+        // Copies.
+        const auto v2 = v;
+        REQUIRE(v2 == v);
+        v.clear();
+#if defined(MPPP_HAVE_THREAD_LOCAL)
+        // The arrays of the destroyed integers were released to the arena.
+        REQUIRE(ar.live() == v2.size());
+#endif
+    }
+    // Rationals.
+    rational<1> q0{0};
+    for (int i = 1; i < 100; ++i) {
+        q0 += rational<1>{1, i};
+    }
+    {
+        integer_arena ar;
+        rational<1> q{0};
+        for (int i = 1; i < 100; ++i) {
+            q += rational<1>{1, i};
+        }
+        REQUIRE(q == q0);
+    }
+}
+
+TEST_CASE("arena realloc")
+{
+    integer_arena ar;
+    {
+        int_t n{1};
+        for (int i = 0; i < 100; ++i) {
+            // NOTE: the reallocations performed by GMP
+            // are served by the arena too.
+            n <<= 100;
+#if defined(MPPP_HAVE_THREAD_LOCAL)
+            REQUIRE(ar.live() == (n.is_dynamic() ? 1u : 0u));
+#endif
+        }
+        REQUIRE(n == pow(int_t{2}, 10000u));
+#if defined(MPPP_HAVE_THREAD_LOCAL)
+        REQUIRE(ar.live() == 1u);
+#endif
+    }
+#if defined(MPPP_HAVE_THREAD_LOCAL)
+    REQUIRE(ar.live() == 0u);
+#endif
+}
+
+TEST_CASE("arena escape")
+{
+    const auto big = pow(int_t{7}, 500u);
+    int_t out, out2;
+    {
+        integer_arena ar;
+        auto tmp = big + 1;
+        REQUIRE(tmp.is_dynamic());
+        out = std::move(tmp);
+        out2 = out - 2;
+#if defined(MPPP_HAVE_THREAD_LOCAL)
+        REQUIRE(ar.live() == 2u);
+#endif
+    }
+    // The integers which escaped the scope of the arena are still valid.
+    REQUIRE(out == big + 1);
+    REQUIRE(out2 == big - 1);
+    // A reallocation moves the limbs out of the arena.
+    out *= out2;
+    REQUIRE(out == big * big - 1);
+    out2 = int_t{};
+    // New dynamic integers do not come from the arena any more.
+    auto tmp = out + 1;
+    REQUIRE(tmp == big * big);
+}
+
+TEST_CASE("arena nested")
+{
+    const auto big = pow(int_t{3}, 500u);
+    integer_arena outer;
+    auto a = big + 1;
+    {
+        integer_arena inner;
+        auto b = big + 2;
+        auto c = a + b;
+#if defined(MPPP_HAVE_THREAD_LOCAL)
+        REQUIRE(outer.live() == 1u);
+        REQUIRE(inner.live() == 2u);
+#endif
+        // Reallocate an array of the outer arena while the inner one is active.
+        a <<= 10000;
+        REQUIRE(a == (big + 1) << 10000);
+#if defined(MPPP_HAVE_THREAD_LOCAL)
+        REQUIRE(outer.live() == 0u);
+        REQUIRE(inner.live() == 3u);
+#endif
+        REQUIRE(c == 2 * big + 3);
+        a = big + 5;
+    }
+    auto d = big + 4;
+    REQUIRE(d > big);
+#if defined(MPPP_HAVE_THREAD_LOCAL)
+    // a is still alive, its limbs belong to the inner arena.
+    REQUIRE(outer.live() == 1u);
+#endif
+    REQUIRE(a == big + 5);
+}
+
+TEST_CASE("arena threads")
+{
+    std::atomic<bool> flag{true};
+    auto func = [&flag](unsigned n) {
+        std::mt19937 rng;
+        rng.seed(n);
+        detail::mpz_raii tmp, acc;
+        for (int r = 0; r < 10; ++r) {
+            integer_arena ar(128);
+            int_t sum;
+            ::mpz_set_ui(&acc.m_mpz, 0);
+            for (int i = 0; i < ntries; ++i) {
+                random_integer(tmp, n + 1u, rng);
+                ::mpz_addmul(&acc.m_mpz, &tmp.m_mpz, &tmp.m_mpz);
+                const int_t x{&tmp.m_mpz};
+                sum += x * x;
+            }
+            if (sum != int_t{&acc.m_mpz}) {
+                flag.store(false);
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < 4u; ++i) {
+        threads.emplace_back(func, i);
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    REQUIRE(flag.load());
+}
+
+TEST_CASE("arena parallel")
+{
+    // The tasks of the parallel algorithms run by the calling thread must not
+    // allocate from its arena, as their results are combined by other threads.
+    parallel::set_n_threads(4);
+    std::mt19937 rng;
+    detail::mpz_raii tmp;
+    std::vector<int_t> v;
+    for (int i = 0; i < 8192; ++i) {
+        random_integer(tmp, 2, rng);
+        v.emplace_back(&tmp.m_mpz);
+        v.back() += 1;
+    }
+    int_t prod{1}, sum;
+    for (const auto &x : v) {
+        prod *= x;
+        sum += x;
+    }
+    for (int r = 0; r < 10; ++r) {
+        integer_arena ar;
+        REQUIRE(parallel::product(v.begin(), v.end()) == prod);
+        REQUIRE(parallel::sum(v.begin(), v.end()) == sum);
+    }
+    // With a single thread, all the tasks are run by the calling thread.
+    parallel::set_n_threads(1);
+    {
+        integer_arena ar;
+        REQUIRE(parallel::product(v.begin(), v.end()) == prod);
+        REQUIRE(ar.allocated() == 0u);
+        int_t x = v[0] * v[1];
+        REQUIRE(x == v[0] * v[1]);
+        REQUIRE(ar.allocated() != 0u);
+    }
+    parallel::set_n_threads(0);
+}
@@ -21,6 +21,7 @@
 #include <tuple>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #if defined(MPPP_HAVE_STRING_VIEW)
 #include <string_view>
@@ -445,6 +446,40 @@ TEST_CASE("to_string")
     tuple_for_each(sizes{}, to_string_tester{});
 }
 
+TEST_CASE("to_string large")
+{
+    // Values large enough to trigger the divide-and-conquer
+    // conversion, checked against GMP.
+    using integer = integer<1>;
+    detail::mpz_raii tmp;
+    std::mt19937 rng;
+    const auto check = [](const integer &n, int base) {
+        std::vector<char> buffer(::mpz_sizeinbase(n.get_mpz_view(), base) + 2u);
+        ::mpz_get_str(buffer.data(), base, n.get_mpz_view());
+        REQUIRE(n.to_string(base) == buffer.data());
+    };
+    for (const auto base : {2, 3, 10, 16, 36, 62}) {
+        for (const unsigned nlimbs : {1499u, 1500u, 1501u, 4000u, 9999u}) {
+            random_integer(tmp, nlimbs, rng);
+            integer n{&tmp.m_mpz};
+            check(n, base);
+            n.neg();
+            check(n, base);
+        }
+        // Powers of the base and their neighbours, which give
+        // long runs of zeroes and of maximal digits.
+        const auto p = pow(integer{base}, 100000u);
+        for (const auto &n : {p, p - 1, p + 1, -p, -(p - 1)}) {
+            check(n, base);
+        }
+    }
+    // Concurrent conversion.
+    random_integer(tmp, 50000u, rng);
+    integer n{&tmp.m_mpz};
+    n.neg();
+    check(n, 10);
+}
+
 struct stream_tester {
     template <typename S>
     void operator()(const S &) const
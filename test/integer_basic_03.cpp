@@ -11,6 +11,7 @@
 #include <algorithm>
 #include <array>
 #include <atomic>
+#include <cctype>
 #include <cmath>
 #include <cstddef>
 #include <ios>
@@ -34,6 +35,7 @@
 
 #include <mp++/detail/type_traits.hpp>
 #include <mp++/integer.hpp>
+#include <mp++/parallel.hpp>
 
 #include "catch.hpp"
 #include "test_utils.hpp"
@@ -249,6 +251,128 @@ TEST_CASE("string constructor")
     tuple_for_each(sizes{}, string_ctor_tester{});
 }
 
+struct dec_string_ctor_tester {
+    template <typename S>
+    void operator()(const S &) const
+    {
+        // Decimal strings around the limits of the values
+        // handled without GMP, checked against mpz_set_str().
+        using integer = integer<S::value>;
+        detail::mpz_raii tmp;
+        const auto check = [&tmp](const std::string &str) {
+            REQUIRE(::mpz_set_str(&tmp.m_mpz, str.c_str(), 10) == 0);
+            const integer n{str};
+            REQUIRE(n == integer{&tmp.m_mpz});
+            REQUIRE(n.is_static() == (n.size() <= S::value));
+            REQUIRE((integer{str.data(), str.data() + str.size(), 10} == n));
+        };
+        std::vector<std::string> strs{"0",
+                                      "0000",
+                                      "00001",
+                                      "18446744073709551615",
+                                      "18446744073709551616",
+                                      "0018446744073709551616",
+                                      "340282366920938463463374607431768211455",
+                                      "340282366920938463463374607431768211456",
+                                      "999999999999999999999999999999999999999",
+                                      "1000000000000000000000000000000000000000",
+                                      std::string(100, '0') + "123"};
+        // Powers of ten and their neighbours.
+        std::string p10 = "1";
+        for (int i = 0; i < 41; ++i) {
+            strs.push_back(p10);
+            strs.push_back(std::string(p10.size(), '9'));
+            p10 += '0';
+        }
+        // Random strings of all the lengths up to 41 digits.
+        std::uniform_int_distribution<int> dist(0, 9);
+        for (std::size_t len = 1; len <= 41u; ++len) {
+            std::string str;
+            for (std::size_t i = 0; i < len; ++i) {
+                str += static_cast<char>('0' + dist(rng));
+            }
+            strs.push_back(str);
+        }
+        for (const auto &str : strs) {
+            check(str);
+            check("-" + str);
+        }
+        // Strings handled by GMP.
+        check(" 123");
+        check("12 3");
+        check("1234567 89");
+        REQUIRE_THROWS_AS(integer{"12345678:"}, std::invalid_argument);
+        REQUIRE_THROWS_AS(integer{"1234567/"}, std::invalid_argument);
+        REQUIRE_THROWS_AS(integer{"12345678901234567890123456789012345678901234567890a"}, std::invalid_argument);
+        REQUIRE_THROWS_AS(integer{"--1"}, std::invalid_argument);
+        REQUIRE_THROWS_AS(integer{"-"}, std::invalid_argument);
+        REQUIRE_THROWS_AS(integer{""}, std::invalid_argument);
+        const std::string with_nul("12\0" "34", 5);
+        REQUIRE((integer{with_nul.data(), with_nul.data() + 5, 10} == 12));
+    }
+};
+
+TEST_CASE("decimal string constructor")
+{
+    tuple_for_each(sizes{}, dec_string_ctor_tester{});
+}
+
+TEST_CASE("string constructor large")
+{
+    // Strings long enough to be parsed concurrently, checked against GMP.
+    using integer = integer<1>;
+    std::mt19937 rng;
+    std::uniform_int_distribution<int> dist(0, 61);
+    const char *digits = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+    detail::mpz_raii tmp;
+    const auto check = [&tmp](const std::string &str, int base) {
+        REQUIRE(::mpz_set_str(&tmp.m_mpz, str.c_str(), base) == 0);
+        REQUIRE((integer{str, base} == integer{&tmp.m_mpz}));
+        REQUIRE((integer{str.data(), str.data() + str.size(), base} == integer{&tmp.m_mpz}));
+    };
+    for (const unsigned nt : {1u, 2u, 4u}) {
+        parallel::set_n_threads(nt);
+        for (const auto base : {2, 10, 16, 36, 62}) {
+            for (const std::size_t len : {100000u, 100001u, 345678u}) {
+                std::string str(len, '0');
+                for (auto &c : str) {
+                    c = digits[dist(rng) % base];
+                }
+                // NOTE: a nonzero leading digit, for the automatic base detection.
+                str[0] = '1';
+                check(str, base);
+                check("-" + str, base);
+                check(" \t -" + str, base);
+                if (base == 10) {
+                    check(str, 0);
+                    check("-" + str, 0);
+                }
+                if (base == 16) {
+                    check("0x" + str, 0);
+                    // Lowercase hex digits.
+                    std::transform(str.begin(), str.end(), str.begin(), [](char c) {
+                        return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+                    });
+                    check(str, base);
+                }
+                // Leading zeroes.
+                std::fill(str.begin(), str.begin() + 50000, '0');
+                check(str, base);
+                // Whitespace within the digits is ignored by GMP.
+                str[len / 2u] = ' ';
+                check(str, base);
+                // Invalid characters.
+                str[len / 2u] = '!';
+                REQUIRE_THROWS_AS((integer{str, base}), std::invalid_argument);
+                str[len / 2u] = '0';
+                str.back() = '-';
+                REQUIRE_THROWS_AS((integer{str, base}), std::invalid_argument);
+            }
+        }
+    }
+    parallel::set_n_threads(0);
+}
+
 struct mpz_copy_ctor_tester {
     template <typename S>
     void operator()(const S &) const
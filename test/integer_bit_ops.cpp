@@ -0,0 +1,154 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <cstddef>
+#include <limits>
+#include <random>
+#include <tuple>
+#include <type_traits>
+
+#include <mp++/detail/gmp.hpp>
+#include <mp++/integer.hpp>
+
+#include "catch.hpp"
+#include "test_utils.hpp"
+
+static int ntries = 1000;
+
+using namespace mppp;
+using namespace mppp_test;
+
+using sizes = std::tuple<std::integral_constant<std::size_t, 1>, std::integral_constant<std::size_t, 2>,
+                         std::integral_constant<std::size_t, 3>, std::integral_constant<std::size_t, 6>,
+                         std::integral_constant<std::size_t, 10>>;
+
+static std::mt19937 rng;
+
+struct bit_ops_tester {
+    template <typename S>
+    inline void operator()(const S &) const
+    {
+        using integer = integer<S::value>;
+        constexpr auto max_bc = std::numeric_limits<::mp_bitcnt_t>::max();
+
+        // A few simple tests.
+        REQUIRE(popcount(integer{}) == 0u);
+        REQUIRE(popcount(integer{7}) == 3u);
+        REQUIRE(popcount(integer{-7}) == max_bc);
+        REQUIRE(hamdist(integer{5}, integer{2}) == 3u);
+        REQUIRE(hamdist(integer{-5}, integer{-2}) == 2u);
+        REQUIRE(hamdist(integer{-5}, integer{2}) == max_bc);
+        REQUIRE(scan1(integer{}, 0) == max_bc);
+        REQUIRE(scan0(integer{}, 10) == 10u);
+        REQUIRE(scan1(integer{12}, 0) == 2u);
+        REQUIRE(scan1(integer{12}, 3) == 3u);
+        REQUIRE(scan1(integer{12}, 4) == max_bc);
+        REQUIRE(scan0(integer{-1}, 0) == max_bc);
+        REQUIRE(scan0(integer{-4}, 0) == 0u);
+        REQUIRE(scan0(integer{-4}, 2) == max_bc);
+        REQUIRE(scan1(integer{-4}, 1000) == 1000u);
+        REQUIRE(tstbit(integer{5}, 0));
+        REQUIRE(!tstbit(integer{5}, 1));
+        REQUIRE(!tstbit(integer{5}, 1000));
+        REQUIRE(!tstbit(integer{-2}, 0));
+        REQUIRE(tstbit(integer{-2}, 1));
+        REQUIRE(tstbit(integer{-2}, 1000));
+        integer n;
+        REQUIRE(std::is_same<integer &, decltype(setbit(n, 0))>::value);
+        REQUIRE(setbit(n, 3) == 8);
+        REQUIRE(setbit(n, 3) == 8);
+        REQUIRE(combit(n, 0) == 9);
+        REQUIRE(clrbit(n, 3) == 1);
+        REQUIRE(clrbit(n, 3) == 1);
+        REQUIRE(combit(n, 0) == 0);
+        n = -1;
+        REQUIRE(clrbit(n, 0) == -2);
+        REQUIRE(setbit(n, 0) == -1);
+        REQUIRE(clrbit(n, 1) == -3);
+        REQUIRE(n.is_static());
+
+        // Growth beyond the static size.
+        n = 0;
+        setbit(n, static_cast<::mp_bitcnt_t>(S::value * GMP_NUMB_BITS));
+        REQUIRE(!n.is_static());
+        REQUIRE(n == integer{1} << (S::value * GMP_NUMB_BITS));
+        n = -1;
+        clrbit(n, static_cast<::mp_bitcnt_t>(S::value * GMP_NUMB_BITS));
+        REQUIRE(n == -1 - (integer{1} << (S::value * GMP_NUMB_BITS)));
+        n = integer{((integer{1} << (S::value * GMP_NUMB_BITS)) - 2).get_mpz_view()};
+        REQUIRE(n.is_static());
+        setbit(n, 0);
+        REQUIRE(n.is_static());
+        n.neg();
+        clrbit(n, 0);
+        REQUIRE(!n.is_static());
+        REQUIRE(n == -(integer{1} << (S::value * GMP_NUMB_BITS)));
+
+        // Random testing.
+        integer n1, n2;
+        detail::mpz_raii tmp, m;
+        std::uniform_int_distribution<int> sdist(0, 1);
+        std::uniform_int_distribution<unsigned> bdist(0, 5u * unsigned(GMP_NUMB_BITS));
+        auto random_int = [&](integer &x, unsigned nl) {
+            random_integer(tmp, nl, rng);
+            x = &tmp.m_mpz;
+            if (sdist(rng)) {
+                x.neg();
+            }
+            if (x.is_static() && sdist(rng)) {
+                // Promote sometimes, if possible.
+                x.promote();
+            }
+        };
+        auto random_xy = [&](unsigned x, unsigned y) {
+            for (int i = 0; i < ntries; ++i) {
+                random_int(n1, x);
+                random_int(n2, y);
+                const auto v1 = n1.get_mpz_view(), v2 = n2.get_mpz_view();
+                const auto idx = bdist(rng);
+                REQUIRE(popcount(n1) == ::mpz_popcount(v1));
+                REQUIRE(hamdist(n1, n2) == ::mpz_hamdist(v1, v2));
+                REQUIRE(scan0(n1, idx) == ::mpz_scan0(v1, idx));
+                REQUIRE(scan1(n1, idx) == ::mpz_scan1(v1, idx));
+                REQUIRE(tstbit(n1, idx) == (::mpz_tstbit(v1, idx) != 0));
+
+                // Same sign operands for hamdist().
+                if (n2.sgn() != 0 && (n1.sgn() < 0) != (n2.sgn() < 0)) {
+                    n2.neg();
+                }
+                REQUIRE(hamdist(n1, n2) == ::mpz_hamdist(n1.get_mpz_view(), n2.get_mpz_view()));
+
+                // Mutations.
+                ::mpz_set(&m.m_mpz, n1.get_mpz_view());
+                ::mpz_setbit(&m.m_mpz, idx);
+                REQUIRE(setbit(n1, idx) == integer{&m.m_mpz});
+                const auto idx2 = bdist(rng);
+                ::mpz_clrbit(&m.m_mpz, idx2);
+                REQUIRE(clrbit(n1, idx2) == integer{&m.m_mpz});
+                const auto idx3 = bdist(rng);
+                ::mpz_combit(&m.m_mpz, idx3);
+                REQUIRE(combit(n1, idx3) == integer{&m.m_mpz});
+                ::mpz_combit(&m.m_mpz, idx);
+                REQUIRE(combit(n1, idx) == integer{&m.m_mpz});
+                ::mpz_clrbit(&m.m_mpz, 0);
+                REQUIRE(clrbit(n1, 0) == integer{&m.m_mpz});
+            }
+        };
+
+        for (unsigned x = 0; x <= 4u; ++x) {
+            for (unsigned y = 0; y <= 4u; ++y) {
+                random_xy(x, y);
+            }
+        }
+    }
+};
+
+TEST_CASE("bit_ops")
+{
+    tuple_for_each(sizes{}, bit_ops_tester{});
+}
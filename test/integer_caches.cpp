@@ -9,6 +9,7 @@
 #include <atomic>
 #include <cstddef>
 #include <random>
+#include <stdexcept>
 #include <thread>
 #include <tuple>
 #include <type_traits>
@@ -117,3 +118,253 @@ TEST_CASE("caches")
 {
     tuple_for_each(sizes{}, cache_tester{});
 }
+
+#if defined(MPPP_HAVE_THREAD_LOCAL)
+
+// Number of arrays in the size classes of the thread-local cache.
+static std::size_t cache_count(std::size_t begin, std::size_t end)
+{
+    const auto &mpzc = detail::get_thread_local_mpz_cache();
+    std::size_t retval = 0;
+    for (auto i = begin; i < end; ++i) {
+        retval += mpzc.sizes[i];
+    }
+    return retval;
+}
+
+#endif
+
+TEST_CASE("cache config")
+{
+    using mpzc_t = detail::mpz_alloc_cache;
+    // The default configuration.
+    REQUIRE(get_global_integer_cache_config().max_entries == 100u);
+    REQUIRE(get_global_integer_cache_config().max_limbs == 10u);
+    REQUIRE(get_integer_cache_config().max_entries == 100u);
+    REQUIRE(get_integer_cache_config().max_limbs == 10u);
+    integer_cache_config cfg;
+    cfg.max_limbs = mpzc_t::max_cacheable_limbs + 1u;
+    REQUIRE_THROWS_AS(set_integer_cache_config(cfg), std::invalid_argument);
+    REQUIRE_THROWS_AS(set_global_integer_cache_config(cfg), std::invalid_argument);
+    REQUIRE(get_integer_cache_config().max_limbs == 10u);
+    REQUIRE(get_global_integer_cache_config().max_limbs == 10u);
+    std::thread t([]() {
+        // Thread-local configuration with large size classes.
+        integer_cache_config tcfg;
+        tcfg.max_entries = 20;
+        tcfg.max_limbs = 40;
+        set_integer_cache_config(tcfg);
+        REQUIRE(get_integer_cache_config().max_entries == 20u);
+        REQUIRE(get_integer_cache_config().max_limbs == 40u);
+        REQUIRE(get_global_integer_cache_config().max_limbs == 10u);
+        std::mt19937 rng;
+        detail::mpz_raii tmp;
+        std::vector<integer<1>> v;
+        for (unsigned nlimbs = 1; nlimbs <= 45u; ++nlimbs) {
+            for (int i = 0; i < 30; ++i) {
+                random_integer(tmp, nlimbs, rng);
+                v.emplace_back(&tmp.m_mpz);
+                REQUIRE(v.back() == integer<1>{&tmp.m_mpz});
+            }
+        }
+        v.clear();
+#if defined(MPPP_HAVE_THREAD_LOCAL)
+        const auto &mpzc = detail::get_thread_local_mpz_cache();
+        // The arrays up to 40 limbs have been recycled, at most 20 per size class.
+        for (std::size_t i = 0; i < mpzc_t::n_classes; ++i) {
+            REQUIRE(mpzc.sizes[i] <= 20u);
+        }
+        // The size classes 16, 32 and 64.
+        REQUIRE(mpzc.sizes[mpzc_t::max_size] > 0u);
+        REQUIRE(mpzc.sizes[mpzc_t::max_size + 1u] > 0u);
+        REQUIRE(mpzc.sizes[mpzc_t::max_size + 2u] > 0u);
+        REQUIRE(cache_count(mpzc_t::max_size + 3u, mpzc_t::n_classes) == 0u);
+        // The recycled arrays are reused.
+        const auto misses = integer_cache_stats().misses;
+        for (unsigned nlimbs = 11; nlimbs <= 40u; ++nlimbs) {
+            random_integer(tmp, nlimbs, rng);
+            v.emplace_back(&tmp.m_mpz);
+            REQUIRE(v.back() == integer<1>{&tmp.m_mpz});
+        }
+#if defined(MPPP_WITH_CACHE_STATS)
+        // NOTE: the comparisons with integer<1>{&tmp.m_mpz}
+        // create and destroy 30 more dynamic integers.
+        REQUIRE(integer_cache_stats().misses == misses);
+#else
+        REQUIRE(misses == 0u);
+#endif
+        v.clear();
+        // Shrinking the configuration frees the arrays in excess.
+        tcfg.max_entries = 5;
+        tcfg.max_limbs = 20;
+        set_integer_cache_config(tcfg);
+        for (std::size_t i = 0; i < mpzc_t::n_classes; ++i) {
+            REQUIRE(mpzc.sizes[i] <= 5u);
+        }
+        REQUIRE(cache_count(mpzc_t::max_size + 2u, mpzc_t::n_classes) == 0u);
+        // Disable the cache.
+        tcfg.max_limbs = 0;
+        set_integer_cache_config(tcfg);
+        REQUIRE(cache_count(0, mpzc_t::n_classes) == 0u);
+        v.emplace_back(integer<1>{1} << 1000);
+        v.clear();
+        REQUIRE(cache_count(0, mpzc_t::n_classes) == 0u);
+#endif
+        // Go back to the global configuration.
+        reset_integer_cache_config();
+        REQUIRE(get_integer_cache_config().max_entries == 100u);
+        REQUIRE(get_integer_cache_config().max_limbs == 10u);
+        free_integer_caches();
+    });
+    t.join();
+    // Global configuration.
+    cfg.max_entries = 50;
+    cfg.max_limbs = 100;
+    set_global_integer_cache_config(cfg);
+    REQUIRE(get_global_integer_cache_config().max_entries == 50u);
+    REQUIRE(get_global_integer_cache_config().max_limbs == 100u);
+#if defined(MPPP_HAVE_THREAD_LOCAL)
+    REQUIRE(get_integer_cache_config().max_entries == 50u);
+    REQUIRE(get_integer_cache_config().max_limbs == 100u);
+#endif
+    std::thread t2([]() {
+#if defined(MPPP_HAVE_THREAD_LOCAL)
+        REQUIRE(get_integer_cache_config().max_entries == 50u);
+        REQUIRE(get_integer_cache_config().max_limbs == 100u);
+        {
+            integer<1> n{integer<1>{1} << 5000};
+        }
+        REQUIRE(cache_count(0, detail::mpz_alloc_cache::n_classes) == 1u);
+        integer_cache_config tcfg;
+        tcfg.max_limbs = 3;
+        set_integer_cache_config(tcfg);
+        REQUIRE(cache_count(0, detail::mpz_alloc_cache::n_classes) == 0u);
+#endif
+        // The thread-local configuration is not affected by the global one.
+        integer_cache_config gcfg;
+        gcfg.max_limbs = 7;
+        set_global_integer_cache_config(gcfg);
+#if defined(MPPP_HAVE_THREAD_LOCAL)
+        REQUIRE(get_integer_cache_config().max_limbs == 3u);
+#endif
+    });
+    t2.join();
+    REQUIRE(get_global_integer_cache_config().max_limbs == 7u);
+#if defined(MPPP_HAVE_THREAD_LOCAL)
+    REQUIRE(get_integer_cache_config().max_limbs == 7u);
+#endif
+    // Restore the default configuration.
+    set_global_integer_cache_config(integer_cache_config{});
+    REQUIRE(get_integer_cache_config().max_entries == 100u);
+    REQUIRE(get_integer_cache_config().max_limbs == 10u);
+}
+
+TEST_CASE("cache stats")
+{
+    const auto g0 = global_integer_cache_stats();
+    integer_cache_counters s1;
+    std::thread t([&s1]() {
+        integer_cache_config cfg;
+        cfg.max_entries = 2;
+        cfg.max_limbs = 20;
+        set_integer_cache_config(cfg);
+        // NOTE: empty the global depot, which might contain
+        // arrays released by the other tests.
+        free_integer_caches();
+        const auto s0 = integer_cache_stats();
+        REQUIRE(s0.hits == 0u);
+        REQUIRE(s0.misses == 0u);
+        REQUIRE(s0.evictions == 0u);
+        REQUIRE(s0.bytes_held == 0u);
+        REQUIRE(s0.high_water_mark == 0u);
+        // A value with 15 limbs, served from the size class of 16 limbs.
+        detail::mpz_raii tmp;
+        ::mpz_setbit(&tmp.m_mpz, 15u * unsigned(GMP_NUMB_BITS) - 1u);
+        {
+            std::vector<integer<1>> v;
+            for (int i = 0; i < 3; ++i) {
+                v.emplace_back(&tmp.m_mpz);
+            }
+        }
+        integer<1>{&tmp.m_mpz};
+        s1 = integer_cache_stats();
+#if defined(MPPP_WITH_CACHE_STATS) && defined(MPPP_HAVE_THREAD_LOCAL)
+        // NOTE: the third array is moved to the global
+        // depot together with one of the cached arrays.
+        REQUIRE(s1.hits == 1u);
+        REQUIRE(s1.misses == 3u);
+        REQUIRE(s1.evictions == 0u);
+        REQUIRE(s1.bytes_held == 16u * sizeof(::mp_limb_t));
+        REQUIRE(s1.high_water_mark == 2u * 16u * sizeof(::mp_limb_t));
+        // Freeing the cache counts as evictions.
+        free_integer_caches();
+        const auto s2 = integer_cache_stats();
+        REQUIRE(s2.evictions == 1u);
+        REQUIRE(s2.bytes_held == 0u);
+        REQUIRE(s2.high_water_mark == 2u * 16u * sizeof(::mp_limb_t));
+#else
+        REQUIRE(s1.hits == 0u);
+        REQUIRE(s1.misses == 0u);
+        REQUIRE(s1.evictions == 0u);
+        REQUIRE(s1.bytes_held == 0u);
+        REQUIRE(s1.high_water_mark == 0u);
+#endif
+    });
+    t.join();
+    // The statistics of the thread are preserved in the aggregate
+    // statistics after its exit.
+    const auto g1 = global_integer_cache_stats();
+    REQUIRE(g1.hits >= g0.hits + s1.hits);
+    REQUIRE(g1.misses >= g0.misses + s1.misses);
+    REQUIRE(g1.evictions >= g0.evictions + s1.evictions);
+    REQUIRE(g1.high_water_mark >= g0.high_water_mark + s1.high_water_mark);
+}
+
+TEST_CASE("cache depot")
+{
+    // Integers created by a thread and destroyed by another thread.
+    detail::mpz_raii tmp;
+    ::mpz_setbit(&tmp.m_mpz, 5u * unsigned(GMP_NUMB_BITS) - 1u);
+    std::vector<integer<1>> v;
+    std::thread producer([&v, &tmp]() {
+        for (int i = 0; i < 300; ++i) {
+            v.emplace_back(&tmp.m_mpz);
+        }
+    });
+    producer.join();
+    integer_cache_counters s0;
+    std::thread consumer([&v, &s0]() {
+        v.clear();
+        s0 = integer_cache_stats();
+    });
+    consumer.join();
+#if defined(MPPP_WITH_CACHE_STATS) && defined(MPPP_HAVE_THREAD_LOCAL)
+    // The consumer moved to the depot the arrays it could not cache.
+    REQUIRE(s0.evictions == 0u);
+    REQUIRE(s0.bytes_held > 0u);
+    REQUIRE(s0.bytes_held <= 100u * 5u * sizeof(::mp_limb_t));
+#endif
+    // Another thread reuses the arrays from the depot.
+    std::thread t([&tmp]() {
+        std::vector<integer<1>> w;
+        for (int i = 0; i < 150; ++i) {
+            w.emplace_back(&tmp.m_mpz);
+        }
+        REQUIRE(w.back() == integer<1>{&tmp.m_mpz});
+        w.clear();
+        const auto s1 = integer_cache_stats();
+#if defined(MPPP_WITH_CACHE_STATS) && defined(MPPP_HAVE_THREAD_LOCAL)
+        REQUIRE(s1.hits == 151u);
+        REQUIRE(s1.misses == 0u);
+#endif
+        // This also frees the depot.
+        free_integer_caches();
+        w.emplace_back(&tmp.m_mpz);
+        const auto s2 = integer_cache_stats();
+#if defined(MPPP_WITH_CACHE_STATS) && defined(MPPP_HAVE_THREAD_LOCAL)
+        REQUIRE(s2.hits == 151u);
+        REQUIRE(s2.misses == 1u);
+#endif
+    });
+    t.join();
+}
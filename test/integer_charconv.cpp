@@ -0,0 +1,194 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <cstddef>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include <gmp.h>
+
+#include <mp++/integer.hpp>
+
+#include "catch.hpp"
+#include "test_utils.hpp"
+
+using namespace mppp;
+using namespace mppp_test;
+
+using sizes = std::tuple<std::integral_constant<std::size_t, 1>, std::integral_constant<std::size_t, 2>,
+                         std::integral_constant<std::size_t, 3>, std::integral_constant<std::size_t, 6>,
+                         std::integral_constant<std::size_t, 10>>;
+
+static std::mt19937 rng;
+
+static const int ntries = 100;
+
+struct to_chars_tester {
+    template <typename S>
+    inline void operator()(const S &) const
+    {
+        using integer = integer<S::value>;
+        std::vector<char> buffer;
+        // Zero.
+        buffer.resize(1);
+        auto ret = to_chars(buffer.data(), buffer.data() + 1, integer{}, 10);
+        REQUIRE(ret.ec == std::errc{});
+        REQUIRE(ret.ptr == buffer.data() + 1);
+        REQUIRE(buffer[0] == '0');
+        ret = to_chars(buffer.data(), buffer.data(), integer{}, 10);
+        REQUIRE(ret.ec == std::errc::value_too_large);
+        REQUIRE(ret.ptr == buffer.data());
+        REQUIRE(max_chars(integer{}) == 1u);
+        // Bases.
+        buffer.resize(100);
+        ret = to_chars(buffer.data(), buffer.data() + 100, integer{-255}, 16);
+        REQUIRE(std::string(buffer.data(), ret.ptr) == "-ff");
+        ret = to_chars(buffer.data(), buffer.data() + 100, integer{-255}, 2);
+        REQUIRE(std::string(buffer.data(), ret.ptr) == "-11111111");
+        ret = to_chars(buffer.data(), buffer.data() + 100, integer{61}, 62);
+        REQUIRE(std::string(buffer.data(), ret.ptr) == "z");
+        ret = to_chars(buffer.data(), buffer.data() + 100, integer{36}, 62);
+        REQUIRE(std::string(buffer.data(), ret.ptr) == "a");
+        ret = to_chars(buffer.data(), buffer.data() + 100, integer{35}, 62);
+        REQUIRE(std::string(buffer.data(), ret.ptr) == "Z");
+        ret = to_chars(buffer.data(), buffer.data() + 100, integer{35}, 36);
+        REQUIRE(std::string(buffer.data(), ret.ptr) == "z");
+        REQUIRE_THROWS_PREDICATE(to_chars(buffer.data(), buffer.data() + 100, integer{}, 1), std::invalid_argument,
+                                 [](const std::invalid_argument &ia) {
+                                     return std::string(ia.what())
+                                            == "Invalid base for string conversion: the base must be between "
+                                               "2 and 62, but a value of 1 was provided instead";
+                                 });
+        REQUIRE_THROWS_AS(to_chars(buffer.data(), buffer.data() + 100, integer{}, 63), std::invalid_argument);
+        REQUIRE_THROWS_AS(max_chars(integer{}, 63), std::invalid_argument);
+        // Random testing, including dynamic values.
+        detail::mpz_raii tmp;
+        std::uniform_int_distribution<unsigned> ldist(0, S::value + 2u);
+        std::uniform_int_distribution<int> sdist(0, 1), bdist(2, 62);
+        for (int i = 0; i < ntries; ++i) {
+            random_integer(tmp, ldist(rng), rng);
+            integer n{&tmp.m_mpz};
+            if (sdist(rng)) {
+                n.neg();
+            }
+            const auto base = bdist(rng);
+            const auto str = n.to_string(base);
+            const auto mc = max_chars(n, base);
+            REQUIRE(mc >= str.size());
+            REQUIRE(mc <= str.size() + 1u);
+            buffer.resize(mc);
+            ret = to_chars(buffer.data(), buffer.data() + mc, n, base);
+            REQUIRE(ret.ec == std::errc{});
+            REQUIRE(std::string(buffer.data(), ret.ptr) == str);
+            // Exact size.
+            ret = to_chars(buffer.data(), buffer.data() + str.size(), n, base);
+            REQUIRE(ret.ec == std::errc{});
+            REQUIRE(ret.ptr == buffer.data() + str.size());
+            REQUIRE(std::string(buffer.data(), ret.ptr) == str);
+            // Buffer too small.
+            ret = to_chars(buffer.data(), buffer.data() + (str.size() - 1u), n, base);
+            REQUIRE(ret.ec == std::errc::value_too_large);
+            REQUIRE(ret.ptr == buffer.data() + (str.size() - 1u));
+        }
+    }
+};
+
+TEST_CASE("to_chars")
+{
+    tuple_for_each(sizes{}, to_chars_tester{});
+}
+
+struct from_chars_tester {
+    template <typename S>
+    inline void operator()(const S &) const
+    {
+        using integer = integer<S::value>;
+        integer n{42};
+        std::string str;
+        // Invalid inputs: n is not modified and the returned
+        // pointer is the beginning of the range.
+        for (const auto &s : {"", "-", "+1", " 1", "--1", "x", "-x"}) {
+            str = s;
+            const auto ret = from_chars(str.data(), str.data() + str.size(), n, 10);
+            REQUIRE(ret.ec == std::errc::invalid_argument);
+            REQUIRE(ret.ptr == str.data());
+            REQUIRE(n == 42);
+        }
+        // Partial matches.
+        str = "-123abc";
+        auto ret = from_chars(str.data(), str.data() + str.size(), n, 10);
+        REQUIRE(ret.ec == std::errc{});
+        REQUIRE(ret.ptr == str.data() + 4);
+        REQUIRE(n == -123);
+        ret = from_chars(str.data(), str.data() + str.size(), n, 16);
+        REQUIRE(ret.ec == std::errc{});
+        REQUIRE(ret.ptr == str.data() + str.size());
+        REQUIRE(n == -0x123abc);
+        str = "00012 3";
+        ret = from_chars(str.data(), str.data() + str.size(), n, 10);
+        REQUIRE(ret.ptr == str.data() + 5);
+        REQUIRE(n == 12);
+        str = "-0";
+        ret = from_chars(str.data(), str.data() + str.size(), n, 10);
+        REQUIRE(ret.ptr == str.data() + 2);
+        REQUIRE(n == 0);
+        str = "0x10";
+        ret = from_chars(str.data(), str.data() + str.size(), n, 16);
+        REQUIRE(ret.ptr == str.data() + 1);
+        REQUIRE(n == 0);
+        // Case sensitivity.
+        str = "FfZz";
+        ret = from_chars(str.data(), str.data() + str.size(), n, 16);
+        REQUIRE(ret.ptr == str.data() + 2);
+        REQUIRE(n == 255);
+        ret = from_chars(str.data(), str.data() + str.size(), n, 36);
+        REQUIRE(ret.ptr == str.data() + 4);
+        REQUIRE(n == integer{"FfZz", 36});
+        ret = from_chars(str.data(), str.data() + str.size(), n, 62);
+        REQUIRE(ret.ptr == str.data() + 4);
+        REQUIRE(n == integer{"FfZz", 62});
+        REQUIRE(n != integer{"FFZZ", 62});
+        REQUIRE_THROWS_PREDICATE(from_chars(str.data(), str.data() + str.size(), n, 1), std::invalid_argument,
+                                 [](const std::invalid_argument &ia) {
+                                     return std::string(ia.what())
+                                            == "Invalid base for string conversion: the base must be between "
+                                               "2 and 62, but a value of 1 was provided instead";
+                                 });
+        REQUIRE_THROWS_AS(from_chars(str.data(), str.data() + str.size(), n, 63), std::invalid_argument);
+        // Random testing, including dynamic values.
+        detail::mpz_raii tmp;
+        std::uniform_int_distribution<unsigned> ldist(0, S::value + 2u);
+        std::uniform_int_distribution<int> sdist(0, 1), bdist(2, 62);
+        for (int i = 0; i < ntries; ++i) {
+            random_integer(tmp, ldist(rng), rng);
+            integer m{&tmp.m_mpz};
+            if (sdist(rng)) {
+                m.neg();
+            }
+            const auto base = bdist(rng);
+            str = m.to_string(base) + "!";
+            // Start from a dynamic value.
+            n = integer{1} << (S::value * GMP_NUMB_BITS * 2u);
+            ret = from_chars(str.data(), str.data() + str.size(), n, base);
+            REQUIRE(ret.ec == std::errc{});
+            REQUIRE(ret.ptr == str.data() + str.size() - 1);
+            REQUIRE(n == m);
+            REQUIRE(n.is_static() == (m.size() <= S::value));
+        }
+    }
+};
+
+TEST_CASE("from_chars")
+{
+    tuple_for_each(sizes{}, from_chars_tester{});
+}
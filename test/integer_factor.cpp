@@ -0,0 +1,184 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <gmp.h>
+
+#include <mp++/integer.hpp>
+
+#include "catch.hpp"
+#include "test_utils.hpp"
+
+static int ntries = 200;
+
+using namespace mppp;
+using namespace mppp_test;
+
+using sizes = std::tuple<std::integral_constant<std::size_t, 1>, std::integral_constant<std::size_t, 2>,
+                         std::integral_constant<std::size_t, 3>, std::integral_constant<std::size_t, 6>,
+                         std::integral_constant<std::size_t, 10>>;
+
+static std::mt19937 rng;
+
+// Check that f is the factorisation of n.
+template <typename Int>
+static bool check_factor(const Int &n, const std::vector<std::pair<Int, unsigned long>> &f)
+{
+    Int prod{1};
+    for (decltype(f.size()) i = 0; i < f.size(); ++i) {
+        if (f[i].second == 0u || f[i].first.probab_prime_p() == 0) {
+            return false;
+        }
+        if (i > 0u && !(f[i - 1u].first < f[i].first)) {
+            return false;
+        }
+        prod *= pow_ui(f[i].first, f[i].second);
+    }
+    return prod == abs(n);
+}
+
+// A random prime with the given number of bits.
+template <typename Int>
+static Int random_prime(unsigned nbits)
+{
+    std::uniform_int_distribution<std::uint_least64_t> dist(std::uint_least64_t(1) << (nbits - 1u),
+                                                            (std::uint_least64_t(1) << nbits) - 1u);
+    return nextprime(Int{dist(rng)});
+}
+
+struct factor_tester {
+    template <typename S>
+    inline void operator()(const S &) const
+    {
+        using integer = integer<S::value>;
+        using vec_t = std::vector<std::pair<integer, unsigned long>>;
+        REQUIRE_THROWS_PREDICATE(factor(integer{}), std::domain_error, [](const std::domain_error &ex) {
+            return std::string(ex.what()) == "Cannot factor zero";
+        });
+        REQUIRE(factor(integer{1}).empty());
+        REQUIRE(factor(integer{-1}).empty());
+        REQUIRE((factor(integer{2}) == vec_t{{integer{2}, 1}}));
+        REQUIRE((factor(integer{-12}) == vec_t{{integer{2}, 2}, {integer{3}, 1}}));
+        REQUIRE((factor(integer{65537}) == vec_t{{integer{65537}, 1}}));
+        REQUIRE((factor(integer{66049}) == vec_t{{integer{257}, 2}}));
+        // Small values.
+        for (int i = 1; i < 5000; ++i) {
+            REQUIRE(check_factor(integer{i}, factor(integer{i})));
+            REQUIRE(check_factor(integer{-i}, factor(integer{-i})));
+        }
+        // Mersenne numbers.
+        REQUIRE((factor(integer{"18446744073709551615"})
+                 == vec_t{{integer{3}, 1},
+                          {integer{5}, 1},
+                          {integer{17}, 1},
+                          {integer{257}, 1},
+                          {integer{641}, 1},
+                          {integer{65537}, 1},
+                          {integer{6700417}, 1}}));
+        REQUIRE((factor(integer{"340282366920938463463374607431768211455"})
+                 == vec_t{{integer{3}, 1},
+                          {integer{5}, 1},
+                          {integer{17}, 1},
+                          {integer{257}, 1},
+                          {integer{641}, 1},
+                          {integer{65537}, 1},
+                          {integer{274177}, 1},
+                          {integer{6700417}, 1},
+                          {integer{"67280421310721"}, 1}}));
+        // The largest 64-bit prime, and a 2-limb prime.
+        REQUIRE((factor(integer{"18446744073709551557"}) == vec_t{{integer{"18446744073709551557"}, 1}}));
+        REQUIRE((factor(integer{"340282366920938463463374607431768211297"})
+                 == vec_t{{integer{"340282366920938463463374607431768211297"}, 1}}));
+        // Semiprimes, squares and cubes of primes.
+        for (int i = 0; i < ntries / 10; ++i) {
+            const auto p = random_prime<integer>(31), q = random_prime<integer>(32);
+            auto f = factor(p * q);
+            REQUIRE(check_factor(p * q, f));
+            REQUIRE(f.size() == (p == q ? 1u : 2u));
+            REQUIRE((factor(p * p) == vec_t{{p, 2}}));
+            REQUIRE((factor(-p * p * p) == vec_t{{p, 3}}));
+            REQUIRE((factor(p * p * q * q) == factor(p * q * p * q)));
+        }
+        // Random 1-limb values.
+        detail::mpz_raii tmp;
+        for (int i = 0; i < ntries; ++i) {
+            random_integer(tmp, 1, rng);
+            const integer n{&tmp.m_mpz};
+            if (!n.is_zero()) {
+                REQUIRE(check_factor(n, factor(n)));
+            }
+        }
+        // Random products of primes with up to 32 bits, spanning
+        // a few limbs.
+        std::uniform_int_distribution<unsigned> bdist(2, 32), ndist(1, 6);
+        for (int i = 0; i < ntries; ++i) {
+            integer n{1};
+            for (auto j = ndist(rng); j != 0u; --j) {
+                n *= random_prime<integer>(bdist(rng));
+            }
+            auto f = factor(n);
+            REQUIRE(check_factor(n, f));
+            if (n.is_static() && S::value > 1u && n.size() == 1u) {
+                // Promote, and check that the result does not change.
+                n.promote();
+                REQUIRE(factor(n) == f);
+            }
+        }
+        // A 3-limb value with 40-bit prime factors.
+        integer n{1};
+        for (int j = 0; j < 4; ++j) {
+            n *= random_prime<integer>(40);
+        }
+        n *= 3;
+        REQUIRE(check_factor(n, factor(n)));
+    }
+};
+
+TEST_CASE("factor")
+{
+    tuple_for_each(sizes{}, factor_tester{});
+}
+
+TEST_CASE("squfof")
+{
+    using integer = integer<1>;
+    // Count the successes of SQUFOF on ntries products of random primes
+    // of the given sizes, checking the factors found.
+    auto run = [](unsigned b1, unsigned b2) {
+        int count = 0;
+        for (int i = 0; i < ntries; ++i) {
+            const auto p = random_prime<integer>(b1), q = random_prime<integer>(b2);
+            if (p == q) {
+                continue;
+            }
+            const auto n = static_cast<std::uint_least64_t>(p * q), f = detail::integer_squfof(n);
+            if (f != 0u) {
+                REQUIRE(f != 1u);
+                REQUIRE(f != n);
+                REQUIRE(n % f == 0u);
+                ++count;
+            }
+        }
+        return count;
+    };
+    // NOTE: SQUFOF may fail, but with several multipliers
+    // available it succeeds on nearly all the inputs.
+    REQUIRE(run(24, 24) >= ntries * 9 / 10);
+    REQUIRE(run(24, 29) >= ntries * 9 / 10);
+    // Close to the upper limit fewer multipliers are available.
+    REQUIRE(run(29, 31) >= ntries / 4);
+    REQUIRE(run(31, 31) >= ntries / 4);
+}
@@ -0,0 +1,201 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <cstddef>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+#include <mp++/detail/gmp.hpp>
+#include <mp++/exceptions.hpp>
+#include <mp++/integer.hpp>
+
+#include "catch.hpp"
+#include "test_utils.hpp"
+
+static int ntries = 1000;
+
+using namespace mppp;
+using namespace mppp_test;
+
+using sizes = std::tuple<std::integral_constant<std::size_t, 1>, std::integral_constant<std::size_t, 2>,
+                         std::integral_constant<std::size_t, 3>, std::integral_constant<std::size_t, 6>,
+                         std::integral_constant<std::size_t, 10>>;
+
+static std::mt19937 rng;
+
+struct fdiv_cdiv_tester {
+    template <typename S>
+    inline void operator()(const S &) const
+    {
+        using integer = integer<S::value>;
+        integer q, r;
+
+        // A few simple tests.
+        REQUIRE(std::is_same<void, decltype(fdiv_qr(q, r, q, r))>::value);
+        REQUIRE(std::is_same<integer &, decltype(fdiv_q(q, q, r))>::value);
+        REQUIRE(std::is_same<integer &, decltype(mod(q, q, r))>::value);
+        REQUIRE(std::is_same<integer &, decltype(cdiv_q_2exp(q, q, 1u))>::value);
+        fdiv_qr(q, r, integer{7}, integer{2});
+        REQUIRE(q == 3);
+        REQUIRE(r == 1);
+        fdiv_qr(q, r, integer{-7}, integer{2});
+        REQUIRE(q == -4);
+        REQUIRE(r == 1);
+        fdiv_qr(q, r, integer{7}, integer{-2});
+        REQUIRE(q == -4);
+        REQUIRE(r == -1);
+        fdiv_qr(q, r, integer{-7}, integer{-2});
+        REQUIRE(q == 3);
+        REQUIRE(r == -1);
+        cdiv_qr(q, r, integer{7}, integer{2});
+        REQUIRE(q == 4);
+        REQUIRE(r == -1);
+        cdiv_qr(q, r, integer{-7}, integer{2});
+        REQUIRE(q == -3);
+        REQUIRE(r == -1);
+        cdiv_qr(q, r, integer{7}, integer{-2});
+        REQUIRE(q == -3);
+        REQUIRE(r == 1);
+        cdiv_qr(q, r, integer{-7}, integer{-2});
+        REQUIRE(q == 4);
+        REQUIRE(r == 1);
+        REQUIRE(fdiv_q(q, integer{-6}, integer{3}) == -2);
+        REQUIRE(cdiv_q(q, integer{-1}, integer{3}) == 0);
+        REQUIRE(fdiv_r(r, integer{-1}, integer{3}) == 2);
+        REQUIRE(cdiv_r(r, integer{1}, integer{3}) == -2);
+        REQUIRE(mod(r, integer{-7}, integer{2}) == 1);
+        REQUIRE(mod(r, integer{-7}, integer{-2}) == 1);
+        REQUIRE(mod(r, integer{-6}, integer{-2}) == 0);
+        REQUIRE(fdiv_q_2exp(q, integer{-5}, 1u) == -3);
+        REQUIRE(fdiv_q_2exp(q, integer{-4}, 1u) == -2);
+        REQUIRE(fdiv_q_2exp(q, integer{-4}, 1000u) == -1);
+        REQUIRE(fdiv_q_2exp(q, integer{4}, 1000u) == 0);
+        REQUIRE(cdiv_q_2exp(q, integer{5}, 1u) == 3);
+        REQUIRE(cdiv_q_2exp(q, integer{-5}, 1u) == -2);
+        REQUIRE(cdiv_q_2exp(q, integer{4}, 1000u) == 1);
+        REQUIRE(cdiv_q_2exp(q, integer{}, 1000u) == 0);
+
+        // Error handling.
+        REQUIRE_THROWS_PREDICATE(fdiv_qr(q, q, integer{1}, integer{2}), std::invalid_argument,
+                                 [](const std::invalid_argument &ex) {
+                                     return std::string(ex.what())
+                                            == "When performing a division with remainder, the quotient 'q' and the "
+                                               "remainder 'r' must be distinct objects";
+                                 });
+        REQUIRE_THROWS_AS(cdiv_qr(q, q, integer{1}, integer{2}), std::invalid_argument);
+        REQUIRE_THROWS_PREDICATE(
+            fdiv_qr(q, r, integer{1}, integer{}), zero_division_error,
+            [](const zero_division_error &ex) { return std::string(ex.what()) == "Integer division by zero"; });
+        REQUIRE_THROWS_AS(cdiv_qr(q, r, integer{1}, integer{}), zero_division_error);
+        REQUIRE_THROWS_AS(fdiv_q(q, integer{1}, integer{}), zero_division_error);
+        REQUIRE_THROWS_AS(cdiv_q(q, integer{1}, integer{}), zero_division_error);
+        REQUIRE_THROWS_AS(fdiv_r(r, integer{1}, integer{}), zero_division_error);
+        REQUIRE_THROWS_AS(cdiv_r(r, integer{1}, integer{}), zero_division_error);
+        REQUIRE_THROWS_AS(mod(r, integer{1}, integer{}), zero_division_error);
+
+        // Random testing.
+        integer n1, n2;
+        detail::mpz_raii tmp, mq, mr;
+        std::uniform_int_distribution<int> sdist(0, 1);
+        std::uniform_int_distribution<unsigned> shdist(0, 4u * unsigned(GMP_NUMB_BITS));
+        auto random_int = [&](integer &n, unsigned x) {
+            random_integer(tmp, x, rng);
+            n = &tmp.m_mpz;
+            if (sdist(rng)) {
+                n.neg();
+            }
+            if (n.is_static() && sdist(rng)) {
+                // Promote sometimes, if possible.
+                n.promote();
+            }
+        };
+        auto check = [&](const integer &n, const integer &d) {
+            fdiv_qr(q, r, n, d);
+            ::mpz_fdiv_qr(&mq.m_mpz, &mr.m_mpz, n.get_mpz_view(), d.get_mpz_view());
+            REQUIRE(q == integer{&mq.m_mpz});
+            REQUIRE(r == integer{&mr.m_mpz});
+            REQUIRE(fdiv_q(q, n, d) == integer{&mq.m_mpz});
+            REQUIRE(fdiv_r(r, n, d) == integer{&mr.m_mpz});
+
+            cdiv_qr(q, r, n, d);
+            ::mpz_cdiv_qr(&mq.m_mpz, &mr.m_mpz, n.get_mpz_view(), d.get_mpz_view());
+            REQUIRE(q == integer{&mq.m_mpz});
+            REQUIRE(r == integer{&mr.m_mpz});
+            REQUIRE(cdiv_q(q, n, d) == integer{&mq.m_mpz});
+            REQUIRE(cdiv_r(r, n, d) == integer{&mr.m_mpz});
+
+            ::mpz_mod(&mr.m_mpz, n.get_mpz_view(), d.get_mpz_view());
+            REQUIRE(mod(r, n, d) == integer{&mr.m_mpz});
+
+            // Overlapping arguments.
+            auto n_copy(n), d_copy(d);
+            fdiv_qr(n_copy, d_copy, n_copy, d_copy);
+            ::mpz_fdiv_qr(&mq.m_mpz, &mr.m_mpz, n.get_mpz_view(), d.get_mpz_view());
+            REQUIRE(n_copy == integer{&mq.m_mpz});
+            REQUIRE(d_copy == integer{&mr.m_mpz});
+            n_copy = n;
+            d_copy = d;
+            cdiv_qr(d_copy, n_copy, n_copy, d_copy);
+            ::mpz_cdiv_qr(&mq.m_mpz, &mr.m_mpz, n.get_mpz_view(), d.get_mpz_view());
+            REQUIRE(d_copy == integer{&mq.m_mpz});
+            REQUIRE(n_copy == integer{&mr.m_mpz});
+            d_copy = d;
+            fdiv_r(d_copy, n, d_copy);
+            ::mpz_fdiv_r(&mr.m_mpz, n.get_mpz_view(), d.get_mpz_view());
+            REQUIRE(d_copy == integer{&mr.m_mpz});
+            d_copy = d;
+            mod(d_copy, n, d_copy);
+            ::mpz_mod(&mr.m_mpz, n.get_mpz_view(), d.get_mpz_view());
+            REQUIRE(d_copy == integer{&mr.m_mpz});
+            d_copy = d;
+            cdiv_q(d_copy, n, d_copy);
+            ::mpz_cdiv_q(&mq.m_mpz, n.get_mpz_view(), d.get_mpz_view());
+            REQUIRE(d_copy == integer{&mq.m_mpz});
+
+            // Division by powers of 2.
+            const auto s = shdist(rng);
+            ::mpz_fdiv_q_2exp(&mq.m_mpz, n.get_mpz_view(), s);
+            REQUIRE(fdiv_q_2exp(q, n, s) == integer{&mq.m_mpz});
+            ::mpz_cdiv_q_2exp(&mq.m_mpz, n.get_mpz_view(), s);
+            REQUIRE(cdiv_q_2exp(q, n, s) == integer{&mq.m_mpz});
+            n_copy = n;
+            REQUIRE(cdiv_q_2exp(n_copy, n_copy, s) == integer{&mq.m_mpz});
+        };
+        auto random_xy = [&](unsigned x, unsigned y) {
+            for (int i = 0; i < ntries; ++i) {
+                if (sdist(rng) && sdist(rng) && sdist(rng)) {
+                    // Reset the return values every once in a while.
+                    q = integer{};
+                    r = integer{};
+                }
+                random_int(n1, x);
+                random_int(n2, y);
+                if (n2.sgn() == 0) {
+                    continue;
+                }
+                check(n1, n2);
+                // Exact divisions.
+                check(n1 * n2, n2);
+            }
+        };
+
+        for (unsigned x = 0; x <= 4u; ++x) {
+            for (unsigned y = 1; y <= 4u; ++y) {
+                random_xy(x, y);
+            }
+        }
+    }
+};
+
+TEST_CASE("fdiv_cdiv")
+{
+    tuple_for_each(sizes{}, fdiv_cdiv_tester{});
+}
@@ -10,6 +10,7 @@
 #include <random>
 #include <tuple>
 #include <type_traits>
+#include <utility>
 
 #include <gmp.h>
 
@@ -168,6 +169,23 @@ struct gcd_tester {
         random_xy(4, 2);
         random_xy(4, 3);
         random_xy(4, 4);
+
+        // Operands with nontrivial GCDs (including large powers of 2 and
+        // equal operands), which exercise the 2-limb binary GCD.
+        std::uniform_int_distribution<unsigned> shdist(0, 80);
+        for (int i = 0; i < ntries; ++i) {
+            random_integer(tmp, 1, rng);
+            const auto g = integer{&tmp.m_mpz} << shdist(rng);
+            random_integer(tmp, 1, rng);
+            n2 = g * integer{&tmp.m_mpz};
+            random_integer(tmp, 1, rng);
+            n3 = g * integer{&tmp.m_mpz} * mdist(rng);
+            for (const auto &p : {std::make_pair(n2, n3), std::make_pair(n3, n2), std::make_pair(n2, n2)}) {
+                ::mpz_gcd(&m1.m_mpz, p.first.get_mpz_view(), p.second.get_mpz_view());
+                gcd(n1, p.first, p.second);
+                REQUIRE((lex_cast(n1) == lex_cast(m1)));
+            }
+        }
     }
 };
 
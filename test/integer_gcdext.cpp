@@ -0,0 +1,295 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <cstddef>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+#include <mp++/detail/gmp.hpp>
+#include <mp++/exceptions.hpp>
+#include <mp++/integer.hpp>
+
+#include "catch.hpp"
+#include "test_utils.hpp"
+
+using namespace mppp;
+using namespace mppp_test;
+
+using sizes = std::tuple<std::integral_constant<std::size_t, 1>, std::integral_constant<std::size_t, 2>,
+                         std::integral_constant<std::size_t, 3>, std::integral_constant<std::size_t, 4>,
+                         std::integral_constant<std::size_t, 6>, std::integral_constant<std::size_t, 10>>;
+
+static int ntries = 1000;
+
+static std::mt19937 rng;
+
+struct gcdext_tester {
+    template <typename S>
+    void operator()(const S &) const
+    {
+        using integer = integer<S::value>;
+        integer g, s, t;
+        detail::mpz_raii mg, ms, mt;
+        // Check g_, s_ and t_ against the mpz result.
+        auto check_gst = [&](const integer &g_, const integer &s_, const integer &t_, const integer &a,
+                             const integer &b) {
+            ::mpz_gcdext(&mg.m_mpz, &ms.m_mpz, &mt.m_mpz, a.get_mpz_view(), b.get_mpz_view());
+            REQUIRE(g_ == integer{&mg.m_mpz});
+            REQUIRE(s_ == integer{&ms.m_mpz});
+            REQUIRE(t_ == integer{&mt.m_mpz});
+        };
+        auto check = [&](const integer &a, const integer &b) { check_gst(g, s, t, a, b); };
+
+        // A few simple tests.
+        gcdext(g, s, t, integer{}, integer{});
+        REQUIRE(g == 0);
+        REQUIRE(s == 0);
+        REQUIRE(t == 0);
+        check(integer{}, integer{});
+        {
+            // Both operands zero: the outputs must be proper zeroes
+            // (checked also by the destructor in debug mode).
+            integer g0, s0, t0, z;
+            gcdext(g0, s0, t0, z, z);
+            REQUIRE(g0 + 1 == 1);
+            REQUIRE(s0 + 1 == 1);
+            REQUIRE(t0 + 1 == 1);
+        }
+        gcdext(g, s, t, integer{}, integer{-6});
+        REQUIRE(g == 6);
+        REQUIRE(s == 0);
+        REQUIRE(t == -1);
+        check(integer{}, integer{-6});
+        gcdext(g, s, t, integer{6}, integer{});
+        REQUIRE(g == 6);
+        REQUIRE(s == 1);
+        REQUIRE(t == 0);
+        check(integer{6}, integer{});
+        gcdext(g, s, t, integer{240}, integer{46});
+        REQUIRE(g == 2);
+        REQUIRE(s == -9);
+        REQUIRE(t == 47);
+        check(integer{240}, integer{46});
+        gcdext(g, s, t, integer{-240}, integer{46});
+        REQUIRE(g == 2);
+        REQUIRE(s == 9);
+        REQUIRE(t == 47);
+        check(integer{-240}, integer{46});
+        for (auto a : {-6, -3, -2, -1, 1, 2, 3, 6}) {
+            for (auto b : {-6, -3, -2, -1, 1, 2, 3, 6}) {
+                gcdext(g, s, t, integer{a}, integer{b});
+                check(integer{a}, integer{b});
+            }
+        }
+
+        // The return values must be distinct.
+        REQUIRE_THROWS_PREDICATE(gcdext(g, g, t, integer{1}, integer{2}), std::invalid_argument,
+                                 [](const std::invalid_argument &ex) {
+                                     return std::string(ex.what())
+                                            == "When computing the extended GCD, the return values 'g', 's' and "
+                                               "'t' must be distinct objects";
+                                 });
+        REQUIRE_THROWS_AS(gcdext(g, s, g, integer{1}, integer{2}), std::invalid_argument);
+        REQUIRE_THROWS_AS(gcdext(g, s, s, integer{1}, integer{2}), std::invalid_argument);
+
+        // Random testing.
+        integer n1, n2;
+        detail::mpz_raii tmp;
+        std::uniform_int_distribution<int> sdist(0, 1);
+        auto random_int = [&](integer &n, unsigned x) {
+            random_integer(tmp, x, rng);
+            n = &tmp.m_mpz;
+            if (sdist(rng)) {
+                n.neg();
+            }
+            if (n.is_static() && sdist(rng)) {
+                // Promote sometimes, if possible.
+                n.promote();
+            }
+        };
+        auto random_xy = [&](unsigned x, unsigned y) {
+            for (int i = 0; i < ntries; ++i) {
+                random_int(n1, x);
+                random_int(n2, y);
+                if (sdist(rng) && sdist(rng) && sdist(rng)) {
+                    // Reset the return values every once in a while.
+                    g = integer{};
+                    s = integer{};
+                    t = integer{};
+                }
+                gcdext(g, s, t, n1, n2);
+                check(n1, n2);
+
+                // Special values of the operands.
+                gcdext(g, s, t, n1, n1);
+                check(n1, n1);
+                gcdext(g, s, t, n1, -n1);
+                check(n1, -n1);
+                gcdext(g, s, t, n1, 2 * n1);
+                check(n1, 2 * n1);
+                gcdext(g, s, t, -2 * n2, n2);
+                check(-2 * n2, n2);
+                gcdext(g, s, t, n1 * n2, n2);
+                check(n1 * n2, n2);
+
+                // Overlapping arguments.
+                const auto n1_old(n1), n2_old(n2);
+                gcdext(n1, s, t, n1, n2);
+                check_gst(n1, s, t, n1_old, n2_old);
+                n1 = n1_old;
+                gcdext(g, n1, t, n1, n2);
+                check_gst(g, n1, t, n1_old, n2_old);
+                n1 = n1_old;
+                gcdext(g, s, n1, n1, n2);
+                check_gst(g, s, n1, n1_old, n2_old);
+                n1 = n1_old;
+                gcdext(g, n2, n1, n1, n2);
+                check_gst(g, n2, n1, n1_old, n2_old);
+                n1 = n1_old;
+                n2 = n2_old;
+            }
+        };
+
+        for (unsigned x = 0; x <= 4u; ++x) {
+            for (unsigned y = 0; y <= 4u; ++y) {
+                random_xy(x, y);
+            }
+        }
+
+        // Consecutive Fibonacci numbers, which maximise
+        // the number of iterations.
+        integer f0{1}, f1{1};
+        for (int i = 0; i < 200; ++i) {
+            gcdext(g, s, t, f1, f0);
+            check(f1, f0);
+            gcdext(g, s, t, f0, -f1);
+            check(f0, -f1);
+            f0 += f1;
+            swap(f0, f1);
+        }
+    }
+};
+
+TEST_CASE("gcdext")
+{
+    tuple_for_each(sizes{}, gcdext_tester{});
+}
+
+struct invert_tester {
+    template <typename S>
+    void operator()(const S &) const
+    {
+        using integer = integer<S::value>;
+        integer ret;
+
+        // A few simple tests.
+        invert(ret, integer{3}, integer{7});
+        REQUIRE(ret == 5);
+        REQUIRE(invert(integer{3}, integer{-7}) == 5);
+        REQUIRE(invert(integer{-3}, integer{7}) == 2);
+        REQUIRE(invert(integer{-3}, integer{-7}) == 2);
+        REQUIRE(invert(integer{10}, integer{7}) == 5);
+        REQUIRE(invert(integer{1}, integer{2}) == 1);
+        REQUIRE(invert(integer{-1}, integer{2}) == 1);
+        REQUIRE(invert(integer{0}, integer{1}) == 0);
+        REQUIRE(invert(integer{5}, integer{-1}) == 0);
+
+        // Non-invertible values.
+        ret = 42;
+        REQUIRE_THROWS_PREDICATE(invert(ret, integer{2}, integer{4}), zero_division_error,
+                                 [](const zero_division_error &ex) {
+                                     return std::string(ex.what()) == "Cannot compute the inverse of 2 modulo 4";
+                                 });
+        REQUIRE(ret == 42);
+        REQUIRE_THROWS_PREDICATE(invert(integer{0}, integer{-5}), zero_division_error,
+                                 [](const zero_division_error &ex) {
+                                     return std::string(ex.what()) == "Cannot compute the inverse of 0 modulo -5";
+                                 });
+
+        // Zero modulus.
+        REQUIRE_THROWS_PREDICATE(
+            invert(ret, integer{3}, integer{0}), zero_division_error,
+            [](const zero_division_error &ex) { return std::string(ex.what()) == "Integer division by zero"; });
+
+        // Random testing.
+        integer n1, n2, n3;
+        detail::mpz_raii tmp;
+        std::uniform_int_distribution<int> sdist(0, 1);
+        auto random_int = [&](integer &n, unsigned x) {
+            random_integer(tmp, x, rng);
+            n = &tmp.m_mpz;
+            if (sdist(rng)) {
+                n.neg();
+            }
+            if (n.is_static() && sdist(rng)) {
+                // Promote sometimes, if possible.
+                n.promote();
+            }
+        };
+        auto random_xy = [&](unsigned x, unsigned y) {
+            for (int i = 0; i < ntries; ++i) {
+                random_int(n2, x);
+                random_int(n3, y);
+                if (n3 == 0) {
+                    continue;
+                }
+                if (::mpz_invert(&tmp.m_mpz, n2.get_mpz_view(), n3.get_mpz_view())) {
+                    invert(n1, n2, n3);
+                    REQUIRE(n1 == integer{&tmp.m_mpz});
+                    REQUIRE(invert(n2, n3) == n1);
+                    // The result is always static if the modulus is.
+                    if (n3.is_static()) {
+                        REQUIRE(n1.is_static());
+                    }
+
+                    // In-place variants.
+                    const auto n2_old(n2), n3_old(n3);
+                    invert(n2, n2, n3);
+                    REQUIRE(n2 == n1);
+                    n2 = n2_old;
+                    invert(n3, n2, n3);
+                    REQUIRE(n3 == n1);
+                    n3 = n3_old;
+                } else {
+                    REQUIRE_THROWS_AS(invert(n1, n2, n3), zero_division_error);
+                }
+            }
+        };
+
+        for (unsigned x = 0; x <= 4u; ++x) {
+            for (unsigned y = 1; y <= 4u; ++y) {
+                random_xy(x, y);
+            }
+        }
+
+        // Force odd moduli, so that the inverses exist more often.
+        for (int i = 0; i < ntries; ++i) {
+            for (unsigned y = 1; y <= 2u; ++y) {
+                random_int(n2, 2);
+                random_int(n3, y);
+                if (n3.even_p()) {
+                    ++n3;
+                }
+                if (n3 == 0 || !::mpz_invert(&tmp.m_mpz, n2.get_mpz_view(), n3.get_mpz_view())) {
+                    continue;
+                }
+                invert(n1, n2, n3);
+                REQUIRE(n1 == integer{&tmp.m_mpz});
+                REQUIRE((n1 * n2 - 1) % n3 == 0);
+            }
+        }
+    }
+};
+
+TEST_CASE("invert")
+{
+    tuple_for_each(sizes{}, invert_tester{});
+}
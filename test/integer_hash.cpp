@@ -6,11 +6,15 @@
 // Public License v. 2.0. If a copy of the MPL was not distributed
 // with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <random>
 #include <tuple>
 #include <type_traits>
+#include <unordered_set>
+#include <vector>
 
 #include <gmp.h>
 
@@ -87,3 +91,104 @@ TEST_CASE("hash")
 {
     tuple_for_each(sizes{}, hash_tester{});
 }
+
+// Number of bits which differ between a and b.
+static unsigned bit_diff(std::uint64_t a, std::uint64_t b)
+{
+    unsigned retval = 0;
+    for (auto x = a ^ b; x != 0u; x &= x - 1u) {
+        ++retval;
+    }
+    return retval;
+}
+
+TEST_CASE("hash quality")
+{
+    using int_t = integer<2>;
+    // Structured keys: small values, values with a single limb set,
+    // multiples of a power of two and pairs of small limbs.
+    std::vector<int_t> keys;
+    for (int i = -20000; i < 20000; ++i) {
+        keys.emplace_back(i);
+        keys.push_back(int_t{i} << 32);
+        keys.push_back(int_t{i} << GMP_NUMB_BITS);
+        keys.push_back((int_t{i} << (3 * GMP_NUMB_BITS)) + i);
+    }
+    for (int i = 1; i < 100; ++i) {
+        for (int j = 0; j < 100; ++j) {
+            keys.push_back((int_t{i} << GMP_NUMB_BITS) + j);
+            keys.push_back((int_t{i} << (5 * GMP_NUMB_BITS)) + (int_t{j} << (2 * GMP_NUMB_BITS)));
+        }
+    }
+    // Limbs equal to the constants of the hash function.
+    for (auto c : {detail::hash_p0, detail::hash_p1, detail::hash_p2, detail::hash_p3}) {
+        const int_t k{c};
+        keys.push_back(k);
+        keys.push_back(-k);
+        for (int i = 1; i < 5; ++i) {
+            keys.push_back((int_t{i} << GMP_NUMB_BITS) + k);
+            keys.push_back(-((int_t{i} << GMP_NUMB_BITS) + k));
+            keys.push_back((k << GMP_NUMB_BITS) + i);
+            // NOTE: a constant in any of the lanes of the hash of a
+            // long integer must not wipe out the other limbs.
+            for (int j = 0; j < 6; ++j) {
+                keys.push_back((int_t{i} << (7 * GMP_NUMB_BITS)) + (k << (j * GMP_NUMB_BITS)));
+                keys.push_back((int_t{i} << (3 * GMP_NUMB_BITS)) + (k << (j % 3 * GMP_NUMB_BITS)));
+            }
+        }
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    // No collisions in the 64-bit hash.
+    std::unordered_set<std::uint64_t> hashes;
+    for (const auto &n : keys) {
+        hashes.insert(detail::hash64(n));
+    }
+    REQUIRE(hashes.size() == keys.size());
+
+    // The lower bits of the hash (i.e., the bits selecting the bucket in
+    // unordered containers) are evenly distributed.
+    std::vector<std::size_t> buckets(1024u);
+    for (const auto &n : keys) {
+        ++buckets[hash(n) % buckets.size()];
+    }
+    const auto avg = keys.size() / buckets.size();
+    REQUIRE(*std::min_element(buckets.begin(), buckets.end()) > avg / 2u);
+    REQUIRE(*std::max_element(buckets.begin(), buckets.end()) < avg * 2u);
+
+    // Avalanche: flipping a single bit of the value flips
+    // on average half the bits of the hash.
+    std::mt19937 rng;
+    detail::mpz_raii tmp;
+    for (unsigned x = 1; x <= 8u; ++x) {
+        unsigned long tot = 0, count = 0;
+        for (int i = 0; i < ntries; ++i) {
+            random_integer(tmp, x, rng);
+            const int_t n{&tmp.m_mpz};
+            if (n.is_zero()) {
+                continue;
+            }
+            const auto h = detail::hash64(n);
+            // NOTE: flip bits which do not change the size of n.
+            const auto nbits = n.nbits() - 1u;
+            for (::mp_bitcnt_t b = 0; b < nbits; b += nbits / 8u + 1u) {
+                auto m = n;
+                if (::mpz_tstbit(&tmp.m_mpz, b)) {
+                    m -= int_t{1} << b;
+                } else {
+                    m += int_t{1} << b;
+                }
+                REQUIRE(m.size() == n.size());
+                tot += bit_diff(h, detail::hash64(m));
+                ++count;
+            }
+            // Negation.
+            tot += bit_diff(h, detail::hash64(-n));
+            ++count;
+        }
+        const auto avg_diff = static_cast<double>(tot) / static_cast<double>(count);
+        REQUIRE(avg_diff > 30.);
+        REQUIRE(avg_diff < 34.);
+    }
+}
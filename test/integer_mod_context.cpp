@@ -0,0 +1,164 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <cstddef>
+#include <random>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+#include <mp++/detail/gmp.hpp>
+#include <mp++/exceptions.hpp>
+#include <mp++/integer.hpp>
+#include <mp++/mod_context.hpp>
+
+#include "catch.hpp"
+#include "test_utils.hpp"
+
+using namespace mppp;
+using namespace mppp_test;
+
+using sizes = std::tuple<std::integral_constant<std::size_t, 1>, std::integral_constant<std::size_t, 2>,
+                         std::integral_constant<std::size_t, 3>, std::integral_constant<std::size_t, 6>,
+                         std::integral_constant<std::size_t, 10>>;
+
+static int ntries = 1000;
+
+static std::mt19937 rng;
+
+struct mod_context_tester {
+    template <typename S>
+    void operator()(const S &) const
+    {
+        using integer = integer<S::value>;
+        using mod_context = mod_context<S::value>;
+
+        REQUIRE_THROWS_PREDICATE(mod_context{integer{}}, zero_division_error, [](const zero_division_error &ex) {
+            return std::string(ex.what()) == "Cannot create a modular context with a zero modulus";
+        });
+
+        // A few simple tests.
+        mod_context ctx{integer{-7}};
+        REQUIRE(ctx.get_mod() == 7);
+        REQUIRE(ctx.reduce(integer{0}) == 0);
+        REQUIRE(ctx.reduce(integer{15}) == 1);
+        REQUIRE(ctx.reduce(integer{-15}) == 6);
+        REQUIRE(ctx.reduce(integer{-14}) == 0);
+        REQUIRE(ctx.mulm(integer{3}, integer{-4}) == 2);
+        REQUIRE(ctx.mulm(integer{-3}, integer{-4}) == 5);
+        REQUIRE(ctx.sqrm(integer{-3}) == 2);
+        REQUIRE(ctx.powm(integer{3}, integer{0}) == 1);
+        REQUIRE(ctx.powm(integer{0}, integer{0}) == 1);
+        REQUIRE(ctx.powm(integer{0}, integer{3}) == 0);
+        REQUIRE(ctx.powm(integer{-2}, integer{3}) == 6);
+        REQUIRE(ctx.powm(integer{3}, integer{-1}) == 5);
+        REQUIRE_THROWS_AS(ctx.powm(integer{14}, integer{-1}), zero_division_error);
+
+        mod_context ctx1{integer{1}};
+        REQUIRE(ctx1.reduce(integer{-15}) == 0);
+        REQUIRE(ctx1.mulm(integer{3}, integer{-4}) == 0);
+        REQUIRE(ctx1.sqrm(integer{3}) == 0);
+        REQUIRE(ctx1.powm(integer{3}, integer{0}) == 0);
+        REQUIRE(ctx1.powm(integer{3}, integer{5}) == 0);
+
+        mod_context ctx2{integer{10}};
+        REQUIRE(ctx2.powm(integer{-2}, integer{3}) == 2);
+        REQUIRE(ctx2.powm(integer{3}, integer{-1}) == 7);
+
+        // Random testing.
+        integer n1, n2, n3, n4;
+        detail::mpz_raii tmp;
+        std::uniform_int_distribution<int> sdist(0, 1);
+        auto random_int = [&](integer &n, unsigned x, bool neg) {
+            random_integer(tmp, x, rng);
+            n = &tmp.m_mpz;
+            if (neg && sdist(rng)) {
+                n.neg();
+            }
+            if (n.is_static() && sdist(rng)) {
+                // Promote sometimes, if possible.
+                n.promote();
+            }
+        };
+        // Reference implementations.
+        auto mod = [&tmp](const integer &n, const integer &m) {
+            ::mpz_mod(&tmp.m_mpz, n.get_mpz_view(), m.get_mpz_view());
+            return integer{&tmp.m_mpz};
+        };
+        auto ref_powm = [&tmp](const integer &b, const integer &e, const integer &m) {
+            ::mpz_powm(&tmp.m_mpz, b.get_mpz_view(), e.get_mpz_view(), m.get_mpz_view());
+            return integer{&tmp.m_mpz};
+        };
+        // Run a variety of tests with operands with x limbs and a modulus with z limbs.
+        auto random_xz = [&](unsigned x, unsigned z) {
+            for (int i = 0; i < ntries; ++i) {
+                random_int(n4, z, true);
+                if (n4 == 0) {
+                    continue;
+                }
+                if (sdist(rng) && sdist(rng)) {
+                    // Force an odd modulus every once in a while.
+                    n4 |= 1;
+                }
+                const mod_context c{n4};
+                REQUIRE(c.get_mod() == abs(n4));
+
+                random_int(n2, x, true);
+                random_int(n3, x, true);
+                if (sdist(rng) && sdist(rng) && sdist(rng)) {
+                    // Reset rop every once in a while.
+                    n1 = integer{};
+                }
+
+                c.reduce(n1, n2);
+                REQUIRE(n1 == mod(n2, n4));
+                REQUIRE(c.reduce(n3) == mod(n3, n4));
+
+                c.mulm(n1, n2, n3);
+                REQUIRE(n1 == mod(n2 * n3, n4));
+                REQUIRE(c.mulm(n2, n3) == n1);
+
+                c.sqrm(n1, n2);
+                REQUIRE(n1 == mod(n2 * n2, n4));
+                REQUIRE(c.sqrm(n2) == n1);
+
+                // Exponents with up to 3 limbs.
+                random_int(n3, static_cast<unsigned>(i % 4), false);
+                c.powm(n1, n2, n3);
+                REQUIRE(n1 == ref_powm(n2, n3, n4));
+                REQUIRE(c.powm(n2, n3) == n1);
+
+                // In-place variants.
+                auto n2_old(n2);
+                c.reduce(n2, n2);
+                REQUIRE(n2 == mod(n2_old, n4));
+                n2 = n2_old;
+                c.mulm(n2, n2, n2);
+                REQUIRE(n2 == mod(n2_old * n2_old, n4));
+                n2 = n2_old;
+                c.sqrm(n2, n2);
+                REQUIRE(n2 == mod(n2_old * n2_old, n4));
+                n2 = n2_old;
+                c.powm(n2, n2, n3);
+                REQUIRE(n2 == ref_powm(n2_old, n3, n4));
+                n2 = n2_old;
+            }
+        };
+
+        for (unsigned x = 0; x <= 4u; ++x) {
+            for (unsigned z = 1; z <= 3u; ++z) {
+                random_xz(x, z);
+            }
+        }
+    }
+};
+
+TEST_CASE("mod_context")
+{
+    tuple_for_each(sizes{}, mod_context_tester{});
+}
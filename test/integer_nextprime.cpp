@@ -48,6 +48,16 @@ struct nextprime_tester {
         REQUIRE(n1.is_static());
         ::mpz_nextprime(&m1.m_mpz, &m1.m_mpz);
         REQUIRE((lex_cast(nextprime(n1)) == lex_cast(m1)));
+        // Values close to the 1-limb and 2-limb boundaries.
+        for (const auto *str : {"18446744073709551556", "18446744073709551557", "18446744073709551615",
+                                "340282366920938463463374607431768211296", "340282366920938463463374607431768211455"}) {
+            ::mpz_set_str(&m2.m_mpz, str, 10);
+            ::mpz_nextprime(&m1.m_mpz, &m2.m_mpz);
+            n2 = integer{str};
+            REQUIRE((lex_cast(nextprime(n2)) == lex_cast(m1)));
+            n2.nextprime();
+            REQUIRE((lex_cast(n2) == lex_cast(m1)));
+        }
         detail::mpz_raii tmp;
         std::uniform_int_distribution<int> sdist(0, 1);
         // Run a variety of tests with operands with x number of limbs.
@@ -0,0 +1,107 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <random>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include <gmp.h>
+
+#include <mp++/integer.hpp>
+#include <mp++/parallel.hpp>
+
+#include "catch.hpp"
+#include "test_utils.hpp"
+
+using namespace mppp;
+using namespace mppp_test;
+
+using sizes = std::tuple<std::integral_constant<std::size_t, 1>, std::integral_constant<std::size_t, 2>,
+                         std::integral_constant<std::size_t, 3>, std::integral_constant<std::size_t, 6>>;
+
+static std::mt19937 rng;
+
+struct parallel_tester {
+    template <typename S>
+    inline void operator()(const S &) const
+    {
+        using integer = integer<S::value>;
+        detail::mpz_raii tmp;
+        std::uniform_int_distribution<unsigned> ldist(0, S::value + 1u);
+        std::uniform_int_distribution<int> sdist(0, 1);
+        for (const unsigned nt : {1u, 2u, 3u, 8u}) {
+            parallel::set_n_threads(nt);
+            REQUIRE(parallel::get_n_threads() == nt);
+            // NOTE: the sizes include ranges which are split in many chunks.
+            for (const std::size_t n : {0u, 1u, 2u, 5u, 1000u, 20000u}) {
+                std::vector<integer> v1, v2;
+                integer s, d, p{1};
+                for (std::size_t i = 0; i < n; ++i) {
+                    random_integer(tmp, ldist(rng), rng);
+                    v1.emplace_back(&tmp.m_mpz);
+                    random_integer(tmp, ldist(rng), rng);
+                    v2.emplace_back(&tmp.m_mpz);
+                    if (sdist(rng)) {
+                        v1.back().neg();
+                    }
+                    s += v1.back();
+                    addmul(d, v1.back(), v2.back());
+                }
+                REQUIRE(parallel::sum(v1.begin(), v1.end()) == s);
+                REQUIRE(parallel::dot(v1.begin(), v1.end(), v2.begin()) == d);
+                REQUIRE(parallel::dot(v1.cbegin(), v1.cend(), std::deque<integer>(v2.begin(), v2.end()).begin())
+                        == d);
+                // NOTE: use small values in the product, otherwise it becomes too expensive.
+                for (std::size_t i = 0; i < n; ++i) {
+                    v2[i] = integer{static_cast<int>(i % 7u) + 1} * (sdist(rng) ? 1 : -1);
+                    p *= v2[i];
+                }
+                REQUIRE(parallel::product(v2.begin(), v2.end()) == p);
+                if (n != 0u) {
+                    // A zero anywhere in the range.
+                    v2[n / 2u] = 0;
+                    REQUIRE(parallel::product(v2.begin(), v2.end()) == 0);
+                }
+            }
+        }
+        parallel::set_n_threads(0);
+    }
+};
+
+TEST_CASE("parallel reductions")
+{
+    tuple_for_each(sizes{}, parallel_tester{});
+}
+
+TEST_CASE("parallel run")
+{
+    // Exceptions thrown by the tasks are re-thrown in the calling thread,
+    // after the completion of all the tasks.
+    parallel::set_n_threads(4);
+    std::atomic<std::size_t> counter(0);
+    REQUIRE_THROWS_AS(detail::parallel_run(100,
+                                           [&counter](std::size_t i) {
+                                               ++counter;
+                                               if (i == 42u) {
+                                                   throw std::invalid_argument("");
+                                               }
+                                           }),
+                      std::invalid_argument);
+    REQUIRE(counter.load() == 100u);
+    // Nested invocations.
+    counter = 0;
+    detail::parallel_run(8, [&counter](std::size_t) { detail::parallel_run(8, [&counter](std::size_t) { ++counter; }); });
+    REQUIRE(counter.load() == 64u);
+    parallel::set_n_threads(0);
+    REQUIRE(parallel::get_n_threads() >= 1u);
+}
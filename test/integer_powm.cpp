@@ -0,0 +1,214 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <cstddef>
+#include <random>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+#include <mp++/detail/gmp.hpp>
+#include <mp++/exceptions.hpp>
+#include <mp++/integer.hpp>
+
+#include "catch.hpp"
+#include "test_utils.hpp"
+
+using namespace mppp;
+using namespace mppp_test;
+
+using sizes = std::tuple<std::integral_constant<std::size_t, 1>, std::integral_constant<std::size_t, 2>,
+                         std::integral_constant<std::size_t, 3>, std::integral_constant<std::size_t, 4>,
+                         std::integral_constant<std::size_t, 6>, std::integral_constant<std::size_t, 10>>;
+
+static int ntries = 1000;
+
+static std::mt19937 rng;
+
+struct powm_tester {
+    template <typename S>
+    void operator()(const S &) const
+    {
+        using integer = integer<S::value>;
+        integer ret;
+
+        // A few simple tests.
+        powm(ret, integer{0}, integer{0}, integer{1});
+        REQUIRE(ret == 0);
+        REQUIRE(powm(integer{0}, integer{0}, integer{-1}) == 0);
+
+        powm(ret, integer{0}, integer{0}, integer{3});
+        REQUIRE(ret == 1);
+        REQUIRE(powm(integer{0}, integer{0}, integer{-3}) == 1);
+
+        powm(ret, integer{0}, integer{5}, integer{3});
+        REQUIRE(ret == 0);
+        REQUIRE(powm(integer{0}, integer{5}, integer{-3}) == 0);
+
+        powm(ret, integer{5}, integer{3}, integer{1});
+        REQUIRE(ret == 0);
+        REQUIRE(powm(integer{5}, integer{3}, integer{-1}) == 0);
+
+        powm(ret, integer{2}, integer{10}, integer{1000});
+        REQUIRE(ret == 24);
+        REQUIRE(powm(integer{2}, integer{10}, integer{1001}) == 23);
+
+        powm(ret, integer{-2}, integer{3}, integer{7});
+        REQUIRE(ret == 6);
+        REQUIRE(powm(integer{-2}, integer{3}, integer{-7}) == 6);
+
+        powm(ret, integer{-2}, integer{2}, integer{7});
+        REQUIRE(ret == 4);
+        REQUIRE(powm(integer{-2}, integer{2}, integer{-7}) == 4);
+
+        powm(ret, integer{-7}, integer{3}, integer{7});
+        REQUIRE(ret == 0);
+        REQUIRE(powm(integer{-14}, integer{3}, integer{-7}) == 0);
+
+        // Negative exponents.
+        powm(ret, integer{3}, integer{-1}, integer{7});
+        REQUIRE(ret == 5);
+        REQUIRE(powm(integer{3}, integer{-2}, integer{7}) == 4);
+        REQUIRE(powm(integer{-3}, integer{-1}, integer{8}) == 5);
+
+        REQUIRE_THROWS_PREDICATE(powm(ret, integer{2}, integer{-1}, integer{4}), zero_division_error,
+                                 [](const zero_division_error &ex) {
+                                     return std::string(ex.what())
+                                            == "Cannot raise 2 to the negative power -1 modulo 4: the base is not "
+                                               "invertible";
+                                 });
+        REQUIRE_THROWS_PREDICATE(powm(integer{0}, integer{-3}, integer{5}), zero_division_error,
+                                 [](const zero_division_error &ex) {
+                                     return std::string(ex.what())
+                                            == "Cannot raise 0 to the negative power -3 modulo 5: the base is not "
+                                               "invertible";
+                                 });
+
+        // Zero modulus.
+        REQUIRE_THROWS_PREDICATE(
+            powm(ret, integer{-2}, integer{2}, integer{0}), zero_division_error,
+            [](const zero_division_error &ex) { return std::string(ex.what()) == "Integer division by zero"; });
+        REQUIRE_THROWS_PREDICATE(
+            powm(integer{-2}, integer{-2}, integer{0}), zero_division_error,
+            [](const zero_division_error &ex) { return std::string(ex.what()) == "Integer division by zero"; });
+
+        // Random testing.
+        integer n1, n2, n3, n4;
+        detail::mpz_raii tmp;
+        std::uniform_int_distribution<int> sdist(0, 1);
+        auto random_int = [&](integer &n, unsigned x, bool neg) {
+            random_integer(tmp, x, rng);
+            n = &tmp.m_mpz;
+            if (neg && sdist(rng)) {
+                n.neg();
+            }
+            if (n.is_static() && sdist(rng)) {
+                // Promote sometimes, if possible.
+                n.promote();
+            }
+        };
+        // Check n1 against the mpz result.
+        auto check = [&tmp](const integer &r, const integer &b, const integer &e, const integer &m) {
+            ::mpz_powm(&tmp.m_mpz, b.get_mpz_view(), e.get_mpz_view(), m.get_mpz_view());
+            REQUIRE(r == integer{&tmp.m_mpz});
+        };
+        // Run a variety of tests with base, exponent and modulus
+        // with x, y and z number of limbs.
+        auto random_xyz = [&](unsigned x, unsigned y, unsigned z) {
+            for (int i = 0; i < ntries; ++i) {
+                random_int(n2, x, true);
+                random_int(n3, y, false);
+                random_int(n4, z, true);
+                if (n4 == 0) {
+                    continue;
+                }
+                if (sdist(rng) && sdist(rng) && sdist(rng)) {
+                    // Reset rop every once in a while.
+                    n1 = integer{};
+                }
+                powm(n1, n2, n3, n4);
+                check(n1, n2, n3, n4);
+                // The result is always static if the modulus is.
+                if (n4.is_static()) {
+                    REQUIRE(n1.is_static());
+                }
+
+                // The ternary variant.
+                REQUIRE(powm(n2, n3, n4) == n1);
+
+                // In-place variants.
+                auto n2_old(n2);
+                powm(n2, n2, n3, n4);
+                REQUIRE(n2 == n1);
+                n2 = n2_old;
+
+                auto n3_old(n3);
+                powm(n3, n2, n3, n4);
+                REQUIRE(n3 == n1);
+                n3 = n3_old;
+
+                auto n4_old(n4);
+                powm(n4, n2, n3, n4);
+                REQUIRE(n4 == n1);
+                n4 = n4_old;
+
+                if (n2 != 0) {
+                    powm(n1, n2, n3, n2);
+                    check(n1, n2, n3, n2);
+                    powm(n1, n4, n3, n4);
+                    check(n1, n4, n3, n4);
+                }
+
+                // Negative exponents.
+                if (n3 != 0) {
+                    n3.neg();
+                    if (::mpz_invert(&tmp.m_mpz, n2.get_mpz_view(), n4.get_mpz_view())) {
+                        powm(n1, n2, n3, n4);
+                        // n1 * n2**abs(n3) must be 1 mod n4.
+                        REQUIRE(powm(n2, -n3, n4) * n1 % n4 == powm(integer{1}, integer{1}, n4));
+                    } else {
+                        REQUIRE_THROWS_AS(powm(n1, n2, n3, n4), zero_division_error);
+                    }
+                    n3.neg();
+                }
+            }
+        };
+
+        for (unsigned x = 0; x <= 4u; ++x) {
+            for (unsigned y = 0; y <= 2u; ++y) {
+                for (unsigned z = 1; z <= 4u; ++z) {
+                    random_xyz(x, y, z);
+                }
+            }
+        }
+
+        // Force odd moduli, in order to exercise the Montgomery code paths.
+        for (int i = 0; i < ntries; ++i) {
+            for (unsigned z = 1; z <= 2u; ++z) {
+                random_int(n2, 2, true);
+                // NOTE: use large exponents as well, in order to test
+                // all the window sizes.
+                random_int(n3, 1u + static_cast<unsigned>(i % 6), false);
+                random_int(n4, z, true);
+                if (n4.even_p()) {
+                    ++n4;
+                }
+                if (n4 == 0) {
+                    continue;
+                }
+                powm(n1, n2, n3, n4);
+                check(n1, n2, n3, n4);
+            }
+        }
+    }
+};
+
+TEST_CASE("powm")
+{
+    tuple_for_each(sizes{}, powm_tester{});
+}
@@ -0,0 +1,145 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <random>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include <mp++/integer.hpp>
+#include <mp++/prime_sieve.hpp>
+
+#include "catch.hpp"
+#include "test_utils.hpp"
+
+static int ntries = 100;
+
+using namespace mppp;
+using namespace mppp_test;
+
+using sizes = std::tuple<std::integral_constant<std::size_t, 1>, std::integral_constant<std::size_t, 2>,
+                         std::integral_constant<std::size_t, 3>, std::integral_constant<std::size_t, 6>,
+                         std::integral_constant<std::size_t, 10>>;
+
+static std::mt19937 rng;
+
+struct prime_sieve_tester {
+    template <typename S>
+    inline void operator()(const S &) const
+    {
+        using integer = integer<S::value>;
+        // Reference implementation via nextprime().
+        auto ref = [](const integer &lo, const integer &hi) {
+            std::vector<integer> retval;
+            auto p = lo.sgn() < 0 ? integer{-1} : lo - 1;
+            for (p.nextprime(); p < hi; p.nextprime()) {
+                retval.push_back(p);
+            }
+            return retval;
+        };
+        auto from_range = [](const integer &lo, const integer &hi) {
+            std::vector<integer> retval;
+            prime_range<S::value> r(lo, hi);
+            for (const auto &p : r) {
+                retval.push_back(p);
+            }
+            return retval;
+        };
+        auto check = [&](const integer &lo, const integer &hi, unsigned nthreads) {
+            std::vector<integer> out{integer{42}};
+            const auto r = ref(lo, hi);
+            primes_in(lo, hi, out, nthreads);
+            REQUIRE(out == r);
+            REQUIRE(from_range(lo, hi) == r);
+        };
+
+        auto ints = [](std::initializer_list<int> l) {
+            std::vector<integer> retval;
+            for (auto n : l) {
+                retval.emplace_back(n);
+            }
+            return retval;
+        };
+
+        // Small and empty ranges.
+        std::vector<integer> out;
+        primes_in(integer{0}, integer{30}, out);
+        REQUIRE(out == ints({2, 3, 5, 7, 11, 13, 17, 19, 23, 29}));
+        primes_in(integer{-10}, integer{4}, out);
+        REQUIRE(out == ints({2, 3}));
+        primes_in(integer{30}, integer{30}, out);
+        REQUIRE(out.empty());
+        primes_in(integer{30}, integer{10}, out);
+        REQUIRE(out.empty());
+        primes_in(integer{-30}, integer{-10}, out);
+        REQUIRE(out.empty());
+        primes_in(integer{3}, integer{4}, out);
+        REQUIRE(out == ints({3}));
+        for (int lo = -3; lo < 40; ++lo) {
+            for (int hi = lo; hi < 60; ++hi) {
+                check(integer{lo}, integer{hi}, 1);
+            }
+        }
+        {
+            prime_range<S::value> r(integer{24}, integer{29});
+            REQUIRE(r.begin() == r.end());
+        }
+        {
+            prime_range<S::value> r(integer{10}, integer{20});
+            auto it = r.begin();
+            REQUIRE(it->is_static());
+            REQUIRE(*it == 11);
+            it++;
+            REQUIRE(*it == 13);
+            ++it;
+            REQUIRE(*it == 17);
+            ++it;
+            REQUIRE(*it == 19);
+            REQUIRE(++it == r.end());
+            REQUIRE(std::is_same<typename std::iterator_traits<decltype(it)>::iterator_category,
+                                 std::input_iterator_tag>::value);
+        }
+
+        // Counts of primes up to powers of 10, with multiple threads.
+        for (auto nt : {0u, 1u, 2u, 3u}) {
+            primes_in(integer{0}, integer{10000000}, out, nt);
+            REQUIRE(out.size() == 664579u);
+            REQUIRE(out.back() == 9999991);
+        }
+        std::size_t count = 0;
+        for (const auto &p : prime_range<S::value>(integer{1000000}, integer{10000000})) {
+            detail::ignore(p);
+            ++count;
+        }
+        REQUIRE(count == 664579u - 78498u);
+
+        // Random ranges.
+        std::uniform_int_distribution<long long> ldist(0, 10000000), lendist(0, 100000);
+        for (int i = 0; i < ntries; ++i) {
+            const auto lo = ldist(rng);
+            check(integer{lo}, integer{lo + lendist(rng)}, static_cast<unsigned>(i % 3));
+        }
+
+        // Ranges which are too short to be sieved, and ranges crossing the sieve limit.
+        const integer limit{detail::prime_sieve_limit};
+        check(integer{1} << 40, (integer{1} << 40) + 1000, 1);
+        check(limit - 100000, limit + 1000, 2);
+        check(limit, limit + 1000, 2);
+        check((integer{1} << 64) - 1000, (integer{1} << 64) + 1000, 1);
+        check((integer{1} << 128) - 1000, (integer{1} << 128) + 1000, 1);
+    }
+};
+
+TEST_CASE("prime_sieve")
+{
+    tuple_for_each(sizes{}, prime_sieve_tester{});
+}
@@ -7,6 +7,7 @@
 // with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
 
 #include <cstddef>
+#include <random>
 #include <stdexcept>
 #include <string>
 #include <tuple>
@@ -22,6 +23,10 @@
 using namespace mppp;
 using namespace mppp_test;
 
+static std::mt19937 rng;
+
+static int ntries = 1000;
+
 using sizes = std::tuple<std::integral_constant<std::size_t, 1>, std::integral_constant<std::size_t, 2>,
                          std::integral_constant<std::size_t, 3>, std::integral_constant<std::size_t, 6>,
                          std::integral_constant<std::size_t, 10>>;
@@ -47,6 +52,55 @@ struct probab_prime_p_tester {
         REQUIRE((probab_prime_p(integer{17}) != 0));
         REQUIRE((probab_prime_p(integer{49979687ll}) != 0));
         REQUIRE((probab_prime_p(integer{128}) == 0));
+        // Small primes and composites.
+        for (int i = 0; i < 4000; ++i) {
+            ::mpz_set_si(&m1.m_mpz, i);
+            REQUIRE((probab_prime_p(integer{i}) == ::mpz_probab_prime_p(&m1.m_mpz, 25)));
+        }
+        // Carmichael numbers and strong pseudoprimes to several bases.
+        REQUIRE((probab_prime_p(integer{561}) == 0));
+        REQUIRE((probab_prime_p(integer{41041}) == 0));
+        REQUIRE((probab_prime_p(integer{3215031751ll}) == 0));
+        REQUIRE((probab_prime_p(integer{"3825123056546413051"}) == 0));
+        REQUIRE((probab_prime_p(integer{"318665857834031151167461"}) == 0));
+        REQUIRE((probab_prime_p(integer{"3317044064679887385961981"}) == 0));
+        // Large primes.
+        REQUIRE((probab_prime_p(integer{"18446744073709551557"}) != 0));
+        REQUIRE((probab_prime_p(integer{"2305843009213693951"}) != 0));
+        REQUIRE((probab_prime_p(integer{"618970019642690137449562111"}) != 0));
+        REQUIRE((probab_prime_p(integer{"170141183460469231731687303715884105727"}) != 0));
+        REQUIRE((probab_prime_p(integer{"340282366920938463463374607431768211297"}) != 0));
+        REQUIRE((probab_prime_p(integer{"340282366920938463463374607431768211455"}) == 0));
+        REQUIRE((probab_prime_p(integer{"340282366920938463463374607431768211457"}) == 0));
+        // Squares of primes.
+        REQUIRE((probab_prime_p(integer{"18446744073709551557"} * integer{"18446744073709551557"}) == 0));
+        REQUIRE((probab_prime_p(integer{1000003} * integer{1000003}) == 0));
+        // Random testing.
+        detail::mpz_raii tmp;
+        auto random_x = [&](unsigned x) {
+            for (int i = 0; i < ntries; ++i) {
+                random_integer(tmp, x, rng);
+                n1 = &tmp.m_mpz;
+                REQUIRE(((probab_prime_p(n1) != 0) == (::mpz_probab_prime_p(&tmp.m_mpz, 25) != 0)));
+                // Test also a prime and a product of two primes.
+                ::mpz_nextprime(&m1.m_mpz, &tmp.m_mpz);
+                n1 = &m1.m_mpz;
+                REQUIRE((probab_prime_p(n1) != 0));
+                if (::mpz_sizeinbase(&m1.m_mpz, 2) <= 64u) {
+                    REQUIRE((probab_prime_p(n1) == 2));
+                }
+                ::mpz_tdiv_q_2exp(&tmp.m_mpz, &tmp.m_mpz, static_cast<::mp_bitcnt_t>(x * GMP_NUMB_BITS / 2u));
+                ::mpz_nextprime(&tmp.m_mpz, &tmp.m_mpz);
+                ::mpz_mul(&tmp.m_mpz, &tmp.m_mpz, &m1.m_mpz);
+                n1 = &tmp.m_mpz;
+                REQUIRE((probab_prime_p(n1) == 0));
+            }
+        };
+
+        random_x(0);
+        random_x(1);
+        random_x(2);
+        random_x(3);
         // Test errors.
         REQUIRE_THROWS_PREDICATE(probab_prime_p(n1, 0), std::invalid_argument, [](const std::invalid_argument &ex) {
             return std::string(ex.what())
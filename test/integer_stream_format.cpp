@@ -6,6 +6,7 @@
 // Public License v. 2.0. If a copy of the MPL was not distributed
 // with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
 
+#include <cctype>
 #include <cstddef>
 #include <iomanip>
 #include <ios>
@@ -13,6 +14,9 @@
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
+
+#include <gmp.h>
 
 #include <mp++/integer.hpp>
 
@@ -621,3 +625,67 @@ TEST_CASE("out test")
 {
     tuple_for_each(sizes{}, out_tester{});
 }
+
+TEST_CASE("out test large")
+{
+    // Formatting of values large enough to trigger
+    // the divide-and-conquer conversion to string.
+    using integer = integer<1>;
+    const auto n = pow(integer{10}, 40000u) - 1;
+    const auto hex = n.to_string(16);
+    REQUIRE(runner(n) == std::string(40000u, '9'));
+    REQUIRE(runner(-n, std::setw(40005), std::setfill('*')) == "****-" + std::string(40000u, '9'));
+    REQUIRE(runner(n, std::setw(40005), std::setfill('*'), std::left, std::showpos)
+            == "+" + std::string(40000u, '9') + "****");
+    REQUIRE(runner(-n, std::hex, std::showbase, std::setw(static_cast<int>(hex.size() + 13u)), std::setfill('*'),
+                   std::internal)
+            == "-0x" + std::string(10, '*') + hex);
+    auto upper = hex;
+    for (auto &c : upper) {
+        c = static_cast<char>(std::toupper(c));
+    }
+    REQUIRE(runner(n, std::hex, std::showbase, std::uppercase) == "0X" + upper);
+}
+
+struct out_dec_tester {
+    template <typename S>
+    inline void operator()(const S &) const
+    {
+        // Decimal output of values around the limits of
+        // the values formatted without GMP.
+        using integer = integer<S::value>;
+        std::vector<integer> values{integer{}, integer{1}, integer{9}, integer{10}, integer{99}, integer{100}};
+        integer p10{1};
+        for (int i = 0; i < 41; ++i) {
+            values.push_back(p10 - 1);
+            values.push_back(p10);
+            values.push_back(p10 + 1);
+            p10 *= 10;
+        }
+        for (const auto b : {63u, 64u, 65u, 127u, 128u, 129u}) {
+            values.push_back((integer{1} << b) - 1);
+            values.push_back(integer{1} << b);
+        }
+        std::vector<char> buffer;
+        for (const auto &v : values) {
+            for (const auto &n : {v, -v}) {
+                buffer.resize(::mpz_sizeinbase(n.get_mpz_view(), 10) + 2u);
+                ::mpz_get_str(buffer.data(), 10, n.get_mpz_view());
+                const std::string str = buffer.data();
+                REQUIRE(n.to_string() == str);
+                REQUIRE(runner(n) == str);
+                REQUIRE(runner(n, std::setw(50), std::setfill('*'))
+                        == std::string(50u - str.size(), '*') + str);
+                REQUIRE(runner(n, std::showpos) == (n.sgn() >= 0 ? "+" : "") + str);
+                buffer.resize(str.size());
+                const auto ret = to_chars(buffer.data(), buffer.data() + buffer.size(), n);
+                REQUIRE(std::string(buffer.data(), ret.ptr) == str);
+            }
+        }
+    }
+};
+
+TEST_CASE("out test decimal")
+{
+    tuple_for_each(sizes{}, out_dec_tester{});
+}
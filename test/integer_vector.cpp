@@ -0,0 +1,294 @@
+// Copyright 2016-2020 Francesco Biscani (bluescarni@gmail.com)
+//
+// This file is part of the mp++ library.
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include <gmp.h>
+
+#include <mp++/integer.hpp>
+#include <mp++/integer_vector.hpp>
+
+#include "catch.hpp"
+#include "test_utils.hpp"
+
+static int ntries = 1000;
+
+using namespace mppp;
+using namespace mppp_test;
+
+using sizes = std::tuple<std::integral_constant<std::size_t, 1>, std::integral_constant<std::size_t, 2>,
+                         std::integral_constant<std::size_t, 3>, std::integral_constant<std::size_t, 6>,
+                         std::integral_constant<std::size_t, 10>>;
+
+static std::mt19937 rng;
+
+struct vector_tester {
+    template <typename S>
+    inline void operator()(const S &) const
+    {
+        using integer = integer<S::value>;
+        using ivec = integer_vector<S::value>;
+        // Basic API.
+        ivec v0;
+        REQUIRE(v0.size() == 0u);
+        ivec v1(3);
+        REQUIRE(v1.size() == 3u);
+        REQUIRE(v1.get(0) == 0);
+        REQUIRE(v1.is_static(2));
+        v1.set(1, integer{-42});
+        REQUIRE(v1.get(1) == -42);
+        REQUIRE(v1.get(1).is_static());
+        // A promoted value which fits in static storage is stored as static.
+        integer tmp_int{123};
+        tmp_int.promote();
+        v1.set(2, tmp_int);
+        REQUIRE(v1.is_static(2));
+        REQUIRE(v1.get(2) == 123);
+        // A large value.
+        const auto big = integer{1} << (S::value * GMP_NUMB_BITS + 3u);
+        v1.set(0, big);
+        REQUIRE(!v1.is_static(0));
+        REQUIRE(v1.n_dynamic() == 1u);
+        REQUIRE(v1.get(0) == big);
+        v1.set(0, integer{5});
+        REQUIRE(v1.is_static(0));
+        REQUIRE(v1.n_dynamic() == 0u);
+        v1.set(0, big);
+        v1.resize(0);
+        REQUIRE(v1.n_dynamic() == 0u);
+        v1.push_back(big);
+        v1.push_back(integer{7});
+        REQUIRE(v1.size() == 2u);
+        REQUIRE(v1.get(0) == big);
+        REQUIRE(v1.get(1) == 7);
+        // Size mismatches.
+        REQUIRE_THROWS_PREDICATE(add(v0, v0, v1), std::invalid_argument, [](const std::invalid_argument &ex) {
+            return std::string(ex.what())
+                   == "Cannot perform the batch operation 'add' on integer vectors of different sizes (0 and 2)";
+        });
+        REQUIRE_THROWS_AS(addmul(v0, v1, v1), std::invalid_argument);
+        std::vector<int> c;
+        REQUIRE_THROWS_AS(cmp(c, v1, v0), std::invalid_argument);
+        // Random testing against the integer functions, with operands of various sizes.
+        detail::mpz_raii tmp;
+        std::uniform_int_distribution<int> sdist(0, 1);
+        std::uniform_int_distribution<unsigned> ldist(0, S::value + 1u), shdist(0, 2u * GMP_NUMB_BITS);
+        const auto n = static_cast<std::size_t>(ntries);
+        std::vector<integer> a, b, r;
+        ivec va, vb, vr;
+        for (std::size_t i = 0; i < n; ++i) {
+            for (auto *vec : {&a, &b, &r}) {
+                random_integer(tmp, ldist(rng), rng);
+                vec->emplace_back(&tmp.m_mpz);
+                if (sdist(rng)) {
+                    vec->back().neg();
+                }
+            }
+            va.push_back(a.back());
+            vb.push_back(b.back());
+            vr.push_back(r.back());
+        }
+        const auto check = [n](const ivec &v, const std::vector<integer> &cmp_v) {
+            for (std::size_t i = 0; i < n; ++i) {
+                if (v.get(i) != cmp_v[i] || v.is_static(i) != (cmp_v[i].size() <= S::value)) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        ivec out;
+        add(out, va, vb);
+        std::vector<integer> cmp_v(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            cmp_v[i] = a[i] + b[i];
+        }
+        REQUIRE(check(out, cmp_v));
+        sub(out, va, vb);
+        for (std::size_t i = 0; i < n; ++i) {
+            cmp_v[i] = a[i] - b[i];
+        }
+        REQUIRE(check(out, cmp_v));
+        mul(out, va, vb);
+        for (std::size_t i = 0; i < n; ++i) {
+            cmp_v[i] = a[i] * b[i];
+        }
+        REQUIRE(check(out, cmp_v));
+        addmul(vr, va, vb);
+        for (std::size_t i = 0; i < n; ++i) {
+            cmp_v[i] = r[i] + a[i] * b[i];
+        }
+        REQUIRE(check(vr, cmp_v));
+        const auto s = shdist(rng);
+        mul_2exp(out, va, s);
+        for (std::size_t i = 0; i < n; ++i) {
+            cmp_v[i] = a[i] << s;
+        }
+        REQUIRE(check(out, cmp_v));
+        cmp(c, va, vb);
+        for (std::size_t i = 0; i < n; ++i) {
+            REQUIRE(c[i] == cmp(a[i], b[i]));
+        }
+        cmp(c, va, va);
+        for (std::size_t i = 0; i < n; ++i) {
+            REQUIRE(c[i] == 0);
+        }
+        // Overlapping arguments.
+        out = va;
+        add(out, out, out);
+        for (std::size_t i = 0; i < n; ++i) {
+            cmp_v[i] = a[i] + a[i];
+        }
+        REQUIRE(check(out, cmp_v));
+        out = va;
+        mul(out, out, vb);
+        for (std::size_t i = 0; i < n; ++i) {
+            cmp_v[i] = a[i] * b[i];
+        }
+        REQUIRE(check(out, cmp_v));
+        out = va;
+        addmul(out, out, out);
+        for (std::size_t i = 0; i < n; ++i) {
+            cmp_v[i] = a[i] + a[i] * a[i];
+        }
+        REQUIRE(check(out, cmp_v));
+        out = va;
+        mul_2exp(out, out, s);
+        for (std::size_t i = 0; i < n; ++i) {
+            cmp_v[i] = a[i] << s;
+        }
+        REQUIRE(check(out, cmp_v));
+    }
+};
+
+TEST_CASE("integer_vector")
+{
+    tuple_for_each(sizes{}, vector_tester{});
+}
+
+TEST_CASE("integer_vector_simd")
+{
+    // Test the 1-limb kernels at all the available SIMD levels, with values around
+    // the thresholds of the SIMD kernels and dynamic elements in the output vector.
+    using integer = integer<1>;
+    using ivec = integer_vector<1>;
+    const auto orig_level = detail::integer_vector_simd_level();
+    std::vector<integer> special;
+    for (const auto bits : {0u, 1u, 31u, 32u, 33u, 62u, 63u, 64u, 65u}) {
+        const auto p2 = integer{1} << bits;
+        for (const auto &m : {p2 - 1, p2, p2 + 1}) {
+            special.push_back(m);
+            special.push_back(-m);
+        }
+    }
+    std::uniform_int_distribution<std::uint_least64_t> ldist;
+    std::uniform_int_distribution<unsigned> shdist(0, 63), kdist(0, 3);
+    std::uniform_int_distribution<std::size_t> spdist(0, special.size() - 1u);
+    const auto gen = [&]() {
+        switch (kdist(rng)) {
+            case 0:
+                return special[spdist(rng)];
+            case 1:
+                return integer{ldist(rng) >> shdist(rng)};
+            case 2:
+                return -integer{ldist(rng) >> shdist(rng)};
+            default:
+                return integer{static_cast<std::int_least64_t>(ldist(rng) >> 48) - 32768};
+        }
+    };
+    for (int level = 0; level <= orig_level; ++level) {
+        detail::integer_vector_set_simd_level(level);
+        REQUIRE(detail::integer_vector_simd_level() == level);
+        // NOTE: test also sizes which are not multiples of the number of lanes.
+        for (std::size_t n : {0u, 1u, 7u, 9u, 1001u}) {
+            std::vector<integer> a, b, cmp_v(n);
+            ivec va, vb;
+            for (std::size_t i = 0; i < n; ++i) {
+                a.push_back(gen());
+                b.push_back(gen());
+                va.push_back(a.back());
+                vb.push_back(b.back());
+            }
+            const auto check = [n](const ivec &v, const std::vector<integer> &c) {
+                std::size_t n_dyn = 0;
+                for (std::size_t i = 0; i < n; ++i) {
+                    if (v.get(i) != c[i] || v.is_static(i) != (c[i].size() <= 1u)) {
+                        return false;
+                    }
+                    n_dyn += static_cast<std::size_t>(c[i].size() > 1u);
+                }
+                return v.n_dynamic() == n_dyn;
+            };
+            // The output vector initially contains only dynamic elements.
+            const auto dyn_out = [n]() {
+                ivec retval;
+                for (std::size_t i = 0; i < n; ++i) {
+                    retval.push_back(integer{1} << 200);
+                }
+                return retval;
+            };
+            auto out = dyn_out();
+            add(out, va, vb);
+            for (std::size_t i = 0; i < n; ++i) {
+                cmp_v[i] = a[i] + b[i];
+            }
+            REQUIRE(check(out, cmp_v));
+            out = dyn_out();
+            sub(out, va, vb);
+            for (std::size_t i = 0; i < n; ++i) {
+                cmp_v[i] = a[i] - b[i];
+            }
+            REQUIRE(check(out, cmp_v));
+            out = dyn_out();
+            mul(out, va, vb);
+            for (std::size_t i = 0; i < n; ++i) {
+                cmp_v[i] = a[i] * b[i];
+            }
+            REQUIRE(check(out, cmp_v));
+            for (const auto s : {0u, 1u, 31u, 63u, 64u, 65u}) {
+                out = dyn_out();
+                mul_2exp(out, va, s);
+                for (std::size_t i = 0; i < n; ++i) {
+                    cmp_v[i] = a[i] << s;
+                }
+                REQUIRE(check(out, cmp_v));
+            }
+            std::vector<int> c;
+            cmp(c, va, vb);
+            for (std::size_t i = 0; i < n; ++i) {
+                REQUIRE(c[i] == cmp(a[i], b[i]));
+            }
+            // Overlapping arguments.
+            out = va;
+            sub(out, out, vb);
+            for (std::size_t i = 0; i < n; ++i) {
+                cmp_v[i] = a[i] - b[i];
+            }
+            REQUIRE(check(out, cmp_v));
+            out = vb;
+            mul(out, out, out);
+            for (std::size_t i = 0; i < n; ++i) {
+                cmp_v[i] = b[i] * b[i];
+            }
+            REQUIRE(check(out, cmp_v));
+        }
+    }
+    detail::integer_vector_set_simd_level(orig_level);
+    REQUIRE(detail::integer_vector_simd_level() == orig_level);
+    // Out-of-range levels are clamped.
+    detail::integer_vector_set_simd_level(-1);
+    REQUIRE(detail::integer_vector_simd_level() == 0);
+    detail::integer_vector_set_simd_level(100);
+    REQUIRE(detail::integer_vector_simd_level() == orig_level);
+}
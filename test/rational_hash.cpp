@@ -11,6 +11,7 @@
 #include <random>
 #include <tuple>
 #include <type_traits>
+#include <unordered_set>
 
 #include <gmp.h>
 
@@ -38,7 +39,6 @@ struct hash_tester {
         const std::hash<rational> hasher{};
         rational n1;
         const auto orig_h = hash(n1);
-        REQUIRE((hash(n1) == hash(n1.get_num()) + hash(n1.get_den())));
         REQUIRE((hasher(n1) == hash(n1)));
         n1._get_num().promote();
         REQUIRE((hash(n1) == orig_h));
@@ -68,8 +68,16 @@ struct hash_tester {
                 }
                 ::mpq_canonicalize(&tmp.m_mpq);
                 n1 = &tmp.m_mpq;
-                REQUIRE((hash(n1) == hash(n1.get_num()) + hash(n1.get_den())));
                 REQUIRE((hasher(n1) == hash(n1)));
+                // The hash does not depend on the storage type.
+                auto n2 = n1;
+                if (n2.get_num().is_static()) {
+                    n2._get_num().promote();
+                }
+                if (n2.get_den().is_static()) {
+                    n2._get_den().promote();
+                }
+                REQUIRE((hash(n2) == hash(n1)));
             }
         };
 
@@ -85,3 +93,27 @@ TEST_CASE("hash")
 {
     tuple_for_each(sizes{}, hash_tester{});
 }
+
+TEST_CASE("hash quality")
+{
+    using rational = rational<2>;
+    // Swapping numerator and denominator changes the hash.
+    REQUIRE((hash(rational{2, 3}) != hash(rational{3, 2})));
+    REQUIRE((hash(rational{-2, 3}) != hash(rational{-3, 2})));
+    // No collisions among the fractions with small numerator and denominator.
+    std::unordered_set<std::size_t> hashes;
+    std::size_t count = 0;
+    for (int num = -300; num <= 300; ++num) {
+        for (int den = 1; den <= 300; ++den) {
+            const rational q{num, den};
+            // Count only the fractions in lowest terms.
+            if (q.get_den() == den) {
+                hashes.insert(hash(q));
+                ++count;
+            }
+        }
+    }
+    // NOTE: with a 32-bit std::size_t, a handful of
+    // collisions is expected by the birthday bound.
+    REQUIRE(count - hashes.size() <= (sizeof(std::size_t) < 8u ? 10u : 0u));
+}